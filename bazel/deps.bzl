@@ -70,6 +70,15 @@ def deps(repo_mapping = {}):
         repo_mapping = repo_mapping,
     )
 
+    maybe(
+        http_archive,
+        name = "com_github_google_benchmark",
+        url = "https://github.com/google/benchmark/archive/refs/tags/v1.7.1.tar.gz",
+        sha256 = "6430e4092653380d9dc4ccb45a1e2dc9259d581f4866dc0759713126056bc1d7",
+        strip_prefix = "benchmark-1.7.1",
+        repo_mapping = repo_mapping,
+    )
+
     # NOTE: using glog version 0.5.0 since older versions failed
     # to compile on Windows, see:
     # https://github.com/google/glog/issues/472
@@ -0,0 +1,148 @@
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/catch.h"
+#include "eventuals/compose.h"
+#include "eventuals/concurrent.h"
+#include "eventuals/errors.h"
+#include "eventuals/just.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/raise.h"
+#include "eventuals/range.h"
+#include "eventuals/task.h"
+#include "eventuals/terminal.h"
+#include "eventuals/then.h"
+#include "test/allocations.h"
+
+// NOTE: these benchmarks are in their own binary because
+// 'test/allocations.cc' replaces the global 'operator new' (in order
+// to count allocations) which would otherwise skew the timings of
+// every other benchmark.
+
+namespace eventuals::benchmarks {
+namespace {
+
+using eventuals::test::Allocations;
+
+// Reports the average number of allocations per iteration (and per
+// item if 'items' is non-zero) as counters.
+void ReportAllocations(
+    benchmark::State& state,
+    size_t before,
+    size_t items = 0) {
+  const double allocations = Allocations() - before;
+
+  state.counters["allocations"] = benchmark::Counter(
+      allocations,
+      benchmark::Counter::kAvgIterations);
+
+  if (items > 0) {
+    state.counters["allocations_per_item"] = benchmark::Counter(
+        allocations / items,
+        benchmark::Counter::kAvgIterations);
+  }
+}
+
+
+void BM_AllocationsThen(benchmark::State& state) {
+  size_t before = Allocations();
+
+  for (auto _ : state) {
+    int result = 0;
+
+    auto k = Build(
+        Just(42)
+        >> Then([](int i) { return i + 1; })
+        >> Terminal()
+               .start([&](int i) {
+                 result = i;
+               }));
+
+    k.Start();
+
+    benchmark::DoNotOptimize(result);
+  }
+
+  ReportAllocations(state, before);
+}
+
+BENCHMARK(BM_AllocationsThen);
+
+
+void BM_AllocationsTask(benchmark::State& state) {
+  auto task = []() -> Task::Of<int> {
+    return []() {
+      return Just(42);
+    };
+  };
+
+  size_t before = Allocations();
+
+  for (auto _ : state) {
+    int result = 0;
+
+    auto k = Build(
+        task()
+        >> Terminal()
+               .start([&](int i) {
+                 result = i;
+               }));
+
+    k.Start();
+
+    benchmark::DoNotOptimize(result);
+  }
+
+  ReportAllocations(state, before);
+}
+
+BENCHMARK(BM_AllocationsTask);
+
+
+void BM_AllocationsConcurrent(benchmark::State& state) {
+  size_t before = Allocations();
+
+  for (auto _ : state) {
+    *(Range(state.range(0))
+      >> Concurrent([]() {
+          return Map([](int i) {
+            return i + 1;
+          });
+        })
+      >> Loop());
+  }
+
+  ReportAllocations(state, before, state.range(0));
+}
+
+BENCHMARK(BM_AllocationsConcurrent)->Range(1, 1 << 10);
+
+
+void BM_AllocationsRaiseCatch(benchmark::State& state) {
+  size_t before = Allocations();
+
+  for (auto _ : state) {
+    std::string what;
+
+    auto k = Build(
+        Raise(RuntimeError("error"))
+        >> Catch()
+               .raised<RuntimeError>([&](RuntimeError&& error) {
+                 what = error.what();
+               })
+        >> Terminal());
+
+    k.Start();
+
+    benchmark::DoNotOptimize(what);
+  }
+
+  ReportAllocations(state, before);
+}
+
+BENCHMARK(BM_AllocationsRaiseCatch);
+
+} // namespace
+} // namespace eventuals::benchmarks
@@ -0,0 +1,36 @@
+#include <array>
+#include <functional>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/callback.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Creates, moves, and invokes a callable 'F' that captures 'Bytes'
+// bytes, i.e., what happens to every callback that gets submitted to
+// a scheduler.
+template <typename F, size_t Bytes>
+void BM_Callback(benchmark::State& state) {
+  std::array<char, Bytes> bytes = {};
+
+  for (auto _ : state) {
+    F f = [bytes]() {
+      benchmark::DoNotOptimize(bytes);
+    };
+
+    F g = std::move(f);
+
+    g();
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_Callback, Callback<void()>, 8);
+BENCHMARK_TEMPLATE(BM_Callback, std::function<void()>, 8);
+BENCHMARK_TEMPLATE(BM_Callback, Callback<void(), 128>, 128);
+BENCHMARK_TEMPLATE(BM_Callback, PooledCallback<void()>, 128);
+BENCHMARK_TEMPLATE(BM_Callback, std::function<void()>, 128);
+
+} // namespace
+} // namespace eventuals::benchmarks
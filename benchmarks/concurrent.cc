@@ -0,0 +1,162 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/callback.h"
+#include "eventuals/concurrent-ordered.h"
+#include "eventuals/concurrent.h"
+#include "eventuals/eventual.h"
+#include "eventuals/flat-map.h"
+#include "eventuals/just.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/range.h"
+#include "eventuals/reduce.h"
+#include "eventuals/static-thread-pool.h"
+#include "eventuals/then.h"
+#include "glog/logging.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+auto Sum() {
+  return Reduce(
+      /* sum = */ 0,
+      [](int& sum) {
+        return Then([&](int i) {
+          sum += i;
+          return true;
+        });
+      });
+}
+
+
+// Per element cost of running each value on its own fiber.
+void BM_Concurrent(benchmark::State& state) {
+  for (auto _ : state) {
+    int sum = *(Range(static_cast<int>(state.range(0)))
+                >> Concurrent([]() {
+                     return Map([](int i) { return i + 1; });
+                   })
+                >> Sum());
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Concurrent)->Range(1, 1 << 14);
+
+
+// Same as 'BM_Concurrent' but every fiber blocks until all of the
+// fibers have started, i.e., 'state.range(0)' fibers are active at
+// the same time and none of them can be reused.
+void BM_ConcurrentBlocked(benchmark::State& state) {
+  const int fibers = static_cast<int>(state.range(0));
+
+  std::vector<Callback<void()>> callbacks;
+  callbacks.reserve(fibers);
+
+  for (auto _ : state) {
+    callbacks.clear();
+
+    auto [future, k] = Promisify(
+        "concurrent blocked",
+        Range(fibers)
+            >> Concurrent([&]() {
+                return Map([&](int i) {
+                  return Eventual<int>([&callbacks, i](auto& k) {
+                    callbacks.emplace_back([&k, i]() {
+                      k.Start(i + 1);
+                    });
+                  });
+                });
+              })
+            >> Sum());
+
+    k.Start();
+
+    // All of the fibers should be blocked.
+    CHECK_EQ(static_cast<size_t>(fibers), callbacks.size());
+
+    for (Callback<void()>& callback : callbacks) {
+      callback();
+    }
+
+    benchmark::DoNotOptimize(future.get());
+  }
+
+  state.SetItemsProcessed(state.iterations() * fibers);
+}
+
+BENCHMARK(BM_ConcurrentBlocked)->Arg(1 << 10)->Arg(10000);
+
+
+// Same as 'BM_Concurrent' but values are reordered (which is mostly a
+// no-op here since every fiber completes synchronously) and at most
+// 'state.range(1)' values are in flight.
+void BM_ConcurrentOrdered(benchmark::State& state) {
+  for (auto _ : state) {
+    int sum = *(Range(static_cast<int>(state.range(0)))
+                >> ConcurrentOrdered(
+                    []() {
+                      return Map([](int i) { return i + 1; });
+                    },
+                    state.range(1))
+                >> Sum());
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ConcurrentOrdered)
+    ->ArgsProduct({{1 << 10, 1 << 14}, {1, 64}});
+
+
+// Per value cost of 'state.range(0)' fibers each emitting many values
+// from their own 'StaticThreadPool' worker (when there are enough
+// CPUs), i.e., many producers concurrently handing values to egress.
+void BM_ConcurrentProducers(benchmark::State& state) {
+  static constexpr int VALUES_PER_PRODUCER = 1000;
+
+  const int producers = static_cast<int>(state.range(0));
+
+  std::vector<StaticThreadPool::Requirements> requirements;
+  for (int i = 0; i < producers; i++) {
+    requirements.emplace_back(
+        "producer " + std::to_string(i),
+        Pinned::ModuloTotalCPUs(i));
+  }
+
+  for (auto _ : state) {
+    int sum = *(Range(producers)
+                >> Concurrent([&]() {
+                     // NOTE: the rest of the fiber stays on the worker
+                     // that 'Schedule()' moves it to since fibers use
+                     // the default scheduler which doesn't switch
+                     // threads when rescheduling back.
+                     return Map([&](int i) {
+                              return StaticThreadPool::Scheduler().Schedule(
+                                  &requirements[i],
+                                  Just(i));
+                            })
+                         >> FlatMap([](int) {
+                              return Range(VALUES_PER_PRODUCER);
+                            });
+                   })
+                >> Sum());
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(
+      state.iterations() * producers * VALUES_PER_PRODUCER);
+}
+
+BENCHMARK(BM_ConcurrentProducers)->Arg(1)->Arg(8)->Arg(64)->UseRealTime();
+
+} // namespace
+} // namespace eventuals::benchmarks
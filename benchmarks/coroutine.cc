@@ -0,0 +1,124 @@
+#include "eventuals/coroutine.h"
+
+// NOTE: only benchmarked when building with C++20, i.e., with
+// 'bazel run -c opt --config=cpp20 //benchmarks'.
+#if EVENTUALS_HAS_COROUTINES
+
+#include "benchmark/benchmark.h"
+#include "eventuals/arena.h"
+#include "eventuals/compose.h"
+#include "eventuals/just.h"
+#include "eventuals/task.h"
+#include "eventuals/terminal.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Each benchmark performs two steps, each of which is an eventual,
+// both sequentially in a coroutine and as an equivalent 'Task'.
+
+Task::Of<int> AddOneTask(int i) {
+  return [i]() {
+    return Just(i)
+        >> Then([](int i) {
+             return i + 1;
+           });
+  };
+}
+
+Coroutine::Of<int> AddOneCoroutine(int i) {
+  int j = co_await Just(i);
+  co_return j + 1;
+}
+
+
+void BM_TaskSequential(benchmark::State& state) {
+  auto task = []() -> Task::Of<int> {
+    return []() {
+      return AddOneTask(40)
+          >> Then([](int i) {
+               return AddOneTask(i);
+             });
+    };
+  };
+
+  for (auto _ : state) {
+    int result = 0;
+
+    auto k = Build(
+        task()
+        >> Terminal()
+               .start([&](int i) {
+                 result = i;
+               }));
+
+    k.Start();
+
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_TaskSequential);
+
+
+Coroutine::Of<int> Sequential() {
+  int i = co_await AddOneCoroutine(40);
+  co_return co_await AddOneCoroutine(i);
+}
+
+void BM_CoroutineSequential(benchmark::State& state) {
+  for (auto _ : state) {
+    int result = 0;
+
+    auto k = Build(
+        Sequential()
+        >> Terminal()
+               .start([&](int i) {
+                 result = i;
+               }));
+
+    k.Start();
+
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_CoroutineSequential);
+
+
+// Same as 'BM_CoroutineSequential' but allocating the coroutine
+// frames from an 'Arena' rather than the heap.
+void BM_CoroutineSequentialArena(benchmark::State& state) {
+  Arena arena;
+
+  Scheduler::Context::Get()->set_allocator(&arena);
+
+  for (auto _ : state) {
+    int result = 0;
+
+    {
+      auto k = Build(
+          Sequential()
+          >> Terminal()
+                 .start([&](int i) {
+                   result = i;
+                 }));
+
+      k.Start();
+    }
+
+    arena.Reset();
+
+    benchmark::DoNotOptimize(result);
+  }
+
+  Scheduler::Context::Get()->set_allocator(nullptr);
+}
+
+BENCHMARK(BM_CoroutineSequentialArena);
+
+} // namespace
+} // namespace eventuals::benchmarks
+
+#endif
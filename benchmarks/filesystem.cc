@@ -0,0 +1,276 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/buffer-pool.h"
+#include "eventuals/concurrent.h"
+#include "eventuals/event-loop.h"
+#include "eventuals/filesystem.h"
+#include "eventuals/iterate.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/range.h"
+#include "eventuals/reduce.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+constexpr size_t READ_SIZE = 4096;
+
+constexpr size_t FILE_SIZE = 64 * 1024 * 1024;
+
+// 4K random reads with 'state.range(0)' reads in flight at a time,
+// using io_uring if 'state.range(1)' is 1 and libuv's threadpool
+// otherwise.
+//
+// NOTE: the file will most likely be in the page cache so this is
+// mostly a measure of the overhead of each read rather than of the
+// disk itself.
+void BM_RandomRead(benchmark::State& state) {
+  const size_t depth = state.range(0);
+
+#if EVENTUALS_IO_URING
+  if (state.range(1) == 0) {
+    setenv("EVENTUALS_IO_URING", "0", /* overwrite = */ 1);
+  }
+#endif
+
+  EventLoop::ConstructDefault();
+
+#if EVENTUALS_IO_URING
+  unsetenv("EVENTUALS_IO_URING");
+
+  if (state.range(1) == 1 && EventLoop::Default().io_uring() == nullptr) {
+    EventLoop::DestructDefault();
+    state.SkipWithError("io_uring is not supported");
+    return;
+  }
+#endif
+
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "eventuals_random_read";
+
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    std::string block(READ_SIZE, 'x');
+    for (size_t i = 0; i < FILE_SIZE / READ_SIZE; i++) {
+      ofs << block;
+    }
+  }
+
+  {
+    filesystem::File file = *filesystem::OpenFile(path, UV_FS_O_RDONLY, 0);
+
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<size_t> blocks(
+        0,
+        FILE_SIZE / READ_SIZE - 1);
+
+    std::vector<size_t> offsets(depth);
+
+    for (auto _ : state) {
+      for (size_t& offset : offsets) {
+        offset = blocks(random) * READ_SIZE;
+      }
+
+      size_t bytes = *(Iterate(std::vector<size_t>(offsets))
+                       >> Concurrent([&]() {
+                            return Map([&](size_t offset) {
+                              return filesystem::ReadFile(
+                                  file,
+                                  READ_SIZE,
+                                  offset);
+                            });
+                          })
+                       >> Reduce(
+                           /* bytes = */ size_t(0),
+                           [](size_t& bytes) {
+                             return Then([&](std::string&& data) {
+                               bytes += data.size();
+                               return true;
+                             });
+                           }));
+
+      if (bytes != depth * READ_SIZE) {
+        state.SkipWithError("short read");
+        break;
+      }
+    }
+
+    *filesystem::CloseFile(std::move(file));
+  }
+
+  std::filesystem::remove(path);
+
+  EventLoop::DestructDefault();
+
+  state.SetItemsProcessed(state.iterations() * depth);
+  state.SetBytesProcessed(state.iterations() * depth * READ_SIZE);
+}
+
+#if EVENTUALS_IO_URING
+BENCHMARK(BM_RandomRead)
+    ->ArgNames({"depth", "io_uring"})
+    ->ArgsProduct({{1, 4, 16, 64, 256}, {0, 1}})
+    ->UseRealTime();
+#else
+BENCHMARK(BM_RandomRead)
+    ->ArgNames({"depth", "io_uring"})
+    ->ArgsProduct({{1, 4, 16, 64, 256}, {0}})
+    ->UseRealTime();
+#endif
+
+// Reads the whole file sequentially 64K at a time, either into a new
+// 'std::string' for each chunk if 'state.range(0)' is 0 or into a
+// single 'BufferPool::Buffer' that is reused for every chunk if
+// 'state.range(0)' is 1.
+void BM_SequentialRead(benchmark::State& state) {
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  const bool pooled = state.range(0) == 1;
+
+  EventLoop::ConstructDefault();
+
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "eventuals_sequential_read";
+
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    std::string block(READ_SIZE, 'x');
+    for (size_t i = 0; i < FILE_SIZE / READ_SIZE; i++) {
+      ofs << block;
+    }
+  }
+
+  {
+    filesystem::File file = *filesystem::OpenFile(path, UV_FS_O_RDONLY, 0);
+
+    BufferPool pool(CHUNK_SIZE);
+
+    for (auto _ : state) {
+      size_t bytes = 0;
+
+      if (pooled) {
+        BufferPool::Buffer buffer = pool.Acquire();
+        bytes = *(Range(0, FILE_SIZE / CHUNK_SIZE)
+                  >> Map([&](int i) {
+                       return filesystem::ReadFile(
+                           file,
+                           buffer,
+                           i * CHUNK_SIZE);
+                     })
+                  >> Reduce(
+                      /* bytes = */ size_t(0),
+                      [](size_t& bytes) {
+                        return Then([&](size_t read) {
+                          bytes += read;
+                          return true;
+                        });
+                      }));
+      } else {
+        bytes = *(Range(0, FILE_SIZE / CHUNK_SIZE)
+                  >> Map([&](int i) {
+                       return filesystem::ReadFile(
+                           file,
+                           CHUNK_SIZE,
+                           i * CHUNK_SIZE);
+                     })
+                  >> Reduce(
+                      /* bytes = */ size_t(0),
+                      [](size_t& bytes) {
+                        return Then([&](std::string&& data) {
+                          bytes += data.size();
+                          return true;
+                        });
+                      }));
+      }
+
+      if (bytes != FILE_SIZE) {
+        state.SkipWithError("short read");
+        break;
+      }
+    }
+
+    *filesystem::CloseFile(std::move(file));
+  }
+
+  std::filesystem::remove(path);
+
+  EventLoop::DestructDefault();
+
+  state.SetBytesProcessed(state.iterations() * FILE_SIZE);
+}
+
+BENCHMARK(BM_SequentialRead)
+    ->ArgNames({"pooled"})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+
+// Like 'BM_SequentialRead' but using 'ReadFileStream()' with
+// 'state.range(0)' reads in flight at a time (so a readahead of 1 is
+// equivalent to 'BM_SequentialRead' with 'pooled' 1).
+void BM_ReadFileStream(benchmark::State& state) {
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  const size_t readahead = state.range(0);
+
+  EventLoop::ConstructDefault();
+
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "eventuals_read_file_stream";
+
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    std::string block(READ_SIZE, 'x');
+    for (size_t i = 0; i < FILE_SIZE / READ_SIZE; i++) {
+      ofs << block;
+    }
+  }
+
+  {
+    filesystem::File file = *filesystem::OpenFile(path, UV_FS_O_RDONLY, 0);
+
+    BufferPool pool(CHUNK_SIZE);
+
+    for (auto _ : state) {
+      size_t bytes = *(filesystem::ReadFileStream(file, pool, readahead)
+                       >> Reduce(
+                           /* bytes = */ size_t(0),
+                           [](size_t& bytes) {
+                             return Then([&](BufferPool::Buffer&& buffer) {
+                               bytes += buffer.size();
+                               return true;
+                             });
+                           }));
+
+      if (bytes != FILE_SIZE) {
+        state.SkipWithError("short read");
+        break;
+      }
+    }
+
+    *filesystem::CloseFile(std::move(file));
+  }
+
+  std::filesystem::remove(path);
+
+  EventLoop::DestructDefault();
+
+  state.SetBytesProcessed(state.iterations() * FILE_SIZE);
+}
+
+BENCHMARK(BM_ReadFileStream)
+    ->ArgNames({"readahead"})
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+
+} // namespace
+} // namespace eventuals::benchmarks
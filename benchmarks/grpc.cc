@@ -0,0 +1,216 @@
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/grpc/client.h"
+#include "eventuals/grpc/server.h"
+#include "eventuals/head.h"
+#include "eventuals/let.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/range.h"
+#include "eventuals/then.h"
+#include "examples/protos/helloworld.grpc.pb.h"
+#include "examples/protos/keyvaluestore.grpc.pb.h"
+
+namespace eventuals::grpc::benchmarks {
+namespace {
+
+using helloworld::Greeter;
+using helloworld::HelloReply;
+using helloworld::HelloRequest;
+
+using keyvaluestore::Request;
+using keyvaluestore::Response;
+
+using stout::Borrowable;
+
+// Latency of a unary call to an in-process server, i.e., the
+// overhead of eventuals on top of gRPC's own completion queues.
+void BM_GrpcUnary(benchmark::State& state) {
+  ServerBuilder builder;
+
+  int port = 0;
+
+  builder.AddListeningPort(
+      "0.0.0.0:0",
+      ::grpc::InsecureServerCredentials(),
+      &port);
+
+  auto build = builder.BuildAndStart();
+
+  if (!build.status.ok()) {
+    state.SkipWithError("failed to start server");
+    return;
+  }
+
+  auto server = std::move(build.server);
+
+  // Serve calls until the server gets shutdown.
+  auto serve = [&]() {
+    return server->Accept<Greeter, HelloRequest, HelloReply>("SayHello")
+        >> Map(Let([](auto& call) {
+             return call.Reader().Read()
+                 >> Head()
+                 >> Then([](HelloRequest&& request) {
+                      HelloReply reply;
+                      reply.set_message("Hello " + request.name());
+                      return reply;
+                    })
+                 >> UnaryEpilogue(call);
+           }))
+        >> Loop();
+  };
+
+  auto [future, k] = Promisify("serve", serve());
+
+  k.Start();
+
+  Borrowable<ClientCompletionThreadPool> pool;
+
+  Client client(
+      "0.0.0.0:" + std::to_string(port),
+      ::grpc::InsecureChannelCredentials(),
+      pool.Borrow());
+
+  auto call = [&]() {
+    return client.Call<Greeter, HelloRequest, HelloReply>("SayHello")
+        >> Then(Let([](auto& call) {
+             HelloRequest request;
+             request.set_name("benchmark");
+             return call.Writer().WriteLast(request)
+                 >> call.Reader().Read()
+                 >> Loop()
+                 >> call.Finish();
+           }));
+  };
+
+  for (auto _ : state) {
+    auto status = *call();
+
+    if (!status.ok()) {
+      state.SkipWithError(status.error_message().c_str());
+      break;
+    }
+  }
+
+  server->Shutdown();
+  server->Wait();
+
+  try {
+    future.get();
+  } catch (...) {
+    // Expected to fail or stop when the server is shutdown.
+  }
+}
+
+BENCHMARK(BM_GrpcUnary)->UseRealTime();
+
+
+// Latency of a request/response round trip on an already established
+// bidirectional stream, i.e., the per message overhead once the cost
+// of starting a call has been amortized over 'state.range(0)'
+// messages.
+void BM_GrpcStreaming(benchmark::State& state) {
+  const int messages = state.range(0);
+
+  ServerBuilder builder;
+
+  int port = 0;
+
+  builder.AddListeningPort(
+      "0.0.0.0:0",
+      ::grpc::InsecureServerCredentials(),
+      &port);
+
+  auto build = builder.BuildAndStart();
+
+  if (!build.status.ok()) {
+    state.SkipWithError("failed to start server");
+    return;
+  }
+
+  auto server = std::move(build.server);
+
+  // Echo every request until the client is done writing, serving
+  // calls until the server gets shutdown.
+  auto serve = [&]() {
+    return server->Accept<
+               Stream<Request>,
+               Stream<Response>>(
+               "keyvaluestore.KeyValueStore.GetValues")
+        >> Map(Let([](auto& call) {
+             return call.Reader().Read()
+                 >> Map([](Request&& request) {
+                      Response response;
+                      response.set_value(request.key());
+                      return response;
+                    })
+                 >> StreamingEpilogue(call);
+           }))
+        >> Loop();
+  };
+
+  auto [future, k] = Promisify("serve", serve());
+
+  k.Start();
+
+  Borrowable<ClientCompletionThreadPool> pool;
+
+  Client client(
+      "0.0.0.0:" + std::to_string(port),
+      ::grpc::InsecureChannelCredentials(),
+      pool.Borrow());
+
+  auto call = [&]() {
+    return client.Call<
+               Stream<Request>,
+               Stream<Response>>(
+               "keyvaluestore.KeyValueStore.GetValues")
+        >> Then(Let([&](auto& call) {
+             return Range(messages)
+                 >> Map([&](int i) {
+                      Request request;
+                      request.set_key(std::to_string(i));
+                      return call.Writer().Write(request)
+                          >> call.Reader().Read()
+                          >> Head()
+                          >> Then([](Response&&) {});
+                    })
+                 >> Loop()
+                 >> call.WritesDone()
+                 >> call.Reader().Read()
+                 >> Loop()
+                 >> call.Finish();
+           }));
+  };
+
+  for (auto _ : state) {
+    auto status = *call();
+
+    if (!status.ok()) {
+      state.SkipWithError(status.error_message().c_str());
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * messages);
+
+  server->Shutdown();
+  server->Wait();
+
+  try {
+    future.get();
+  } catch (...) {
+    // Expected to fail or stop when the server is shutdown.
+  }
+}
+
+BENCHMARK(BM_GrpcStreaming)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(256)
+    ->UseRealTime();
+
+} // namespace
+} // namespace eventuals::grpc::benchmarks
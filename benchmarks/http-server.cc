@@ -0,0 +1,146 @@
+#include <chrono>
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/concurrent.h"
+#include "eventuals/event-loop.h"
+#include "eventuals/http-server.h"
+#include "eventuals/iterate.h"
+#include "eventuals/just.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/reduce.h"
+#include "eventuals/tcp.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+using eventuals::http::Server;
+
+// Runs the default event loop until 'future' is ready.
+template <typename T>
+void RunUntil(std::future<T>& future) {
+  while (future.wait_for(std::chrono::nanoseconds::zero())
+         != std::future_status::ready) {
+    EventLoop::Default().RunUntilIdle();
+  }
+}
+
+// Requests per second with 'state.range(0)' keep-alive connections
+// each sending 'state.range(1)' pipelined 'GET' requests at a time,
+// i.e., a simple load generator running against the server on the
+// same event loop.
+//
+// NOTE: the server handles requests via 'Concurrent()' so responses
+// to pipelined requests may be completed out of order (they're still
+// sent in order).
+void BM_HttpServer(benchmark::State& state) {
+  const size_t connections = state.range(0);
+  const size_t depth = state.range(1);
+
+  static constexpr std::string_view RESPONSE =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 5\r\n"
+      "\r\n"
+      "hello";
+
+  EventLoop::ConstructDefault();
+
+  {
+    Server server = *Server::Listen("127.0.0.1", 0);
+
+    auto [served, serve] = Promisify(
+        "serve",
+        server.Serve()
+            >> Concurrent([]() {
+                return Map([](Server::Exchange&& exchange) {
+                  // NOTE: 'Concurrent()' doesn't support 'void' values.
+                  return exchange.Respond(200, {}, "hello") >> Just(true);
+                });
+              })
+            >> Loop());
+
+    serve.Start();
+
+    std::vector<TcpStream> clients;
+
+    for (size_t i = 0; i < connections; i++) {
+      clients.push_back(*TcpStream::Connect("127.0.0.1", server.port()));
+    }
+
+    std::string requests;
+
+    for (size_t i = 0; i < depth; i++) {
+      requests += "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    }
+
+    const size_t size = depth * RESPONSE.size();
+
+    std::vector<size_t> indexes;
+
+    for (size_t i = 0; i < connections; i++) {
+      indexes.push_back(i);
+    }
+
+    for (auto _ : state) {
+      size_t bytes = *(Iterate(std::vector<size_t>(indexes))
+                       >> Concurrent([&]() {
+                            return Map([&](size_t i) {
+                              return clients[i].Write(requests)
+                                  >> Then([&, i]() {
+                                       return clients[i].Read()
+                                           >> Reduce(
+                                               /* bytes = */ size_t(0),
+                                               [&](size_t& bytes) {
+                                                 return Then(
+                                                     [&](std::string_view chunk) {
+                                                       bytes += chunk.size();
+                                                       return bytes < size;
+                                                     });
+                                               });
+                                     });
+                            });
+                          })
+                       >> Reduce(
+                           /* bytes = */ size_t(0),
+                           [](size_t& bytes) {
+                             return Then([&](size_t read) {
+                               bytes += read;
+                               return true;
+                             });
+                           }));
+
+      if (bytes != connections * size) {
+        state.SkipWithError("short read");
+        break;
+      }
+    }
+
+    for (TcpStream& client : clients) {
+      *client.Close();
+    }
+
+    *server.Close();
+
+    RunUntil(served);
+
+    served.get();
+  }
+
+  EventLoop::DestructDefault();
+
+  state.SetItemsProcessed(state.iterations() * connections * depth);
+}
+
+BENCHMARK(BM_HttpServer)
+    ->ArgNames({"connections", "depth"})
+    ->ArgsProduct({{1, 16, 64}, {1, 16}})
+    ->UseRealTime();
+
+} // namespace
+} // namespace eventuals::benchmarks
@@ -0,0 +1,107 @@
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/event-loop.h"
+#include "eventuals/http.h"
+#include "eventuals/promisify.h"
+#include "gmock/gmock.h"
+#include "test/http-mock-server.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+using eventuals::http::test::HttpMockServer;
+
+// Latency of a 'GET' request (including connecting) against a local
+// mock server.
+//
+// NOTE: the mock server handles one socket at a time on its own
+// thread, so this is mostly a measure of the client's overhead.
+void BM_HttpGet(benchmark::State& state, const std::string& scheme) {
+  EventLoop::ConstructDefault();
+
+  {
+    HttpMockServer server(scheme);
+
+    http::Client client = server.Client();
+
+    EXPECT_CALL(server, ReceivedHeaders)
+        .WillRepeatedly([](auto socket, const std::string& data) {
+          socket->Send(
+              "HTTP/1.1 200 OK\r\n"
+              "Content-Length: 25\r\n"
+              "\r\n"
+              "<html>Hello World!</html>\r\n"
+              "\r\n");
+
+          socket->Close();
+        });
+
+    for (auto _ : state) {
+      auto response = *client.Get(server.uri());
+
+      if (response.code() != 200) {
+        state.SkipWithError("unexpected response code");
+        break;
+      }
+    }
+  }
+
+  EventLoop::DestructDefault();
+}
+
+// Responses per second for replies with 20 headers, i.e., the
+// overhead of receiving and parsing headers for small API calls.
+void BM_HttpGetHeaders(benchmark::State& state) {
+  EventLoop::ConstructDefault();
+
+  {
+    HttpMockServer server("http://");
+
+    http::Client client = server.Client();
+
+    std::string reply = "HTTP/1.1 200 OK\r\n";
+
+    // 19 headers plus 'Content-Length'.
+    for (size_t i = 0; i < 19; i++) {
+      reply += "X-Header-" + std::to_string(i) + ": value-"
+          + std::to_string(i) + "\r\n";
+    }
+
+    reply +=
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "hello";
+
+    EXPECT_CALL(server, ReceivedHeaders)
+        .WillRepeatedly([&](auto socket, const std::string& data) {
+          socket->Send(reply);
+          socket->Close();
+        });
+
+    for (auto _ : state) {
+      auto response = *client.Get(server.uri());
+
+      if (response.code() != 200 || !response.header("x-header-18")) {
+        state.SkipWithError("unexpected response");
+        break;
+      }
+    }
+  }
+
+  EventLoop::DestructDefault();
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_HttpGet, http, std::string("http://"))
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_HttpGet, https, std::string("https://"))
+    ->UseRealTime();
+
+BENCHMARK(BM_HttpGetHeaders)
+    ->UseRealTime();
+
+} // namespace
+} // namespace eventuals::benchmarks
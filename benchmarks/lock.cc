@@ -0,0 +1,135 @@
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/if.h"
+#include "eventuals/lock.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/range.h"
+#include "eventuals/sharded-lock.h"
+#include "eventuals/shared-lock.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Number of times each thread acquires (and releases) a lock for
+// every iteration, so that the cost of blocking on an eventual is
+// amortized.
+constexpr int OPERATIONS = 1000;
+
+// Acquiring and releasing a 'Lock' from 'state.threads()' threads at
+// once, i.e., uncontended for a single thread and otherwise a lock
+// "handoff" whenever a thread has to wait.
+void BM_Lock(benchmark::State& state) {
+  static Lock lock;
+  static uint64_t count = 0;
+
+  for (auto _ : state) {
+    *(Range(OPERATIONS)
+      >> Map([](int) {
+          return Acquire(&lock)
+              >> Then([]() {
+                   count++;
+                 })
+              >> Release(&lock);
+        })
+      >> Loop());
+  }
+
+  state.SetItemsProcessed(state.iterations() * OPERATIONS);
+}
+
+BENCHMARK(BM_Lock)->ThreadRange(1, 16)->UseRealTime();
+
+
+// Same as 'BM_Lock' but each thread uses its own key for one of 16
+// locks, i.e., contention is the exception rather than the rule.
+void BM_ShardedLock(benchmark::State& state) {
+  static ShardedLock<16> locks;
+  static uint64_t counts[16] = {};
+
+  const int key = state.thread_index();
+
+  for (auto _ : state) {
+    *(Range(OPERATIONS)
+      >> Map([key](int) {
+          return locks.Synchronized(
+              key,
+              Then([key]() {
+                counts[ShardedLock<16>::IndexOf(key)]++;
+              }));
+        })
+      >> Loop());
+  }
+
+  state.SetItemsProcessed(state.iterations() * OPERATIONS);
+}
+
+BENCHMARK(BM_ShardedLock)->ThreadRange(1, 16)->UseRealTime();
+
+
+// A read mostly workload where 95% of the operations acquire the lock
+// shared and 5% acquire it exclusive.
+void BM_SharedLock(benchmark::State& state) {
+  static SharedLock lock;
+  static uint64_t value = 0;
+
+  for (auto _ : state) {
+    *(Range(OPERATIONS)
+      >> Map([](int i) {
+          return If(i % 20 == 0)
+              .yes([]() {
+                return Acquire(&lock)
+                    >> Then([]() {
+                         value++;
+                       })
+                    >> Release(&lock);
+              })
+              .no([]() {
+                return AcquireShared(&lock)
+                    >> Then([]() {
+                         benchmark::DoNotOptimize(value);
+                       })
+                    >> ReleaseShared(&lock);
+              });
+        })
+      >> Loop());
+  }
+
+  state.SetItemsProcessed(state.iterations() * OPERATIONS);
+}
+
+BENCHMARK(BM_SharedLock)->ThreadRange(1, 16)->UseRealTime();
+
+
+// Same workload as 'BM_SharedLock' but every operation acquires a
+// 'Lock' for comparison.
+void BM_SharedLockBaseline(benchmark::State& state) {
+  static Lock lock;
+  static uint64_t value = 0;
+
+  for (auto _ : state) {
+    *(Range(OPERATIONS)
+      >> Map([](int i) {
+          return Acquire(&lock)
+              >> Then([i]() {
+                   if (i % 20 == 0) {
+                     value++;
+                   } else {
+                     benchmark::DoNotOptimize(value);
+                   }
+                 })
+              >> Release(&lock);
+        })
+      >> Loop());
+  }
+
+  state.SetItemsProcessed(state.iterations() * OPERATIONS);
+}
+
+BENCHMARK(BM_SharedLockBaseline)->ThreadRange(1, 16)->UseRealTime();
+
+} // namespace
+} // namespace eventuals::benchmarks
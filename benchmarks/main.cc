@@ -0,0 +1,41 @@
+#include <string_view>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+////////////////////////////////////////////////////////////////////////
+
+// Like 'benchmark_main' except that results are output as JSON by
+// default (so that results can be diffed between releases) unless
+// '--benchmark_format' is explicitly passed.
+int main(int argc, char** argv) {
+  std::vector<char*> args(argv, argv + argc);
+
+  bool format = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::string_view(argv[i]).rfind("--benchmark_format", 0) == 0) {
+      format = true;
+    }
+  }
+
+  char json[] = "--benchmark_format=json";
+
+  if (!format) {
+    args.push_back(json);
+  }
+
+  argc = static_cast<int>(args.size());
+
+  benchmark::Initialize(&argc, args.data());
+
+  if (benchmark::ReportUnrecognizedArguments(argc, args.data())) {
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
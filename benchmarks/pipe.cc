@@ -0,0 +1,91 @@
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/bounded-pipe.h"
+#include "eventuals/pipe.h"
+#include "eventuals/promisify.h"
+#include "eventuals/reduce.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Total number of values written to the pipe for every iteration,
+// divided evenly between the writers.
+constexpr int VALUES = 1 << 14;
+
+// Writes 'VALUES' through a pipe from 'state.range(0)' writers to
+// 'state.range(1)' readers.
+template <typename Pipe>
+void BM_Pipe(benchmark::State& state, Pipe* (*create)()) {
+  const int writers = state.range(0);
+  const int readers = state.range(1);
+
+  for (auto _ : state) {
+    std::unique_ptr<Pipe> pipe(create());
+
+    std::vector<std::future<int>> sums;
+    for (int i = 0; i < readers; i++) {
+      sums.push_back(std::async(std::launch::async, [&]() {
+        return *(pipe->Read()
+                 >> Reduce(
+                     /* sum = */ 0,
+                     [](int& sum) {
+                       return Then([&](int value) {
+                         sum += value;
+                         return true;
+                       });
+                     }));
+      }));
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < writers; i++) {
+      threads.emplace_back([&]() {
+        // NOTE: writing one value at a time because a writer that
+        // has to wait gets resumed on the thread of whoever made room
+        // in the pipe (when using the default scheduler) and would
+        // otherwise keep writing from that thread, nesting deeper
+        // and deeper.
+        for (int value = 0; value < VALUES / writers; value++) {
+          *pipe->Write(1);
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    *pipe->Close();
+
+    int sum = 0;
+    for (auto& future : sums) {
+      sum += future.get();
+    }
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * (VALUES / writers) * writers);
+}
+
+BENCHMARK_CAPTURE(
+    BM_Pipe,
+    Pipe,
+    +[]() { return new Pipe<int>(); })
+    ->ArgsProduct({{1, 4, 16, 64}, {1, 4, 16, 64}})
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(
+    BM_Pipe,
+    BoundedPipe,
+    +[]() { return new BoundedPipe<int>(1024); })
+    ->ArgsProduct({{1, 4, 16, 64}, {1, 4, 16, 64}})
+    ->UseRealTime();
+
+} // namespace
+} // namespace eventuals::benchmarks
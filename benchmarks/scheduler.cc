@@ -0,0 +1,113 @@
+#include "benchmark/benchmark.h"
+#include "eventuals/compose.h"
+#include "eventuals/event-loop.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/range.h"
+#include "eventuals/static-thread-pool.h"
+#include "eventuals/terminal.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Number of values streamed through a scheduler for every iteration
+// so that the cost of blocking on an eventual is amortized.
+constexpr int VALUES = 1000;
+
+// Per value cost of scheduling on a 'StaticThreadPool', i.e.,
+// 'StaticThreadPool::Submit()' and the worker picking up the
+// callback.
+void BM_StaticThreadPoolSchedule(benchmark::State& state) {
+  StaticThreadPool::Requirements requirements("benchmark");
+
+  for (auto _ : state) {
+    *(Range(VALUES)
+      >> StaticThreadPool::Scheduler().Schedule(
+          &requirements,
+          Map([](int i) {
+            return i + 1;
+          }))
+      >> Loop());
+  }
+
+  state.SetItemsProcessed(state.iterations() * VALUES);
+}
+
+BENCHMARK(BM_StaticThreadPoolSchedule)->UseRealTime();
+
+
+// Per value cost of a "context switch" between two workers of a
+// 'StaticThreadPool', i.e., every value is rescheduled twice.
+void BM_StaticThreadPoolPingPong(benchmark::State& state) {
+  struct Ping : public StaticThreadPool::Schedulable {
+    Ping()
+      : StaticThreadPool::Schedulable(Pinned::ModuloTotalCPUs(0)) {}
+
+    auto Stream() {
+      return Range(VALUES)
+          >> Schedule(Map([](int i) {
+               return i + 1;
+             }));
+    }
+  };
+
+  struct Pong : public StaticThreadPool::Schedulable {
+    Pong()
+      : StaticThreadPool::Schedulable(Pinned::ModuloTotalCPUs(1)) {}
+
+    auto Listen() {
+      return Schedule(Map([](int i) {
+               return i + 1;
+             }))
+          >> Loop();
+    }
+  };
+
+  Ping ping;
+  Pong pong;
+
+  for (auto _ : state) {
+    *(ping.Stream() >> pong.Listen());
+  }
+
+  state.SetItemsProcessed(state.iterations() * VALUES);
+}
+
+BENCHMARK(BM_StaticThreadPoolPingPong)->UseRealTime();
+
+
+// Cost of 'EventLoop::Submit()' and running the callback from the
+// event loop.
+void BM_EventLoopSchedule(benchmark::State& state) {
+  EventLoop::ConstructDefault();
+
+  for (auto _ : state) {
+    bool done = false;
+
+    auto k = Build(
+        EventLoop::Default().Schedule(
+            "benchmark",
+            Then([]() {
+              return 42;
+            }))
+        >> Terminal()
+               .start([&](int) {
+                 done = true;
+               }));
+
+    k.Start();
+
+    while (!done) {
+      EventLoop::Default().RunUntilIdle();
+    }
+  }
+
+  EventLoop::DestructDefault();
+}
+
+BENCHMARK(BM_EventLoopSchedule);
+
+} // namespace
+} // namespace eventuals::benchmarks
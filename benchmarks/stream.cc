@@ -0,0 +1,84 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/compose.h"
+#include "eventuals/filter.h"
+#include "eventuals/iterate.h"
+#include "eventuals/just.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/range.h"
+#include "eventuals/reduce.h"
+#include "eventuals/terminal.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Cost of composing (building) and running a few 'Then()'s that are
+// completed synchronously, i.e., the baseline for every eventual.
+void BM_Then(benchmark::State& state) {
+  for (auto _ : state) {
+    int result = 0;
+
+    auto k = Build(
+        Just(1)
+        >> Then([](int i) { return i + 1; })
+        >> Then([](int i) { return i + 1; })
+        >> Then([](int i) { return i + 1; })
+        >> Terminal()
+               .start([&](int i) {
+                 result = i;
+               }));
+
+    k.Start();
+
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_Then);
+
+
+// Per element cost of a stream with a 'Map()' which is reported via
+// 'items_per_second'.
+void BM_IterateMapReduce(benchmark::State& state) {
+  std::vector<int> values(state.range(0), 1);
+
+  for (auto _ : state) {
+    int sum = *(Iterate(values)
+                >> Map([](int i) { return i + 1; })
+                >> Reduce(
+                    /* sum = */ 0,
+                    [](int& sum) {
+                      return Then([&](int i) {
+                        sum += i;
+                        return true;
+                      });
+                    }));
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_IterateMapReduce)->Range(1, 1 << 16);
+
+
+void BM_RangeFilterLoop(benchmark::State& state) {
+  for (auto _ : state) {
+    *(Range(static_cast<int>(state.range(0)))
+      >> Filter([](int i) { return i % 2 == 0; })
+      >> Map([](int i) { benchmark::DoNotOptimize(i); })
+      >> Loop());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_RangeFilterLoop)->Range(1, 1 << 16);
+
+} // namespace
+} // namespace eventuals::benchmarks
@@ -0,0 +1,133 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/compose.h"
+#include "eventuals/generator.h"
+#include "eventuals/iterate.h"
+#include "eventuals/just.h"
+#include "eventuals/promisify.h"
+#include "eventuals/reduce.h"
+#include "eventuals/task.h"
+#include "eventuals/terminal.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Baseline for 'BM_Task' without any type erasure.
+void BM_Just(benchmark::State& state) {
+  for (auto _ : state) {
+    int result = 0;
+
+    auto k = Build(
+        Just(42)
+        >> Then([](int i) { return i + 1; })
+        >> Terminal()
+               .start([&](int i) {
+                 result = i;
+               }));
+
+    k.Start();
+
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_Just);
+
+
+// Cost of dispatching through a 'Task', i.e., type erasure, with
+// enough inline storage that the task never needs to be allocated.
+void BM_Task(benchmark::State& state) {
+  auto task = []() -> Task::Of<int>::Inline<1024> {
+    return []() {
+      return Just(42);
+    };
+  };
+
+  for (auto _ : state) {
+    int result = 0;
+
+    auto k = Build(
+        task()
+        >> Then([](int i) { return i + 1; })
+        >> Terminal()
+               .start([&](int i) {
+                 result = i;
+               }));
+
+    k.Start();
+
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_Task);
+
+
+// Same as 'BM_Task' but with a continuation that is too big to be
+// stored inline so the task must be allocated.
+void BM_TaskLarge(benchmark::State& state) {
+  struct Large {
+    char bytes[1024] = {};
+  };
+
+  auto task = []() -> Task::Of<int>::Inline<1024> {
+    return []() {
+      return Just(Large())
+          >> Then([](Large&& large) {
+               return static_cast<int>(large.bytes[0]);
+             });
+    };
+  };
+
+  for (auto _ : state) {
+    int result = 0;
+
+    auto k = Build(
+        task()
+        >> Terminal()
+               .start([&](int i) {
+                 result = i;
+               }));
+
+    k.Start();
+
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_TaskLarge);
+
+
+// Per element cost of a 'Generator', i.e., type erasure of a stream.
+void BM_Generator(benchmark::State& state) {
+  std::vector<int> values(state.range(0), 1);
+
+  auto generator = [&]() -> Generator::Of<int> {
+    return [&]() {
+      return Iterate(values);
+    };
+  };
+
+  for (auto _ : state) {
+    int sum = *(generator()
+                >> Reduce(
+                    /* sum = */ 0,
+                    [](int& sum) {
+                      return Then([&](int i) {
+                        sum += i;
+                        return true;
+                      });
+                    }));
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Generator)->Range(1, 1 << 16);
+
+} // namespace
+} // namespace eventuals::benchmarks
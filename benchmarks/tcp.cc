@@ -0,0 +1,112 @@
+#include <chrono>
+#include <future>
+#include <string>
+#include <string_view>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/event-loop.h"
+#include "eventuals/head.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/reduce.h"
+#include "eventuals/tcp.h"
+#include "eventuals/then.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Runs the default event loop until 'future' is ready.
+template <typename T>
+void RunUntil(std::future<T>& future) {
+  while (future.wait_for(std::chrono::nanoseconds::zero())
+         != std::future_status::ready) {
+    EventLoop::Default().RunUntilIdle();
+  }
+}
+
+// Round trips of a 'state.range(0)' byte message to an echo server
+// over loopback, i.e., latency for small messages and throughput for
+// large ones.
+//
+// NOTE: the client and the server share the same event loop (and
+// thread) so this is mostly a measure of the overhead of each read
+// and write rather than of the network stack. Messages are kept small
+// enough to fit in the socket buffers since the client doesn't start
+// reading until its write has completed.
+void BM_TcpEcho(benchmark::State& state) {
+  const size_t size = state.range(0);
+
+  EventLoop::ConstructDefault();
+
+  {
+    TcpListener listener = *TcpListener::Listen("127.0.0.1", 0);
+
+    auto [accepted, accept] = Promisify(
+        "accept",
+        listener.Accept() >> Head());
+
+    accept.Start();
+
+    TcpStream client = *TcpStream::Connect("127.0.0.1", listener.port());
+
+    RunUntil(accepted);
+
+    TcpStream server = accepted.get();
+
+    // Echo everything back until the client shuts down.
+    auto [echoed, echo] = Promisify(
+        "echo",
+        server.Read()
+            >> Map([&server](std::string_view chunk) {
+                return server.Write(std::string(chunk));
+              })
+            >> Loop());
+
+    echo.Start();
+
+    const std::string message(size, 'x');
+
+    for (auto _ : state) {
+      *client.Write(message);
+
+      size_t bytes = *(client.Read()
+                       >> Reduce(
+                           /* bytes = */ size_t(0),
+                           [&](size_t& bytes) {
+                             return Then([&](std::string_view chunk) {
+                               bytes += chunk.size();
+                               return bytes < size;
+                             });
+                           }));
+
+      if (bytes != size) {
+        state.SkipWithError("short read");
+        break;
+      }
+    }
+
+    *client.Shutdown();
+
+    RunUntil(echoed);
+
+    *client.Close();
+    *server.Close();
+    *listener.Close();
+  }
+
+  EventLoop::DestructDefault();
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_TcpEcho)
+    ->ArgNames({"size"})
+    ->Arg(64)
+    ->Arg(4 * 1024)
+    ->Arg(64 * 1024)
+    ->UseRealTime();
+
+} // namespace
+} // namespace eventuals::benchmarks
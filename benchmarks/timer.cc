@@ -0,0 +1,74 @@
+#include <chrono>
+
+#include "benchmark/benchmark.h"
+#include "eventuals/compose.h"
+#include "eventuals/event-loop.h"
+#include "eventuals/interrupt.h"
+#include "eventuals/terminal.h"
+#include "eventuals/timer.h"
+
+namespace eventuals::benchmarks {
+namespace {
+
+// Cost of starting a timer and having it fire.
+void BM_Timer(benchmark::State& state) {
+  EventLoop::ConstructDefault();
+
+  for (auto _ : state) {
+    bool done = false;
+
+    auto k = Build(
+        Timer(std::chrono::milliseconds(0))
+        >> Terminal()
+               .start([&]() {
+                 done = true;
+               }));
+
+    k.Start();
+
+    while (!done) {
+      EventLoop::Default().RunUntilIdle();
+    }
+  }
+
+  EventLoop::DestructDefault();
+}
+
+BENCHMARK(BM_Timer);
+
+
+// Cost of starting a timer and then interrupting it before it fires,
+// e.g., for a timeout of an operation that completed in time.
+void BM_TimerInterrupt(benchmark::State& state) {
+  EventLoop::ConstructDefault();
+
+  for (auto _ : state) {
+    bool done = false;
+
+    auto k = Build(
+        Timer(std::chrono::seconds(100))
+        >> Terminal()
+               .stop([&]() {
+                 done = true;
+               }));
+
+    Interrupt interrupt;
+
+    k.Register(interrupt);
+
+    k.Start();
+
+    interrupt.Trigger();
+
+    while (!done) {
+      EventLoop::Default().RunUntilIdle();
+    }
+  }
+
+  EventLoop::DestructDefault();
+}
+
+BENCHMARK(BM_TimerInterrupt);
+
+} // namespace
+} // namespace eventuals::benchmarks
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <memory> // For 'std::unique_ptr'.
+#include <new> // For 'std::align_val_t' and placement new.
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// Interface for allocating the memory that eventuals need at runtime
+// (e.g., for a type-erased 'Task' that doesn't fit inline), similar
+// in spirit to 'std::pmr::memory_resource'.
+//
+// Every 'Scheduler::Context' has an allocator (see
+// 'Scheduler::Context::allocator()') so that, for example, all of
+// the memory for a single request can come from a pool or an arena.
+class Allocator {
+ public:
+  virtual ~Allocator() = default;
+
+  virtual void* Allocate(size_t size, size_t alignment) = 0;
+
+  virtual void Deallocate(void* pointer, size_t size, size_t alignment) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns an allocator that uses the global 'operator new' and
+// 'operator delete'.
+inline Allocator* DefaultAllocator() {
+  class HeapAllocator final : public Allocator {
+   public:
+    void* Allocate(size_t size, size_t alignment) override {
+      return ::operator new(size, std::align_val_t(alignment));
+    }
+
+    void Deallocate(void* pointer, size_t size, size_t alignment) override {
+      ::operator delete(pointer, size, std::align_val_t(alignment));
+    }
+  };
+
+  static HeapAllocator allocator;
+
+  return &allocator;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Deleter for a 'std::unique_ptr' returned from 'AllocateUnique()'.
+//
+// NOTE: rather than using the pointer passed to 'operator()' this
+// destructs and deallocates the object exactly as it was allocated so
+// that a 'AllocatedPtr<T>' can be converted to an 'AllocatedPtr' of
+// any base class of 'T' even if it doesn't have a virtual destructor.
+struct AllocatedDeleter final {
+  template <typename T>
+  void operator()(T*) const {
+    destroy(allocator, pointer);
+  }
+
+  Allocator* allocator = nullptr;
+  void* pointer = nullptr;
+  void (*destroy)(Allocator*, void*) = nullptr;
+};
+
+template <typename T>
+using AllocatedPtr = std::unique_ptr<T, AllocatedDeleter>;
+
+// Constructs a 'T' from 'args' using memory from 'allocator'.
+template <typename T, typename... Args>
+AllocatedPtr<T> AllocateUnique(Allocator* allocator, Args&&... args) {
+  T* t = new (allocator->Allocate(sizeof(T), alignof(T)))
+      T(std::forward<Args>(args)...);
+
+  return AllocatedPtr<T>(
+      t,
+      AllocatedDeleter{
+          allocator,
+          t,
+          [](Allocator* allocator, void* pointer) {
+            static_cast<T*>(pointer)->~T();
+            allocator->Deallocate(pointer, sizeof(T), alignof(T));
+          }});
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
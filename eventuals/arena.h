@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "eventuals/allocator.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// An 'Allocator' that "bump" allocates from large chunks of memory
+// and never deallocates individual allocations, instead all of the
+// memory is released at once when the arena is destructed (or reused
+// after calling 'Reset()'), similar to
+// 'std::pmr::monotonic_buffer_resource'.
+//
+// This is intended to be used for all of the memory of a single
+// request (e.g., by setting it as the allocator for the
+// 'Scheduler::Context' of the request) so that after the arena has
+// grown to the size a request needs no more memory is allocated from
+// the global heap even if the arena is reused for many requests.
+//
+// NOTE: an arena is thread-safe since eventuals on the same
+// 'Scheduler::Context' (or contexts cloned from it) may execute on
+// different threads. Allocating from the current chunk is a lock-free
+// atomic bump of a pointer, only moving on to another chunk takes a
+// lock.
+class Arena final : public Allocator {
+ public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+
+  explicit Arena(size_t initial_chunk_size = DEFAULT_CHUNK_SIZE)
+    : next_chunk_size_(std::max(initial_chunk_size, size_t(64))) {}
+
+  Arena(const Arena&) = delete;
+  Arena(Arena&&) = delete;
+
+  ~Arena() override {
+    for (std::unique_ptr<Chunk>& chunk : chunks_) {
+      DefaultAllocator()->Deallocate(chunk->memory, chunk->size, ALIGNMENT);
+    }
+  }
+
+  void* Allocate(size_t size, size_t alignment) override {
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+
+    Chunk* chunk = current_.load(std::memory_order_acquire);
+
+    while (true) {
+      if (chunk != nullptr) {
+        void* pointer = TryAllocate(*chunk, size, alignment);
+        if (pointer != nullptr) {
+          return pointer;
+        }
+      }
+      chunk = Next(chunk, size, alignment);
+    }
+  }
+
+  void Deallocate(void*, size_t, size_t) override {
+    // Memory is only released by 'Reset()' or destructing.
+  }
+
+  // Makes all of the memory previously allocated available to be
+  // allocated again, without returning any of it to the global heap.
+  //
+  // NOTE: it's up to the caller to ensure that nothing is still
+  // using any of the memory previously allocated, nor concurrently
+  // allocating!
+  void Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_ = 0;
+    if (!chunks_.empty()) {
+      chunks_[0]->used.store(0, std::memory_order_relaxed);
+      current_.store(chunks_[0].get(), std::memory_order_release);
+    }
+    allocations_.store(0, std::memory_order_relaxed);
+  }
+
+  // Returns the number of allocations since construction or the last
+  // call to 'Reset()'.
+  size_t allocations() {
+    return allocations_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the number of chunks that have been allocated from the
+  // global heap, which only grows if a request needs more memory
+  // than has ever been needed before.
+  size_t chunks() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return chunks_.size();
+  }
+
+ private:
+  struct Chunk final {
+    Chunk(char* memory, size_t size)
+      : memory(memory),
+        size(size) {}
+
+    char* const memory;
+    const size_t size;
+    std::atomic<size_t> used = 0;
+  };
+
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  static void* TryAllocate(Chunk& chunk, size_t size, size_t alignment) {
+    size_t used = chunk.used.load(std::memory_order_relaxed);
+    while (true) {
+      uintptr_t start = reinterpret_cast<uintptr_t>(chunk.memory) + used;
+      uintptr_t aligned =
+          (start + alignment - 1) & ~(uintptr_t(alignment) - 1);
+      size_t padding = aligned - start;
+      if (used + padding + size > chunk.size) {
+        return nullptr;
+      }
+      // NOTE: on failure 'used' gets updated so we just try again.
+      if (chunk.used.compare_exchange_weak(
+              used,
+              used + padding + size,
+              std::memory_order_relaxed)) {
+        return reinterpret_cast<void*>(aligned);
+      }
+    }
+  }
+
+  // Returns the chunk to try next after 'full' didn't have enough
+  // room, either because another thread already moved on from 'full'
+  // or by moving on to any chunks that are left over from before the
+  // last call to 'Reset()' or lastly by allocating a new chunk.
+  Chunk* Next(Chunk* full, size_t size, size_t alignment) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Chunk* current = current_.load(std::memory_order_relaxed);
+    if (current != full) {
+      return current;
+    }
+
+    if (index_ + 1 < chunks_.size()) {
+      index_++;
+    } else {
+      // Need a new chunk, which grows geometrically so that the
+      // number of chunks is logarithmic in the total size.
+      size_t chunk_size = next_chunk_size_;
+      while (chunk_size < size + alignment) {
+        chunk_size *= 2;
+      }
+      next_chunk_size_ = chunk_size * 2;
+
+      chunks_.push_back(
+          std::make_unique<Chunk>(
+              static_cast<char*>(
+                  DefaultAllocator()->Allocate(chunk_size, ALIGNMENT)),
+              chunk_size));
+
+      index_ = chunks_.size() - 1;
+    }
+
+    // NOTE: a chunk left over from before 'Reset()' might still be
+    // too small for 'size' in which case the caller will just call
+    // 'Next()' again.
+    current = chunks_[index_].get();
+    current->used.store(0, std::memory_order_relaxed);
+    current_.store(current, std::memory_order_release);
+
+    return current;
+  }
+
+  // Chunk that allocations are currently bumped from, only changed
+  // while holding 'mutex_'.
+  std::atomic<Chunk*> current_ = nullptr;
+
+  std::atomic<size_t> allocations_ = 0;
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  size_t index_ = 0;
+  size_t next_chunk_size_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
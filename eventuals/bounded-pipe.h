@@ -0,0 +1,387 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "eventuals/bounded-queue.h"
+#include "eventuals/filter.h"
+#include "eventuals/head.h"
+#include "eventuals/if.h"
+#include "eventuals/just.h"
+#include "eventuals/lock.h"
+#include "eventuals/map.h"
+#include "eventuals/repeat.h"
+#include "eventuals/then.h"
+#include "eventuals/type-check.h"
+#include "eventuals/until.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// Like 'Pipe' except it holds at most 'capacity' values and writing
+// to a full pipe waits until a reader has made room.
+//
+// Values are passed between writers and readers through a lock-free
+// queue (see 'BoundedQueue') so unlike 'Pipe' the lock is only
+// acquired when a reader or writer needs to wait (or needs to notify
+// a reader or writer that is waiting).
+template <typename T>
+class BoundedPipe final : public Synchronizable {
+ public:
+  // NOTE: 'capacity' is rounded up (see 'BoundedQueue').
+  explicit BoundedPipe(size_t capacity)
+    : values_(capacity),
+      has_values_or_closed_(&lock()),
+      has_space_or_closed_(&lock()),
+      closed_and_empty_(&lock()) {}
+
+  ~BoundedPipe() override = default;
+
+  // Writes a value to the pipe if the pipe is not closed, waiting for
+  // space if the pipe is full. If the pipe is closed, the value is
+  // silently dropped (including while waiting for space).
+  [[nodiscard]] auto Write(T&& value) {
+    return TypeCheck<void>(WriteValues(Single{std::move(value)}));
+  }
+
+  // Writes all of 'values' to the pipe, waiting for space as
+  // necessary, but only notifying readers at most once for all of
+  // the values that fit. If the pipe is closed, any values not yet
+  // written are silently dropped.
+  [[nodiscard]] auto WriteBatch(std::vector<T>&& values) {
+    return TypeCheck<void>(WriteValues(Batch{std::move(values)}));
+  }
+
+  // Reads the next value from the pipe.
+  //
+  // NOTE: using 'RepeatIteratively()' so that a reader that can read
+  // many values without waiting (or that gets resumed on the stack
+  // of a writer) doesn't recurse for every value.
+  [[nodiscard]] auto Read() {
+    return RepeatIteratively()
+        >> Map([this]() {
+             return TryRead<T>([this](std::optional<T>& value) {
+               value = values_.TryPop();
+               return value.has_value();
+             });
+           })
+        >> Until([this](std::optional<T>& value) {
+             return !value.has_value() && ClosedAndEmpty();
+           })
+        // NOTE: a reader might fail to get a value after waiting if
+        // another reader got to it first in which case we just try
+        // again.
+        >> Filter([](const std::optional<T>& value) {
+             return value.has_value();
+           })
+        >> Map([](std::optional<T>&& value) {
+             CHECK(value);
+             // NOTE: need to use 'Just' here in case 'T' is an
+             // eventual otherwise we'll try and compose with it here!
+             return Just(std::move(*value));
+           });
+  }
+
+  // Reads at least 1 and at most 'max' values from the pipe, or
+  // returns no values if the pipe is closed and empty.
+  [[nodiscard]] auto ReadBatch(size_t max) {
+    CHECK_GT(max, 0u);
+    return TypeCheck<std::vector<T>>(
+        Repeat()
+        >> Map([this, max]() {
+            return TryRead<std::vector<T>>(
+                [this, max](std::optional<std::vector<T>>& values) {
+                  values.emplace();
+                  while (values->size() < max) {
+                    std::optional<T> value = values_.TryPop();
+                    if (!value) {
+                      break;
+                    }
+                    values->push_back(std::move(*value));
+                  }
+                  return !values->empty();
+                });
+          })
+        // NOTE: like in 'Read()' a reader might fail to get any values
+        // after waiting in which case we just try again.
+        >> Filter([this](const std::optional<std::vector<T>>& values) {
+            return values.has_value() || ClosedAndEmpty();
+          })
+        >> Map([](std::optional<std::vector<T>>&& values) {
+            if (values) {
+              return std::move(*values);
+            } else {
+              return std::vector<T>();
+            }
+          })
+        >> Head());
+  }
+
+  // Closes the pipe. Idempotent.
+  [[nodiscard]] auto Close() {
+    return Synchronized(Then([this]() {
+      closed_.store(true);
+      has_values_or_closed_.NotifyAll();
+      has_space_or_closed_.NotifyAll();
+      if (ClosedAndEmpty()) {
+        closed_and_empty_.NotifyAll();
+      }
+    }));
+  }
+
+  // Returns the number of values currently in the pipe.
+  [[nodiscard]] auto Size() {
+    return Then([this]() {
+      return values_.size();
+    });
+  }
+
+  // Returns whether the pipe is closed.
+  [[nodiscard]] auto IsClosed() {
+    return Then([this]() {
+      return closed_.load();
+    });
+  }
+
+  // Blocks until the pipe is closed and drained of values.
+  // Postcondition: IsClosed() == true && Size() == 0.
+  [[nodiscard]] auto WaitForClosedAndEmpty() {
+    return TypeCheck<void>(Synchronized(Then([this]() {
+      return closed_and_empty_.Wait([this]() {
+        return /* while */ !ClosedAndEmpty();
+      });
+    })));
+  }
+
+  size_t capacity() const {
+    return values_.capacity();
+  }
+
+ private:
+  // Helpers for writing either a single value or a batch of values
+  // with the same code in 'WriteValues()'.
+  struct Single {
+    // Returns true if the value has been pushed.
+    bool TryPush(BoundedQueue<T>& values) {
+      if (value && values.TryPush(std::move(*value))) {
+        value.reset();
+      }
+      return !value.has_value();
+    }
+
+    std::optional<T> value;
+  };
+
+  struct Batch {
+    // Returns true if all of the values have been pushed.
+    bool TryPush(BoundedQueue<T>& values) {
+      while (next < batch.size() && values.TryPush(std::move(batch[next]))) {
+        next++;
+      }
+      return next == batch.size();
+    }
+
+    std::vector<T> batch;
+    size_t next = 0;
+  };
+
+  template <typename Values>
+  [[nodiscard]] auto WriteValues(Values&& values) {
+    return Then([this, values = std::move(values)]() mutable {
+      // Fast path: push everything without acquiring the lock unless
+      // we need to notify a waiting reader.
+      bool closed = closed_.load();
+      bool pushed = !closed && values.TryPush(values_);
+      bool notify = pushed && ReadersMightBeWaiting();
+
+      return If(!closed && !pushed)
+          .yes([this, values = std::move(values)]() mutable {
+            return WriteSlow(std::move(values));
+          })
+          .no([this, notify]() {
+            return If(notify)
+                .yes([this]() {
+                  return Synchronized(Then([this]() {
+                    NotifyReaders();
+                  }));
+                })
+                .no([]() {});
+          });
+    });
+  }
+
+  // Waits for space to push the rest of 'values' while holding the
+  // lock, see 'WriteValues()' for the fast path.
+  template <typename Values>
+  [[nodiscard]] auto WriteSlow(Values&& values) {
+    return Synchronized(Then([this, values = std::move(values)]() mutable {
+      return has_space_or_closed_.Wait([this, &values]() {
+        if (closed_.load()) {
+          return false; // Drop anything we haven't pushed.
+        }
+
+        bool pushed = values.TryPush(values_);
+
+        if (!pushed) {
+          // Let readers know they need to notify us and then make
+          // sure one didn't pop a value in the meantime.
+          writers_waiting_.store(true);
+
+          // NOTE: this fence pairs with the one in
+          // 'NeedToNotifyAfterRead()'.
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+
+          pushed = values.TryPush(values_);
+        }
+
+        // Notify readers for any values we pushed even if we
+        // haven't pushed all of them yet.
+        NotifyReaders();
+
+        return /* while */ !pushed;
+      });
+    }));
+  }
+
+  // Returns an eventual which tries to read a 'Value' using 'f'
+  // without acquiring the lock and otherwise acquires the lock and
+  // waits until there are values to read (or the pipe is closed) and
+  // then tries to read using 'f' again. The eventual returns an empty
+  // optional if there weren't any values when trying the second
+  // time.
+  template <typename Value, typename F>
+  [[nodiscard]] auto TryRead(F f) {
+    std::optional<Value> value;
+
+    bool read = f(value);
+
+    if (!read) {
+      value.reset();
+    }
+
+    bool notify = read && NeedToNotifyAfterRead();
+
+    return If(!read)
+        .yes([this, f = std::move(f)]() mutable {
+          return ReadSlow<Value>(std::move(f));
+        })
+        .no([this, value = std::move(value), notify]() mutable {
+          return If(notify)
+                     .yes([this]() {
+                       return Synchronized(Then([this]() {
+                         NotifyWritersAndClosedAndEmpty();
+                       }));
+                     })
+                     .no([]() {})
+              >> Then([value = std::move(value)]() mutable {
+                   return std::move(value);
+                 });
+        });
+  }
+
+  // See 'TryRead()'.
+  template <typename Value, typename F>
+  [[nodiscard]] auto ReadSlow(F f) {
+    return Synchronized(
+        has_values_or_closed_.Wait([this]() {
+          if (!values_.Empty() || closed_.load()) {
+            return false;
+          }
+
+          // Let writers know they need to notify us and then make
+          // sure one didn't push a value in the meantime.
+          readers_waiting_.store(true);
+
+          // NOTE: this fence pairs with the one in
+          // 'ReadersMightBeWaiting()'.
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+
+          return /* while */ values_.Empty();
+        })
+        >> Then([this, f = std::move(f)]() mutable {
+            std::optional<Value> value;
+            if (!f(value)) {
+              value.reset();
+            } else {
+              NotifyWritersAndClosedAndEmpty();
+            }
+            return value;
+          }));
+  }
+
+  // Returns true if a reader might be waiting for a value and thus a
+  // writer that just pushed a value without holding the lock needs
+  // to acquire the lock and call 'NotifyReaders()'.
+  bool ReadersMightBeWaiting() {
+    // NOTE: this fence pairs with the one in 'ReadSlow()'.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return readers_waiting_.load(std::memory_order_relaxed);
+  }
+
+  // Returns true if a reader that just popped values without holding
+  // the lock needs to acquire the lock and call
+  // 'NotifyWritersAndClosedAndEmpty()' because either a writer might
+  // be waiting for space or the pipe is now closed and empty.
+  bool NeedToNotifyAfterRead() {
+    // NOTE: this fence pairs with the one in 'WriteSlow()' and the
+    // one in 'ClosedAndEmpty()'.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return writers_waiting_.load(std::memory_order_relaxed)
+        || (closed_.load(std::memory_order_relaxed) && values_.Empty());
+  }
+
+  bool ClosedAndEmpty() {
+    // NOTE: this fence ensures that either a reader that just popped
+    // the last value sees that we're closed or 'Close()' sees that
+    // we're empty (or both).
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return closed_.load() && values_.Empty();
+  }
+
+  // NOTE: expects to be called while holding the lock.
+  void NotifyReaders() {
+    CHECK(lock().OwnedByCurrentSchedulerContext());
+    if (readers_waiting_.exchange(false)) {
+      has_values_or_closed_.NotifyAll();
+    }
+  }
+
+  // NOTE: expects to be called while holding the lock.
+  void NotifyWritersAndClosedAndEmpty() {
+    CHECK(lock().OwnedByCurrentSchedulerContext());
+    if (writers_waiting_.exchange(false)) {
+      has_space_or_closed_.NotifyAll();
+    }
+    if (ClosedAndEmpty()) {
+      closed_and_empty_.NotifyAll();
+    }
+  }
+
+  BoundedQueue<T> values_;
+
+  // Notified whenever we either have new values or the pipe has been closed.
+  ConditionVariable has_values_or_closed_;
+  // Notified whenever we have space for new values or the pipe has
+  // been closed.
+  ConditionVariable has_space_or_closed_;
+  // Notified once the pipe is closed and is emptied of all values, after which
+  // the pipe will never again contain values.
+  ConditionVariable closed_and_empty_;
+
+  std::atomic<bool> closed_ = false;
+
+  // Set by readers (writers) before waiting so that writers (readers)
+  // only acquire the lock to notify them when necessary.
+  std::atomic<bool> readers_waiting_ = false;
+  std::atomic<bool> writers_waiting_ = false;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
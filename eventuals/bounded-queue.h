@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new> // For placement new.
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "glog/logging.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// A bounded, lock-free, multiple producer multiple consumer queue.
+//
+// The implementation is the well known array based queue from Dmitry
+// Vyukov where each slot has a sequence number that producers and
+// consumers use to determine whether or not the slot is ready for
+// them. All of the storage is allocated once at construction so
+// pushing and popping never performs any dynamic memory allocation.
+//
+// NOTE: this is _not_ an eventual, it's a building block for
+// implementing eventuals that need to pass values between scheduler
+// contexts without acquiring a 'Lock' (see for example
+// 'Concurrent()').
+template <typename T>
+class BoundedQueue final {
+ public:
+  // NOTE: 'capacity' is rounded up to the next power of 2 and is at
+  // least 2 since with a single slot the sequence number of a full
+  // slot is indistinguishable from that of an empty one.
+  explicit BoundedQueue(size_t capacity)
+    : capacity_(RoundUpToPowerOfTwo(capacity)),
+      mask_(capacity_ - 1),
+      slots_(new Slot[capacity_]) {
+    for (size_t i = 0; i < capacity_; i++) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue(BoundedQueue&&) = delete;
+
+  ~BoundedQueue() {
+    while (TryPop()) {}
+  }
+
+  // Attempts to push 'value' and returns false if the queue is full.
+  //
+  // NOTE: 'value' is only moved from (or copied) if this returns
+  // true so callers can fall back to doing something else with
+  // 'value' when the queue is full.
+  template <typename U>
+  [[nodiscard]] bool TryPush(U&& value) {
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+
+    for (;;) {
+      Slot& slot = slots_[position & mask_];
+
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+      auto difference =
+          static_cast<std::ptrdiff_t>(sequence)
+          - static_cast<std::ptrdiff_t>(position);
+
+      if (difference == 0) {
+        if (enqueue_position_.compare_exchange_weak(
+                position,
+                position + 1,
+                std::memory_order_relaxed)) {
+          new (&slot.storage) T(std::forward<U>(value));
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false; // Full.
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Attempts to pop a value and returns an empty optional if either
+  // the queue is empty or the next value has been claimed by a
+  // producer but has not yet been published (see 'Empty()' for
+  // distinguishing between the two).
+  [[nodiscard]] std::optional<T> TryPop() {
+    size_t position = dequeue_position_.load(std::memory_order_relaxed);
+
+    for (;;) {
+      Slot& slot = slots_[position & mask_];
+
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+      auto difference =
+          static_cast<std::ptrdiff_t>(sequence)
+          - static_cast<std::ptrdiff_t>(position + 1);
+
+      if (difference == 0) {
+        if (dequeue_position_.compare_exchange_weak(
+                position,
+                position + 1,
+                std::memory_order_relaxed)) {
+          T* t = std::launder(reinterpret_cast<T*>(&slot.storage));
+          std::optional<T> value(std::move(*t));
+          t->~T();
+          slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return value;
+        }
+      } else if (difference < 0) {
+        return std::nullopt; // Empty (or not yet published).
+      } else {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Returns true if no producer has claimed a slot that hasn't been
+  // popped yet. Unlike a failed 'TryPop()' this accounts for values
+  // that are in the process of being pushed.
+  //
+  // NOTE: this is only a snapshot and may be out of date as soon as
+  // it returns unless the caller otherwise knows there are no
+  // concurrent producers.
+  bool Empty() const {
+    return enqueue_position_.load(std::memory_order_relaxed)
+        == dequeue_position_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the number of values that have been pushed and not yet
+  // popped.
+  //
+  // NOTE: like 'Empty()' this is only a snapshot.
+  size_t size() const {
+    // NOTE: loading the dequeue position first since it can never
+    // get ahead of the enqueue position.
+    size_t dequeue_position = dequeue_position_.load();
+    size_t enqueue_position = enqueue_position_.load();
+    return enqueue_position - dequeue_position;
+  }
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+ private:
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    CHECK_GT(n, 0u) << "'BoundedQueue' capacity must be greater than 0";
+    size_t power = 2;
+    while (power < n) {
+      power <<= 1;
+    }
+    return power;
+  }
+
+  struct Slot {
+    std::atomic<size_t> sequence;
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+  };
+
+  // NOTE: producers and consumers only touch their own position so
+  // we keep them on separate cache lines to avoid false sharing.
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_position_ = 0;
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_position_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "eventuals/buffer-pool.h"
+#include "glog/logging.h"
+#include "uv.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// A sequence of (non-contiguous) slices of memory that can be written
+// all at once with a single vectored write (e.g., 'writev()') rather
+// than first copying them into one contiguous buffer, e.g., headers
+// followed by a body read in chunks.
+//
+// Appending never copies any bytes: strings and pooled buffers are
+// moved into a reference counted slice and appending (or copying) a
+// chain just shares its slices. The memory backing a slice is freed
+// (or returned to its 'BufferPool') after the last chain referencing
+// it has been destructed, e.g., once a write has completed.
+//
+// NOTE: a chain is not thread-safe but copies of a chain can be used
+// from different threads.
+//
+// Moveable and Copyable (copies share the same slices).
+class BufferChain final {
+ public:
+  BufferChain() = default;
+
+  BufferChain(const BufferChain&) = default;
+  BufferChain(BufferChain&&) noexcept = default;
+
+  BufferChain& operator=(const BufferChain&) = default;
+  BufferChain& operator=(BufferChain&&) noexcept = default;
+
+  ~BufferChain() = default;
+
+  BufferChain& Append(std::string&& data) {
+    if (!data.empty()) {
+      auto owner = std::make_shared<std::string>(std::move(data));
+      const char* pointer = owner->data();
+      const size_t size = owner->size();
+      Add(std::move(owner), pointer, size);
+    }
+    return *this;
+  }
+
+  BufferChain& Append(std::shared_ptr<const std::string> data) {
+    if (data && !data->empty()) {
+      const char* pointer = data->data();
+      const size_t size = data->size();
+      Add(std::move(data), pointer, size);
+    }
+    return *this;
+  }
+
+  // Appends the first 'buffer.size()' bytes of 'buffer' which gets
+  // returned to its pool after the last chain referencing it has been
+  // destructed.
+  BufferChain& Append(BufferPool::Buffer&& buffer) {
+    if (buffer.size() > 0) {
+      auto owner = std::make_shared<BufferPool::Buffer>(std::move(buffer));
+      const char* pointer = owner->data();
+      const size_t size = owner->size();
+      Add(std::move(owner), pointer, size);
+    }
+    return *this;
+  }
+
+  // Appends all of the slices of 'that' (sharing, not copying, them).
+  BufferChain& Append(const BufferChain& that) {
+    CHECK_NE(this, &that) << "use a copy to append a chain to itself";
+    slices_.insert(slices_.end(), that.slices_.begin(), that.slices_.end());
+    buffers_.insert(
+        buffers_.end(),
+        that.buffers_.begin(),
+        that.buffers_.end());
+    size_ += that.size_;
+    return *this;
+  }
+
+  // Appends 'data' without taking ownership of it, i.e., 'data' must
+  // outlive this chain and all copies of it, e.g., a string literal.
+  BufferChain& AppendUnowned(std::string_view data) {
+    if (!data.empty()) {
+      Add(nullptr, data.data(), data.size());
+    }
+    return *this;
+  }
+
+  template <typename T>
+  BufferChain& operator+=(T&& t) {
+    return Append(std::forward<T>(t));
+  }
+
+  // Total number of bytes in the chain.
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  // Number of (non-empty) slices in the chain.
+  size_t slices() const noexcept {
+    return slices_.size();
+  }
+
+  // Returns a 'uv_buf_t' for each slice, e.g., for 'uv_write()' or
+  // 'uv_fs_write()'. On Unix libuv guarantees that 'uv_buf_t' has the
+  // same layout as 'iovec' so these can also be passed to 'writev()'.
+  //
+  // NOTE: only valid until the chain is next modified.
+  const std::vector<uv_buf_t>& buffers() const noexcept {
+    return buffers_;
+  }
+
+  // Removes the first 'bytes' bytes from the chain, e.g., after a
+  // partial write, releasing any slices that no longer have any
+  // bytes.
+  void Consume(size_t bytes) {
+    CHECK_LE(bytes, size_);
+
+    size_ -= bytes;
+
+    size_t consumed = 0;
+
+    while (bytes > 0) {
+      uv_buf_t& buffer = buffers_[consumed];
+
+      if (bytes < buffer.len) {
+        buffer.base += bytes;
+        buffer.len -= bytes;
+        break;
+      }
+
+      bytes -= buffer.len;
+      consumed++;
+    }
+
+    slices_.erase(slices_.begin(), slices_.begin() + consumed);
+    buffers_.erase(buffers_.begin(), buffers_.begin() + consumed);
+  }
+
+  void Clear() {
+    slices_.clear();
+    buffers_.clear();
+    size_ = 0;
+  }
+
+  // Copies all of the slices into a single contiguous string.
+  std::string ToString() const {
+    std::string result;
+    result.reserve(size_);
+    for (const uv_buf_t& buffer : buffers_) {
+      result.append(buffer.base, buffer.len);
+    }
+    return result;
+  }
+
+ private:
+  void Add(std::shared_ptr<const void> owner, const char* data, size_t size) {
+    slices_.push_back(std::move(owner));
+    buffers_.push_back(uv_buf_init(const_cast<char*>(data), size));
+    size_ += size;
+  }
+
+  // The owner of each slice (or 'nullptr' if unowned) kept parallel
+  // to 'buffers_' so that 'buffers()' doesn't need to be computed.
+  std::vector<std::shared_ptr<const void>> slices_;
+  std::vector<uv_buf_t> buffers_;
+  size_t size_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
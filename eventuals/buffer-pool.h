@@ -0,0 +1,223 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// A pool of fixed size buffers for reading into (and writing from)
+// without allocating (or zero-filling) a new buffer every time, e.g.,
+// when streaming a large file a chunk at a time.
+//
+// Buffers are returned to the pool when they are destructed and
+// reused by the next 'Acquire()', keeping up to 'max_cached' of them
+// around, so after the pool has "warmed up" no more memory gets
+// allocated from the heap.
+//
+// NOTE: a pool is thread-safe since buffers are often acquired on an
+// event loop but destructed on whatever thread consumed them. A pool
+// must outlive all of its buffers.
+class BufferPool final {
+ public:
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+  static constexpr size_t DEFAULT_MAX_CACHED = 64;
+
+  // Moveable, not Copyable.
+  class Buffer final {
+   public:
+    Buffer() = default;
+
+    Buffer(const Buffer&) = delete;
+
+    Buffer(Buffer&& that) noexcept
+      : pool_(that.pool_),
+        data_(that.data_),
+        size_(that.size_) {
+      that.pool_ = nullptr;
+      that.data_ = nullptr;
+      that.size_ = 0;
+    }
+
+    Buffer& operator=(const Buffer&) = delete;
+
+    Buffer& operator=(Buffer&& that) noexcept {
+      if (this == &that) {
+        return *this;
+      }
+
+      Release();
+
+      pool_ = that.pool_;
+      data_ = that.data_;
+      size_ = that.size_;
+
+      that.pool_ = nullptr;
+      that.data_ = nullptr;
+      that.size_ = 0;
+
+      return *this;
+    }
+
+    ~Buffer() {
+      Release();
+    }
+
+    char* data() noexcept {
+      return data_;
+    }
+
+    const char* data() const noexcept {
+      return data_;
+    }
+
+    // Number of valid bytes in the buffer, e.g., how many bytes were
+    // read into it, which is initially 'capacity()'.
+    size_t size() const noexcept {
+      return size_;
+    }
+
+    size_t capacity() const noexcept {
+      return pool_ != nullptr ? pool_->buffer_size() : 0;
+    }
+
+    // NOTE: never initializes any bytes, just changes 'size()'.
+    void resize(size_t size) {
+      CHECK_LE(size, capacity());
+      size_ = size;
+    }
+
+    std::string_view view() const noexcept {
+      return std::string_view(data_, size_);
+    }
+
+   private:
+    friend class BufferPool;
+
+    Buffer(BufferPool* pool, char* data, size_t size)
+      : pool_(pool),
+        data_(data),
+        size_(size) {}
+
+    void Release() {
+      if (pool_ != nullptr) {
+        pool_->Release(data_);
+        pool_ = nullptr;
+        data_ = nullptr;
+        size_ = 0;
+      }
+    }
+
+    BufferPool* pool_ = nullptr;
+    char* data_ = nullptr;
+    size_t size_ = 0;
+  };
+
+  explicit BufferPool(
+      size_t buffer_size = DEFAULT_BUFFER_SIZE,
+      size_t max_cached = DEFAULT_MAX_CACHED)
+    : buffer_size_(buffer_size),
+      max_cached_(max_cached) {
+    CHECK_GT(buffer_size_, 0u);
+  }
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool(BufferPool&&) = delete;
+
+  ~BufferPool() {
+    CHECK_EQ(outstanding_, 0u)
+        << "destructing buffer pool with outstanding buffers";
+
+    for (char* data : cached_) {
+      delete[] data;
+    }
+  }
+
+  // Returns a buffer of 'buffer_size()' bytes whose contents are
+  // unspecified (i.e., whatever was left in it from last time).
+  Buffer Acquire() {
+    char* data = nullptr;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      outstanding_++;
+
+      if (!cached_.empty()) {
+        data = cached_.back();
+        cached_.pop_back();
+      } else {
+        allocations_++;
+      }
+    }
+
+    if (data == nullptr) {
+      // NOTE: deliberately not value-initialized, i.e., not zeroed.
+      data = new char[buffer_size_];
+    }
+
+    return Buffer(this, data, buffer_size_);
+  }
+
+  size_t buffer_size() const noexcept {
+    return buffer_size_;
+  }
+
+  // Number of buffers that are currently cached, i.e., that can be
+  // acquired without allocating.
+  size_t cached() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cached_.size();
+  }
+
+  // Number of buffers that have been acquired but not yet released.
+  size_t outstanding() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outstanding_;
+  }
+
+  // Total number of buffers that have been allocated from the heap.
+  size_t allocations() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocations_;
+  }
+
+ private:
+  void Release(char* data) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      outstanding_--;
+
+      if (cached_.size() < max_cached_) {
+        cached_.push_back(data);
+        return;
+      }
+    }
+
+    delete[] data;
+  }
+
+  const size_t buffer_size_;
+  const size_t max_cached_;
+
+  std::mutex mutex_;
+  std::vector<char*> cached_;
+  size_t outstanding_ = 0;
+  size_t allocations_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
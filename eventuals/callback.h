@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <cstring> // For 'std::memcpy'.
+#include <new> // For placement new.
 #include <type_traits> // For std::aligned_storage.
 #include <utility> // For std::move.
 
@@ -12,16 +15,184 @@ namespace eventuals {
 
 ////////////////////////////////////////////////////////////////////////
 
+struct _Callback final {
+  // NOTE: helper function used only to get a type so we can determine
+  // the size necessary to accomodate storing a
+  // 'stout::borrowed_callable'.
+  static auto BorrowedCallable() {
+    stout::Borrowable<int> borrowable;
+    return borrowable.Borrow([i = new int]() {});
+  }
+
+  // Pool of fixed size blocks for callables that are too big to be
+  // stored inline in a 'PooledCallback'.
+  //
+  // Blocks are cached per thread (up to 'MAX_CACHED_BLOCKS' for each
+  // size) so that repeatedly creating (and destructing) the same kind
+  // of callback doesn't need to allocate from the heap. Each block
+  // remembers which thread's cache it was allocated from and is only
+  // ever cached by that thread, a block deallocated on any other
+  // thread (or after its thread's cache has been destructed, e.g., by
+  // another 'thread_local' being destructed at thread exit) is just
+  // returned to the heap.
+  class Pool final {
+   public:
+    static constexpr std::size_t MIN_BLOCK_SIZE = 64;
+    static constexpr std::size_t SIZES = 7; // 64, 128, ..., 4096.
+    static constexpr std::size_t MAX_CACHED_BLOCKS = 64;
+
+    static void* Allocate(std::size_t size) {
+      const std::size_t index = IndexOf(size);
+
+      if (index == SIZES) {
+        return ::operator new(size);
+      }
+
+      FreeLists* lists = Lists();
+
+      if (lists != nullptr) {
+        FreeList& list = lists->lists[index];
+
+        if (list.head != nullptr) {
+          Block* block = list.head;
+          list.head = block->next;
+          list.count--;
+          return block;
+        }
+      }
+
+      auto* header = new (::operator new(
+          sizeof(Header) + (MIN_BLOCK_SIZE << index))) Header{lists};
+
+      return header + 1;
+    }
+
+    static void Deallocate(void* pointer, std::size_t size) {
+      const std::size_t index = IndexOf(size);
+
+      if (index == SIZES) {
+        ::operator delete(pointer);
+        return;
+      }
+
+      Header* header = static_cast<Header*>(pointer) - 1;
+
+      FreeLists* lists = Lists();
+
+      if (lists == nullptr
+          || header->origin != lists
+          || lists->lists[index].count == MAX_CACHED_BLOCKS) {
+        ::operator delete(header);
+        return;
+      }
+
+      FreeList& list = lists->lists[index];
+
+      list.head = new (pointer) Block{list.head};
+      list.count++;
+    }
+
+   private:
+    struct FreeLists;
+
+    // Precedes every block so it can be cached by the thread it was
+    // allocated on, padded so the block itself stays aligned.
+    struct alignas(std::max_align_t) Header final {
+      FreeLists* origin = nullptr;
+    };
+
+    struct Block final {
+      Block* next = nullptr;
+    };
+
+    struct FreeList final {
+      Block* head = nullptr;
+      std::size_t count = 0;
+    };
+
+    struct FreeLists final {
+      ~FreeLists() {
+        Destructed() = true;
+        for (FreeList& list : lists) {
+          while (list.head != nullptr) {
+            Block* block = list.head;
+            list.head = block->next;
+            ::operator delete(reinterpret_cast<Header*>(block) - 1);
+          }
+        }
+      }
+
+      FreeList lists[SIZES];
+    };
+
+    // NOTE: a 'bool' is trivially destructible so unlike 'FreeLists'
+    // it can still be used after the thread's 'thread_local' objects
+    // have started being destructed.
+    static bool& Destructed() {
+      static thread_local bool destructed = false;
+      return destructed;
+    }
+
+    // Returns the current thread's free lists or 'nullptr' if they
+    // have already been destructed.
+    static FreeLists* Lists() {
+      if (Destructed()) {
+        return nullptr;
+      }
+      static thread_local FreeLists lists;
+      return &lists;
+    }
+
+    static constexpr std::size_t IndexOf(std::size_t size) {
+      std::size_t index = 0;
+      while (index < SIZES && (MIN_BLOCK_SIZE << index) < size) {
+        index++;
+      }
+      return index;
+    }
+  };
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Default number of bytes that a 'Callback' can store inline, which
+// is enough for a 'stout::borrowed_callable' of a lambda that only
+// captures 'this' (or something else that is pointer sized) plus
+// another pointer's worth of captures.
+inline constexpr std::size_t SIZEOF_CALLBACK =
+    sizeof(decltype(_Callback::BorrowedCallable())) + sizeof(void*);
+
+////////////////////////////////////////////////////////////////////////
+
 // Helper for using lambdas that only capture 'this' or something less
-// than or equal to 'sizeof(void*)' without needing to do any heap
-// allocation or use std::function (which increases compile times and
-// is not required to avoid heap allocation even if most
-// implementations do for small lambdas).
-template <typename>
+// than or equal to 'SIZEOF_CALLBACK' (or 'Size_' if specified)
+// without needing to do any heap allocation or use std::function
+// (which increases compile times and is not required to avoid heap
+// allocation even if most implementations do for small lambdas).
+//
+// Callables that are trivially copyable (e.g., lambdas that only
+// capture pointers or references) are moved and destructed without
+// any indirection.
+//
+// A callable that is too big to store inline is a compile time error
+// unless 'Pooled_' is true (see 'PooledCallback') in which case it is
+// stored in a block from '_Callback::Pool'.
+template <
+    typename Signature,
+    std::size_t Size_ = SIZEOF_CALLBACK,
+    bool Pooled_ = false>
 struct Callback;
 
-template <typename R, typename... Args>
-struct Callback<R(Args...)> final {
+template <typename R, typename... Args, std::size_t Size_, bool Pooled_>
+struct Callback<R(Args...), Size_, Pooled_> final {
+  static constexpr std::size_t SIZE = Size_;
+
+  // Returns true if 'F' can be stored inline, i.e., without using
+  // '_Callback::Pool'.
+  template <typename F>
+  static constexpr bool Fits = sizeof(F) <= Size_
+      && alignof(F) <= alignof(std::aligned_storage_t<Size_>);
+
   // TODO(benh): Delete default constructor and force a usage pattern
   // where a delayed initialization requires std::optional so that a
   // user doesn't run into issues where they try and invoke a callback
@@ -42,17 +213,9 @@ struct Callback<R(Args...)> final {
       return *this;
     }
 
-    if (base_ != nullptr) {
-      base_->~Base();
-      base_ = nullptr;
-    }
+    Reset();
 
-    if (that.base_ != nullptr) {
-      base_ = that.base_->Move(&storage_);
-
-      // Set 'base_' to nullptr so we only destruct once.
-      that.base_ = nullptr;
-    }
+    Take(that);
 
     return *this;
   }
@@ -64,92 +227,137 @@ struct Callback<R(Args...)> final {
         "Not to be used as a *copy* assignment operator!");
 
     static_assert(
-        sizeof(Handler<F>) <= SIZE,
+        Fits<F> || Pooled_,
         "Your callable (e.g., a lambda) is too big for 'Callback' "
-        "(do you have too many captures in your lambda?)");
+        "(do you have too many captures in your lambda?) either "
+        "increase the inline size, e.g., 'Callback<void(), 128>', "
+        "or use a 'PooledCallback'");
 
-    if (base_ != nullptr) {
-      base_->~Base();
-    }
+    Reset();
 
-    new (&storage_) Handler<F>(std::move(f));
+    if constexpr (Fits<F>) {
+      new (&storage_) F(std::move(f));
 
-    base_ = reinterpret_cast<Handler<F>*>(&storage_);
+      invoke_ = &Invoke<F>;
+
+      if constexpr (!std::is_trivially_copyable_v<F>) {
+        manage_ = &Manage<F>;
+      }
+    } else {
+      static_assert(
+          alignof(F) <= alignof(std::max_align_t),
+          "Your callable (e.g., a lambda) is over aligned");
+
+      F* pointer = new (_Callback::Pool::Allocate(sizeof(F)))
+          F(std::move(f));
+
+      new (&storage_) F*(pointer);
+
+      invoke_ = &InvokePooled<F>;
+      manage_ = &ManagePooled<F>;
+    }
 
     return *this;
   }
 
   Callback(Callback&& that) noexcept {
-    if (that.base_ != nullptr) {
-      base_ = that.base_->Move(&storage_);
-
-      // Set 'base_' to nullptr so we only destruct once.
-      that.base_ = nullptr;
-    }
+    Take(that);
   }
 
   ~Callback() {
-    if (base_ != nullptr) {
-      base_->~Base();
-    }
+    Reset();
   }
 
   R operator()(Args... args) {
-    assert(base_ != nullptr);
-    return base_->Invoke(std::forward<Args>(args)...);
+    assert(invoke_ != nullptr);
+    return invoke_(&storage_, std::forward<Args>(args)...);
   }
 
   operator bool() const {
-    return base_ != nullptr;
+    return invoke_ != nullptr;
   }
 
-  struct Base {
-    virtual ~Base() = default;
-
-    virtual R Invoke(Args... args) = 0;
-
-    virtual Base* Move(void* storage) = 0;
+ private:
+  enum class Operation {
+    Move,
+    Destruct,
   };
 
   template <typename F>
-  struct Handler final : Base {
-    Handler(F f)
-      : f_(std::move(f)) {}
+  static R Invoke(void* storage, Args&&... args) {
+    return (*static_cast<F*>(storage))(std::forward<Args>(args)...);
+  }
 
-    ~Handler() override = default;
+  template <typename F>
+  static R InvokePooled(void* storage, Args&&... args) {
+    return (**static_cast<F**>(storage))(std::forward<Args>(args)...);
+  }
 
-    R Invoke(Args... args) override {
-      return f_(std::forward<Args>(args)...);
+  // Either moves the callable from 'from' to 'to' (and destructs
+  // the callable at 'from') or destructs the callable at 'from'.
+  template <typename F>
+  static void Manage(Operation operation, void* from, void* to) {
+    F* f = static_cast<F*>(from);
+    if (operation == Operation::Move) {
+      new (to) F(std::move(*f));
     }
+    f->~F();
+  }
 
-    // TODO(benh): better way to do this?
-    Base* Move(void* storage) override {
-      new (storage) Handler<F>(std::move(f_));
-      return reinterpret_cast<Handler<F>*>(storage);
+  template <typename F>
+  static void ManagePooled(Operation operation, void* from, void* to) {
+    F* f = *static_cast<F**>(from);
+    if (operation == Operation::Move) {
+      new (to) F*(f);
+    } else {
+      f->~F();
+      _Callback::Pool::Deallocate(f, sizeof(F));
     }
+  }
 
-    F f_;
-  };
+  void Take(Callback& that) {
+    if (that.invoke_ != nullptr) {
+      if (that.manage_ != nullptr) {
+        that.manage_(Operation::Move, &that.storage_, &storage_);
+      } else {
+        std::memcpy(&storage_, &that.storage_, Size_);
+      }
+
+      invoke_ = that.invoke_;
+      manage_ = that.manage_;
+
+      // Set 'invoke_' and 'manage_' to nullptr so we only destruct
+      // once.
+      that.invoke_ = nullptr;
+      that.manage_ = nullptr;
+    }
+  }
 
-  // NOTE: helper function used only to get a type so we can determine
-  // the size necessary to accomodate storing a
-  // 'stout::borrowed_callable'.
-  static auto BorrowedCallable() {
-    stout::Borrowable<int> borrowable;
-    return borrowable.Borrow([i = new int]() {});
+  void Reset() {
+    if (manage_ != nullptr) {
+      manage_(Operation::Destruct, &storage_, nullptr);
+    }
+
+    invoke_ = nullptr;
+    manage_ = nullptr;
   }
 
-  static constexpr std::size_t SIZE =
-      sizeof(decltype(BorrowedCallable())) + sizeof(Base);
+  std::aligned_storage_t<Size_> storage_;
 
-  std::aligned_storage_t<SIZE> storage_;
+  R (*invoke_)(void*, Args&&...) = nullptr;
 
-  Base* base_ = nullptr;
+  // Only set if the callable is _not_ trivially copyable (or is
+  // pooled) so that moving and destructing is otherwise "free".
+  void (*manage_)(Operation, void*, void*) = nullptr;
 };
 
 ////////////////////////////////////////////////////////////////////////
 
-inline constexpr std::size_t SIZEOF_CALLBACK = Callback<void()>::SIZE;
+// A 'Callback' that stores callables that are too big to be stored
+// inline in blocks from '_Callback::Pool' rather than failing to
+// compile.
+template <typename Signature, std::size_t Size_ = SIZEOF_CALLBACK>
+using PooledCallback = Callback<Signature, Size_, true>;
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -2,22 +2,13 @@
 
 #include <type_traits>
 
+#include "eventuals/logging.h"
 #include "eventuals/os.h"
 #include "eventuals/type-traits.h"
 #include "glog/logging.h"
 
 ////////////////////////////////////////////////////////////////////////
 
-inline bool EventualsLog(int level) {
-  static const char* variable = std::getenv("EVENTUALS_LOG");
-  static int value = variable != nullptr ? atoi(variable) : 0;
-  return value >= level;
-}
-
-#define EVENTUALS_LOG(level) LOG_IF(INFO, EventualsLog(level))
-
-////////////////////////////////////////////////////////////////////////
-
 namespace eventuals {
 
 ////////////////////////////////////////////////////////////////////////
@@ -1,8 +1,11 @@
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <tuple>
+#include <vector>
 
 #include "eventuals/callback.h"
 #include "eventuals/compose.h"
@@ -20,11 +23,115 @@ namespace eventuals {
 
 /////////////////////////////////////////////////////////////////////
 
+// Shared between the stage that assigns indexes to upstream values
+// (see 'ReorderWindow()') and 'ReorderAdaptor()' so that when
+// 'ConcurrentOrdered()' is given a window we stop admitting upstream
+// values while the value at the head of the window is stalled.
+class _ReorderWindow final {
+ public:
+  explicit _ReorderWindow(size_t size)
+    : size_(static_cast<int>(size)) {
+    CHECK_GT(size, 0u) << "'ConcurrentOrdered()' window must be > 0";
+  }
+
+  _ReorderWindow(const _ReorderWindow&) = delete;
+  _ReorderWindow(_ReorderWindow&&) = delete;
+
+  size_t size() const {
+    return static_cast<size_t>(size_);
+  }
+
+  bool closed() const {
+    return closed_.load();
+  }
+
+  // Returns true if the value with 'index' can be admitted.
+  bool Admits(int index) const {
+    return closed_.load()
+        || index - head_.load() < size_;
+  }
+
+  // Stores 'callback' to be invoked once 'index' is admitted, or
+  // returns false if 'index' has already been admitted in which case
+  // 'callback' will never be invoked.
+  bool WaitUntilAdmits(int index, Callback<void()>&& callback) {
+    std::scoped_lock lock(mutex_);
+    CHECK(!callback_) << "only one value should be waiting at a time";
+
+    // NOTE: we need to set 'waiting_' _before_ we check 'Admits()'
+    // (and 'Advance()' needs to do the opposite) so that at least
+    // one of us sees the other.
+    waiting_.store(true);
+
+    if (Admits(index)) {
+      waiting_.store(false);
+      return false;
+    }
+
+    index_ = index;
+    callback_ = std::move(callback);
+    return true;
+  }
+
+  // Moves the head of the window to 'head', invoking the callback
+  // for any value waiting to be admitted if it now can be.
+  void Advance(int head) {
+    head_.store(head);
+    Wakeup();
+  }
+
+  // Admits all values from now on, e.g., because we've failed or
+  // stopped and won't be advancing the head anymore.
+  void Close() {
+    closed_.store(true);
+    Wakeup();
+  }
+
+ private:
+  void Wakeup() {
+    if (waiting_.load()) {
+      Callback<void()> callback;
+      {
+        std::scoped_lock lock(mutex_);
+        if (callback_ && Admits(index_)) {
+          waiting_.store(false);
+          callback = std::move(callback_);
+        }
+      }
+      if (callback) {
+        callback();
+      }
+    }
+  }
+
+  const int size_;
+
+  // Index of the next value that 'ReorderAdaptor()' will emit.
+  std::atomic<int> head_ = 1;
+
+  std::atomic<bool> closed_ = false;
+
+  // Fast check for whether or not a value is waiting so that
+  // 'Advance()' only needs to acquire 'mutex_' when one is.
+  std::atomic<bool> waiting_ = false;
+
+  std::mutex mutex_;
+  int index_ = 0;
+  Callback<void()> callback_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
 struct _ReorderAdaptor final {
   template <typename K_, typename Value_>
   struct Continuation final : public TypeErasedStream {
-    Continuation(K_ k)
-      : k_(std::move(k)) {}
+    Continuation(K_ k, std::shared_ptr<_ReorderWindow> window)
+      : slots_(
+          window
+              ? RoundUpToPowerOfTwo(window->size())
+              : INITIAL_SLOTS),
+        window_(std::move(window)),
+        k_(std::move(k)) {}
 
     Continuation(Continuation&& that) noexcept = default;
 
@@ -42,20 +149,23 @@ struct _ReorderAdaptor final {
       CHECK(!done_);
       int i = std::get<0>(tuple);
       if (i < 0) {
-        ended_[i * -1] = true;
+        SlotFor(i * -1).ended = true;
         Next();
       } else if (index_ == i) {
-        CHECK(buffer_[i].empty());
+        CHECK(SlotFor(i).empty());
         k_.Body(std::move(std::get<1>(tuple).value()));
       } else {
         CHECK(index_ < i);
-        buffer_[i].push_back(std::move(std::get<1>(tuple).value()));
+        SlotFor(i).values.push_back(std::move(std::get<1>(tuple).value()));
         upstream_->Next();
       }
     }
 
     template <typename Error>
     void Fail(Error&& error) {
+      if (window_) {
+        window_->Close();
+      }
       k_.Fail(std::forward<Error>(error));
     }
 
@@ -64,6 +174,9 @@ struct _ReorderAdaptor final {
     }
 
     void Stop() {
+      if (window_) {
+        window_->Close();
+      }
       k_.Stop();
     }
 
@@ -74,13 +187,16 @@ struct _ReorderAdaptor final {
     // Calls 'Next' on 'upstream' in case when there are no stored
     // values, propagate a value from buffer to 'Body' otherwise.
     void Next() override {
-      if (!buffer_[index_].empty()) {
-        auto value = buffer_[index_].front();
-        buffer_[index_].pop_front();
+      Slot& slot = SlotFor(index_);
+      if (!slot.empty()) {
+        auto value = std::move(slot.values[slot.next++]);
         k_.Body(std::move(value));
-      } else if (ended_[index_]) {
-        CHECK(buffer_[index_].empty());
+      } else if (slot.ended) {
+        slot.Reset();
         index_++;
+        if (window_) {
+          window_->Advance(index_);
+        }
         Next();
       } else {
         upstream_->Next();
@@ -89,21 +205,83 @@ struct _ReorderAdaptor final {
 
     void Done() override {
       done_ = true;
-      buffer_.clear();
-      ended_.clear();
+      if (window_) {
+        window_->Close();
+      }
+      for (Slot& slot : slots_) {
+        slot.Reset();
+      }
       upstream_->Done();
     }
 
+    // Buffers the values for a single index. We keep the values in a
+    // 'std::vector' that is cleared (rather than deallocated) when
+    // we're done with an index so that once warmed up a slot doesn't
+    // need to allocate when it gets reused for a later index.
+    struct Slot {
+      bool empty() const {
+        return next == values.size();
+      }
+
+      void Reset() {
+        values.clear();
+        next = 0;
+        ended = false;
+      }
+
+      std::vector<Value_> values;
+      size_t next = 0;
+      bool ended = false;
+    };
+
+    // Returns the slot for index 'i' from our ring of slots, growing
+    // the ring if 'i' doesn't fit (which can only happen if we don't
+    // have a window or it has been closed since otherwise the window
+    // ensures no values are admitted beyond the ring).
+    Slot& SlotFor(int i) {
+      CHECK_GE(i, index_);
+      if (static_cast<size_t>(i - index_) >= slots_.size()) {
+        CHECK(!window_ || window_->closed())
+            << "index outside of 'ConcurrentOrdered()' window";
+        Grow(static_cast<size_t>(i - index_) + 1);
+      }
+      return slots_[static_cast<size_t>(i) & (slots_.size() - 1)];
+    }
+
+    // Grows the ring so that it can hold at least 'size' indexes
+    // starting from 'index_'.
+    void Grow(size_t size) {
+      std::vector<Slot> slots(RoundUpToPowerOfTwo(size));
+      for (size_t i = 0; i < slots_.size(); i++) {
+        size_t index = static_cast<size_t>(index_) + i;
+        slots[index & (slots.size() - 1)] =
+            std::move(slots_[index & (slots_.size() - 1)]);
+      }
+      slots_ = std::move(slots);
+    }
+
+    static size_t RoundUpToPowerOfTwo(size_t n) {
+      size_t power = 1;
+      while (power < n) {
+        power <<= 1;
+      }
+      return power;
+    }
+
+    static constexpr size_t INITIAL_SLOTS = 16;
+
     TypeErasedStream* upstream_ = nullptr;
 
-    std::map<int, std::deque<Value_>> buffer_;
+    // NOTE: always a power of 2 so we can use a mask rather than a
+    // modulus to map an index to a slot.
+    std::vector<Slot> slots_;
 
     int index_ = 1;
 
-    std::map<int, bool> ended_;
-
     bool done_ = false;
 
+    std::shared_ptr<_ReorderWindow> window_;
+
     // NOTE: we store 'k_' as the _last_ member so it will be
     // destructed _first_ and thus we won't have any use-after-delete
     // issues during destruction of 'k_' if it holds any references or
@@ -125,20 +303,153 @@ struct _ReorderAdaptor final {
     auto k(K k) && {
       return Continuation<
           K,
-          typename std::tuple_element<1, Arg>::type::value_type>(std::move(k));
+          typename std::tuple_element<1, Arg>::type::value_type>(
+          std::move(k),
+          std::move(window_));
+    }
+
+    template <typename Downstream>
+    static constexpr bool CanCompose = Downstream::ExpectsStream;
+
+    using Expects = StreamOfValues;
+
+    std::shared_ptr<_ReorderWindow> window_;
+  };
+};
+
+/////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto ReorderAdaptor(
+    std::shared_ptr<_ReorderWindow> window = nullptr) {
+  return _ReorderAdaptor::Composable{std::move(window)};
+}
+
+/////////////////////////////////////////////////////////////////////
+
+// Assigns each upstream value the index that 'ReorderAdaptor()' uses
+// to put it back in order. If there is a window then a value is only
+// passed downstream once it's index is within the window, otherwise
+// we wait for 'ReorderAdaptor()' to advance the window which
+// throttles how many upstream values we'll process (and thus how many
+// values 'ReorderAdaptor()' might need to buffer) when the value at
+// the head of the window is taking a long time.
+struct _ReorderWindowAdaptor final {
+  template <typename K_, typename Arg_>
+  struct Continuation final {
+    Continuation(K_ k, std::shared_ptr<_ReorderWindow> window)
+      : window_(std::move(window)),
+        k_(std::move(k)) {}
+
+    Continuation(Continuation&& that) noexcept
+      : index_(that.index_),
+        window_(std::move(that.window_)),
+        k_(std::move(that.k_)) {
+      CHECK(!arg_) << "moving after starting";
+    }
+
+    void Begin(TypeErasedStream& stream) {
+      k_.Begin(stream);
+    }
+
+    template <typename Error>
+    void Fail(Error&& error) {
+      k_.Fail(std::forward<Error>(error));
+    }
+
+    void Stop() {
+      k_.Stop();
+    }
+
+    template <typename Value>
+    void Body(Value&& value) {
+      int i = index_++;
+
+      if (!window_ || window_->Admits(i)) {
+        k_.Body(Value_(i, std::forward<Value>(value)));
+      } else {
+        arg_.emplace(i, std::forward<Value>(value));
+
+        context_ = Scheduler::Context::Get();
+
+        bool waiting = window_->WaitUntilAdmits(i, [this]() {
+          context_->Unblock([this]() {
+            // NOTE: need to relinquish borrow of context to avoid
+            // this continuation causing a deadlock when trying to
+            // destruct the context.
+            context_.relinquish();
+
+            Admitted();
+          });
+        });
+
+        if (!waiting) {
+          context_.relinquish();
+          Admitted();
+        }
+      }
+    }
+
+    void Ended() {
+      k_.Ended();
+    }
+
+    void Register(Interrupt& interrupt) {
+      k_.Register(interrupt);
+    }
+
+    void Admitted() {
+      CHECK(arg_);
+      auto arg = std::move(*arg_);
+      arg_.reset();
+      k_.Body(std::move(arg));
+    }
+
+    // NOTE: starting our index at 1 because 'ReorderAdaptor()' is
+    // signalled that all of the values for index 'i' have been
+    // emitted via '-i' which means we can't start at 0.
+    int index_ = 1;
+
+    std::shared_ptr<_ReorderWindow> window_;
+
+    using Value_ = std::tuple<int, std::decay_t<Arg_>>;
+
+    std::optional<Value_> arg_;
+
+    stout::borrowed_ptr<Scheduler::Context> context_;
+
+    // NOTE: we store 'k_' as the _last_ member so it will be
+    // destructed _first_ and thus we won't have any use-after-delete
+    // issues during destruction of 'k_' if it holds any references or
+    // pointers to any (or within any) of the above members.
+    K_ k_;
+  };
+
+  struct Composable final {
+    template <typename Arg, typename Errors>
+    using ValueFrom = std::tuple<int, std::decay_t<Arg>>;
+
+    template <typename Arg, typename Errors>
+    using ErrorsFrom = Errors;
+
+    template <typename Arg, typename Errors, typename K>
+    auto k(K k) && {
+      return Continuation<K, Arg>(std::move(k), std::move(window_));
     }
 
     template <typename Downstream>
     static constexpr bool CanCompose = Downstream::ExpectsStream;
 
     using Expects = StreamOfValues;
+
+    std::shared_ptr<_ReorderWindow> window_;
   };
 };
 
 /////////////////////////////////////////////////////////////////////
 
-[[nodiscard]] inline auto ReorderAdaptor() {
-  return _ReorderAdaptor::Composable{};
+[[nodiscard]] inline auto ReorderWindow(
+    std::shared_ptr<_ReorderWindow> window) {
+  return _ReorderWindowAdaptor::Composable{std::move(window)};
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -152,8 +463,9 @@ struct _ReorderAdaptor final {
 struct _ConcurrentOrderedAdaptor final {
   template <typename K_>
   struct Continuation final : public TypeErasedStream {
-    Continuation(K_ k)
-      : k_(std::move(k)) {}
+    Continuation(K_ k, _ReorderWindow* window)
+      : window_(window),
+        k_(std::move(k)) {}
 
     ~Continuation() override = default;
 
@@ -179,6 +491,13 @@ struct _ConcurrentOrderedAdaptor final {
 
     template <typename Error>
     void Fail(Error&& error) {
+      // NOTE: the failure won't get to 'ReorderAdaptor()' until all
+      // of the other values (including any that are waiting to be
+      // admitted to the window) have been processed so we need to
+      // open the window now to avoid deadlocking.
+      if (window_ != nullptr) {
+        window_->Close();
+      }
       k_.Fail(std::forward<Error>(error));
     }
 
@@ -187,6 +506,10 @@ struct _ConcurrentOrderedAdaptor final {
     }
 
     void Stop() {
+      // NOTE: see comment in 'Fail()' above.
+      if (window_ != nullptr) {
+        window_->Close();
+      }
       k_.Stop();
     }
 
@@ -214,6 +537,8 @@ struct _ConcurrentOrderedAdaptor final {
 
     TypeErasedStream* upstream_ = nullptr;
 
+    _ReorderWindow* window_ = nullptr;
+
     // NOTE: we store 'k_' as the _last_ member so it will be
     // destructed _first_ and thus we won't have any use-after-delete
     // issues during destruction of 'k_' if it holds any references or
@@ -232,48 +557,78 @@ struct _ConcurrentOrderedAdaptor final {
 
     template <typename Arg, typename Errors, typename K>
     auto k(K k) && {
-      return Continuation<K>(std::move(k));
+      return Continuation<K>(std::move(k), window_);
     }
 
     template <typename Downstream>
     static constexpr bool CanCompose = Downstream::ExpectsStream;
 
     using Expects = StreamOfValues;
+
+    _ReorderWindow* window_ = nullptr;
   };
 };
 
 /////////////////////////////////////////////////////////////////////
 
-[[nodiscard]] inline auto ConcurrentOrderedAdaptor() {
-  return _ConcurrentOrderedAdaptor::Composable{};
+[[nodiscard]] inline auto ConcurrentOrderedAdaptor(
+    _ReorderWindow* window = nullptr) {
+  return _ConcurrentOrderedAdaptor::Composable{window};
 }
 
 /////////////////////////////////////////////////////////////////////
 
+struct _ConcurrentOrdered final {
+  template <typename F>
+  static auto Create(F f, std::shared_ptr<_ReorderWindow> window) {
+    return ReorderWindow(window)
+        >> Concurrent([f = std::move(f), window = window.get()]() {
+             return FlatMap([&f, window, j = 1](auto&& tuple) mutable {
+               j = std::get<0>(tuple);
+               return Iterate({std::move(std::get<1>(tuple))})
+                   >> f()
+                   >> Map([j](auto&& value) {
+                        return std::make_tuple(j, std::move(value));
+                      })
+                   // A special 'ConcurrentOrderedAdaptor()' allows us to
+                   // handle the case when 'f()' has ended so we can
+                   // propagate down to 'ReorderAdaptor()' that all
+                   // elements for the 'i'th tranche of values has been
+                   // emitted.
+                   >> ConcurrentOrderedAdaptor(window);
+             });
+           })
+        // Handles the reordering of values by the propagated indexes.
+        >> ReorderAdaptor(window);
+  }
+};
+
+/////////////////////////////////////////////////////////////////////
+
+// Like 'Concurrent()' except values are emitted downstream in the
+// same order as their corresponding upstream values.
+//
+// NOTE: values that are emitted out of order are buffered until all
+// of the values before them have been emitted which is unbounded
+// when an upstream value takes a long time, see the overload below
+// that takes a 'window'.
 template <typename F>
 [[nodiscard]] inline auto ConcurrentOrdered(F f) {
-  // NOTE: Starting our index 'i' at 1 because we signal the end of that
-  // tranche of values via '-i' which means we can't start at 0.
-  return Map([i = 1](auto&& value) mutable {
-           return std::make_tuple(i++, std::forward<decltype(value)>(value));
-         })
-      >> Concurrent([f = std::move(f)]() {
-           return FlatMap([&f, j = 1](auto&& tuple) mutable {
-             j = std::get<0>(tuple);
-             return Iterate({std::move(std::get<1>(tuple))})
-                 >> f()
-                 >> Map([j](auto&& value) {
-                      return std::make_tuple(j, std::move(value));
-                    })
-                 // A special 'ConcurrentOrderedAdaptor()' allows us to handle
-                 // the case when 'f()' has ended so we can propagate down to
-                 // 'ReorderAdaptor()' that all elements for the 'i'th tranche
-                 // of values has been emitted.
-                 >> ConcurrentOrderedAdaptor();
-           });
-         })
-      // Handles the reordering of values by the propagated indexes.
-      >> ReorderAdaptor();
+  return _ConcurrentOrdered::Create(std::move(f), nullptr);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+// Like 'ConcurrentOrdered()' above except at most 'window' upstream
+// values, starting with the oldest one that hasn't finished emitting
+// values downstream, are processed at a time. When the oldest value
+// is taking a long time we stop requesting new upstream values
+// rather than buffering an unbounded number of out of order values.
+template <typename F>
+[[nodiscard]] inline auto ConcurrentOrdered(F f, size_t window) {
+  return _ConcurrentOrdered::Create(
+      std::move(f),
+      std::make_shared<_ReorderWindow>(window));
 }
 
 /////////////////////////////////////////////////////////////////////
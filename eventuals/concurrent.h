@@ -1,9 +1,16 @@
 #pragma once
 
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
 
+#include "eventuals/allocator.h"
+#include "eventuals/bounded-queue.h"
+#include "eventuals/if.h"
 #include "eventuals/iterate.h"
 #include "eventuals/let.h"
 #include "eventuals/lock.h"
@@ -63,12 +70,13 @@ struct _Concurrent final {
     // continuation is stored in 'Adaptor::Fiber' below because it
     // requires template types.
     //
-    // Each fiber is part of a linked list of fibers that gets pruned
-    // or appended to during runtime as new fibers are needed. We use
-    // a linked list rather than an existing collection because it
-    // nicely matches our algorithm for being able to reuse fibers
-    // that have completed but haven't yet been pruned (see
-    // 'CreateOrReuseFiber()').
+    // Each fiber is always on exactly one of two intrusive linked
+    // lists: the "active" list of fibers that are currently running
+    // and the "free" list of fibers that are done and may be reused
+    // (see 'CreateOrReuseFiber()'). Keeping them separate means that
+    // finding a fiber to reuse, checking if all fibers are done, and
+    // interrupting fibers never has to walk fibers that aren't
+    // relevant, which matters when there are thousands of them.
     struct TypeErasedFiber {
       virtual bool Reuse() = 0;
 
@@ -81,13 +89,58 @@ struct _Concurrent final {
       // interrupts are propagated.
       class Interrupt interrupt;
 
-      // Each fiber forms a linked list of currently created fibers.
-      std::unique_ptr<TypeErasedFiber> next;
+      // Intrusive links for whichever list (active or free) this
+      // fiber is currently on.
+      TypeErasedFiber* prev = nullptr;
+      TypeErasedFiber* next = nullptr;
 
       // Need to store a cloned context in which would be stored callback.
       std::optional<Scheduler::Context> context;
     };
 
+    // Intrusive doubly linked list of fibers so that we can add and
+    // remove fibers in O(1) without any dynamic memory allocation.
+    struct FiberList final {
+      void PushBack(TypeErasedFiber* fiber) {
+        CHECK(fiber->prev == nullptr && fiber->next == nullptr);
+        fiber->prev = tail;
+        if (tail != nullptr) {
+          tail->next = fiber;
+        } else {
+          head = fiber;
+        }
+        tail = fiber;
+        size++;
+      }
+
+      void Remove(TypeErasedFiber* fiber) {
+        CHECK_GT(size, 0u);
+        if (fiber->prev != nullptr) {
+          fiber->prev->next = fiber->next;
+        } else {
+          CHECK_EQ(head, fiber);
+          head = fiber->next;
+        }
+        if (fiber->next != nullptr) {
+          fiber->next->prev = fiber->prev;
+        } else {
+          CHECK_EQ(tail, fiber);
+          tail = fiber->prev;
+        }
+        fiber->prev = nullptr;
+        fiber->next = nullptr;
+        size--;
+      }
+
+      bool empty() const {
+        return size == 0;
+      }
+
+      TypeErasedFiber* head = nullptr;
+      TypeErasedFiber* tail = nullptr;
+      size_t size = 0;
+    };
+
     // Returns the fiber created from the templated class 'Adaptor'
     // which actually instantiates a 'Fiber' which has template types.
     //
@@ -95,7 +148,10 @@ struct _Concurrent final {
     // defined in 'TypeErasedAdaptor' so that it doesn't have to be
     // instantiated for every 'Adaptor' (and we pay a small runtime
     // hit of having to make a virtual function call).
-    virtual TypeErasedFiber* CreateFiber() = 0;
+    //
+    // NOTE: fibers are allocated using the allocator of the current
+    // 'Scheduler::Context' (see 'Scheduler::Context::allocator()').
+    virtual AllocatedPtr<TypeErasedFiber> CreateFiber() = 0;
 
     // Returns true if all fibers are done.
     //
@@ -104,16 +160,39 @@ struct _Concurrent final {
     // 'Synchronized()').
     bool FibersDone() {
       CHECK(lock().OwnedByCurrentSchedulerContext());
-      bool done = true;
-      TypeErasedFiber* fiber = fibers_.get();
-      while (fiber != nullptr) {
-        if (!fiber->done) {
-          done = false;
-          break;
-        }
-        fiber = fiber->next.get();
+      return active_.empty();
+    }
+
+    // Moves a fiber that has finished from the active list to the
+    // free list so that it can be reused.
+    //
+    // NOTE: expects to be called while holding the lock associated
+    // with this instance (i.e., to be called from within
+    // 'Synchronized()').
+    void FiberDone(TypeErasedFiber* fiber) {
+      CHECK(lock().OwnedByCurrentSchedulerContext());
+      CHECK(!fiber->done);
+      fiber->done = true;
+      active_.Remove(fiber);
+      free_.PushBack(fiber);
+    }
+
+    // Stores 'error' unless we've already stopped or failed, except
+    // that after we've been interrupted an error takes precedence
+    // over a stop since the stop was most likely just caused by our
+    // interrupting the fibers and we don't want it to mask the error.
+    //
+    // NOTE: expects to be called while holding the lock associated
+    // with this instance (i.e., to be called from within
+    // 'Synchronized()').
+    template <typename StoppedOrError, typename Error>
+    void StoreError(StoppedOrError& stopped_or_error, Error&& error) {
+      CHECK(lock().OwnedByCurrentSchedulerContext());
+      if (!stopped_or_error.has_value()
+          || (interrupted_
+              && std::holds_alternative<Stopped>(*stopped_or_error))) {
+        stopped_or_error.emplace(std::forward<Error>(error));
       }
-      return done;
     }
 
     // Returns true if a fiber had to be interrupted (i.e., not all
@@ -125,17 +204,43 @@ struct _Concurrent final {
     bool InterruptFibers() {
       CHECK(lock().OwnedByCurrentSchedulerContext());
       bool interrupted = false;
-      TypeErasedFiber* fiber = fibers_.get();
+      TypeErasedFiber* fiber = active_.head;
       while (fiber != nullptr) {
-        if (!fiber->done) {
-          fiber->interrupt.Trigger();
-          interrupted = true;
-        }
-        fiber = fiber->next.get();
+        // NOTE: getting 'next' _before_ triggering the interrupt just
+        // in case triggering causes the list to get modified.
+        TypeErasedFiber* next = fiber->next;
+        CHECK(!fiber->done);
+        fiber->interrupt.Trigger();
+        interrupted = true;
+        fiber = next;
       }
       return interrupted;
     }
 
+    // Notifies egress if, and only if, it is waiting for a value
+    // (see 'Adaptor::Egress()').
+    //
+    // NOTE: expects to be called while holding the lock associated
+    // with this instance (i.e., to be called from within
+    // 'Synchronized()').
+    void NotifyEgress() {
+      CHECK(lock().OwnedByCurrentSchedulerContext());
+      if (egress_waiting_.exchange(false)) {
+        notify_egress_();
+      }
+    }
+
+    // Returns true if egress might be waiting for a value and thus a
+    // fiber that just pushed a value without holding the lock needs
+    // to acquire the lock and call 'NotifyEgress()'.
+    bool EgressMightBeWaiting() {
+      // NOTE: this fence pairs with the one in 'Adaptor::EgressSlow()'
+      // so that either we see that egress is waiting or egress sees
+      // the value that we just pushed (or both).
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      return egress_waiting_.load(std::memory_order_relaxed);
+    }
+
     // Returns an eventual which will either create a new fiber or
     // reuse an existing one and return that fiber. The eventual
     // returns nullptr to indicate to downstream eventuals that we've
@@ -167,35 +272,28 @@ struct _Concurrent final {
 
             if (!(downstream_done_
                   || interrupted_ || stopped_or_error->has_value())) {
-              do {
-                if (!fibers_) {
-                  fibers_.reset(CreateFiber());
-                  fiber = fibers_.get();
-                } else {
-                  fiber = fibers_.get();
-                  CHECK_NOTNULL(fiber);
-                  for (;;) {
-                    if (fiber->Reuse()) {
-                      break;
-                    } else if (!fiber->next) {
-                      // TODO(benh): we will create an "infinite"
-                      // number of fibers if none are ever done, we
-                      // should consider adding some max number of
-                      // concurrency and then never create more than
-                      // that.
-                      fiber->next.reset(CreateFiber());
-                      fiber = fiber->next.get();
-                      break;
-                    } else {
-                      fiber = fiber->next.get();
-                    }
-                  }
-                  CHECK_NOTNULL(fiber);
-                }
-              } while (fiber == nullptr);
+              // Fibers are appended to the free list in the order
+              // that they finish so the head is the fiber most likely
+              // to have also finished using its context. If even it
+              // can't be reused yet then we create a new fiber rather
+              // than scanning the rest of the free list.
+              //
+              // TODO(benh): we will create an "infinite" number of
+              // fibers if none are ever done, we should consider
+              // adding some max number of concurrency and then never
+              // create more than that.
+              fiber = free_.head;
+              if (fiber != nullptr && fiber->Reuse()) {
+                free_.Remove(fiber);
+              } else {
+                fibers_.emplace_back(CreateFiber());
+                fiber = fibers_.back().get();
+              }
 
               CHECK_NOTNULL(fiber);
 
+              active_.PushBack(fiber);
+
               // Mark fibers not done since we're starting one.
               fibers_done_ = false;
             }
@@ -226,7 +324,7 @@ struct _Concurrent final {
                 fibers_done_ = FibersDone();
 
                 if (fibers_done_) {
-                  notify_egress_();
+                  NotifyEgress();
                   notify_done_();
                 }
 
@@ -235,15 +333,14 @@ struct _Concurrent final {
               .fail([this](auto& stopped_or_error, auto& k, auto&& error) {
                 upstream_done_ = true;
 
-                if (!stopped_or_error->has_value()) {
-                  stopped_or_error->emplace(
-                      std::forward<decltype(error)>(error));
-                }
+                StoreError(
+                    *stopped_or_error,
+                    std::forward<decltype(error)>(error));
 
                 fibers_done_ = FibersDone();
 
                 if (fibers_done_) {
-                  notify_egress_();
+                  NotifyEgress();
                   notify_done_();
                 }
 
@@ -259,7 +356,7 @@ struct _Concurrent final {
                 fibers_done_ = FibersDone();
 
                 if (fibers_done_) {
-                  notify_egress_();
+                  NotifyEgress();
                   notify_done_();
                 }
 
@@ -289,12 +386,12 @@ struct _Concurrent final {
                 CHECK(fiber->context->in_use())
                     << "Context: " << fiber->context->name();
 
-                fiber->done = true;
+                FiberDone(fiber);
 
                 fibers_done_ = FibersDone();
 
                 if (upstream_done_ && fibers_done_) {
-                  notify_egress_();
+                  NotifyEgress();
                   notify_done_();
                 }
 
@@ -310,17 +407,16 @@ struct _Concurrent final {
                 CHECK(fiber->context->in_use())
                     << "Context: " << fiber->context->name();
 
-                fiber->done = true;
+                FiberDone(fiber);
 
-                if (!stopped_or_error->has_value()) {
-                  stopped_or_error->emplace(
-                      std::forward<decltype(error)>(error));
-                }
+                StoreError(
+                    *stopped_or_error,
+                    std::forward<decltype(error)>(error));
 
                 fibers_done_ = !InterruptFibers();
 
                 if (upstream_done_ && fibers_done_) {
-                  notify_egress_();
+                  NotifyEgress();
                   notify_done_();
                 }
 
@@ -333,7 +429,7 @@ struct _Concurrent final {
                 CHECK(fiber->context->in_use())
                     << "Context: " << fiber->context->name();
 
-                fiber->done = true;
+                FiberDone(fiber);
 
                 if (!stopped_or_error->has_value()) {
                   stopped_or_error->emplace(eventuals::Stopped());
@@ -342,7 +438,7 @@ struct _Concurrent final {
                 fibers_done_ = !InterruptFibers();
 
                 if (upstream_done_ && fibers_done_) {
-                  notify_egress_();
+                  NotifyEgress();
                   notify_done_();
                 }
 
@@ -362,7 +458,7 @@ struct _Concurrent final {
                fibers_done_ = !InterruptFibers();
 
                if (upstream_done_ && fibers_done_) {
-                 notify_egress_();
+                 NotifyEgress();
                  notify_done_();
                }
              }))
@@ -446,13 +542,40 @@ struct _Concurrent final {
           >> Terminal();
     }
 
-    // Head of linked list of fibers.
-    std::unique_ptr<TypeErasedFiber> fibers_;
+    // All fibers that have been created, used only for ownership so
+    // that they get deallocated when we do.
+    std::vector<AllocatedPtr<TypeErasedFiber>> fibers_;
+
+    // Fibers that are currently running.
+    FiberList active_;
+
+    // Fibers that are done and may be reused, in the order in which
+    // they finished.
+    FiberList free_;
 
     // Callback associated with waiting for "egress", i.e., values
     // from each fiber.
+    //
+    // NOTE: only valid to invoke while 'egress_waiting_' is true
+    // which is why it should only be invoked via 'NotifyEgress()'.
     Callback<void()> notify_egress_;
 
+    // Number of values that fibers can push for egress without
+    // acquiring the lock before they have to fall back to the
+    // "overflow" buffer (see 'Adaptor::PushOverflow()').
+    static constexpr size_t EGRESS_CAPACITY = 256;
+
+    // Indicates that egress has found no values and is waiting to be
+    // notified. Fibers check this after pushing a value without the
+    // lock so that they only acquire the lock when they must.
+    std::atomic<bool> egress_waiting_ = false;
+
+    // Indicates that fibers have pushed values into the "overflow"
+    // buffer because the lock-free queue was full. While set, fibers
+    // keep using the overflow buffer so that values from the same
+    // fiber are never reordered.
+    std::atomic<bool> overflowing_ = false;
+
     bool upstream_done_ = false;
     bool downstream_done_ = false;
     bool fibers_done_ = false;
@@ -481,6 +604,10 @@ struct _Concurrent final {
 
     ~Adaptor() override = default;
 
+    using Value_ = typename std::invoke_result_t<F_>::template ValueFrom<
+        Arg_,
+        std::tuple<>>;
+
     // Our typeful fiber includes the continuation 'K' that we'll
     // start for each upstream value.
     template <typename E_>
@@ -526,25 +653,65 @@ struct _Concurrent final {
       // returned from 'f_()'.
       return RescheduleAfter(
                  // NOTE: 'f_()' should expect to be composed with a
-                 // stream hence the use of 'Iterate()'. It also might
-                 // return a 'FlatMap()' so we need to use 'Loop()'
-                 // down below even though we know we only have a
-                 // single 'arg' to iterate from the top.
-                 Iterate({std::move(arg)})
+                 // stream hence the use of a stream of a single
+                 // 'arg'. It also might return a 'FlatMap()' so we
+                 // need to use 'Loop()' down below even though we know
+                 // we only have a single 'arg' to iterate from the top.
+                 //
+                 // NOTE: not using 'Iterate({std::move(arg)})' because
+                 // it stores 'arg' in a 'std::deque' which allocates
+                 // (every time it gets moved) for every upstream value.
+                 Stream<std::decay_t<Arg_>>()
+                     .context(std::optional<std::decay_t<Arg_>>(
+                         std::move(arg)))
+                     .next([](auto& arg, auto& k) {
+                       if (arg.has_value()) {
+                         std::decay_t<Arg_> value = std::move(*arg);
+                         arg.reset();
+                         k.Emit(std::move(value));
+                       } else {
+                         k.Ended();
+                       }
+                     })
+                     .done([](auto&, auto& k) {
+                       k.Ended();
+                     })
                  >> f_())
-          >> Synchronized(Map([this](auto&& value) {
-               values_.push_back(std::forward<decltype(value)>(value));
-               notify_egress_();
-             }))
+          // NOTE: taking 'value' by value (rather than 'auto&&') so
+          // that the lambdas below are the same type no matter what
+          // kind of reference 'Map()' ends up invoking us with.
+          >> Map([this](Value_ value) {
+               // Fast path: hand the value to egress without acquiring
+               // the lock unless we need to notify egress.
+               bool pushed = !overflowing_.load(std::memory_order_acquire)
+                   && values_.TryPush(std::move(value));
+
+               std::optional<Value_> overflow;
+               if (!pushed) {
+                 overflow.emplace(std::move(value));
+               }
+
+               return If(!pushed || EgressMightBeWaiting())
+                   .yes([this, overflow = std::move(overflow)]() mutable {
+                     return Synchronized(Then(
+                         [this, overflow = std::move(overflow)]() mutable {
+                           if (overflow) {
+                             PushOverflow(std::move(*overflow));
+                           }
+                           NotifyEgress();
+                         }));
+                   })
+                   .no([]() {});
+             })
           >> Loop()
           >> FiberEpilogue(fiber, stopped_or_error_.reborrow())
           >> Terminal();
     }
 
     // Returns an upcasted 'TypeErasedFiber' from our typeful 'Fiber'.
-    TypeErasedFiber* CreateFiber() override {
+    AllocatedPtr<TypeErasedFiber> CreateFiber() override {
       using E = decltype(FiberEventual(nullptr, std::declval<Arg_>()));
-      return new Fiber<E>();
+      return AllocateUnique<Fiber<E>>(Scheduler::Context::Get()->allocator());
     }
 
     // Helper that starts a fiber by downcasting to typeful fiber.
@@ -557,7 +724,7 @@ struct _Concurrent final {
       // TODO(benh): differentiate the names of the fibers for
       // easier debugging!
       fiber->context.emplace(
-          Scheduler::Context::Get()->name() + " [concurrent fiber]");
+          Scheduler::Context::Get()->name().Derive("concurrent fiber"));
 
       fiber->context->scheduler()->Submit(
           [fiber]() {
@@ -594,56 +761,77 @@ struct _Concurrent final {
           >> Terminal();
     }
 
+    // Pushes a value that didn't fit in 'values_' into 'overflow_'.
+    //
+    // NOTE: expects to be called while holding the lock associated
+    // with this instance (i.e., to be called from within
+    // 'Synchronized()').
+    void PushOverflow(Value_&& value) {
+      CHECK(lock().OwnedByCurrentSchedulerContext());
+      // Egress may have made room since we failed to push so try
+      // again but only if that can't reorder values (i.e., nothing is
+      // waiting in 'overflow_').
+      if (!overflow_.empty() || !values_.TryPush(std::move(value))) {
+        overflow_.push_back(std::move(value));
+        overflowing_.store(true, std::memory_order_release);
+      }
+    }
+
+    // Pops the next value, first from 'values_' and then from
+    // 'overflow_', or returns an empty optional if there are none.
+    //
+    // NOTE: we must drain everything that has been pushed to
+    // 'values_' before taking from 'overflow_' so that values from
+    // the same fiber are not reordered. If a fiber has claimed a slot
+    // in 'values_' but not yet published its value this returns an
+    // empty optional and sets 'unpublished_' so that egress can wait
+    // for the value _after_ releasing the lock, see 'EgressSlow()'.
+    //
+    // NOTE: expects to be called while holding the lock associated
+    // with this instance (i.e., to be called from within
+    // 'Synchronized()').
+    std::optional<Value_> PopValue() {
+      CHECK(lock().OwnedByCurrentSchedulerContext());
+      if (!values_.Empty()) {
+        std::optional<Value_> value = values_.TryPop();
+        if (!value) {
+          unpublished_ = true;
+        }
+        return value;
+      }
+
+      if (!overflow_.empty()) {
+        std::optional<Value_> value(std::move(overflow_.front()));
+        overflow_.pop_front();
+        if (overflow_.empty()) {
+          overflowing_.store(false, std::memory_order_release);
+        }
+        return value;
+      }
+
+      return std::nullopt;
+    }
+
     // Returns an eventual which implements the logic for handling
     // each value emitted from our fibers and moving them downstream.
+    //
+    // Values are popped from 'values_' without acquiring the lock and
+    // only when there aren't any do we acquire the lock in order to
+    // wait for more values or to find out that we're done.
     [[nodiscard]] auto Egress() {
-      return Synchronized(
-                 Wait([this](auto notify) {
-                   notify_egress_ = std::move(notify);
-                   return [this]() {
-                     if (values_.empty()) {
-                       return !(upstream_done_ && fibers_done_);
-                     } else {
-                       return false;
-                     }
-                   };
-                 })
-                 // Need to check for an exception _before_
-                 // 'Until()' because we have no way of hooking
-                 // into "ended" after 'Until()'.
-                 >> Map([this]() {
-                     return Eventual<std::optional<Value_>>()
-                         .template raises<UpstreamErrorsAndErrorsFromE_>()
-                         .start([this](auto& k) {
-                           if (stopped_or_error_->has_value()
-                               && upstream_done_ && fibers_done_) {
-                             // TODO(benh): flush remaining values first?
-                             std::visit(
-                                 [&k](auto&& stopped_or_error) {
-                                   if constexpr (
-                                       std::is_same_v<
-                                           std::decay_t<
-                                               decltype(stopped_or_error)>,
-                                           Stopped>) {
-                                     k.Stop();
-                                   } else {
-                                     k.Fail(
-                                         std::forward<
-                                             decltype(stopped_or_error)>(
-                                             stopped_or_error));
-                                   }
-                                 },
-                                 std::move(stopped_or_error_->value()));
-                           } else if (!values_.empty()) {
-                             auto value = std::move(values_.front());
-                             values_.pop_front();
-                             k.Start(std::optional<Value_>(std::move(value)));
-                           } else {
-                             CHECK(upstream_done_ && fibers_done_);
-                             k.Start(std::optional<Value_>());
-                           }
-                         });
-                   }))
+      return Map([this]() {
+               std::optional<Value_> value = values_.TryPop();
+
+               bool popped = value.has_value();
+
+               return If(popped)
+                   .yes([value = std::move(value)]() mutable {
+                     return std::move(value);
+                   })
+                   .no([this]() {
+                     return EgressSlow();
+                   });
+             })
           >> Until([](std::optional<Value_>& value) {
                return !value;
              })
@@ -653,6 +841,88 @@ struct _Concurrent final {
              });
     }
 
+    // Returns an eventual which, while holding the lock, waits until
+    // there is a value or everything is done and then either returns
+    // the next value, an empty optional if we've ended, or propagates
+    // a failure or stop.
+    [[nodiscard]] auto EgressSlow() {
+      return Synchronized(
+          Wait([this](auto notify) {
+            notify_egress_ = std::move(notify);
+            return [this]() {
+              if (!values_.Empty() || !overflow_.empty()) {
+                return false;
+              } else if (upstream_done_ && fibers_done_) {
+                return false;
+              }
+
+              // Let fibers know they need to notify us and then make
+              // sure one didn't push a value in the meantime.
+              egress_waiting_.store(true, std::memory_order_relaxed);
+
+              // NOTE: this fence pairs with the one in
+              // 'EgressMightBeWaiting()'.
+              std::atomic_thread_fence(std::memory_order_seq_cst);
+
+              if (!values_.Empty()) {
+                egress_waiting_.store(false, std::memory_order_relaxed);
+                return false;
+              }
+
+              return true;
+            };
+          })
+          // Need to check for an exception _before_ 'Until()' in
+          // 'Egress()' because we have no way of hooking into "ended"
+          // after 'Until()'.
+          >> Then([this]() {
+              return Eventual<std::optional<Value_>>()
+                  .template raises<UpstreamErrorsAndErrorsFromE_>()
+                  .start([this](auto& k) {
+                    if (stopped_or_error_->has_value()
+                        && upstream_done_ && fibers_done_) {
+                      // TODO(benh): flush remaining values first?
+                      std::visit(
+                          [&k](auto&& stopped_or_error) {
+                            if constexpr (
+                                std::is_same_v<
+                                    std::decay_t<
+                                        decltype(stopped_or_error)>,
+                                    Stopped>) {
+                              k.Stop();
+                            } else {
+                              k.Fail(
+                                  std::forward<
+                                      decltype(stopped_or_error)>(
+                                      stopped_or_error));
+                            }
+                          },
+                          std::move(stopped_or_error_->value()));
+                    } else {
+                      std::optional<Value_> value = PopValue();
+                      if (!value && !unpublished_) {
+                        CHECK(upstream_done_ && fibers_done_);
+                      }
+                      k.Start(std::move(value));
+                    }
+                  });
+            }))
+        >> Then([this](std::optional<Value_>&& value) {
+             // NOTE: spinning without holding the lock so that the
+             // fiber publishing the value (and any others) can still
+             // acquire it. Only egress pops from 'values_' so the
+             // claimed slot is still the next one to pop.
+             if (unpublished_) {
+               unpublished_ = false;
+               CHECK(!value);
+               while (!(value = values_.TryPop())) {
+                 std::this_thread::yield();
+               }
+             }
+             return std::move(value);
+           });
+    }
+
     F_ f_;
 
     stout::borrowed_ref<
@@ -662,10 +932,18 @@ struct _Concurrent final {
                 UpstreamErrorsAndErrorsFromE_>>>
         stopped_or_error_;
 
-    using Value_ =
-        typename decltype(f_())::template ValueFrom<Arg_, std::tuple<>>;
+    // Values emitted from fibers that are waiting to be moved
+    // downstream. Fibers push and egress pops without acquiring the
+    // lock, see 'FiberEventual()' and 'Egress()'.
+    BoundedQueue<Value_> values_{EGRESS_CAPACITY};
+
+    // Values that didn't fit in 'values_', only accessed while
+    // holding the lock.
+    std::deque<Value_> overflow_;
 
-    std::deque<Value_> values_;
+    // Whether or not 'PopValue()' found a claimed but not yet
+    // published slot in 'values_', only accessed by egress.
+    bool unpublished_ = false;
   };
 
   // 'Continuation' is implemented by acting as both a loop for the
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm> // For 'std::find' and 'std::min'.
+#include <charconv> // For 'std::to_chars'.
+#include <cstddef>
+#include <memory> // For 'std::shared_ptr'.
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// The name of a 'Scheduler::Context'.
+//
+// Names are only used for debugging (e.g., 'EVENTUALS_LOG()' output
+// and 'CHECK()' failures) but contexts get created on hot paths, e.g.,
+// for every fiber of 'Concurrent()', so a name avoids allocating or
+// copying any strings when it is created and instead only
+// materializes the full name when it gets printed or 'str()' is
+// called.
+//
+// A name is either a string literal, which is never copied, or a
+// dynamically created string which gets shared (not copied) by all of
+// the names derived from it via 'Derive()', e.g., "parent [suffix]".
+class ContextName final {
+ public:
+  ContextName() = default;
+
+  // NOTE: intended for string literals, i.e., 'name' must have static
+  // storage duration (or at least outlive this name and any names
+  // derived from it) as it is never copied! The name ends at the
+  // first null character, if any.
+  template <size_t N>
+  ContextName(const char (&name)[N])
+    : name_(name, std::find(name, name + N - 1, '\0') - name) {}
+
+  // Mutable arrays, e.g., a 'char buffer[64]' on the stack, are most
+  // likely not string literals so they must be explicitly converted to
+  // a 'std::string' to get copied.
+  template <size_t N>
+  ContextName(char (&name)[N]) = delete;
+
+  ContextName(std::string&& name)
+    : owned_(std::make_shared<const std::string>(std::move(name))),
+      name_(*owned_) {}
+
+  ContextName(const std::string& name)
+    : ContextName(std::string(name)) {}
+
+  // Returns a name for a context derived from this one, e.g., cloned
+  // for a fiber, of the form "name [suffix - label - index]" where
+  // 'label' and 'index' are optional.
+  //
+  // NOTE: 'suffix' must be a string literal and 'label' must outlive
+  // the derived name. Only deriving from a name that was itself
+  // derived needs to allocate.
+  ContextName Derive(
+      std::string_view suffix,
+      std::string_view label = std::string_view(),
+      std::optional<size_t> index = std::nullopt) const {
+    ContextName name = suffix_.empty() ? *this : ContextName(str());
+    name.suffix_ = suffix;
+    name.label_ = label;
+    name.index_ = index;
+    return name;
+  }
+
+  // Returns the (materialized) name.
+  std::string str() const {
+    std::string s(name_);
+    if (!suffix_.empty()) {
+      s += " [";
+      s += suffix_;
+      if (!label_.empty()) {
+        s += " - ";
+        s += label_;
+      }
+      if (index_.has_value()) {
+        s += " - ";
+        s += std::to_string(index_.value());
+      }
+      s += "]";
+    }
+    return s;
+  }
+
+  // Copies the (materialized) name into 'buffer' without allocating,
+  // truncating it if necessary so that it fits in 'size' bytes
+  // including a terminating null character. Returns the number of
+  // characters copied (not including the null character).
+  size_t CopyTo(char* buffer, size_t size) const {
+    if (size == 0) {
+      return 0;
+    }
+
+    size_t length = 0;
+
+    auto append = [&](std::string_view s) {
+      size_t n = std::min(s.size(), size - 1 - length);
+      s.copy(buffer + length, n);
+      length += n;
+    };
+
+    append(name_);
+
+    if (!suffix_.empty()) {
+      append(" [");
+      append(suffix_);
+      if (!label_.empty()) {
+        append(" - ");
+        append(label_);
+      }
+      if (index_.has_value()) {
+        char digits[20];
+        std::to_chars_result result = std::to_chars(
+            digits,
+            digits + sizeof(digits),
+            index_.value());
+        append(" - ");
+        append(std::string_view(digits, result.ptr - digits));
+      }
+      append("]");
+    }
+
+    buffer[length] = '\0';
+
+    return length;
+  }
+
+  friend std::ostream& operator<<(
+      std::ostream& stream,
+      const ContextName& name) {
+    stream << name.name_;
+    if (!name.suffix_.empty()) {
+      stream << " [" << name.suffix_;
+      if (!name.label_.empty()) {
+        stream << " - " << name.label_;
+      }
+      if (name.index_.has_value()) {
+        stream << " - " << name.index_.value();
+      }
+      stream << "]";
+    }
+    return stream;
+  }
+
+  friend bool operator==(const ContextName& name, std::string_view s) {
+    return name.suffix_.empty() ? name.name_ == s : name.str() == s;
+  }
+
+  friend bool operator!=(const ContextName& name, std::string_view s) {
+    return !(name == s);
+  }
+
+ private:
+  // Non-null only if the name was dynamically created and then
+  // 'name_' refers to it.
+  std::shared_ptr<const std::string> owned_;
+
+  std::string_view name_;
+
+  std::string_view suffix_;
+  std::string_view label_;
+  std::optional<size_t> index_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
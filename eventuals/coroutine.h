@@ -0,0 +1,489 @@
+#pragma once
+
+// NOTE: coroutines require C++20 which is opt-in (build with
+// '--config=cpp20'), otherwise this header doesn't define anything.
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional> // For 'std::reference_wrapper'.
+#include <new> // For placement new.
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant> // For 'std::monostate'.
+
+#include "eventuals/allocator.h"
+#include "eventuals/compose.h"
+#include "eventuals/interrupt.h"
+#include "eventuals/scheduler.h"
+#include "eventuals/type-traits.h"
+#include "eventuals/undefined.h"
+#include "glog/logging.h"
+
+#define EVENTUALS_HAS_COROUTINES 1
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// Storage for a value of type 'T' that might be a reference or void.
+template <typename T>
+using _CoroutineValue = std::optional<
+    std::conditional_t<
+        std::is_void_v<T>,
+        std::monostate,
+        std::conditional_t<
+            std::is_lvalue_reference_v<T>,
+            std::reference_wrapper<std::remove_reference_t<T>>,
+            T>>>;
+
+////////////////////////////////////////////////////////////////////////
+
+struct _Coroutine final {
+  // Type-erased state of a coroutine that the next continuation needs
+  // to provide when the coroutine is started so that the coroutine
+  // can complete without knowing the type of the continuation.
+  struct Frame {
+    void Stop() {
+      stop_(k_);
+    }
+
+    void* k_ = nullptr;
+    void (*complete_)(void*) = nullptr;
+    void (*stop_)(void*) = nullptr;
+
+    Interrupt* interrupt_ = nullptr;
+
+    std::exception_ptr exception_;
+  };
+
+  // Memory for a coroutine frame comes from the allocator of the
+  // current context, which we store at the end of the frame so that
+  // the frame gets deallocated with the same allocator even if it
+  // gets destroyed from another context.
+  static constexpr size_t ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  static size_t AllocatorOffset(size_t size) {
+    return (size + alignof(Allocator*) - 1) & ~(alignof(Allocator*) - 1);
+  }
+
+  static void* Allocate(size_t size) {
+    Allocator* allocator = Scheduler::Context::Get()->allocator();
+    const size_t offset = AllocatorOffset(size);
+    char* frame = static_cast<char*>(
+        allocator->Allocate(offset + sizeof(Allocator*), ALIGNMENT));
+    new (frame + offset) Allocator*(allocator);
+    return frame;
+  }
+
+  static void Deallocate(void* frame, size_t size) {
+    const size_t offset = AllocatorOffset(size);
+    Allocator* allocator =
+        *reinterpret_cast<Allocator**>(static_cast<char*>(frame) + offset);
+    allocator->Deallocate(frame, offset + sizeof(Allocator*), ALIGNMENT);
+  }
+
+  // Awaiter for an eventual 'E_' which builds and starts the eventual
+  // after the coroutine has suspended and then resumes the coroutine
+  // once the eventual has completed.
+  template <typename E_>
+  struct Awaiter final {
+    using Value_ = typename E_::template ValueFrom<void, std::tuple<>>;
+
+    struct Adaptor final {
+      template <typename... Args>
+      void Start(Args&&... args) {
+        if constexpr (!std::is_void_v<Value_>) {
+          awaiter_->value_.emplace(std::forward<Args>(args)...);
+        }
+        awaiter_->Complete();
+      }
+
+      template <typename Error>
+      void Fail(Error&& error) {
+        static_assert(
+            !std::is_same_v<std::decay_t<Error>, std::exception_ptr>,
+            "Not expecting a 'std::exception_ptr' to "
+            "propagate through an eventual");
+
+        awaiter_->exception_ = std::make_exception_ptr(
+            std::decay_t<Error>(std::forward<Error>(error)));
+        awaiter_->Complete();
+      }
+
+      void Stop() {
+        awaiter_->stopped_ = true;
+        awaiter_->Complete();
+      }
+
+      void Register(Interrupt&) {
+        // Already registered in 'await_suspend()' if necessary.
+      }
+
+      Awaiter* awaiter_;
+    };
+
+    Awaiter(E_ e)
+      : e_(std::move(e)) {}
+
+    bool await_ready() {
+      return false;
+    }
+
+    template <typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) {
+      frame_ = &handle.promise();
+      handle_ = handle;
+
+      k_.emplace(std::move(e_).template k<void, std::tuple<>>(Adaptor{this}));
+
+      if (frame_->interrupt_ != nullptr) {
+        k_->Register(*frame_->interrupt_);
+      }
+
+      k_->Start();
+
+      // If the eventual has already completed (e.g., because it is
+      // synchronous) then it didn't resume (or stop) the coroutine
+      // and we need to do it ourselves, see 'Complete()'.
+      if (completed_.exchange(true, std::memory_order_acq_rel)) {
+        if (stopped_) {
+          // NOTE: stopping might destroy the coroutine (and thus
+          // us) so we must not access any members after this.
+          frame_->Stop();
+          return true;
+        } else {
+          return false;
+        }
+      } else {
+        return true;
+      }
+    }
+
+    Value_ await_resume() {
+      // Destruct the eventual so that it's no longer registered with
+      // the interrupt (if any).
+      k_.reset();
+
+      if (exception_) {
+        std::rethrow_exception(exception_);
+      }
+
+      if constexpr (std::is_lvalue_reference_v<Value_>) {
+        return value_->get();
+      } else if constexpr (!std::is_void_v<Value_>) {
+        return std::move(*value_);
+      }
+    }
+
+    // Called once the eventual has completed which might be
+    // concurrently with 'await_suspend()' so whoever is second is
+    // responsible for resuming (or stopping) the coroutine.
+    void Complete() {
+      if (completed_.exchange(true, std::memory_order_acq_rel)) {
+        if (stopped_) {
+          frame_->Stop();
+        } else {
+          handle_.resume();
+        }
+      }
+    }
+
+    E_ e_;
+
+    Frame* frame_ = nullptr;
+    std::coroutine_handle<> handle_;
+
+    _CoroutineValue<Value_> value_;
+    std::exception_ptr exception_;
+    bool stopped_ = false;
+
+    std::atomic<bool> completed_ = false;
+
+    std::optional<
+        decltype(std::declval<E_>().template k<void, std::tuple<>>(
+            std::declval<Adaptor>()))>
+        k_;
+  };
+
+  template <typename To_>
+  struct PromiseValue : Frame {
+    template <typename T>
+    void return_value(T&& t) {
+      value_.emplace(std::forward<T>(t));
+    }
+
+    _CoroutineValue<To_> value_;
+  };
+
+  template <typename To_, typename Raises_>
+  class Composable;
+
+  template <typename To_, typename Raises_>
+  struct Promise final : PromiseValue<To_> {
+    static void* operator new(size_t size) {
+      return Allocate(size);
+    }
+
+    static void operator delete(void* frame, size_t size) {
+      Deallocate(frame, size);
+    }
+
+    Composable<To_, Raises_> get_return_object() {
+      return Composable<To_, Raises_>(
+          std::coroutine_handle<Promise>::from_promise(*this));
+    }
+
+    // Don't start executing until started as an eventual.
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    struct FinalAwaiter final {
+      bool await_ready() noexcept {
+        return false;
+      }
+
+      void await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        // NOTE: the next continuation might destroy the coroutine now
+        // that it has suspended.
+        Frame& frame = handle.promise();
+        frame.complete_(frame.k_);
+      }
+
+      void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept {
+      return {};
+    }
+
+    void unhandled_exception() {
+      this->exception_ = std::current_exception();
+    }
+
+    template <typename E>
+    Awaiter<E> await_transform(E e) {
+      static_assert(
+          HasValueFrom<E>::value,
+          "'co_await' in a 'Coroutine' only supports eventuals");
+
+      return Awaiter<E>(std::move(e));
+    }
+  };
+
+  template <typename K_, typename To_, typename Raises_>
+  struct Continuation final {
+    using Promise_ = Promise<To_, Raises_>;
+
+    Continuation(K_ k, std::coroutine_handle<Promise_> handle)
+      : handle_(handle),
+        k_(std::move(k)) {}
+
+    Continuation(Continuation&& that) noexcept
+      : handle_(std::exchange(that.handle_, nullptr)),
+        k_(std::move(that.k_)) {}
+
+    ~Continuation() {
+      if (handle_) {
+        handle_.destroy();
+      }
+    }
+
+    template <typename... Args>
+    void Start(Args&&...) {
+      static_assert(
+          sizeof...(Args) == 0,
+          "'Coroutine' does not take any arguments "
+          "(it should be composed first, or within a 'Then')");
+
+      Frame& frame = handle_.promise();
+      frame.k_ = this;
+      frame.complete_ = &Continuation::Complete;
+      frame.stop_ = &Continuation::Stop;
+
+      handle_.resume();
+    }
+
+    template <typename Error>
+    void Fail(Error&& error) {
+      k_.Fail(std::forward<Error>(error));
+    }
+
+    void Stop() {
+      k_.Stop();
+    }
+
+    void Register(Interrupt& interrupt) {
+      handle_.promise().interrupt_ = &interrupt;
+      k_.Register(interrupt);
+    }
+
+    static void Complete(void* pointer) {
+      Continuation& continuation = *static_cast<Continuation*>(pointer);
+
+      Promise_& promise = continuation.handle_.promise();
+
+      if (promise.exception_) {
+        continuation.Raise(
+            std::move(promise.exception_),
+            static_cast<Raises_*>(nullptr));
+      } else if constexpr (std::is_void_v<To_>) {
+        continuation.k_.Start();
+      } else if constexpr (std::is_lvalue_reference_v<To_>) {
+        continuation.k_.Start(promise.value_->get());
+      } else {
+        continuation.k_.Start(std::move(*promise.value_));
+      }
+    }
+
+    static void Stop(void* pointer) {
+      static_cast<Continuation*>(pointer)->k_.Stop();
+    }
+
+    // Propagates the error in 'exception' with its actual type, which
+    // must be one of the errors in 'Raises_'.
+    template <typename... Errors>
+    void Raise(std::exception_ptr exception, std::tuple<Errors...>*) {
+      if constexpr (sizeof...(Errors) == 0) {
+        try {
+          std::rethrow_exception(exception);
+        } catch (const std::exception& e) {
+          LOG(FATAL) << "'Coroutine' threw an error not declared in "
+                     << "'Raises': " << e.what();
+        } catch (...) {
+          LOG(FATAL) << "'Coroutine' threw an error not declared in "
+                     << "'Raises'";
+        }
+      } else {
+        RaiseAny<Errors...>(std::move(exception));
+      }
+    }
+
+    template <typename Error, typename... Errors>
+    void RaiseAny(std::exception_ptr exception) {
+      std::optional<Error> error;
+      try {
+        std::rethrow_exception(exception);
+      } catch (Error& e) {
+        error.emplace(std::move(e));
+      } catch (...) {}
+
+      if (error.has_value()) {
+        k_.Fail(std::move(*error));
+      } else {
+        Raise(
+            std::move(exception),
+            static_cast<std::tuple<Errors...>*>(nullptr));
+      }
+    }
+
+    std::coroutine_handle<Promise_> handle_;
+
+    // NOTE: we store 'k_' as the _last_ member so it will be
+    // destructed _first_ and thus we won't have any use-after-delete
+    // issues during destruction of 'k_' if it holds any references or
+    // pointers to any (or within any) of the above members.
+    K_ k_;
+  };
+
+  template <typename To_, typename Raises_>
+  class Composable final {
+   public:
+    using promise_type = Promise<To_, Raises_>;
+
+    template <typename Arg, typename Errors>
+    using ValueFrom = To_;
+
+    template <typename Arg, typename Errors>
+    using ErrorsFrom = tuple_types_union_t<Raises_, Errors>;
+
+    template <typename Downstream>
+    static constexpr bool CanCompose = Downstream::ExpectsValue;
+
+    using Expects = SingleValue;
+
+    template <typename T>
+    using Of = std::enable_if_t<
+        IsUndefined<To_>::value,
+        Composable<T, Raises_>>;
+
+    template <typename... Errors>
+    using Raises = std::enable_if_t<
+        std::tuple_size_v<Raises_> == 0,
+        Composable<To_, std::tuple<Errors...>>>;
+
+    explicit Composable(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+    Composable(Composable&& that) noexcept
+      : handle_(std::exchange(that.handle_, nullptr)) {}
+
+    ~Composable() {
+      if (handle_) {
+        handle_.destroy();
+      }
+    }
+
+    template <typename Arg, typename Errors, typename K>
+    auto k(K k) && {
+      static_assert(
+          !IsUndefined<To_>::value,
+          "'Coroutine' 'Of' type is not specified");
+
+      return Continuation<K, To_, Raises_>(
+          std::move(k),
+          std::exchange(handle_, nullptr));
+    }
+
+   private:
+    std::coroutine_handle<promise_type> handle_;
+  };
+};
+
+////////////////////////////////////////////////////////////////////////
+
+template <>
+struct _Coroutine::PromiseValue<void> : Frame {
+  void return_void() {}
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// A C++20 coroutine that is also an eventual, e.g.:
+//
+//   Coroutine::Of<int>::Raises<RuntimeError> AddOne(int i) {
+//     int j = co_await (Just(i) >> Then([](int i) { return i + 1; }));
+//     co_return j;
+//   }
+//
+//   auto e = AddOne(41) >> Then([](int i) { ... });
+//
+// Any eventual can be 'co_await'-ed from within a coroutine. If the
+// eventual fails its error gets thrown (and can be caught with
+// 'try'/'catch') and if it stops then the coroutine stops too
+// (without being resumed). Errors thrown out of a coroutine get
+// propagated via 'Fail()' and must be one of the errors it 'Raises'.
+// Interrupts get propagated to the eventual currently being awaited.
+//
+// Like a 'Task' a coroutine is type-erased, but rather than virtual
+// functions and possibly allocating, the coroutine frame is always
+// allocated (once, when calling the coroutine) with the allocator of
+// the current 'Scheduler::Context', e.g., an 'Arena'.
+//
+// NOTE: a coroutine doesn't execute until it has been started as an
+// eventual so it's safe to call it and then compose it.
+using Coroutine =_Coroutine::Composable<Undefined, std::tuple<>>;
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
+
+#endif
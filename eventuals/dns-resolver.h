@@ -1,7 +1,21 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "eventuals/callback.h"
+#include "eventuals/closure.h"
 #include "eventuals/event-loop.h"
 #include "eventuals/eventual.h"
+#include "eventuals/if.h"
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -52,11 +66,12 @@ namespace eventuals {
                         ip,
                         16);
 
+                    uv_freeaddrinfo(result);
+
                     if (error) {
                       static_cast<K*>(data.k)->Fail(
                           RuntimeError(uv_err_name(error)));
                     } else {
-                      uv_freeaddrinfo(result);
                       static_cast<K*>(data.k)->Start(std::string{ip});
                     }
                   }
@@ -70,8 +85,477 @@ namespace eventuals {
                   RuntimeError(uv_err_name(error)));
             }
           }));
-  // TODO (Artur): think later about implementing
-  // .interrupt([](auto &data, auto &k){...}); callback
+  // NOTE: see 'DnsResolver' below for a resolver that can be
+  // interrupted (as well as caching, IPv6, etc).
+}
+
+////////////////////////////////////////////////////////////////////////
+
+struct DnsResolverOptions final {
+  // How long successfully resolved addresses are cached for.
+  //
+  // NOTE: 'getaddrinfo()' doesn't expose the TTL of the DNS records
+  // so this should be no more than the TTLs of the names being
+  // resolved.
+  std::chrono::nanoseconds ttl = std::chrono::seconds(30);
+
+  // How long a failure to resolve a name is cached for.
+  std::chrono::nanoseconds negative_ttl = std::chrono::seconds(5);
+
+  // Max number of names to cache. Once exceeded expired names are
+  // evicted first and then, if that's not enough, any other names
+  // that don't have a lookup in flight. Names with a lookup in flight
+  // are never evicted so the cache only grows past this while more
+  // than 'max_entries' lookups are in flight.
+  size_t max_entries = 4096;
+
+  // Optional path to a file in the same format as '/etc/hosts' whose
+  // entries are used (without ever expiring) in favor of the system
+  // resolver, e.g., to stub out names in tests.
+  std::optional<std::filesystem::path> hosts;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Resolves names to all of their IPv4 and IPv6 addresses using
+// libuv's 'uv_getaddrinfo()' but caches the results (see
+// 'DnsResolverOptions') and coalesces concurrent resolves of the same
+// name into a single lookup.
+//
+// Resolving a cached name completes immediately on the calling
+// thread without going through the event loop.
+//
+// NOTE: a resolver is thread-safe and must outlive all of its
+// resolves, including any that were interrupted since an interrupted
+// resolve doesn't cancel the underlying lookup (whose results still
+// get cached).
+class DnsResolver final {
+ public:
+  // Either the resolved addresses or the error.
+  struct Result final {
+    std::vector<std::string> addresses;
+    std::string error;
+  };
+
+  explicit DnsResolver(
+      DnsResolverOptions options = DnsResolverOptions(),
+      EventLoop& loop = EventLoop::Default())
+    : options_(std::move(options)),
+      loop_(loop) {
+    if (options_.hosts) {
+      ParseHosts(*options_.hosts);
+    }
+  }
+
+  DnsResolver(const DnsResolver&) = delete;
+  DnsResolver(DnsResolver&&) = delete;
+
+  ~DnsResolver() {
+    std::scoped_lock lock(mutex_);
+    CHECK_EQ(lookups_inflight_, 0u)
+        << "destructing DNS resolver with outstanding lookups";
+  }
+
+  // Returns all addresses (IPv4 and IPv6, as strings, e.g.,
+  // "127.0.0.1" or "::1") for 'name' in the order the system
+  // resolver returned them.
+  [[nodiscard]] auto Resolve(std::string name);
+
+  // Removes all cached names (except those from 'hosts').
+  void Clear() {
+    std::scoped_lock lock(mutex_);
+    for (auto iterator = entries_.begin(); iterator != entries_.end();) {
+      if (iterator->second.pending) {
+        ++iterator;
+      } else {
+        iterator = entries_.erase(iterator);
+      }
+    }
+  }
+
+  // Number of resolves answered from the cache (or 'hosts').
+  size_t hits() {
+    std::scoped_lock lock(mutex_);
+    return hits_;
+  }
+
+  // Number of lookups performed via the system resolver.
+  size_t lookups() {
+    std::scoped_lock lock(mutex_);
+    return lookups_;
+  }
+
+  // Number of cached names (excluding those from 'hosts'), including
+  // those with a lookup in flight.
+  size_t size() {
+    std::scoped_lock lock(mutex_);
+    return entries_.size();
+  }
+
+ private:
+  struct Waiter final {
+    Callback<void(const Result&)> callback;
+  };
+
+  struct Entry final {
+    Result result;
+    std::chrono::nanoseconds expires = std::chrono::nanoseconds::min();
+
+    // Whether or not a lookup is in flight and who's waiting for it.
+    bool pending = false;
+    std::vector<Waiter*> waiters;
+  };
+
+  struct Lookup final {
+    DnsResolver& resolver;
+    std::string name;
+    uv_getaddrinfo_t request = {};
+  };
+
+  // Returns a copy of the cached result for 'name' if there is one,
+  // otherwise adds 'waiter' and returns true in 'lookup' if a new
+  // lookup needs to be started.
+  std::optional<Result> CachedOrWait(
+      const std::string& name,
+      Waiter* waiter,
+      bool& lookup) {
+    std::scoped_lock lock(mutex_);
+
+    auto iterator = hosts_.find(name);
+    if (iterator != hosts_.end()) {
+      hits_++;
+      return Result{iterator->second, ""};
+    }
+
+    if (waiter == nullptr) {
+      auto iterator = entries_.find(name);
+      if (iterator != entries_.end()
+          && !iterator->second.pending
+          && iterator->second.expires > loop_.clock().Now()) {
+        hits_++;
+        return iterator->second.result;
+      }
+      return std::nullopt;
+    }
+
+    auto [position, inserted] = entries_.try_emplace(name);
+
+    Entry& entry = position->second;
+
+    if (!entry.pending && entry.expires > loop_.clock().Now()) {
+      hits_++;
+      return entry.result;
+    }
+
+    lookup = !entry.pending;
+
+    if (lookup) {
+      entry.pending = true;
+      lookups_++;
+      lookups_inflight_++;
+    }
+
+    // NOTE: evicting after marking 'entry' as pending so that it
+    // doesn't get evicted itself.
+    if (inserted && entries_.size() > options_.max_entries) {
+      Evict();
+    }
+
+    entry.waiters.push_back(waiter);
+
+    return std::nullopt;
+  }
+
+  // Removes 'waiter', returning false if it has already been (or is
+  // being) completed.
+  bool Cancel(const std::string& name, Waiter* waiter) {
+    std::scoped_lock lock(mutex_);
+
+    auto iterator = entries_.find(name);
+    if (iterator == entries_.end()) {
+      return false;
+    }
+
+    auto& waiters = iterator->second.waiters;
+
+    auto position = std::find(waiters.begin(), waiters.end(), waiter);
+    if (position == waiters.end()) {
+      return false;
+    }
+
+    waiters.erase(position);
+
+    return true;
+  }
+
+  // Starts a lookup of 'name', must be called from the event loop.
+  void Start(const std::string& name) {
+    CHECK(loop_.InEventLoop());
+
+    auto* lookup = new Lookup{*this, name};
+
+    lookup->request.data = lookup;
+
+    // NOTE: 'SOCK_STREAM' so that each address is only returned once
+    // rather than once per socket type.
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int error = uv_getaddrinfo(
+        loop_,
+        &lookup->request,
+        [](uv_getaddrinfo_t* request, int status, addrinfo* addresses) {
+          auto* lookup = static_cast<Lookup*>(request->data);
+          lookup->resolver.Complete(lookup->name, status, addresses);
+          if (addresses != nullptr) {
+            uv_freeaddrinfo(addresses);
+          }
+          delete lookup;
+        },
+        lookup->name.c_str(),
+        nullptr,
+        &hints);
+
+    if (error) {
+      Complete(name, error, nullptr);
+      delete lookup;
+    }
+  }
+
+  void Complete(const std::string& name, int status, addrinfo* addresses) {
+    Result result;
+
+    if (status < 0) {
+      result.error = uv_err_name(status);
+    } else {
+      for (addrinfo* address = addresses;
+           address != nullptr;
+           address = address->ai_next) {
+        char ip[INET6_ADDRSTRLEN] = {'\0'};
+
+        int error = 0;
+        if (address->ai_family == AF_INET) {
+          error = uv_ip4_name(
+              reinterpret_cast<sockaddr_in*>(address->ai_addr),
+              ip,
+              sizeof(ip));
+        } else if (address->ai_family == AF_INET6) {
+          error = uv_ip6_name(
+              reinterpret_cast<sockaddr_in6*>(address->ai_addr),
+              ip,
+              sizeof(ip));
+        } else {
+          continue;
+        }
+
+        if (error == 0
+            && std::find(
+                   result.addresses.begin(),
+                   result.addresses.end(),
+                   ip)
+                == result.addresses.end()) {
+          result.addresses.emplace_back(ip);
+        }
+      }
+
+      if (result.addresses.empty()) {
+        result.error = uv_err_name(UV_EAI_NODATA);
+      }
+    }
+
+    std::vector<Waiter*> waiters;
+
+    {
+      std::scoped_lock lock(mutex_);
+
+      lookups_inflight_--;
+
+      auto iterator = entries_.find(name);
+
+      CHECK(iterator != entries_.end());
+
+      Entry& entry = iterator->second;
+
+      waiters = std::move(entry.waiters);
+      entry.waiters.clear();
+
+      entry.pending = false;
+      entry.result = result;
+      entry.expires = loop_.clock().Now()
+          + (result.error.empty() ? options_.ttl : options_.negative_ttl);
+
+      if (entries_.size() > options_.max_entries) {
+        Evict();
+      }
+    }
+
+    for (Waiter* waiter : waiters) {
+      waiter->callback(result);
+    }
+  }
+
+  // Evicts expired entries and if that isn't enough any entries that
+  // don't have a lookup in flight until there are at most
+  // 'max_entries' (see 'DnsResolverOptions::max_entries'). Requires
+  // holding 'mutex_'.
+  void Evict() {
+    const std::chrono::nanoseconds now = loop_.clock().Now();
+
+    for (auto iterator = entries_.begin(); iterator != entries_.end();) {
+      if (!iterator->second.pending && iterator->second.expires <= now) {
+        iterator = entries_.erase(iterator);
+      } else {
+        ++iterator;
+      }
+    }
+
+    for (auto iterator = entries_.begin();
+         iterator != entries_.end()
+         && entries_.size() > options_.max_entries;) {
+      if (!iterator->second.pending) {
+        iterator = entries_.erase(iterator);
+      } else {
+        ++iterator;
+      }
+    }
+  }
+
+  void ParseHosts(const std::filesystem::path& path) {
+    std::ifstream ifs(path);
+
+    CHECK(ifs) << "Failed to open hosts file " << path;
+
+    std::string line;
+    while (std::getline(ifs, line)) {
+      line = line.substr(0, line.find('#'));
+
+      std::istringstream iss(line);
+
+      std::string ip;
+      if (!(iss >> ip)) {
+        continue;
+      }
+
+      std::string name;
+      while (iss >> name) {
+        hosts_[name].push_back(ip);
+      }
+    }
+  }
+
+  const DnsResolverOptions options_;
+
+  EventLoop& loop_;
+
+  std::mutex mutex_;
+
+  std::unordered_map<std::string, std::vector<std::string>> hosts_;
+  std::unordered_map<std::string, Entry> entries_;
+
+  size_t hits_ = 0;
+  size_t lookups_ = 0;
+  size_t lookups_inflight_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto DnsResolver::Resolve(std::string name) {
+  // Completes with 'result', i.e., the addresses or the error.
+  auto complete = [](Result&& result) {
+    return Eventual<std::vector<std::string>>()
+        .raises<RuntimeError>()
+        .start([result = std::move(result)](auto& k) mutable {
+          if (result.error.empty()) {
+            k.Start(std::move(result.addresses));
+          } else {
+            k.Fail(RuntimeError(std::move(result.error)));
+          }
+        });
+  };
+
+  struct Data {
+    DnsResolver& resolver;
+    std::string name;
+
+    Waiter waiter;
+
+    void* k = nullptr;
+  };
+
+  // Waits for the result of a (possibly already started) lookup.
+  auto wait = [this](std::string&& name) {
+    return loop_.Schedule(
+        "DnsResolver::Resolve",
+        Eventual<std::vector<std::string>>()
+            .raises<RuntimeError>()
+            .interruptible()
+            .context(Data{*this, std::move(name)})
+            .start([](Data& data, auto& k, auto& handler) {
+              using K = std::decay_t<decltype(k)>;
+
+              data.k = &k;
+
+              data.waiter.callback = [&data](const Result& result) {
+                auto& k = *static_cast<K*>(data.k);
+                if (result.error.empty()) {
+                  k.Start(std::vector<std::string>(result.addresses));
+                } else {
+                  k.Fail(RuntimeError(result.error));
+                }
+              };
+
+              if (handler) {
+                bool installed = handler->Install([&data]() {
+                  // NOTE: only stop if we haven't already completed.
+                  if (data.resolver.Cancel(data.name, &data.waiter)) {
+                    static_cast<K*>(data.k)->Stop();
+                  }
+                });
+
+                if (!installed) {
+                  // Interrupt has already been triggered.
+                  k.Stop();
+                  return;
+                }
+              }
+
+              bool lookup = false;
+
+              std::optional<Result> result = data.resolver.CachedOrWait(
+                  data.name,
+                  &data.waiter,
+                  lookup);
+
+              if (result) {
+                // Another resolve completed the lookup in the mean
+                // time. An interrupt can't complete us since we're not
+                // waiting so we can complete.
+                data.waiter.callback(*result);
+              } else if (lookup) {
+                data.resolver.Start(data.name);
+              }
+            }));
+  };
+
+  return Closure([this,
+                  name = std::move(name),
+                  complete = std::move(complete),
+                  wait = std::move(wait)]() mutable {
+    bool lookup = false;
+
+    // Fast path for cached names, which doesn't need to go through
+    // the event loop.
+    std::optional<Result> result = CachedOrWait(name, nullptr, lookup);
+
+    return If(result.has_value())
+        .yes([complete, result = std::move(result)]() mutable {
+          return complete(std::move(*result));
+        })
+        .no([wait, name = std::move(name)]() mutable {
+          return wait(std::move(name));
+        });
+  });
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -288,8 +288,10 @@ struct _DoAll final {
 
               // Clone the current scheduler context for running the eventual.
               (fiber.context.emplace(
-                   Scheduler::Context::Get()->name()
-                   + " [DoAll - " + std::to_string(i++) + "]"),
+                   Scheduler::Context::Get()->name().Derive(
+                       "DoAll",
+                       std::string_view(),
+                       static_cast<size_t>(i++))),
                ...);
 
               (fiber.context->scheduler()->Submit(
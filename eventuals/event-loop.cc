@@ -1,5 +1,6 @@
 #include "eventuals/event-loop.h"
 
+#include <cstdlib> // For 'std::getenv()'.
 #include <sstream>
 
 ////////////////////////////////////////////////////////////////////////
@@ -162,6 +163,42 @@ EventLoop::EventLoop()
   });
 
   uv_async_init(&loop_, &async_, nullptr);
+
+#if EVENTUALS_IO_URING
+  const char* variable = std::getenv("EVENTUALS_IO_URING");
+
+  if (variable == nullptr || atoi(variable) != 0) {
+    io_uring_ = IoUring::Create();
+  }
+
+  if (io_uring_) {
+    uv_poll_init(&loop_, &io_uring_poll_, io_uring_->eventfd());
+
+    io_uring_poll_.data = this;
+
+    uv_poll_start(
+        &io_uring_poll_,
+        UV_READABLE,
+        [](uv_poll_t* poll, int status, int events) {
+          EventLoop& loop = *static_cast<EventLoop*>(poll->data);
+          loop.io_uring_->Reap();
+          loop.SubmitIoUring();
+        });
+
+    uv_prepare_init(&loop_, &io_uring_prepare_);
+
+    io_uring_prepare_.data = this;
+
+    uv_prepare_start(&io_uring_prepare_, [](uv_prepare_t* prepare) {
+      static_cast<EventLoop*>(prepare->data)->SubmitIoUring();
+    });
+
+    // Neither handle keeps the loop alive unless there are
+    // outstanding operations, see 'SubmitIoUring()'.
+    uv_unref((uv_handle_t*) &io_uring_poll_);
+    uv_unref((uv_handle_t*) &io_uring_prepare_);
+  }
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -180,6 +217,19 @@ EventLoop::~EventLoop() {
 
   uv_close((uv_handle_t*) &async_, nullptr);
 
+#if EVENTUALS_IO_URING
+  if (io_uring_) {
+    CHECK_EQ(0u, io_uring_->inflight() + io_uring_->prepared())
+        << "destructing EventLoop with outstanding io_uring operations";
+
+    uv_poll_stop(&io_uring_poll_);
+    uv_close((uv_handle_t*) &io_uring_poll_, nullptr);
+
+    uv_prepare_stop(&io_uring_prepare_);
+    uv_close((uv_handle_t*) &io_uring_prepare_, nullptr);
+  }
+#endif
+
   // NOTE: ideally we can just run 'uv_run()' once now in order to
   // properly handle the 'uv_close()' calls we just made. Unfortunately
   // libuv has a peculiar behavior where if 'async_' has an
@@ -269,7 +319,9 @@ void EventLoop::Interrupt() {
 ////////////////////////////////////////////////////////////////////////
 
 bool EventLoop::Continuable(const Scheduler::Context& context) {
-  return InEventLoop();
+  bool continuable = InEventLoop();
+  metrics_.RecordContinuable(0, continuable);
+  return continuable;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -289,6 +341,12 @@ void EventLoop::Submit(Callback<void()> callback, Context& context) {
 
   CHECK(waiter->next == nullptr) << context.name();
 
+  // NOTE: must record _before_ enqueuing because once the waiter has
+  // been enqueued it might get dequeued (and run) immediately.
+  waiter->submitted = SchedulerMetrics::Now();
+
+  metrics_.RecordSubmit(0);
+
   waiter->next = waiters_.load(std::memory_order_relaxed);
 
   while (!waiters_.compare_exchange_weak(
@@ -303,6 +361,8 @@ void EventLoop::Submit(Callback<void()> callback, Context& context) {
 ////////////////////////////////////////////////////////////////////////
 
 void EventLoop::Check() {
+  metrics_.RecordWakeup(0);
+
   Waiter* waiter = nullptr;
   do {
   load:
@@ -333,6 +393,10 @@ void EventLoop::Check() {
 
       Context* context = CHECK_NOTNULL(waiter->context.get());
 
+      auto start = SchedulerMetrics::Now();
+
+      metrics_.RecordDequeue(0, waiter->submitted, start);
+
       context->unblock();
 
       context->use();
@@ -344,6 +408,8 @@ void EventLoop::Check() {
 
       Callback<void()> callback = std::move(waiter->callback);
 
+      trace::Begin("Run", context->name());
+
       callback();
 
       ////////////////////////////////////////////////////
@@ -351,11 +417,40 @@ void EventLoop::Check() {
       // because it might have been deallocated!        //
       ////////////////////////////////////////////////////
 
+      trace::End("Run", context->name());
+
+      metrics_.RecordRun(0, start, SchedulerMetrics::Now());
+
       CHECK_EQ(context, Context::Switch(std::move(previous)).get());
       context->unuse();
     }
   } while (waiter != nullptr);
+
+#if EVENTUALS_IO_URING
+  // Submit anything the callbacks we just ran prepared now rather
+  // than waiting for the next loop iteration.
+  if (io_uring_) {
+    SubmitIoUring();
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#if EVENTUALS_IO_URING
+void EventLoop::SubmitIoUring() {
+  io_uring_->Submit();
+
+  // NOTE: the poll handle is what keeps the loop alive while there
+  // are outstanding operations, otherwise 'uv_run()' might return
+  // (or never even get to 'Submit()') before the operations complete.
+  if (io_uring_->inflight() + io_uring_->prepared() > 0) {
+    uv_ref((uv_handle_t*) &io_uring_poll_);
+  } else {
+    uv_unref((uv_handle_t*) &io_uring_poll_);
+  }
 }
+#endif
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -13,7 +13,9 @@
 
 #include "eventuals/callback.h"
 #include "eventuals/closure.h"
+#include "eventuals/io-uring.h"
 #include "eventuals/lazy.h"
+#include "eventuals/stored-error.h"
 #include "eventuals/stream.h"
 #include "eventuals/then.h"
 #include "eventuals/type-traits.h"
@@ -195,9 +197,10 @@ class EventLoop final : public Scheduler {
 
    private:
     struct _Timer final {
-      template <typename K_>
+      template <typename K_, typename Errors_>
       struct Continuation final
-        : public stout::enable_borrowable_from_this<Continuation<K_>> {
+        : public stout::enable_borrowable_from_this<
+              Continuation<K_, Errors_>> {
         Continuation(
             K_ k,
             stout::borrowed_ref<Clock> clock,
@@ -371,26 +374,16 @@ class EventLoop final : public Scheduler {
 
         template <typename Error>
         void Fail(Error&& error) {
-          // TODO(benh): avoid allocating on heap by storing args in
-          // pre-allocated buffer based on composing with Errors.
-          using Tuple = std::tuple<decltype(this), Error>;
-          auto tuple = std::make_unique<Tuple>(
-              this,
-              std::forward<Error>(error));
+          stored_error_.Store(std::forward<Error>(error));
 
           // Submitting to event loop to avoid race with interrupt.
           loop().Submit(
-              this->Borrow([tuple = std::move(tuple)]() mutable {
-                std::apply(
-                    [](Continuation* continuation, auto&&... args) {
-                      if (!continuation->completed_) {
-                        CHECK(!continuation->started_);
-                        continuation->completed_ = true;
-                        auto& k_ = continuation->k_;
-                        k_.Fail(std::forward<decltype(args)>(args)...);
-                      }
-                    },
-                    std::move(*tuple));
+              this->Borrow([this]() {
+                if (!completed_) {
+                  CHECK(!started_);
+                  completed_ = true;
+                  stored_error_.Fail(k_);
+                }
               }),
               context_);
         }
@@ -471,6 +464,8 @@ class EventLoop final : public Scheduler {
 
         int error_ = 0;
 
+        StoredError<K_, Errors_> stored_error_;
+
         // NOTE: we use 'context_' in each of 'Start()', 'Fail()', and
         // 'Stop()' because only one of them will called at runtime.
         Scheduler::Context context_;
@@ -501,7 +496,7 @@ class EventLoop final : public Scheduler {
 
         template <typename Arg, typename Errors, typename K>
         auto k(K k) && {
-          return Continuation<K>(
+          return Continuation<K, Errors>(
               std::move(k),
               std::move(clock_),
               nanoseconds_);
@@ -598,7 +593,7 @@ class EventLoop final : public Scheduler {
   [[nodiscard]] auto Schedule(E e);
 
   template <typename E>
-  [[nodiscard]] auto Schedule(std::string&& name, E e);
+  [[nodiscard]] auto Schedule(ContextName name, E e);
 
   bool Alive() {
     return uv_loop_alive(&loop_);
@@ -620,6 +615,23 @@ class EventLoop final : public Scheduler {
     return clock_;
   }
 
+  // Metrics for the thread running the event loop, i.e., there is
+  // only a single worker.
+  SchedulerMetrics& metrics() {
+    return metrics_;
+  }
+
+#if EVENTUALS_IO_URING
+  // Returns the io_uring for submitting file I/O directly from the
+  // event loop (rather than via libuv's threadpool), or nullptr if
+  // io_uring isn't available in which case callers should fall back
+  // to libuv. Operations must be prepared from within the event loop
+  // and get submitted in batches, i.e., once per loop iteration.
+  IoUring* io_uring() {
+    return io_uring_.get();
+  }
+#endif
+
   auto WaitForSignal(int signum);
 
   // Returns a stream of 'PollEvents' for each invocation of stream
@@ -628,9 +640,10 @@ class EventLoop final : public Scheduler {
 
  private:
   struct _WaitForSignal final {
-    template <typename K_>
+    template <typename K_, typename Errors_>
     struct Continuation final
-      : public stout::enable_borrowable_from_this<Continuation<K_>> {
+      : public stout::enable_borrowable_from_this<
+            Continuation<K_, Errors_>> {
       Continuation(K_ k, EventLoop& loop, const int signum)
         : loop_(loop),
           signum_(signum),
@@ -723,26 +736,16 @@ class EventLoop final : public Scheduler {
 
       template <typename Error>
       void Fail(Error&& error) {
-        // TODO(benh): avoid allocating on heap by storing args in
-        // pre-allocated buffer based on composing with Errors.
-        using Tuple = std::tuple<decltype(this), Error>;
-        auto tuple = std::make_unique<Tuple>(
-            this,
-            std::forward<Error>(error));
+        stored_error_.Store(std::forward<Error>(error));
 
         // Submitting to event loop to avoid race with interrupt.
         loop_.Submit(
-            this->Borrow([tuple = std::move(tuple)]() {
-              std::apply(
-                  [](auto* continuation, auto&&... args) {
-                    if (!continuation->completed_) {
-                      CHECK(!continuation->started_);
-                      continuation->completed_ = true;
-                      auto& k_ = continuation->k_;
-                      k_.Fail(std::forward<decltype(args)>(args)...);
-                    }
-                  },
-                  std::move(*tuple));
+            this->Borrow([this]() {
+              if (!completed_) {
+                CHECK(!started_);
+                completed_ = true;
+                stored_error_.Fail(k_);
+              }
             }),
             context_);
       }
@@ -815,6 +818,8 @@ class EventLoop final : public Scheduler {
 
       int error_ = 0;
 
+      StoredError<K_, Errors_> stored_error_;
+
       // NOTE: we use 'context_' in each of 'Start()', 'Fail()', and
       // 'Stop()' because only one of them will called at runtime.
       Scheduler::Context context_;
@@ -845,7 +850,7 @@ class EventLoop final : public Scheduler {
 
       template <typename Arg, typename Errors, typename K>
       auto k(K k) && {
-        return Continuation<K>(std::move(k), loop_, signum_);
+        return Continuation<K, Errors>(std::move(k), loop_, signum_);
       }
 
       EventLoop& loop_;
@@ -865,10 +870,11 @@ class EventLoop final : public Scheduler {
     static_assert(
         PollEvents::Prioritized == static_cast<PollEvents>(UV_PRIORITIZED));
 
-    template <typename K_>
+    template <typename K_, typename Errors_>
     struct Continuation final
       : public TypeErasedStream,
-        public stout::enable_borrowable_from_this<Continuation<K_>> {
+        public stout::enable_borrowable_from_this<
+            Continuation<K_, Errors_>> {
       Continuation(K_ k, EventLoop& loop, int fd, PollEvents events)
         : loop_(loop),
           fd_(fd),
@@ -1032,26 +1038,16 @@ class EventLoop final : public Scheduler {
 
       template <typename Error>
       void Fail(Error&& error) {
-        // TODO(benh): avoid allocating on heap by storing args in
-        // pre-allocated buffer based on composing with Errors.
-        using Tuple = std::tuple<decltype(this), Error>;
-        auto tuple = std::make_unique<Tuple>(
-            this,
-            std::forward<Error>(error));
+        stored_error_.Store(std::forward<Error>(error));
 
         // Submitting to event loop to avoid race with interrupt.
         loop_.Submit(
-            this->Borrow([tuple = std::move(tuple)]() {
-              std::apply(
-                  [](auto* continuation, auto&&... args) {
-                    if (!continuation->completed_) {
-                      CHECK(!continuation->started_);
-                      continuation->completed_ = true;
-                      auto& k_ = continuation->k_;
-                      k_.Fail(std::forward<decltype(args)>(args)...);
-                    }
-                  },
-                  std::move(*tuple));
+            this->Borrow([this]() {
+              if (!completed_) {
+                CHECK(!started_);
+                completed_ = true;
+                stored_error_.Fail(k_);
+              }
             }),
             context_);
       }
@@ -1125,6 +1121,8 @@ class EventLoop final : public Scheduler {
 
       int error_ = 0;
 
+      StoredError<K_, Errors_> stored_error_;
+
       // NOTE: we use 'context_' in each of 'Start()', 'Fail()', and
       // 'Stop()' because only one of them will called at runtime.
       Scheduler::Context context_;
@@ -1155,7 +1153,7 @@ class EventLoop final : public Scheduler {
 
       template <typename Arg, typename Errors, typename K>
       auto k(K k) && {
-        return Continuation<K>(std::move(k), loop_, fd_, events_);
+        return Continuation<K, Errors>(std::move(k), loop_, fd_, events_);
       }
 
       EventLoop& loop_;
@@ -1170,23 +1168,68 @@ class EventLoop final : public Scheduler {
   uv_check_t check_ = {};
   uv_async_t async_ = {};
 
+#if EVENTUALS_IO_URING
+  // Submits any prepared io_uring operations and keeps the loop
+  // alive only while there are operations outstanding.
+  void SubmitIoUring();
+
+  std::unique_ptr<IoUring> io_uring_;
+
+  // Polls the io_uring's eventfd for completions.
+  uv_poll_t io_uring_poll_ = {};
+
+  // Submits operations prepared during the loop iteration right
+  // before the loop blocks polling for I/O.
+  uv_prepare_t io_uring_prepare_ = {};
+#endif
+
   std::atomic<bool> running_ = false;
 
   static inline thread_local bool in_event_loop_ = false;
 
   std::atomic<Waiter*> waiters_ = nullptr;
 
+  SchedulerMetrics metrics_ = SchedulerMetrics(1);
+
   Clock clock_;
 };
 
 ////////////////////////////////////////////////////////////////////////
 
 struct _EventLoopSchedule final {
+  // Continues 'K_' after recording the end of the scheduled eventual
+  // (e.g., some I/O) when tracing.
+  template <typename K_>
+  struct Adaptor final {
+    template <typename... Args>
+    void Start(Args&&... args) {
+      trace::AsyncEnd("EventLoop::Schedule", ContextName(), &k_);
+      k_.Start(std::forward<Args>(args)...);
+    }
+
+    template <typename Error>
+    void Fail(Error&& error) {
+      trace::AsyncEnd("EventLoop::Schedule", ContextName(), &k_);
+      k_.Fail(std::forward<Error>(error));
+    }
+
+    void Stop() {
+      trace::AsyncEnd("EventLoop::Schedule", ContextName(), &k_);
+      k_.Stop();
+    }
+
+    void Register(Interrupt&) {
+      // Already registered K once in 'Continuation::Register()'.
+    }
+
+    K_& k_;
+  };
+
   template <typename K_, typename E_, typename Arg_, typename Errors_>
   struct Continuation final
     : public stout::enable_borrowable_from_this<
           Continuation<K_, E_, Arg_, Errors_>> {
-    Continuation(K_ k, E_ e, EventLoop* loop, std::string&& name)
+    Continuation(K_ k, E_ e, EventLoop* loop, ContextName name)
       : e_(std::move(e)),
         context_(
             CHECK_NOTNULL(loop),
@@ -1213,7 +1256,9 @@ struct _EventLoopSchedule final {
           !std::is_void_v<Arg_> || sizeof...(args) == 0,
           "'Schedule' only supports 0 or 1 argument");
 
-      if (loop()->InEventLoop()) {
+      trace::AsyncBegin("EventLoop::Schedule", context_->name(), &k_);
+
+      if (loop()->Continuable(*context_)) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -1245,7 +1290,9 @@ struct _EventLoopSchedule final {
       // to support the use case where code wants to "catch" a failure
       // inside of a 'Schedule()' in order to either recover or
       // propagate a different failure.
-      if (loop()->InEventLoop()) {
+      trace::AsyncBegin("EventLoop::Schedule", context_->name(), &k_);
+
+      if (loop()->Continuable(*context_)) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -1254,22 +1301,12 @@ struct _EventLoopSchedule final {
         CHECK_EQ(previous.get(), context_.get());
         context_->unuse();
       } else {
-        // TODO(benh): avoid allocating on heap by storing args in
-        // pre-allocated buffer based on composing with Errors.
-        using Tuple = std::tuple<decltype(this), Error>;
-        auto tuple = std::make_unique<Tuple>(
-            this,
-            std::forward<Error>(error));
+        error_.Store(std::forward<Error>(error));
 
         loop()->Submit(
-            this->Borrow([tuple = std::move(tuple)]() mutable {
-              std::apply(
-                  [](auto* schedule, auto&&... args) {
-                    schedule->Adapt();
-                    schedule->adapted_->Fail(
-                        std::forward<decltype(args)>(args)...);
-                  },
-                  std::move(*tuple));
+            this->Borrow([this]() {
+              Adapt();
+              error_.Fail(*adapted_);
             }),
             *context_);
       }
@@ -1281,7 +1318,9 @@ struct _EventLoopSchedule final {
       // stop inside of a 'Schedule()' in order to do something
       // different.
 
-      if (loop()->InEventLoop()) {
+      trace::AsyncBegin("EventLoop::Schedule", context_->name(), &k_);
+
+      if (loop()->Continuable(*context_)) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -1323,7 +1362,7 @@ struct _EventLoopSchedule final {
                 std::move(e_).template k<Arg_, Errors_>(
                     Reschedule(std::move(previous))
                         .template k<Value_, ErrorsE_>(
-                            _Then::Adaptor<K_>{k_}))));
+                            Adaptor<K_>{k_}))));
 
         if (interrupt_ != nullptr) {
           adapted_->Register(*interrupt_);
@@ -1341,7 +1380,7 @@ struct _EventLoopSchedule final {
     // this class _before_ it's started and 'Context' is not movable.
     Lazy::Of<Scheduler::Context>::Args<
         EventLoop*,
-        std::string>
+        ContextName>
         context_;
 
     Interrupt* interrupt_ = nullptr;
@@ -1351,10 +1390,12 @@ struct _EventLoopSchedule final {
 
     using Adapted_ = decltype(std::declval<E_>().template k<Arg_, Errors_>(
         std::declval<_Reschedule::Composable>()
-            .template k<Value_, ErrorsE_>(std::declval<_Then::Adaptor<K_>>())));
+            .template k<Value_, ErrorsE_>(std::declval<Adaptor<K_>>())));
 
     std::unique_ptr<Adapted_> adapted_;
 
+    StoredError<Adapted_, Errors_> error_;
+
     // NOTE: we store 'k_' as the _last_ member so it will be
     // destructed _first_ and thus we won't have any use-after-delete
     // issues during destruction of 'k_' if it holds any references or
@@ -1386,7 +1427,7 @@ struct _EventLoopSchedule final {
 
     E_ e_;
     EventLoop* loop_ = nullptr;
-    std::string name_;
+    ContextName name_;
   };
 };
 
@@ -1399,7 +1440,7 @@ template <typename E>
 
 ////////////////////////////////////////////////////////////////////////
 template <typename E>
-[[nodiscard]] auto EventLoop::Schedule(std::string&& name, E e) {
+[[nodiscard]] auto EventLoop::Schedule(ContextName name, E e) {
   return _EventLoopSchedule::Composable<E>{std::move(e), this, std::move(name)};
 }
 
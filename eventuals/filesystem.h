@@ -1,10 +1,36 @@
 #pragma once
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
 #include <filesystem> // std::filesystem::path
+#include <limits>
 #include <optional>
-
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "eventuals/buffer-chain.h"
+#include "eventuals/buffer-pool.h"
+#include "eventuals/closure.h"
+#include "eventuals/concurrent-ordered.h"
 #include "eventuals/event-loop.h"
 #include "eventuals/eventual.h"
+#include "eventuals/if.h"
+#include "eventuals/just.h"
+#include "eventuals/map.h"
+#include "eventuals/raise.h"
+#include "eventuals/range.h"
+#include "eventuals/reduce.h"
+#include "eventuals/repeat.h"
+#include "eventuals/then.h"
+#include "eventuals/until.h"
 #include "uv.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -161,6 +187,9 @@ class File final {
     std::filesystem::path path;
 
     Request request;
+#if EVENTUALS_IO_URING
+    IoUring::Operation operation;
+#endif
     void* k = nullptr;
   };
 
@@ -173,6 +202,28 @@ class File final {
             using K = std::decay_t<decltype(k)>;
 
             data.k = &k;
+
+#if EVENTUALS_IO_URING
+            if (IoUring* io_uring = data.loop.io_uring()) {
+              data.operation.callback = [&data](int result) {
+                auto& k = *static_cast<K*>(data.k);
+                if (result >= 0) {
+                  k.Start(File(result));
+                } else {
+                  k.Fail(RuntimeError(uv_strerror(result)));
+                }
+              };
+
+              io_uring->Open(
+                  data.path.c_str(),
+                  data.flags,
+                  data.mode,
+                  &data.operation);
+
+              return;
+            }
+#endif
+
             data.request->data = &data;
 
             auto error = uv_fs_open(
@@ -207,6 +258,9 @@ class File final {
     EventLoop& loop;
     File file;
     Request request;
+#if EVENTUALS_IO_URING
+    IoUring::Operation operation;
+#endif
 
     void* k = nullptr;
   };
@@ -220,6 +274,25 @@ class File final {
             using K = std::decay_t<decltype(k)>;
 
             data.k = &k;
+
+#if EVENTUALS_IO_URING
+            if (IoUring* io_uring = data.loop.io_uring()) {
+              data.operation.callback = [&data](int result) {
+                auto& k = *static_cast<K*>(data.k);
+                if (result == 0) {
+                  data.file.MarkAsClosed();
+                  k.Start();
+                } else {
+                  k.Fail(RuntimeError(uv_strerror(result)));
+                }
+              };
+
+              io_uring->Close(data.file, &data.operation);
+
+              return;
+            }
+#endif
+
             data.request->data = &data;
 
             auto error = uv_fs_close(
@@ -246,6 +319,9 @@ class File final {
 
 ////////////////////////////////////////////////////////////////////////
 
+// Reads up to 'bytes_to_read' bytes at 'offset', returning what was
+// read (which is only less than 'bytes_to_read' at the end of the
+// file).
 [[nodiscard]] inline auto ReadFile(
     const File& file,
     const size_t& bytes_to_read,
@@ -258,6 +334,13 @@ class File final {
     size_t offset;
     EventLoop::Buffer buffer;
     Request request;
+#if EVENTUALS_IO_URING
+    IoUring::Operation operation;
+#endif
+
+    // Number of bytes read so far, i.e., more than 0 but less than
+    // 'bytes_to_read' after a short read.
+    size_t read = 0;
 
     void* k = nullptr;
   };
@@ -270,30 +353,84 @@ class File final {
           .start([](Data& data, auto& k) mutable {
             using K = std::decay_t<decltype(k)>;
 
-            data.k = &k;
-            data.request->data = &data;
+            // Reads whatever hasn't been read yet, i.e., all of
+            // 'bytes_to_read' unless there was a short read (e.g.,
+            // because of a signal) in which case we read the rest
+            // (or up to the end of the file).
+            struct Read final {
+              static void Submit(Data& data) {
+                char* base = static_cast<uv_buf_t*>(data.buffer)->base
+                    + data.read;
+                const size_t size = data.bytes_to_read - data.read;
+                const size_t offset = data.offset + data.read;
+
+#if EVENTUALS_IO_URING
+                if (IoUring* io_uring = data.loop.io_uring()) {
+                  data.operation.callback = [&data](int result) {
+                    Completed(data, result);
+                  };
 
-            auto error = uv_fs_read(
-                data.loop,
-                data.request,
-                data.file,
-                data.buffer,
-                1,
-                data.offset,
-                [](uv_fs_t* request) {
-                  auto& data = *static_cast<Data*>(request->data);
-                  auto& k = *static_cast<K*>(data.k);
-                  if (request->result >= 0) {
-                    k.Start(data.buffer.Extract());
+                  io_uring->Read(
+                      data.file,
+                      base,
+                      size,
+                      offset,
+                      &data.operation);
+
+                  return;
+                }
+#endif
+
+                data.request->data = &data;
+
+                // NOTE: need to cleanup the request before reusing it
+                // after a short read.
+                if (data.read > 0) {
+                  uv_fs_req_cleanup(data.request);
+                }
+
+                uv_buf_t buffer = uv_buf_init(base, size);
+
+                auto error = uv_fs_read(
+                    data.loop,
+                    data.request,
+                    data.file,
+                    &buffer,
+                    1,
+                    offset,
+                    [](uv_fs_t* request) {
+                      Completed(
+                          *static_cast<Data*>(request->data),
+                          request->result);
+                    });
+
+                if (error) {
+                  static_cast<K*>(data.k)->Fail(
+                      RuntimeError(uv_strerror(error)));
+                }
+              }
+
+              static void Completed(Data& data, ssize_t result) {
+                auto& k = *static_cast<K*>(data.k);
+                if (result < 0) {
+                  k.Fail(RuntimeError(uv_strerror(result)));
+                } else {
+                  data.read += result;
+                  if (result > 0 && data.read < data.bytes_to_read) {
+                    Submit(data);
                   } else {
-                    k.Fail(RuntimeError(uv_strerror(request->result)));
-                  };
-                });
+                    // Only return what was actually read (e.g., at
+                    // the end of the file).
+                    data.buffer.Resize(data.read);
+                    k.Start(data.buffer.Extract());
+                  }
+                }
+              }
+            };
 
-            if (error) {
-              static_cast<K*>(data.k)->Fail(
-                  RuntimeError(uv_strerror(error)));
-            }
+            data.k = &k;
+
+            Read::Submit(data);
           }));
 }
 
@@ -310,6 +447,13 @@ class File final {
     EventLoop::Buffer buffer;
     size_t offset;
     Request request;
+#if EVENTUALS_IO_URING
+    IoUring::Operation operation;
+#endif
+
+    // Number of bytes written so far, i.e., more than 0 but less than
+    // 'buffer.Size()' after a short write.
+    size_t written = 0;
 
     void* k = nullptr;
   };
@@ -322,24 +466,459 @@ class File final {
           .start([](Data& data, auto& k) mutable {
             using K = std::decay_t<decltype(k)>;
 
+            // Writes whatever hasn't been written yet, i.e., all of
+            // 'buffer' unless there was a short write (e.g., because
+            // of a signal or 'RLIMIT_FSIZE') in which case we write
+            // the rest (or get the error that caused it).
+            struct Write final {
+              static void Submit(Data& data) {
+                char* base = static_cast<uv_buf_t*>(data.buffer)->base
+                    + data.written;
+                const size_t size = data.buffer.Size() - data.written;
+                const size_t offset = data.offset + data.written;
+
+#if EVENTUALS_IO_URING
+                if (IoUring* io_uring = data.loop.io_uring()) {
+                  data.operation.callback = [&data](int result) {
+                    Completed(data, result);
+                  };
+
+                  io_uring->Write(
+                      data.file,
+                      base,
+                      size,
+                      offset,
+                      &data.operation);
+
+                  return;
+                }
+#endif
+
+                data.request->data = &data;
+
+                // NOTE: need to cleanup the request before reusing it
+                // after a short write.
+                if (data.written > 0) {
+                  uv_fs_req_cleanup(data.request);
+                }
+
+                uv_buf_t buffer = uv_buf_init(base, size);
+
+                auto error = uv_fs_write(
+                    data.loop,
+                    data.request,
+                    data.file,
+                    &buffer,
+                    1,
+                    offset,
+                    [](uv_fs_t* request) {
+                      Completed(
+                          *static_cast<Data*>(request->data),
+                          request->result);
+                    });
+
+                if (error) {
+                  static_cast<K*>(data.k)->Fail(
+                      RuntimeError(uv_strerror(error)));
+                }
+              }
+
+              static void Completed(Data& data, ssize_t result) {
+                auto& k = *static_cast<K*>(data.k);
+                if (result < 0) {
+                  k.Fail(RuntimeError(uv_strerror(result)));
+                } else if (result == 0 && data.buffer.Size() > 0) {
+                  // NOTE: not making any progress so rather than
+                  // trying again (forever) we fail.
+                  k.Fail(RuntimeError("short write"));
+                } else {
+                  data.written += result;
+                  if (data.written < data.buffer.Size()) {
+                    Submit(data);
+                  } else {
+                    k.Start();
+                  }
+                }
+              }
+            };
+
+            data.k = &k;
+
+            Write::Submit(data);
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Helper for reading into (or writing from) buffers owned by the
+// caller (i.e., without allocating or copying) where 'Buffers_' is
+// either a 'std::array' or a 'std::vector' of 'uv_buf_t' or (only for
+// writing) a 'BufferChain'.
+struct _FileIO final {
+  template <typename Buffers_>
+  static uv_buf_t* Pointer(Buffers_& buffers) {
+    return buffers.data();
+  }
+
+  static uv_buf_t* Pointer(BufferChain& chain) {
+    // NOTE: a chain is only ever written from so it's safe to cast
+    // away const, see the overload of 'WriteFile()' below.
+    return const_cast<uv_buf_t*>(chain.buffers().data());
+  }
+
+  template <typename Buffers_>
+  static size_t Count(Buffers_& buffers) {
+    return buffers.size();
+  }
+
+  static size_t Count(BufferChain& chain) {
+    return chain.buffers().size();
+  }
+
+  template <typename Buffers_>
+  static size_t Size(Buffers_& buffers) {
+    size_t size = 0;
+    for (const uv_buf_t& buffer : buffers) {
+      size += buffer.len;
+    }
+    return size;
+  }
+
+  static size_t Size(BufferChain& chain) {
+    return chain.size();
+  }
+
+  // Removes the first 'bytes' bytes from 'buffers', e.g., after a
+  // short read (write), so that they only refer to what is left to
+  // read into (write from).
+  template <typename Buffers_>
+  static void Consume(Buffers_& buffers, size_t bytes) {
+    for (uv_buf_t& buffer : buffers) {
+      const size_t consumed = std::min<size_t>(bytes, buffer.len);
+      buffer.base += consumed;
+      buffer.len -= consumed;
+      bytes -= consumed;
+    }
+  }
+
+  static void Consume(BufferChain& chain, size_t bytes) {
+    chain.Consume(bytes);
+  }
+
+  // Reads into (or writes from) whatever is left of 'data.buffers'
+  // at 'data.offset'.
+  template <typename K_, typename Data_>
+  static void Submit(Data_& data) {
+#if EVENTUALS_IO_URING
+    if (IoUring* io_uring = data.loop.io_uring()) {
+      data.operation.callback = [&data](int result) {
+        Completed<K_>(data, result);
+      };
+
+      // NOTE: on Unix libuv guarantees that 'uv_buf_t' has the same
+      // layout as 'iovec'.
+      const iovec* iovecs =
+          reinterpret_cast<const iovec*>(Pointer(data.buffers));
+
+      if (data.write) {
+        io_uring->WriteV(
+            data.file,
+            iovecs,
+            Count(data.buffers),
+            data.offset,
+            &data.operation);
+      } else {
+        io_uring->ReadV(
+            data.file,
+            iovecs,
+            Count(data.buffers),
+            data.offset,
+            &data.operation);
+      }
+
+      return;
+    }
+#endif
+
+    data.request->data = &data;
+
+    // NOTE: need to cleanup the request before reusing it after a
+    // short read (write).
+    if (data.transferred > 0) {
+      uv_fs_req_cleanup(data.request);
+    }
+
+    auto callback = [](uv_fs_t* request) {
+      Completed<K_>(*static_cast<Data_*>(request->data), request->result);
+    };
+
+    auto error = data.write
+        ? uv_fs_write(
+            data.loop,
+            data.request,
+            data.file,
+            Pointer(data.buffers),
+            Count(data.buffers),
+            data.offset,
+            callback)
+        : uv_fs_read(
+            data.loop,
+            data.request,
+            data.file,
+            Pointer(data.buffers),
+            Count(data.buffers),
+            data.offset,
+            callback);
+
+    if (error) {
+      static_cast<K_*>(data.k)->Fail(RuntimeError(uv_strerror(error)));
+    }
+  }
+
+  // Handles the result of 'Submit()', reading (writing) the rest of
+  // the buffers after a short read (write), e.g., because of a signal
+  // or 'RLIMIT_FSIZE', until either everything has been read
+  // (written), we've read up to the end of the file, or it fails.
+  template <typename K_, typename Data_>
+  static void Completed(Data_& data, ssize_t result) {
+    auto& k = *static_cast<K_*>(data.k);
+    if (result < 0) {
+      k.Fail(RuntimeError(uv_strerror(result)));
+    } else if (result == 0 && data.transferred < data.size) {
+      if (data.write) {
+        // NOTE: not making any progress so rather than trying again
+        // (forever) we fail.
+        k.Fail(RuntimeError("short write"));
+      } else {
+        // End of file.
+        k.Start(data.transferred);
+      }
+    } else {
+      data.transferred += result;
+      if (data.transferred < data.size) {
+        Consume(data.buffers, result);
+        data.offset += result;
+        Submit<K_>(data);
+      } else {
+        k.Start(data.transferred);
+      }
+    }
+  }
+
+  template <typename Buffers_>
+  [[nodiscard]] static auto ReadOrWrite(
+      ContextName name,
+      const bool write,
+      const File& file,
+      Buffers_&& buffers,
+      const size_t& offset,
+      EventLoop& loop) {
+    struct Data {
+      EventLoop& loop;
+      const File& file;
+      bool write;
+      std::decay_t<Buffers_> buffers;
+      size_t offset;
+      Request request;
+#if EVENTUALS_IO_URING
+      IoUring::Operation operation;
+#endif
+
+      // Total number of bytes to read (write) and how many have been
+      // read (written) so far, i.e., more than 0 but less than 'size'
+      // after a short read (write).
+      size_t size = 0;
+      size_t transferred = 0;
+
+      void* k = nullptr;
+    };
+
+    return loop.Schedule(
+        std::move(name),
+        Eventual<size_t>()
+            .raises<RuntimeError>()
+            .context(Data{
+                loop,
+                file,
+                write,
+                std::forward<Buffers_>(buffers),
+                offset})
+            .start([](Data& data, auto& k) mutable {
+              using K = std::decay_t<decltype(k)>;
+
+              data.k = &k;
+              data.size = Size(data.buffers);
+
+              Submit<K>(data);
+            }));
+  }
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Reads up to 'size' bytes at 'offset' directly into 'data', which
+// must outlive the read, returning the number of bytes read (which is
+// only less than 'size' at the end of the file).
+[[nodiscard]] inline auto ReadFile(
+    const File& file,
+    char* data,
+    const size_t& size,
+    const size_t& offset,
+    EventLoop& loop = EventLoop::Default()) {
+  return _FileIO::ReadOrWrite(
+      "ReadFile",
+      /* write = */ false,
+      file,
+      std::array<uv_buf_t, 1>{uv_buf_init(data, size)},
+      offset,
+      loop);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Reads up to 'buffer.capacity()' bytes at 'offset' into 'buffer',
+// which must outlive the read, resizing it to (and returning) the
+// number of bytes read (which is only less than 'buffer.capacity()'
+// at the end of the file).
+[[nodiscard]] inline auto ReadFile(
+    const File& file,
+    BufferPool::Buffer& buffer,
+    const size_t& offset,
+    EventLoop& loop = EventLoop::Default()) {
+  return ReadFile(file, buffer.data(), buffer.capacity(), offset, loop)
+      >> Then([&buffer](size_t bytes) {
+           buffer.resize(bytes);
+           return bytes;
+         });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Scatter read at 'offset' into 'buffers' (whose memory must outlive
+// the read) filling each buffer in order, returning the total number
+// of bytes read (which is only less than the total size of 'buffers'
+// at the end of the file).
+[[nodiscard]] inline auto ReadFile(
+    const File& file,
+    std::vector<uv_buf_t> buffers,
+    const size_t& offset,
+    EventLoop& loop = EventLoop::Default()) {
+  return _FileIO::ReadOrWrite(
+      "ReadFile",
+      /* write = */ false,
+      file,
+      std::move(buffers),
+      offset,
+      loop);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Writes 'size' bytes from 'data', which must outlive the write, at
+// 'offset' without copying them, returning the number of bytes
+// written.
+[[nodiscard]] inline auto WriteFile(
+    const File& file,
+    const char* data,
+    const size_t& size,
+    const size_t& offset,
+    EventLoop& loop = EventLoop::Default()) {
+  return _FileIO::ReadOrWrite(
+      "WriteFile",
+      /* write = */ true,
+      file,
+      std::array<uv_buf_t, 1>{uv_buf_init(const_cast<char*>(data), size)},
+      offset,
+      loop);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Writes 'buffer.size()' bytes from 'buffer', which must outlive the
+// write, at 'offset', returning the number of bytes written.
+[[nodiscard]] inline auto WriteFile(
+    const File& file,
+    const BufferPool::Buffer& buffer,
+    const size_t& offset,
+    EventLoop& loop = EventLoop::Default()) {
+  return WriteFile(file, buffer.data(), buffer.size(), offset, loop);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Gather write at 'offset' from 'buffers' (whose memory must outlive
+// the write) in order, returning the total number of bytes written.
+[[nodiscard]] inline auto WriteFile(
+    const File& file,
+    std::vector<uv_buf_t> buffers,
+    const size_t& offset,
+    EventLoop& loop = EventLoop::Default()) {
+  return _FileIO::ReadOrWrite(
+      "WriteFile",
+      /* write = */ true,
+      file,
+      std::move(buffers),
+      offset,
+      loop);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Gather write at 'offset' of all of the slices of 'chain' (without
+// copying them) in order, returning the total number of bytes
+// written. The chain's memory is released after the write completes.
+[[nodiscard]] inline auto WriteFile(
+    const File& file,
+    BufferChain chain,
+    const size_t& offset,
+    EventLoop& loop = EventLoop::Default()) {
+  return _FileIO::ReadOrWrite(
+      "WriteFile",
+      /* write = */ true,
+      file,
+      std::move(chain),
+      offset,
+      loop);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Flushes all of the data (and metadata) written to 'file' to disk,
+// i.e., 'fsync()'.
+[[nodiscard]] inline auto SyncFile(
+    const File& file,
+    EventLoop& loop = EventLoop::Default()) {
+  struct Data {
+    EventLoop& loop;
+    const File& file;
+
+    Request request;
+    void* k = nullptr;
+  };
+
+  return loop.Schedule(
+      "SyncFile",
+      Eventual<void>()
+          .raises<RuntimeError>()
+          .context(Data{loop, file})
+          .start([](Data& data, auto& k) mutable {
+            using K = std::decay_t<decltype(k)>;
+
             data.k = &k;
             data.request->data = &data;
 
-            auto error = uv_fs_write(
+            auto error = uv_fs_fsync(
                 data.loop,
                 data.request,
                 data.file,
-                data.buffer,
-                1,
-                data.offset,
                 [](uv_fs_t* request) {
                   auto& data = *static_cast<Data*>(request->data);
                   auto& k = *static_cast<K*>(data.k);
-                  if (request->result >= 0) {
+                  if (request->result == 0) {
                     k.Start();
                   } else {
                     k.Fail(RuntimeError(uv_strerror(request->result)));
-                  };
+                  }
                 });
 
             if (error) {
@@ -588,6 +1167,553 @@ class File final {
 
 ////////////////////////////////////////////////////////////////////////
 
+// Default number of reads (writes) that 'ReadFileStream()'
+// ('WriteFileStream()') keeps in flight at a time.
+constexpr size_t DEFAULT_READAHEAD = 4;
+constexpr size_t DEFAULT_WRITE_BEHIND = 4;
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns a stream of the contents of 'file' from the beginning, each
+// value being a chunk of 'chunk_size' bytes (except the last chunk
+// which might be smaller), ending after the end of the file is read.
+// A short read of a chunk in the middle of the file is retried for
+// the rest of the chunk (see 'ReadFile()') so no bytes are skipped.
+//
+// Up to 'readahead' reads are kept in flight at a time to hide the
+// latency of each read but chunks are always emitted in order and no
+// more reads are started while the oldest chunk hasn't been consumed,
+// i.e., a slow consumer (e.g., a 'Loop()') applies backpressure.
+//
+// NOTE: 'file' must outlive the stream.
+[[nodiscard]] inline auto ReadFileStream(
+    const File& file,
+    const size_t& chunk_size,
+    const size_t& readahead = DEFAULT_READAHEAD,
+    EventLoop& loop = EventLoop::Default()) {
+  CHECK_GT(chunk_size, 0u);
+
+  return Repeat([offset = size_t(0), chunk_size]() mutable {
+           size_t at = offset;
+           offset += chunk_size;
+           return at;
+         })
+      >> ConcurrentOrdered(
+             [&file, &loop, chunk_size]() {
+               return Map([&file, &loop, chunk_size](size_t offset) {
+                 return ReadFile(file, chunk_size, offset, loop);
+               });
+             },
+             readahead)
+      // Reads at or past the end of the file return nothing.
+      >> Until([](std::string& data) {
+           return data.empty();
+         });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Like 'ReadFileStream()' above except each chunk is read into a
+// buffer acquired from 'pool' (and is 'pool.buffer_size()' bytes
+// except the last chunk) so that after the pool has warmed up reading
+// the file doesn't allocate.
+//
+// NOTE: 'file' and 'pool' must outlive the stream.
+[[nodiscard]] inline auto ReadFileStream(
+    const File& file,
+    BufferPool& pool,
+    const size_t& readahead = DEFAULT_READAHEAD,
+    EventLoop& loop = EventLoop::Default()) {
+  return Repeat([offset = size_t(0), &pool]() mutable {
+           size_t at = offset;
+           offset += pool.buffer_size();
+           return at;
+         })
+      >> ConcurrentOrdered(
+             [&file, &pool, &loop]() {
+               return Map([&file, &pool, &loop](size_t offset) {
+                 return Closure([&file,
+                                 &loop,
+                                 offset,
+                                 buffer = pool.Acquire()]() mutable {
+                   return ReadFile(file, buffer, offset, loop)
+                       >> Then([&buffer](size_t) {
+                            return std::move(buffer);
+                          });
+                 });
+               });
+             },
+             readahead)
+      >> Until([](BufferPool::Buffer& buffer) {
+           return buffer.size() == 0;
+         });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// When 'WriteFileStream()' should sync the file to disk.
+enum class SyncPolicy {
+  // Leave it up to the operating system.
+  Never,
+  // Once after every chunk has been written.
+  AtEnd,
+  // After writing each chunk (expensive!).
+  EveryChunk,
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns a sink for a stream of chunks (anything with 'data()' and
+// 'size()', e.g., 'std::string' or 'BufferPool::Buffer') that writes
+// each chunk to 'file' one after another starting at 'offset',
+// returning the total number of bytes written.
+//
+// Up to 'write_behind' writes are kept in flight at a time, after
+// which no more chunks are requested from upstream until the oldest
+// write completes.
+//
+// NOTE: 'file' must outlive the sink.
+[[nodiscard]] inline auto WriteFileStream(
+    const File& file,
+    const size_t& offset = 0,
+    const size_t& write_behind = DEFAULT_WRITE_BEHIND,
+    const SyncPolicy& sync = SyncPolicy::AtEnd,
+    EventLoop& loop = EventLoop::Default()) {
+  return Map([offset = offset](auto&& chunk) mutable {
+           size_t at = offset;
+           offset += chunk.size();
+           return std::make_pair(at, std::move(chunk));
+         })
+      >> ConcurrentOrdered(
+             [&file, &loop, sync]() {
+               return Map([&file, &loop, sync](auto&& pair) {
+                 return Closure([&file,
+                                 &loop,
+                                 sync,
+                                 offset = pair.first,
+                                 chunk = std::move(pair.second)]() {
+                   return WriteFile(
+                              file,
+                              chunk.data(),
+                              chunk.size(),
+                              offset,
+                              loop)
+                       >> Then([&file, &loop, sync, size = chunk.size()](
+                                   size_t written) {
+                            return If(written == size)
+                                .no([]() {
+                                  return Raise(RuntimeError("short write"));
+                                })
+                                .yes([&file, &loop, sync, written]() {
+                                  return If(sync == SyncPolicy::EveryChunk)
+                                             .yes([&file, &loop]() {
+                                               return SyncFile(file, loop);
+                                             })
+                                             .no([]() { return Just(); })
+                                      >> Just(written);
+                                });
+                          });
+                 });
+               });
+             },
+             write_behind)
+      >> Reduce(
+             /* written = */ size_t(0),
+             [](size_t& written) {
+               return Then([&](size_t bytes) {
+                 written += bytes;
+                 return true;
+               });
+             })
+      >> Then([&file, &loop, sync](size_t written) {
+           return If(sync == SyncPolicy::AtEnd)
+                      .yes([&file, &loop]() {
+                        return SyncFile(file, loop);
+                      })
+                      .no([]() { return Just(); })
+               >> Just(written);
+         });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#ifndef _WIN32
+
+////////////////////////////////////////////////////////////////////////
+
+// How a file should be mapped, see 'MapFile()'.
+enum class MapMode {
+  // Pages can only be read.
+  ReadOnly,
+  // Pages can be read and written, with writes being carried through
+  // to the file (i.e., 'MAP_SHARED').
+  ReadWrite,
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Hints for how a mapped file will be accessed, see
+// 'MappedFile::Advise()' and 'madvise(2)'.
+enum class MapAdvice {
+  Normal,
+  Sequential,
+  Random,
+  WillNeed,
+  DontNeed,
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// A file (or part of a file) mapped into memory, see 'MapFile()'.
+// Accessing the file via the mapping avoids copying into (and
+// duplicating the page cache in) heap memory, which makes it a good
+// fit for large read-mostly files.
+//
+// NOTE: the first access of a page that isn't yet resident blocks
+// the accessing thread until it's read from disk, so don't touch a
+// mapping from an event loop without first prefaulting it, see
+// 'PrefaultMappedFile()'.
+//
+// Moveable, not Copyable.
+class MappedFile final {
+ public:
+  MappedFile() = default;
+
+  MappedFile(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& that) noexcept
+    : data_(that.data_),
+      size_(that.size_) {
+    that.data_ = nullptr;
+    that.size_ = 0;
+  }
+
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile& operator=(MappedFile&& that) noexcept {
+    if (this == &that) {
+      return *this;
+    }
+
+    Unmap();
+
+    data_ = that.data_;
+    size_ = that.size_;
+
+    that.data_ = nullptr;
+    that.size_ = 0;
+
+    return *this;
+  }
+
+  ~MappedFile() {
+    Unmap();
+  }
+
+  // NOTE: only writeable if mapped with 'MapMode::ReadWrite'.
+  char* data() noexcept {
+    return data_;
+  }
+
+  const char* data() const noexcept {
+    return data_;
+  }
+
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  std::string_view view() const noexcept {
+    return std::string_view(data_, size_);
+  }
+
+  // Tells the kernel how 'size' bytes starting at 'offset' will be
+  // accessed, returning false if the advice is invalid for the
+  // mapping. This never blocks, e.g., 'MapAdvice::WillNeed' only
+  // starts asynchronous readahead.
+  bool Advise(
+      MapAdvice advice,
+      size_t offset = 0,
+      size_t size = std::string_view::npos) {
+    if (offset >= size_) {
+      return size_ == 0;
+    }
+
+    // 'madvise()' requires a page aligned address.
+    const size_t aligned = offset - (offset % PageSize());
+
+    size = std::min(size, size_ - offset) + (offset - aligned);
+
+    int flags = MADV_NORMAL;
+    switch (advice) {
+      case MapAdvice::Normal:
+        flags = MADV_NORMAL;
+        break;
+      case MapAdvice::Sequential:
+        flags = MADV_SEQUENTIAL;
+        break;
+      case MapAdvice::Random:
+        flags = MADV_RANDOM;
+        break;
+      case MapAdvice::WillNeed:
+        flags = MADV_WILLNEED;
+        break;
+      case MapAdvice::DontNeed:
+        flags = MADV_DONTNEED;
+        break;
+    }
+
+    return madvise(data_ + aligned, size, flags) == 0;
+  }
+
+  static size_t PageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+  }
+
+ private:
+  friend struct _MapFile;
+
+  MappedFile(char* data, size_t size)
+    : data_(data),
+      size_(size) {}
+
+  void Unmap() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+struct _MapFile final {
+  // Returns 0 on success or 'errno' otherwise. Expected to be called
+  // from libuv's threadpool since it may block.
+  static int Map(
+      int fd,
+      const MapMode& mode,
+      const bool& prefault,
+      MappedFile& mapped) {
+    struct stat stat;
+    if (fstat(fd, &stat) != 0) {
+      return errno;
+    }
+
+    // NOTE: can't 'mmap()' zero bytes, an empty file is just an empty
+    // mapping.
+    if (stat.st_size == 0) {
+      return 0;
+    }
+
+    const int protection = mode == MapMode::ReadWrite
+        ? PROT_READ | PROT_WRITE
+        : PROT_READ;
+
+    void* data = mmap(
+        nullptr,
+        stat.st_size,
+        protection,
+        MAP_SHARED,
+        fd,
+        0);
+
+    if (data == MAP_FAILED) {
+      return errno;
+    }
+
+    mapped = MappedFile(static_cast<char*>(data), stat.st_size);
+
+    if (prefault) {
+      Prefault(mapped);
+    }
+
+    return 0;
+  }
+
+  // Faults in every page of 'mapped' (blocking until they've been
+  // read from disk if necessary). Expected to be called from libuv's
+  // threadpool since it may block.
+  static void Prefault(const MappedFile& mapped) {
+#ifdef MADV_POPULATE_READ
+    if (madvise(
+            const_cast<char*>(mapped.data()),
+            mapped.size(),
+            MADV_POPULATE_READ)
+        == 0) {
+      return;
+    }
+#endif
+
+    // Fall back to touching each page ourselves.
+    const volatile char* data = mapped.data();
+    for (size_t i = 0; i < mapped.size(); i += MappedFile::PageSize()) {
+      (void) data[i];
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Maps all of 'file' into memory, returning a 'MappedFile' which
+// remains valid even after 'file' has been closed.
+//
+// The mapping is performed on libuv's threadpool and if 'prefault' is
+// true every page is also faulted in there so that accessing the
+// mapping afterwards never blocks on disk I/O (at least until the
+// kernel decides to evict the pages again).
+[[nodiscard]] inline auto MapFile(
+    const File& file,
+    const MapMode& mode = MapMode::ReadOnly,
+    const bool& prefault = false,
+    EventLoop& loop = EventLoop::Default()) {
+  struct Data {
+    EventLoop& loop;
+    const File& file;
+    MapMode mode;
+    bool prefault;
+
+    uv_work_t work = {};
+    int error = 0;
+    MappedFile mapped;
+
+    void* k = nullptr;
+  };
+
+  return loop.Schedule(
+      "MapFile",
+      Eventual<MappedFile>()
+          .raises<RuntimeError>()
+          .context(Data{loop, file, mode, prefault})
+          .start([](Data& data, auto& k) mutable {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+            data.work.data = &data;
+
+            auto error = uv_queue_work(
+                data.loop,
+                &data.work,
+                [](uv_work_t* work) {
+                  auto& data = *static_cast<Data*>(work->data);
+                  data.error = _MapFile::Map(
+                      data.file,
+                      data.mode,
+                      data.prefault,
+                      data.mapped);
+                },
+                [](uv_work_t* work, int status) {
+                  auto& data = *static_cast<Data*>(work->data);
+                  auto& k = *static_cast<K*>(data.k);
+                  if (status != 0) {
+                    k.Fail(RuntimeError(uv_strerror(status)));
+                  } else if (data.error != 0) {
+                    k.Fail(RuntimeError(uv_strerror(-data.error)));
+                  } else {
+                    k.Start(std::move(data.mapped));
+                  }
+                });
+
+            if (error) {
+              static_cast<K*>(data.k)->Fail(
+                  RuntimeError(uv_strerror(error)));
+            }
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Faults in every page of 'mapped' on libuv's threadpool so that the
+// next access of the mapping (e.g., from an event loop) doesn't block
+// on disk I/O.
+//
+// NOTE: 'mapped' must outlive the eventual.
+[[nodiscard]] inline auto PrefaultMappedFile(
+    const MappedFile& mapped,
+    EventLoop& loop = EventLoop::Default()) {
+  struct Data {
+    EventLoop& loop;
+    const MappedFile& mapped;
+
+    uv_work_t work = {};
+
+    void* k = nullptr;
+  };
+
+  return loop.Schedule(
+      "PrefaultMappedFile",
+      Eventual<void>()
+          .raises<RuntimeError>()
+          .context(Data{loop, mapped})
+          .start([](Data& data, auto& k) mutable {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+            data.work.data = &data;
+
+            auto error = uv_queue_work(
+                data.loop,
+                &data.work,
+                [](uv_work_t* work) {
+                  auto& data = *static_cast<Data*>(work->data);
+                  _MapFile::Prefault(data.mapped);
+                },
+                [](uv_work_t* work, int status) {
+                  auto& data = *static_cast<Data*>(work->data);
+                  auto& k = *static_cast<K*>(data.k);
+                  if (status != 0) {
+                    k.Fail(RuntimeError(uv_strerror(status)));
+                  } else {
+                    k.Start();
+                  }
+                });
+
+            if (error) {
+              static_cast<K*>(data.k)->Fail(
+                  RuntimeError(uv_strerror(error)));
+            }
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns a stream of consecutive views of (at most) 'chunk_size'
+// bytes of 'mapped', by default a page at a time. Each view is only
+// valid as long as 'mapped' is.
+//
+// NOTE: no copies are made, but the first access of each page may
+// block if it's not resident, see 'PrefaultMappedFile()'.
+[[nodiscard]] inline auto IteratePages(
+    const MappedFile& mapped,
+    const size_t& chunk_size = MappedFile::PageSize()) {
+  CHECK_GT(chunk_size, 0u);
+
+  const size_t chunks = (mapped.size() + chunk_size - 1) / chunk_size;
+
+  CHECK_LE(chunks, static_cast<size_t>(std::numeric_limits<int>::max()))
+      << "Too many chunks, try a bigger 'chunk_size'";
+
+  return Range(static_cast<int>(chunks))
+      >> Map([&mapped, chunk_size](int i) {
+           return mapped.view().substr(i * chunk_size, chunk_size);
+         });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#endif // _WIN32
+
+////////////////////////////////////////////////////////////////////////
+
 } // namespace filesystem
 } // namespace eventuals
 
@@ -27,10 +27,16 @@ struct _FlatMap final {
 
     void Ended() {
       CHECK(streamforeach_->adapted_.has_value());
-      streamforeach_->adapted_.reset();
       CHECK(streamforeach_->inner_ != nullptr);
       streamforeach_->inner_ = nullptr;
 
+      // NOTE: we don't destruct 'adapted_' here because we're most
+      // likely still executing within it, e.g., continuing on the
+      // context of an 'EventLoop::Schedule()' which waits for that
+      // context to be relinquished before it can be destructed (which
+      // would deadlock). Instead it gets destructed once we start the
+      // next inner stream or we get destructed.
+
       if (streamforeach_->done_) {
         streamforeach_->outer_->Done();
       } else {
@@ -90,7 +96,9 @@ struct _FlatMap final {
 
     template <typename... Args>
     void Body(Args&&... args) {
-      CHECK(!adapted_.has_value());
+      CHECK(inner_ == nullptr);
+
+      adapted_.reset();
 
       adapted_.emplace(
           f_(std::forward<Args>(args)...)
@@ -104,14 +112,14 @@ struct _FlatMap final {
     }
 
     void Ended() {
-      CHECK(!adapted_.has_value());
+      CHECK(inner_ == nullptr);
       k_.Ended();
     }
 
     void Next() override {
       previous_->Continue([this]() {
-        if (adapted_.has_value()) {
-          CHECK_NOTNULL(inner_)->Next();
+        if (inner_ != nullptr) {
+          inner_->Next();
         } else {
           outer_->Next();
         }
@@ -121,8 +129,8 @@ struct _FlatMap final {
     void Done() override {
       previous_->Continue([this]() {
         done_ = true;
-        if (adapted_.has_value()) {
-          CHECK_NOTNULL(inner_)->Done();
+        if (inner_ != nullptr) {
+          inner_->Done();
         } else {
           outer_->Done();
         }
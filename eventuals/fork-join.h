@@ -282,8 +282,10 @@ struct _ForkJoin final {
 
           // Clone the current scheduler context for running the eventual.
           fiber.context.emplace(
-              Scheduler::Context::Get()->name()
-              + " [ForkJoin - " + name_ + " - " + std::to_string(index) + "]");
+              Scheduler::Context::Get()->name().Derive(
+                  "ForkJoin",
+                  name_,
+                  index));
 
           fiber.context->scheduler()->Submit(
               [&]() {
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <memory>
 #include <optional>
 #include <tuple>
 #include <variant>
@@ -10,6 +9,7 @@
 #include "eventuals/task.h"
 #include "eventuals/terminal.h"
 #include "eventuals/then.h"
+#include "eventuals/type-erased-storage.h"
 #include "eventuals/type-traits.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -193,6 +193,10 @@ struct _Generator final {
     Fail = 2,
   };
 
+  // See comment on '_TaskFromToWith::Storage', always using the
+  // default 'TYPE_ERASED_INLINE_SIZE'.
+  using Storage = TypeErasedStorage<TYPE_ERASED_INLINE_SIZE>;
+
   // Using templated type name to allow using both
   // in 'Composable' and 'Continuation'.
   template <
@@ -214,7 +218,7 @@ struct _Generator final {
                   std::is_void_v<From>,
                   std::monostate,
                   From>>&&,
-          std::unique_ptr<void, Callback<void(void*)>>&,
+          Storage&,
           Interrupt&,
           GeneratorBeginCallback&&,
           GeneratorFailCallback<Raises>&&,
@@ -330,7 +334,7 @@ struct _Generator final {
 
     DispatchCallback<From_, To_, Catches_, Raises_, Args_...> dispatch_;
 
-    std::unique_ptr<void, Callback<void(void*)>> e_;
+    Storage e_;
     Interrupt* interrupt_ = nullptr;
 
     // NOTE: we store 'k_' as the _last_ member so it will be
@@ -460,7 +464,7 @@ struct _Generator final {
                               std::is_void_v<From_>,
                               std::monostate,
                               From_>>&& arg,
-                      std::unique_ptr<void, Callback<void(void*)>>& e_,
+                      Storage& e_,
                       Interrupt& interrupt,
                       GeneratorBeginCallback&& begin,
                       GeneratorFailCallback<Raises_>&& fail,
@@ -468,21 +472,15 @@ struct _Generator final {
                       GeneratorBodyCallback<To_>&& body,
                       GeneratorEndedCallback&& ended) mutable {
         if (!e_) {
-          e_ = std::unique_ptr<void, Callback<void(void*)>>(
-              new HeapGenerator<
+          e_.Emplace<
+              HeapGenerator<
                   E,
                   From_,
                   To_,
                   Catches_,
-                  Raises_>(f(args...)),
-              [](void* e) {
-                delete static_cast<HeapGenerator<
-                    E,
-                    From_,
-                    To_,
-                    Catches_,
-                    Raises_>*>(e);
-              });
+                  Raises_>>(
+              Scheduler::Context::Get()->allocator(),
+              f(args...));
         }
 
         auto* e = static_cast<
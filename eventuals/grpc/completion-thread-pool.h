@@ -7,6 +7,7 @@
 
 #include "eventuals/callback.h"
 #include "eventuals/os.h"
+#include "eventuals/scheduler-metrics.h"
 #include "eventuals/semaphore.h"
 #include "grpcpp/completion_queue.h"
 #include "stout/borrowable.h"
@@ -106,21 +107,41 @@ class StaticCompletionThreadPool
         << "\n";
 
     cqs_.emplace_back(std::move(cq));
+    SchedulerMetrics& metrics =
+        metrics_.emplace_back(number_of_threads_per_completion_queue_);
     for (size_t i = 0;
          i < number_of_threads_per_completion_queue_;
          ++i) {
       threads_.emplace_back(
-          [cq = cqs_.back().get()]() {
+          [cq = cqs_.back().get(), metrics = &metrics, i]() {
             void* tag = nullptr;
             bool ok = false;
             while (cq->Next(&tag, &ok)) {
+              metrics->RecordWakeup(i);
+              auto start = SchedulerMetrics::Now();
               (*static_cast<Callback<void(bool)>*>(tag))(ok);
+              metrics->RecordRun(i, start, SchedulerMetrics::Now());
             }
           },
           "grpc comp. q.");
     }
   }
 
+  // Returns the metrics for every thread of every completion queue
+  // (in the order the completion queues were added). Since gRPC owns
+  // the completion queues only wakeups (i.e., completions) and the
+  // time spent running callbacks are recorded.
+  SchedulerMetrics::Snapshot metrics() const {
+    SchedulerMetrics::Snapshot snapshot;
+    for (const SchedulerMetrics& metrics : metrics_) {
+      for (const SchedulerMetrics::Worker& worker :
+           metrics.snapshot().workers) {
+        snapshot.workers.push_back(worker);
+      }
+    }
+    return snapshot;
+  }
+
   size_t NumberOfCompletionQueues() override {
     return cqs_.size();
   }
@@ -148,6 +169,10 @@ class StaticCompletionThreadPool
  private:
   std::deque<stout::Borrowable<std::unique_ptr<CompletionQueue>>> cqs_;
 
+  // NOTE: using a 'std::deque' so that threads can keep a pointer to
+  // their metrics as more completion queues get added.
+  std::deque<SchedulerMetrics> metrics_;
+
   size_t number_of_threads_per_completion_queue_ = 1;
 
   std::vector<os::Thread> threads_;
@@ -1,12 +1,17 @@
 #pragma once
 
+#include "eventuals/logging.h"
 #include "glog/logging.h"
 
 inline bool EventualsGrpcLog(int level) {
   // TODO(benh): Initialize logging if it hasn't already been done so?
-  static const char* variable = std::getenv("EVENTUALS_GRPC_LOG");
-  static int value = variable != nullptr ? atoi(variable) : 0;
-  return value >= level;
+  static const int value = []() {
+    const char* variable = std::getenv("EVENTUALS_GRPC_LOG");
+    return variable != nullptr ? atoi(variable) : 0;
+  }();
+  return EVENTUALS_UNLIKELY(value >= level);
 }
 
-#define EVENTUALS_GRPC_LOG(level) LOG_IF(INFO, EventualsGrpcLog(level))
+// NOTE: also compiled out above 'EVENTUALS_MAX_LOG_LEVEL'.
+#define EVENTUALS_GRPC_LOG(level) \
+  LOG_IF(INFO, (level) <= EVENTUALS_MAX_LOG_LEVEL && EventualsGrpcLog(level))
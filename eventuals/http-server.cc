@@ -0,0 +1,1246 @@
+#include "eventuals/http-server.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "glog/logging.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+namespace http {
+
+////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////
+
+// Max length of a chunk size line (including any extensions).
+constexpr size_t MAX_CHUNK_SIZE_LINE = 1024;
+
+////////////////////////////////////////////////////////////////////////
+
+std::string_view Reason(int code) {
+  switch (code) {
+    case 100:
+      return "Continue";
+    case 200:
+      return "OK";
+    case 201:
+      return "Created";
+    case 202:
+      return "Accepted";
+    case 204:
+      return "No Content";
+    case 301:
+      return "Moved Permanently";
+    case 302:
+      return "Found";
+    case 304:
+      return "Not Modified";
+    case 400:
+      return "Bad Request";
+    case 401:
+      return "Unauthorized";
+    case 403:
+      return "Forbidden";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    case 408:
+      return "Request Timeout";
+    case 411:
+      return "Length Required";
+    case 413:
+      return "Payload Too Large";
+    case 429:
+      return "Too Many Requests";
+    case 431:
+      return "Request Header Fields Too Large";
+    case 500:
+      return "Internal Server Error";
+    case 501:
+      return "Not Implemented";
+    case 503:
+      return "Service Unavailable";
+    case 505:
+      return "HTTP Version Not Supported";
+    default:
+      return "Unknown";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns the status line and headers of a response.
+std::string Head(
+    int code,
+    const Headers& headers,
+    const _HttpServer::Connection::Outgoing& outgoing,
+    std::optional<size_t> content_length) {
+  std::string head = outgoing.http_1_0 ? "HTTP/1.0 " : "HTTP/1.1 ";
+
+  head += std::to_string(code);
+  head += ' ';
+  head += Reason(code);
+  head += "\r\n";
+
+  for (const auto& [name, value] : headers) {
+    // We determine the framing (and whether or not the connection is
+    // kept alive) ourselves.
+    if (absl::EqualsIgnoreCase(name, "content-length")
+        || absl::EqualsIgnoreCase(name, "transfer-encoding")
+        || absl::EqualsIgnoreCase(name, "connection")) {
+      continue;
+    }
+    head += name;
+    head += ": ";
+    head += value;
+    head += "\r\n";
+  }
+
+  if (content_length) {
+    head += "Content-Length: ";
+    head += std::to_string(*content_length);
+    head += "\r\n";
+  }
+
+  if (outgoing.chunked) {
+    head += "Transfer-Encoding: chunked\r\n";
+  }
+
+  if (outgoing.close) {
+    head += "Connection: close\r\n";
+  } else if (outgoing.http_1_0) {
+    head += "Connection: keep-alive\r\n";
+  }
+
+  head += "\r\n";
+
+  return head;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns true if 'value' (e.g., of a 'Connection' header) contains
+// 'token' in its comma separated list (case-insensitive).
+bool HasToken(std::string_view value, std::string_view token) {
+  while (!value.empty()) {
+    size_t comma = value.find(',');
+    std::string_view element = absl::StripAsciiWhitespace(
+        value.substr(0, comma));
+    if (absl::EqualsIgnoreCase(element, token)) {
+      return true;
+    }
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    value.remove_prefix(comma + 1);
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Parses a non-negative decimal (or hexadecimal) number, returning
+// false if 'value' is empty, contains anything else, or overflows.
+bool ParseSize(std::string_view value, int base, size_t& size) {
+  if (value.empty()) {
+    return false;
+  }
+
+  size = 0;
+
+  for (char c : value) {
+    size_t digit = 0;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (base == 16 && c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (base == 16 && c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      return false;
+    }
+
+    if (size > (std::numeric_limits<size_t>::max() - digit) / base) {
+      return false;
+    }
+
+    size = size * base + digit;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Data being written along with the 'uv_write_t' (inside of
+// '_Tcp::Stream::Write') which must remain at the same address until
+// the write completes.
+struct Sending final {
+  BufferChain data;
+  _Tcp::Stream::Write write;
+  Callback<void(const char*)> callback;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////
+
+std::optional<std::string_view> Server::Request::header(
+    std::string_view name) const {
+  auto iterator = headers_.find(absl::AsciiStrToLower(name));
+  if (iterator != headers_.end()) {
+    return std::string_view(iterator->second);
+  } else {
+    return std::nullopt;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int Server::Request::Parse(std::string_view head, Request& request) {
+  size_t end = head.find("\r\n");
+
+  std::string_view line = head.substr(0, end);
+
+  // Request line, i.e., 'METHOD SP TARGET SP VERSION'.
+  size_t first = line.find(' ');
+  size_t second = first == std::string_view::npos
+      ? std::string_view::npos
+      : line.find(' ', first + 1);
+
+  if (first == 0
+      || second == std::string_view::npos
+      || second == first + 1
+      || second == line.size() - 1) {
+    return 400;
+  }
+
+  request.method_ = line.substr(0, first);
+  request.target_ = line.substr(first + 1, second - first - 1);
+  request.version_ = line.substr(second + 1);
+
+  if (request.version_ != "HTTP/1.1" && request.version_ != "HTTP/1.0") {
+    return request.version_.rfind("HTTP/", 0) == 0 ? 505 : 400;
+  }
+
+  // Headers, i.e., 'NAME ":" OWS VALUE OWS'.
+  for (size_t start = end + 2; start < head.size(); start = end + 2) {
+    end = head.find("\r\n", start);
+
+    line = head.substr(start, end - start);
+
+    size_t colon = line.find(':');
+
+    // NOTE: we don't support obsolete line folding (i.e., a line
+    // starting with whitespace) nor whitespace before the colon.
+    if (colon == 0
+        || colon == std::string_view::npos
+        || absl::ascii_isspace(line[0])
+        || absl::ascii_isspace(line[colon - 1])) {
+      return 400;
+    }
+
+    std::string name = absl::AsciiStrToLower(line.substr(0, colon));
+    std::string_view value = absl::StripAsciiWhitespace(
+        line.substr(colon + 1));
+
+    auto [iterator, inserted] = request.headers_.emplace(
+        std::move(name),
+        std::string(value));
+
+    if (!inserted) {
+      iterator->second += ", ";
+      iterator->second += value;
+    }
+  }
+
+  const bool http_1_0 = request.version_ == "HTTP/1.0";
+
+  std::optional<std::string_view> connection = request.header("connection");
+
+  request.keep_alive_ = http_1_0
+      ? connection && HasToken(*connection, "keep-alive")
+      : !connection || !HasToken(*connection, "close");
+
+  std::optional<std::string_view> transfer_encoding =
+      request.header("transfer-encoding");
+
+  std::optional<std::string_view> content_length =
+      request.header("content-length");
+
+  if (transfer_encoding) {
+    // NOTE: rejecting requests with both since they're ambiguous
+    // (and a common means of request smuggling).
+    if (content_length) {
+      return 400;
+    } else if (!absl::EqualsIgnoreCase(*transfer_encoding, "chunked")) {
+      return 501;
+    }
+    request.chunked_ = true;
+  } else if (content_length) {
+    size_t size = 0;
+    if (!ParseSize(*content_length, 10, size)) {
+      return 400;
+    }
+    request.content_length_ = size;
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+_HttpServer::Transaction::~Transaction() {
+  if (!finished.load()) {
+    connection->Abandon(sequence);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+_HttpServer::Connection::Connection(State* server, _Tcp::Stream* stream)
+  : loop(server->loop),
+    server(server),
+    stream(CHECK_NOTNULL(stream)) {}
+
+////////////////////////////////////////////////////////////////////////
+
+_HttpServer::Connection::~Connection() {
+  CHECK(closed) << "destructing a connection that hasn't been closed";
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Start() {
+  CHECK_EQ(
+      0,
+      uv_async_init(loop, &async, [](uv_async_t* handle) {
+        auto& connection = *static_cast<Connection*>(handle->data);
+
+        std::vector<uint64_t> abandoned;
+
+        {
+          std::lock_guard<std::mutex> lock(connection.mutex);
+          abandoned.swap(connection.abandoned);
+        }
+
+        for (uint64_t sequence : abandoned) {
+          if (connection.closed) {
+            return;
+          }
+
+          auto iterator = connection.outgoing.find(sequence);
+
+          if (iterator != connection.outgoing.end()
+              && !iterator->second.finished) {
+            // We can still tell the client something went wrong if
+            // nothing has been sent yet, otherwise we've sent a
+            // partial response and all we can do is close.
+            if (!iterator->second.started) {
+              connection.Fail(sequence, 500);
+            } else {
+              connection.Close();
+            }
+          }
+        }
+      }));
+
+  async.data = this;
+
+  Read();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Read() {
+  if (reading || eof || closed) {
+    return;
+  }
+
+  reading = true;
+
+  stream->StartReading([this](ssize_t nread) {
+    reading = false;
+
+    if (nread == UV_ECANCELED) {
+      // We're being closed.
+      return;
+    } else if (nread < 0) {
+      Close();
+      return;
+    } else if (nread == 0) {
+      eof = true;
+    } else {
+      input.append(stream->buffer.get(), nread);
+    }
+
+    Process();
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Process() {
+  // NOTE: processing may end up calling back into us, e.g., a handler
+  // that responds immediately, so rather than recursing we process
+  // again after we're done.
+  if (processing) {
+    again = true;
+    return;
+  }
+
+  // Keep ourselves alive in case we get closed while processing.
+  std::shared_ptr<Connection> self = shared_from_this();
+
+  processing = true;
+
+  do {
+    again = false;
+    ProcessOnce();
+  } while (again && !closed);
+
+  processing = false;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::ProcessOnce() {
+  if (closed) {
+    return;
+  }
+
+  while (body.active && (body.reader || body.discard)) {
+    std::string chunk;
+
+    switch (DecodeBody(chunk)) {
+      case Decoded::Chunk:
+        if (body.reader) {
+          auto reader = std::move(body.reader);
+          reader(nullptr, std::move(chunk));
+        }
+        break;
+      case Decoded::Done:
+        body.active = false;
+        body.discard = false;
+        if (body.reader) {
+          auto reader = std::move(body.reader);
+          reader(nullptr, std::move(chunk));
+        }
+        break;
+      case Decoded::More:
+        if (eof) {
+          if (body.reader) {
+            auto reader = std::move(body.reader);
+            reader("unexpected end of stream", std::string());
+          }
+          Close();
+        } else {
+          Read();
+        }
+        return;
+      case Decoded::Error:
+        if (body.reader) {
+          auto reader = std::move(body.reader);
+          reader("invalid chunked encoding", std::string());
+        }
+        Close();
+        return;
+    }
+
+    if (closed) {
+      return;
+    }
+  }
+
+  if (body.active) {
+    // Waiting for the body to be read (or responded to).
+    return;
+  }
+
+  if (stopped) {
+    if (eof && outgoing.empty()) {
+      Close();
+    }
+    return;
+  }
+
+  if (server == nullptr
+      || requests - responding >= server->options.max_pipelined_requests) {
+    // Continue after responding to earlier requests, see 'Advance()'.
+    return;
+  }
+
+  Parse();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Parse() {
+  // Ignore any empty lines before a request.
+  size_t start = 0;
+  while (input.compare(start, 2, "\r\n") == 0) {
+    start += 2;
+  }
+  input.erase(0, start);
+
+  const size_t max_header_size = server->options.max_header_size;
+
+  size_t end = input.find("\r\n\r\n");
+
+  if (end == std::string::npos || end + 4 > max_header_size) {
+    if (input.size() > max_header_size) {
+      uint64_t sequence = requests++;
+      outgoing[sequence];
+      Fail(sequence, 431);
+    } else if (eof) {
+      // NOTE: any partial request is discarded.
+      stopped = true;
+      again = true;
+    } else {
+      Read();
+    }
+    return;
+  }
+
+  Server::Request request;
+
+  int code = Server::Request::Parse(
+      std::string_view(input).substr(0, end + 2),
+      request);
+
+  input.erase(0, end + 4);
+
+  uint64_t sequence = requests++;
+
+  Outgoing& response = outgoing[sequence];
+  response.http_1_0 = request.version_ == "HTTP/1.0";
+  response.omit_body = request.method_ == "HEAD";
+  response.close = !request.keep_alive_;
+
+  if (code != 0) {
+    Fail(sequence, code);
+    return;
+  }
+
+  if (!request.keep_alive_) {
+    stopped = true;
+  }
+
+  if (request.chunked_) {
+    body.active = true;
+    body.sequence = sequence;
+    body.state = Body::State::ChunkSize;
+    body.discard = false;
+  } else if (request.content_length_.value_or(0) > 0) {
+    body.active = true;
+    body.sequence = sequence;
+    body.state = Body::State::Length;
+    body.remaining = *request.content_length_;
+    body.discard = false;
+  }
+
+  server->Dispatch(std::make_shared<Transaction>(
+      shared_from_this(),
+      sequence,
+      std::move(request)));
+
+  again = true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+_HttpServer::Connection::Decoded _HttpServer::Connection::DecodeBody(
+    std::string& chunk) {
+  while (true) {
+    switch (body.state) {
+      case Body::State::Length:
+      case Body::State::ChunkData: {
+        if (input.empty()) {
+          return Decoded::More;
+        }
+
+        size_t size = std::min(body.remaining, input.size());
+
+        chunk.assign(input, 0, size);
+        input.erase(0, size);
+
+        body.remaining -= size;
+
+        if (body.state == Body::State::Length) {
+          return body.remaining == 0 ? Decoded::Done : Decoded::Chunk;
+        }
+
+        if (body.remaining == 0) {
+          body.state = Body::State::ChunkDataEnd;
+        }
+
+        return Decoded::Chunk;
+      }
+
+      case Body::State::ChunkSize: {
+        size_t end = input.find("\r\n");
+
+        if (end == std::string::npos) {
+          return input.size() > MAX_CHUNK_SIZE_LINE
+              ? Decoded::Error
+              : Decoded::More;
+        }
+
+        // NOTE: ignoring any chunk extensions.
+        std::string_view line = std::string_view(input).substr(0, end);
+        line = absl::StripTrailingAsciiWhitespace(
+            line.substr(0, line.find(';')));
+
+        size_t size = 0;
+
+        if (!ParseSize(line, 16, size)) {
+          return Decoded::Error;
+        }
+
+        input.erase(0, end + 2);
+
+        if (size == 0) {
+          body.state = Body::State::Trailers;
+        } else {
+          body.state = Body::State::ChunkData;
+          body.remaining = size;
+        }
+
+        break;
+      }
+
+      case Body::State::ChunkDataEnd: {
+        if (input.size() < 2) {
+          return Decoded::More;
+        } else if (input.compare(0, 2, "\r\n") != 0) {
+          return Decoded::Error;
+        }
+
+        input.erase(0, 2);
+
+        body.state = Body::State::ChunkSize;
+
+        break;
+      }
+
+      case Body::State::Trailers: {
+        size_t end = input.find("\r\n");
+
+        if (end == std::string::npos) {
+          return input.size() > server->options.max_header_size
+              ? Decoded::Error
+              : Decoded::More;
+        }
+
+        // NOTE: ignoring any trailers.
+        input.erase(0, end + 2);
+
+        if (end == 0) {
+          return Decoded::Done;
+        }
+
+        break;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Respond(
+    Transaction& transaction,
+    int code,
+    Headers&& headers,
+    BufferChain&& body,
+    Callback<void(const char*)>&& callback) {
+  auto iterator = outgoing.find(transaction.sequence);
+
+  if (closed || iterator == outgoing.end()) {
+    transaction.finished.store(true);
+    callback("connection closed");
+    return;
+  }
+
+  Outgoing& response = iterator->second;
+
+  if (response.started) {
+    callback("response already started");
+    return;
+  }
+
+  response.started = true;
+
+  BufferChain data;
+  data.Append(Head(code, headers, response, body.size()));
+
+  if (!response.omit_body) {
+    data.Append(std::move(body));
+  }
+
+  transaction.finished.store(true);
+
+  Send(
+      transaction.sequence,
+      std::move(data),
+      /* last = */ true,
+      std::move(callback));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Begin(
+    Transaction& transaction,
+    int code,
+    Headers&& headers,
+    Callback<void(const char*)>&& callback) {
+  auto iterator = outgoing.find(transaction.sequence);
+
+  if (closed || iterator == outgoing.end()) {
+    transaction.finished.store(true);
+    callback("connection closed");
+    return;
+  }
+
+  Outgoing& response = iterator->second;
+
+  if (response.started) {
+    callback("response already started");
+    return;
+  }
+
+  response.started = true;
+
+  // HTTP/1.0 doesn't support chunked encoding so instead the end of
+  // the body is the end of the connection.
+  if (response.http_1_0) {
+    response.close = true;
+    stopped = true;
+  } else {
+    response.chunked = true;
+  }
+
+  BufferChain data;
+  data.Append(Head(code, headers, response, std::nullopt));
+
+  Send(
+      transaction.sequence,
+      std::move(data),
+      /* last = */ false,
+      std::move(callback));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Write(
+    Transaction& transaction,
+    BufferChain&& data,
+    Callback<void(const char*)>&& callback) {
+  auto iterator = outgoing.find(transaction.sequence);
+
+  if (closed || iterator == outgoing.end()) {
+    transaction.finished.store(true);
+    callback("connection closed");
+    return;
+  }
+
+  Outgoing& response = iterator->second;
+
+  if (!response.started || response.finished) {
+    callback("response not started (or already ended)");
+    return;
+  }
+
+  // NOTE: can't send an empty chunk since that ends the body.
+  if (response.omit_body || data.empty()) {
+    callback(nullptr);
+    return;
+  }
+
+  BufferChain chunk;
+
+  if (response.chunked) {
+    char size[32];
+    std::snprintf(size, sizeof(size), "%zx\r\n", data.size());
+    chunk.Append(std::string(size));
+    chunk.Append(std::move(data));
+    chunk.AppendUnowned("\r\n");
+  } else {
+    chunk = std::move(data);
+  }
+
+  Send(
+      transaction.sequence,
+      std::move(chunk),
+      /* last = */ false,
+      std::move(callback));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::End(
+    Transaction& transaction,
+    Callback<void(const char*)>&& callback) {
+  auto iterator = outgoing.find(transaction.sequence);
+
+  if (closed || iterator == outgoing.end()) {
+    transaction.finished.store(true);
+    callback("connection closed");
+    return;
+  }
+
+  Outgoing& response = iterator->second;
+
+  if (!response.started || response.finished) {
+    callback("response not started (or already ended)");
+    return;
+  }
+
+  BufferChain data;
+
+  if (response.chunked && !response.omit_body) {
+    data.AppendUnowned("0\r\n\r\n");
+  }
+
+  transaction.finished.store(true);
+
+  Send(
+      transaction.sequence,
+      std::move(data),
+      /* last = */ true,
+      std::move(callback));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::ReadBody(
+    Transaction& transaction,
+    Callback<void(const char*, std::string&&)>&& callback) {
+  if (closed) {
+    callback("connection closed", std::string());
+    return;
+  }
+
+  if (!body.active || body.sequence != transaction.sequence) {
+    // No (more) body.
+    callback(nullptr, std::string());
+    return;
+  }
+
+  CHECK(!body.reader) << "already reading the body";
+
+  body.reader = std::move(callback);
+
+  Process();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Send(
+    uint64_t sequence,
+    BufferChain&& data,
+    bool last,
+    Callback<void(const char*)>&& callback) {
+  auto iterator = outgoing.find(sequence);
+
+  CHECK(iterator != outgoing.end());
+
+  Outgoing& response = iterator->second;
+
+  if (last) {
+    response.finished = true;
+
+    // Discard the rest of the body (if any) so we can continue
+    // reading requests.
+    if (body.active && body.sequence == sequence) {
+      body.discard = true;
+    }
+  }
+
+  if (sequence == responding) {
+    Flush(std::move(data), std::move(callback));
+    if (last) {
+      Advance();
+    }
+  } else {
+    // Wait for earlier responses to be sent first.
+    response.pending.Append(data);
+    if (callback) {
+      callback(nullptr);
+    }
+  }
+
+  if (last) {
+    Process();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Flush(
+    BufferChain&& data,
+    Callback<void(const char*)>&& callback) {
+  if (closed) {
+    if (callback) {
+      callback("connection closed");
+    }
+    return;
+  }
+
+  auto* sending = new Sending{std::move(data), {}, std::move(callback)};
+
+  sending->write.buffers = sending->data.buffers().data();
+  sending->write.count = sending->data.buffers().size();
+  sending->write.callback = [sending](int status) {
+    Callback<void(const char*)> callback = std::move(sending->callback);
+    delete sending;
+    if (callback) {
+      callback(status == 0 ? nullptr : uv_strerror(status));
+    }
+  };
+
+  stream->Add(&sending->write);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Fail(uint64_t sequence, int code) {
+  Outgoing& response = outgoing[sequence];
+
+  response.started = true;
+  response.close = true;
+  response.chunked = false;
+
+  stopped = true;
+
+  BufferChain data;
+  data.Append(Head(code, Headers(), response, /* content_length = */ 0));
+
+  Send(
+      sequence,
+      std::move(data),
+      /* last = */ true,
+      Callback<void(const char*)>());
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Advance() {
+  while (!closed) {
+    auto iterator = outgoing.find(responding);
+
+    CHECK(iterator != outgoing.end());
+    CHECK(iterator->second.finished);
+
+    const bool close = iterator->second.close;
+
+    outgoing.erase(iterator);
+
+    responding++;
+
+    if (close) {
+      stopped = true;
+      // Close once everything has been written.
+      Flush(BufferChain(), [this](const char*) {
+        Close();
+      });
+      return;
+    }
+
+    iterator = outgoing.find(responding);
+
+    if (iterator == outgoing.end()) {
+      return;
+    }
+
+    if (!iterator->second.pending.empty()) {
+      Flush(
+          std::move(iterator->second.pending),
+          Callback<void(const char*)>());
+      iterator->second.pending.Clear();
+    }
+
+    if (!iterator->second.finished) {
+      return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Abandon(uint64_t sequence) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!closed) {
+    abandoned.push_back(sequence);
+    uv_async_send(&async);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Close() {
+  if (closed) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+  }
+
+  // Keep ourselves alive until all of our handles have been closed.
+  self = shared_from_this();
+
+  if (body.reader) {
+    auto reader = std::move(body.reader);
+    reader("connection closed", std::string());
+  }
+
+  if (server != nullptr) {
+    std::exchange(server, nullptr)->Remove(this);
+  }
+
+  closing = 2;
+
+  std::exchange(stream, nullptr)->Close([this]() {
+    Closed();
+  });
+
+  uv_close(reinterpret_cast<uv_handle_t*>(&async), [](uv_handle_t* handle) {
+    static_cast<Connection*>(handle->data)->Closed();
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::Connection::Closed() {
+  CHECK_GT(closing, 0u);
+  if (--closing == 0) {
+    // NOTE: might delete 'this' so must be last.
+    self.reset();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int _HttpServer::State::Listen(const std::string& ip, int port) {
+  listener = new _Tcp::Listener(loop, options.tcp);
+
+  sockaddr_storage address = {};
+
+  int error = _Tcp::Address(ip, port, &address);
+
+  if (!error) {
+    error = listener->Listen(address);
+  }
+
+  if (!error) {
+    Accept();
+  }
+
+  return error;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::State::Accept() {
+  if (closed
+      || accepting
+      || connections.size() >= options.max_connections) {
+    return;
+  }
+
+  accepting = true;
+
+  listener->Accept([this](int error, _Tcp::Stream* stream) {
+    accepting = false;
+
+    if (error == UV_ECANCELED) {
+      // We're being closed.
+      return;
+    } else if (error) {
+      // NOTE: errors from accepting (e.g., 'UV_EMFILE' or a connection
+      // that was reset before it got accepted) only affect a single
+      // connection so rather than failing the server we keep
+      // accepting. Each error is only reported once by the listener
+      // (i.e., accepting again waits for the next connection) so this
+      // doesn't spin.
+      LOG(WARNING) << "Failed to accept a connection: "
+                   << uv_strerror(error);
+      Accept();
+      return;
+    }
+
+    auto connection = std::make_shared<Connection>(this, stream);
+
+    connections.insert(connection);
+    count.store(connections.size());
+
+    connection->Start();
+
+    Accept();
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::State::Dispatch(
+    std::shared_ptr<Transaction>&& transaction) {
+  if (waiter) {
+    auto waiter = std::move(this->waiter);
+    waiter(0, std::move(transaction));
+  } else {
+    ready.push_back(std::move(transaction));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::State::Remove(Connection* connection) {
+  connections.erase(connection->shared_from_this());
+  count.store(connections.size());
+  Accept();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::State::Next(
+    Callback<void(int, std::shared_ptr<Transaction>&&)>&& callback) {
+  CHECK(!waiter) << "already waiting for the next request";
+
+  if (!ready.empty()) {
+    std::shared_ptr<Transaction> transaction = std::move(ready.front());
+    ready.pop_front();
+    callback(0, std::move(transaction));
+  } else if (closed) {
+    callback(0, nullptr);
+  } else {
+    waiter = std::move(callback);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::State::Cancel() {
+  auto cancel = [this]() {
+    cancelling.store(false);
+    if (waiter) {
+      auto waiter = std::move(this->waiter);
+      waiter(UV_ECANCELED, nullptr);
+    }
+  };
+
+  if (EventLoop::InEventLoop()) {
+    cancel();
+  } else if (!cancelling.exchange(true)) {
+    loop.Submit(std::move(cancel), interrupt_context);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::State::Close(Callback<void()>&& callback) {
+  CHECK(EventLoop::InEventLoop());
+
+  closed = true;
+
+  if (waiter) {
+    auto waiter = std::move(this->waiter);
+    waiter(0, nullptr);
+  }
+
+  ready.clear();
+
+  std::set<std::shared_ptr<Connection>> connections;
+  connections.swap(this->connections);
+  count.store(0);
+
+  for (const std::shared_ptr<Connection>& connection : connections) {
+    connection->server = nullptr;
+    connection->Close();
+  }
+
+  done = std::move(callback);
+
+  auto closed = [this]() {
+    Callback<void()> done = std::move(this->done);
+    delete this;
+    if (done) {
+      done();
+    }
+  };
+
+  if (listener != nullptr) {
+    std::exchange(listener, nullptr)->Close(std::move(closed));
+  } else {
+    closed();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HttpServer::State::Destroy(State* state) {
+  if (EventLoop::InEventLoop()) {
+    state->Close(Callback<void()>());
+  } else {
+    // NOTE: 'context' won't be destructed until the listener has been
+    // closed which happens asynchronously after this callback.
+    state->loop.Submit(
+        [state]() {
+          state->Close(Callback<void()>());
+        },
+        state->context);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Server& Server::operator=(Server&& that) noexcept {
+  if (this == &that) {
+    return *this;
+  }
+
+  if (state_ != nullptr) {
+    _HttpServer::State::Destroy(state_);
+  }
+
+  state_ = std::exchange(that.state_, nullptr);
+
+  return *this;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Server::~Server() {
+  if (state_ != nullptr) {
+    _HttpServer::State::Destroy(state_);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int Server::port() {
+  return CHECK_NOTNULL(CHECK_NOTNULL(state_)->listener)->port();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_t Server::connections() {
+  return CHECK_NOTNULL(state_)->count.load();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace http
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,818 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "eventuals/buffer-chain.h"
+#include "eventuals/callback.h"
+#include "eventuals/event-loop.h"
+#include "eventuals/eventual.h"
+#include "eventuals/http.h"
+#include "eventuals/map.h"
+#include "eventuals/repeat.h"
+#include "eventuals/tcp.h"
+#include "eventuals/until.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+namespace http {
+
+////////////////////////////////////////////////////////////////////////
+
+struct ServerOptions final {
+  // Max number of connections open at once. Once reached no more
+  // connections are accepted (i.e., they wait in the listen backlog)
+  // until a connection gets closed.
+  size_t max_connections = 1024;
+
+  // Max number of requests read from a connection that haven't been
+  // responded to yet, i.e., how far ahead we read pipelined requests.
+  size_t max_pipelined_requests = 16;
+
+  // Max size of a request line plus its headers.
+  size_t max_header_size = 64 * 1024;
+
+  TcpOptions tcp;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+struct _HttpServer final {
+  struct Connection;
+  struct State;
+  struct Transaction;
+
+  // Runs 'f' on the connection's event loop passing it the
+  // transaction and a callback to invoke with either 'nullptr' or an
+  // error once it's done.
+  template <typename F_>
+  [[nodiscard]] static auto Run(
+      ContextName name,
+      std::shared_ptr<Transaction> transaction,
+      F_ f);
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// An HTTP/1.1 server that runs on an event loop, see
+// 'Server::Listen()' and 'Server::Serve()'.
+//
+// Requests are read incrementally from each connection (which are
+// kept alive unless the client asks otherwise) and a connection keeps
+// reading pipelined requests while earlier requests are still being
+// handled, so they can be handled concurrently, e.g., via
+// 'Concurrent()'. Responses are always written in the order the
+// requests were received regardless of the order they are completed.
+//
+// NOTE: like 'TcpListener' a server must outlive any of its
+// operations and should be closed via 'Close()'.
+//
+// Moveable, not Copyable.
+class Server final {
+ public:
+  class Request final {
+   public:
+    Request() = default;
+
+    const std::string& method() const {
+      return method_;
+    }
+
+    // The request target, e.g., "/path?query".
+    const std::string& target() const {
+      return target_;
+    }
+
+    std::string_view path() const {
+      std::string_view target = target_;
+      return target.substr(0, target.find('?'));
+    }
+
+    std::string_view query() const {
+      std::string_view target = target_;
+      size_t question = target.find('?');
+      return question == std::string_view::npos
+          ? std::string_view()
+          : target.substr(question + 1);
+    }
+
+    // E.g., "HTTP/1.1".
+    const std::string& version() const {
+      return version_;
+    }
+
+    // All of the headers with lowercase names (multiple headers with
+    // the same name are joined with ", ").
+    const Headers& headers() const {
+      return headers_;
+    }
+
+    // Returns the value of the header with 'name' (case-insensitive).
+    std::optional<std::string_view> header(std::string_view name) const;
+
+    bool keep_alive() const {
+      return keep_alive_;
+    }
+
+   private:
+    friend struct _HttpServer;
+
+    // Parses a request line and headers (each ending with "\r\n")
+    // returning 0 or the status code to respond with.
+    static int Parse(std::string_view head, Request& request);
+
+    std::string method_;
+    std::string target_;
+    std::string version_;
+    Headers headers_;
+    bool keep_alive_ = true;
+    std::optional<size_t> content_length_;
+    bool chunked_ = false;
+  };
+
+  // A request along with the means to respond to it, see
+  // 'Server::Serve()'.
+  class Exchange;
+
+  // Listens on 'ip' (IPv4 or IPv6) at 'port', or an ephemeral port
+  // if 'port' is 0, see 'port()'.
+  [[nodiscard]] static auto Listen(
+      std::string ip,
+      int port,
+      ServerOptions options = ServerOptions(),
+      EventLoop& loop = EventLoop::Default());
+
+  Server() = default;
+
+  Server(const Server&) = delete;
+
+  Server(Server&& that) noexcept
+    : state_(std::exchange(that.state_, nullptr)) {}
+
+  Server& operator=(const Server&) = delete;
+
+  Server& operator=(Server&& that) noexcept;
+
+  ~Server();
+
+  bool IsOpen() const {
+    return state_ != nullptr;
+  }
+
+  int port();
+
+  // Number of connections that are currently open.
+  size_t connections();
+
+  // Returns a stream of exchanges from all connections as requests
+  // are received, which ends once the server is closed.
+  //
+  // NOTE: the stream should only be consumed once at a time.
+  [[nodiscard]] auto Serve();
+
+  // Closes the server (and all of its connections), ending any
+  // 'Serve()' stream.
+  [[nodiscard]] auto Close();
+
+ private:
+  explicit Server(_HttpServer::State* state)
+    : state_(state) {}
+
+  [[nodiscard]] auto Next();
+
+  _HttpServer::State* state_ = nullptr;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// The state of a single request and its response which is shared by
+// the 'Server::Exchange' and any of its operations so that an exchange
+// doesn't need to outlive its operations.
+struct _HttpServer::Transaction final {
+  Transaction(
+      std::shared_ptr<Connection> connection,
+      uint64_t sequence,
+      Server::Request&& request)
+    : connection(std::move(connection)),
+      sequence(sequence),
+      request(std::move(request)) {}
+
+  // Lets the connection know if we never finished responding so that
+  // it doesn't wait for a response forever.
+  ~Transaction();
+
+  std::shared_ptr<Connection> connection;
+  const uint64_t sequence;
+  const Server::Request request;
+
+  // Set (on the event loop) once the whole response has been sent
+  // (or buffered to be sent).
+  std::atomic<bool> finished = false;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// A connection to a client which reads and parses requests and
+// writes responses in order.
+//
+// NOTE: all functions must be called from within the event loop
+// except 'Abandon()'.
+struct _HttpServer::Connection final
+  : public std::enable_shared_from_this<Connection> {
+  // A response that either is being sent or is waiting for all of the
+  // responses to earlier requests to be sent first.
+  struct Outgoing final {
+    // Bytes that are waiting for earlier responses to be sent first.
+    BufferChain pending;
+
+    bool started = false;
+    bool finished = false;
+
+    // Whether or not the body is sent using chunked encoding.
+    bool chunked = false;
+
+    // Whether or not the body should be omitted, i.e., for 'HEAD'.
+    bool omit_body = false;
+
+    // Whether or not to close the connection after the response.
+    bool close = false;
+
+    // The request's version for the status line, i.e., HTTP/1.0 or
+    // HTTP/1.1.
+    bool http_1_0 = false;
+  };
+
+  // State for reading a request body.
+  struct Body final {
+    enum class State {
+      Length,
+      ChunkSize,
+      ChunkData,
+      ChunkDataEnd,
+      Trailers,
+    };
+
+    bool active = false;
+    uint64_t sequence = 0;
+    State state = State::Length;
+    size_t remaining = 0;
+
+    // Set once the request has been responded to so the rest of the
+    // body is read and discarded.
+    bool discard = false;
+
+    Callback<void(const char*, std::string&&)> reader;
+  };
+
+  Connection(State* server, _Tcp::Stream* stream);
+
+  Connection(const Connection&) = delete;
+  Connection(Connection&&) = delete;
+
+  ~Connection();
+
+  void Start();
+
+  // Starts a response with a complete body (possibly empty).
+  void Respond(
+      Transaction& transaction,
+      int code,
+      Headers&& headers,
+      BufferChain&& body,
+      Callback<void(const char*)>&& callback);
+
+  // Starts a response whose body is sent with 'Write()' and 'End()'.
+  void Begin(
+      Transaction& transaction,
+      int code,
+      Headers&& headers,
+      Callback<void(const char*)>&& callback);
+
+  void Write(
+      Transaction& transaction,
+      BufferChain&& data,
+      Callback<void(const char*)>&& callback);
+
+  void End(
+      Transaction& transaction,
+      Callback<void(const char*)>&& callback);
+
+  // Reads the next chunk of the request body, which is empty at the
+  // end of the body.
+  void ReadBody(
+      Transaction& transaction,
+      Callback<void(const char*, std::string&&)>&& callback);
+
+  // Called from any thread when a transaction is destructed without
+  // having finished its response.
+  void Abandon(uint64_t sequence);
+
+  void Close();
+
+  EventLoop& loop;
+
+  // Raw pointer since the server closes all of its connections when
+  // it gets closed, which sets this to 'nullptr'.
+  State* server;
+
+  _Tcp::Stream* stream;
+
+  // Bytes that have been read but not yet parsed.
+  std::string input;
+
+  bool reading = false;
+  bool eof = false;
+
+  // Set after a request that doesn't keep the connection alive (or
+  // that we couldn't parse) so we stop reading requests.
+  bool stopped = false;
+
+  // Sequence number of the next request and of the request whose
+  // response is currently being sent.
+  uint64_t requests = 0;
+  uint64_t responding = 0;
+
+  std::map<uint64_t, Outgoing> outgoing;
+
+  Body body;
+
+  bool processing = false;
+  bool again = false;
+
+  // Used to find out about abandoned transactions from other threads.
+  uv_async_t async = {};
+  std::mutex mutex;
+  std::vector<uint64_t> abandoned;
+  bool closed = false;
+
+  // Number of handles that are still closing and a reference to
+  // ourselves to keep us alive until they're closed.
+  size_t closing = 0;
+  std::shared_ptr<Connection> self;
+
+ private:
+  void Read();
+  void Process();
+  void ProcessOnce();
+
+  // Parses the next request head, if we've read all of it.
+  void Parse();
+
+  enum class Decoded {
+    Chunk,
+    More,
+    Done,
+    Error,
+  };
+
+  Decoded DecodeBody(std::string& chunk);
+
+  // Sends 'data' for the response to 'sequence', or buffers it if
+  // earlier responses are still being sent.
+  void Send(
+      uint64_t sequence,
+      BufferChain&& data,
+      bool last,
+      Callback<void(const char*)>&& callback);
+
+  void Flush(BufferChain&& data, Callback<void(const char*)>&& callback);
+
+  // Sends a complete response for 'sequence' that also closes the
+  // connection, e.g., for requests that fail to parse.
+  void Fail(uint64_t sequence, int code);
+
+  // Starts sending the next responses after the one currently being
+  // sent has finished.
+  void Advance();
+
+  // Called after each handle has been closed.
+  void Closed();
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// The state of a 'Server', see '_Tcp::Listener'.
+//
+// NOTE: all functions must be called from within the event loop
+// except 'Destroy()' and 'Cancel()'.
+struct _HttpServer::State final {
+  State(EventLoop& loop, const ServerOptions& options)
+    : loop(loop),
+      options(options),
+      context(&loop, "http::Server (close)"),
+      interrupt_context(&loop, "http::Server (interrupt)") {}
+
+  State(const State&) = delete;
+  State(State&&) = delete;
+
+  int Listen(const std::string& ip, int port);
+
+  void Accept();
+
+  void Dispatch(std::shared_ptr<Transaction>&& transaction);
+
+  void Remove(Connection* connection);
+
+  // Waits for the next transaction (at most once), invoking
+  // 'callback' with either a transaction, nothing if the server has
+  // been closed, or an error.
+  void Next(Callback<void(int, std::shared_ptr<Transaction>&&)>&& callback);
+
+  // Like '_Tcp::Stream::Cancel()' but for 'Next()'.
+  void Cancel();
+
+  void Close(Callback<void()>&& callback);
+
+  static void Destroy(State* state);
+
+  EventLoop& loop;
+  const ServerOptions options;
+
+  _Tcp::Listener* listener = nullptr;
+  bool accepting = false;
+  bool closed = false;
+
+  std::set<std::shared_ptr<Connection>> connections;
+  std::atomic<size_t> count = 0;
+
+  std::deque<std::shared_ptr<Transaction>> ready;
+
+  Callback<void(int, std::shared_ptr<Transaction>&&)> waiter;
+
+  // Invoked after the server has been closed (and deleted).
+  Callback<void()> done;
+
+  Scheduler::Context context;
+  Scheduler::Context interrupt_context;
+  std::atomic<bool> cancelling = false;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+class Server::Exchange final {
+ public:
+  Exchange() = default;
+
+  const Request& request() const {
+    CHECK(transaction_);
+    return transaction_->request;
+  }
+
+  // Returns a stream of the chunks of the request body as they are
+  // read (if there is a body) which ends at the end of the body.
+  //
+  // NOTE: the exchange must outlive the stream. The next request on
+  // the same connection isn't read until the body has been read or
+  // responded to (in which case the rest of the body is read and
+  // discarded).
+  [[nodiscard]] auto Body();
+
+  // Responds with 'code' and a complete 'body', adding a
+  // 'Content-Length' header.
+  [[nodiscard]] auto Respond(
+      int code,
+      Headers headers = Headers(),
+      std::string body = std::string());
+
+  // Like 'Respond()' above but without copying the body.
+  [[nodiscard]] auto Respond(int code, Headers headers, BufferChain body);
+
+  // Starts a response whose body is streamed with 'Write()' and
+  // ended with 'End()', using chunked encoding.
+  [[nodiscard]] auto Begin(int code, Headers headers = Headers());
+
+  [[nodiscard]] auto Write(std::string data);
+
+  [[nodiscard]] auto Write(BufferChain data);
+
+  [[nodiscard]] auto End();
+
+ private:
+  friend class Server;
+
+  explicit Exchange(std::shared_ptr<_HttpServer::Transaction> transaction)
+    : transaction_(std::move(transaction)) {}
+
+  [[nodiscard]] auto ReadBody();
+
+  std::shared_ptr<_HttpServer::Transaction> transaction_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+template <typename F_>
+[[nodiscard]] auto _HttpServer::Run(
+    ContextName name,
+    std::shared_ptr<Transaction> transaction,
+    F_ f) {
+  struct Data {
+    std::shared_ptr<Transaction> transaction;
+    F_ f;
+
+    void* k = nullptr;
+  };
+
+  EventLoop& loop = CHECK_NOTNULL(transaction)->connection->loop;
+
+  return loop.Schedule(
+      std::move(name),
+      Eventual<void>()
+          .raises<RuntimeError>()
+          .context(Data{std::move(transaction), std::move(f)})
+          .start([](Data& data, auto& k) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            data.f(*data.transaction, [&data](const char* error) {
+              auto& k = *static_cast<K*>(data.k);
+              if (error == nullptr) {
+                k.Start();
+              } else {
+                k.Fail(RuntimeError(error));
+              }
+            });
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Exchange::ReadBody() {
+  struct Data {
+    std::shared_ptr<_HttpServer::Transaction> transaction;
+
+    void* k = nullptr;
+  };
+
+  CHECK(transaction_);
+
+  return transaction_->connection->loop.Schedule(
+      "http::Server::Exchange::Body",
+      Eventual<std::string>()
+          .raises<RuntimeError>()
+          .context(Data{transaction_})
+          .start([](Data& data, auto& k) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            data.transaction->connection->ReadBody(
+                *data.transaction,
+                [&data](const char* error, std::string&& chunk) {
+                  auto& k = *static_cast<K*>(data.k);
+                  if (error == nullptr) {
+                    k.Start(std::move(chunk));
+                  } else {
+                    k.Fail(RuntimeError(error));
+                  }
+                });
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Exchange::Body() {
+  return Repeat([this]() { return ReadBody(); })
+      >> Until([](std::string& chunk) {
+           return chunk.empty();
+         });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Exchange::Respond(
+    int code,
+    Headers headers,
+    BufferChain body) {
+  CHECK(transaction_);
+  return _HttpServer::Run(
+      "http::Server::Exchange::Respond",
+      transaction_,
+      [code, headers = std::move(headers), body = std::move(body)](
+          _HttpServer::Transaction& transaction,
+          Callback<void(const char*)>&& callback) mutable {
+        transaction.connection->Respond(
+            transaction,
+            code,
+            std::move(headers),
+            std::move(body),
+            std::move(callback));
+      });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Exchange::Respond(
+    int code,
+    Headers headers,
+    std::string body) {
+  BufferChain chain;
+  chain.Append(std::move(body));
+  return Respond(code, std::move(headers), std::move(chain));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Exchange::Begin(
+    int code,
+    Headers headers) {
+  CHECK(transaction_);
+  return _HttpServer::Run(
+      "http::Server::Exchange::Begin",
+      transaction_,
+      [code, headers = std::move(headers)](
+          _HttpServer::Transaction& transaction,
+          Callback<void(const char*)>&& callback) mutable {
+        transaction.connection->Begin(
+            transaction,
+            code,
+            std::move(headers),
+            std::move(callback));
+      });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Exchange::Write(BufferChain data) {
+  CHECK(transaction_);
+  return _HttpServer::Run(
+      "http::Server::Exchange::Write",
+      transaction_,
+      [data = std::move(data)](
+          _HttpServer::Transaction& transaction,
+          Callback<void(const char*)>&& callback) mutable {
+        transaction.connection->Write(
+            transaction,
+            std::move(data),
+            std::move(callback));
+      });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Exchange::Write(std::string data) {
+  BufferChain chain;
+  chain.Append(std::move(data));
+  return Write(std::move(chain));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Exchange::End() {
+  CHECK(transaction_);
+  return _HttpServer::Run(
+      "http::Server::Exchange::End",
+      transaction_,
+      [](_HttpServer::Transaction& transaction,
+         Callback<void(const char*)>&& callback) {
+        transaction.connection->End(transaction, std::move(callback));
+      });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Listen(
+    std::string ip,
+    int port,
+    ServerOptions options,
+    EventLoop& loop) {
+  struct Data {
+    EventLoop& loop;
+    std::string ip;
+    int port;
+    ServerOptions options;
+  };
+
+  return loop.Schedule(
+      "http::Server::Listen",
+      Eventual<Server>()
+          .raises<RuntimeError>()
+          .context(Data{loop, std::move(ip), port, std::move(options)})
+          .start([](Data& data, auto& k) {
+            auto* state = new _HttpServer::State(data.loop, data.options);
+
+            int error = state->Listen(data.ip, data.port);
+
+            if (error) {
+              _HttpServer::State::Destroy(state);
+              k.Fail(RuntimeError(uv_strerror(error)));
+            } else {
+              k.Start(Server(state));
+            }
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Next() {
+  struct Data {
+    _HttpServer::State* state;
+
+    void* k = nullptr;
+  };
+
+  CHECK_NOTNULL(state_);
+
+  return state_->loop.Schedule(
+      "http::Server::Serve",
+      Eventual<std::optional<Exchange>>()
+          .raises<RuntimeError>()
+          .interruptible()
+          .context(Data{state_})
+          .start([](Data& data, auto& k, auto& handler) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            if (handler) {
+              // NOTE: only capturing the state, see
+              // 'TcpStream::ReadChunk()'.
+              bool installed = handler->Install([state = data.state]() {
+                state->Cancel();
+              });
+
+              if (!installed) {
+                // Interrupt has already been triggered.
+                k.Stop();
+                return;
+              }
+            }
+
+            data.state->Next(
+                [&data](
+                    int error,
+                    std::shared_ptr<_HttpServer::Transaction>&& transaction) {
+                  auto& k = *static_cast<K*>(data.k);
+                  if (!error) {
+                    std::optional<Exchange> exchange;
+                    if (transaction) {
+                      exchange = Exchange(std::move(transaction));
+                    }
+                    k.Start(std::move(exchange));
+                  } else if (error == UV_ECANCELED) {
+                    k.Stop();
+                  } else {
+                    k.Fail(RuntimeError(uv_strerror(error)));
+                  }
+                });
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Serve() {
+  return Repeat([this]() { return Next(); })
+      >> Until([](std::optional<Exchange>& exchange) {
+           return !exchange.has_value();
+         })
+      >> Map([](std::optional<Exchange>&& exchange) {
+           return std::move(*exchange);
+         });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Server::Close() {
+  struct Data {
+    Server& self;
+
+    void* k = nullptr;
+  };
+
+  CHECK_NOTNULL(state_);
+
+  return state_->loop.Schedule(
+      "http::Server::Close",
+      Eventual<void>()
+          .context(Data{*this})
+          .start([](Data& data, auto& k) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            _HttpServer::State* state =
+                std::exchange(data.self.state_, nullptr);
+
+            CHECK_NOTNULL(state)->Close([&data]() {
+              static_cast<K*>(data.k)->Start();
+            });
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace http
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
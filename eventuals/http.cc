@@ -1,5 +1,8 @@
 #include "eventuals/http.h"
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+
 ////////////////////////////////////////////////////////////////////////
 
 namespace {
@@ -24,3 +27,398 @@ const CURLGlobalInitializer initializer_;
 } // namespace
 
 ////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+namespace http {
+
+////////////////////////////////////////////////////////////////////////
+
+std::optional<std::string_view> Response::header(
+    std::string_view name) const {
+  for (const Field& field : fields_) {
+    if (absl::EqualsIgnoreCase(this->name(field), name)) {
+      return value(field);
+    }
+  }
+  return std::nullopt;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const Headers& Response::headers() const {
+  return headers_.Get([this]() {
+    Headers headers;
+
+    for (const Field& field : fields_) {
+      // RFC 7230, section 3.2.2:
+      // A recipient MAY combine multiple header fields
+      // with the same field name into one
+      // "field-name: field-value" pair, without changing
+      // the semantics of the message, by appending each
+      // subsequent field value to the combined field
+      // value in order, separated by a comma.
+      //
+      // Example:
+      // Cookie: cookie1=value1, cookie2=value2
+      auto [iterator, inserted] = headers.emplace(
+          std::string(name(field)),
+          std::string(value(field)));
+
+      if (!inserted) {
+        iterator->second += ", ";
+        iterator->second += value(field);
+      }
+    }
+
+    return headers;
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void Response::AddHeaderLine(std::string_view line) {
+  // Skip lines like 'HTTP/1.1 200' that aren't headers.
+  size_t colon = line.find(':');
+
+  if (colon == std::string_view::npos) {
+    return;
+  }
+
+  std::string_view name = absl::StripAsciiWhitespace(line.substr(0, colon));
+  std::string_view value = absl::StripAsciiWhitespace(line.substr(colon + 1));
+
+  // NOTE: only keeping the (trimmed) name and value rather than the
+  // whole line to keep 'fields_buffer_' as small as possible.
+  Field field;
+
+  field.name_offset = fields_buffer_.size();
+  field.name_size = name.size();
+  fields_buffer_ += name;
+
+  field.value_offset = fields_buffer_.size();
+  field.value_size = value.size();
+  fields_buffer_ += value;
+
+  fields_.push_back(field);
+
+  // Invalidate any previously built map.
+  headers_.Reset();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HTTP::Metrics::Record(CURL* easy) {
+  // Number of new connections libcurl had to create for the transfer
+  // (which might be more than one, e.g., following redirects).
+  long connects = 0;
+
+  CHECK_EQ(
+      curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects),
+      CURLE_OK);
+
+  if (connects > 0) {
+    connections_opened += connects;
+  } else {
+    connections_reused++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<_HTTP::Session> _HTTP::Session::Create(
+    EventLoop& loop,
+    long max_concurrent_streams,
+    std::shared_ptr<Metrics> metrics) {
+  return std::shared_ptr<Session>(
+      new Session(loop, max_concurrent_streams, std::move(metrics)),
+      &Session::Destroy);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+_HTTP::Session::Session(
+    EventLoop& loop,
+    long max_concurrent_streams,
+    std::shared_ptr<Metrics> metrics)
+  : loop_(loop),
+    max_concurrent_streams_(max_concurrent_streams),
+    metrics_(std::move(metrics)),
+    context_(&loop, "HTTP (session)") {}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HTTP::Session::Destroy(Session* session) {
+  // NOTE: every transfer holds a reference to the session so there
+  // can't be any outstanding transfers at this point, and if the
+  // session was never initialized there aren't any handles to close.
+  if (!session->initialized_) {
+    delete session;
+  } else if (EventLoop::InEventLoop()) {
+    // NOTE: the last reference might be released by a completed
+    // transfer, in which case we close after 'Action()' is done.
+    if (session->acting_) {
+      session->destroyed_ = true;
+    } else {
+      session->Close();
+    }
+  } else {
+    // NOTE: 'context_' won't be destructed until the timer has been
+    // closed which happens asynchronously after this callback.
+    session->loop_.Submit(
+        [session]() {
+          session->Close();
+        },
+        session->context_);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HTTP::Session::Initialize() {
+  CHECK(EventLoop::InEventLoop());
+
+  multi_ = CHECK_NOTNULL(curl_multi_init());
+
+  CHECK_EQ(
+      curl_multi_setopt(multi_, CURLMOPT_SOCKETDATA, this),
+      CURLM_OK);
+  CHECK_EQ(
+      curl_multi_setopt(multi_, CURLMOPT_SOCKETFUNCTION, &SocketFunction),
+      CURLM_OK);
+  CHECK_EQ(
+      curl_multi_setopt(multi_, CURLMOPT_TIMERDATA, this),
+      CURLM_OK);
+  CHECK_EQ(
+      curl_multi_setopt(multi_, CURLMOPT_TIMERFUNCTION, &TimerFunction),
+      CURLM_OK);
+  CHECK_EQ(
+      curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX),
+      CURLM_OK);
+  CHECK_EQ(
+      curl_multi_setopt(
+          multi_,
+          CURLMOPT_MAX_CONCURRENT_STREAMS,
+          max_concurrent_streams_),
+      CURLM_OK);
+
+  CHECK_EQ(0, uv_timer_init(loop_, &timer_));
+  uv_handle_set_data((uv_handle_t*) &timer_, this);
+
+  initialized_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HTTP::Session::Close() {
+  CHECK(EventLoop::InEventLoop());
+  CHECK(initialized_);
+  CHECK(transfers_.empty());
+
+  // Closes any cached connections which might remove (some of) the
+  // polls via 'SocketFunction()'.
+  CHECK_EQ(curl_multi_cleanup(std::exchange(multi_, nullptr)), CURLM_OK);
+
+  for (uv_poll_t* poll : polls_) {
+    if (uv_is_active((uv_handle_t*) poll)) {
+      uv_poll_stop(poll);
+    }
+    uv_close(
+        (uv_handle_t*) poll,
+        [](uv_handle_t* handle) {
+          delete (uv_poll_t*) handle;
+        });
+  }
+
+  polls_.clear();
+
+  uv_timer_stop(&timer_);
+  uv_close(
+      (uv_handle_t*) &timer_,
+      [](uv_handle_t* handle) {
+        delete (Session*) handle->data;
+      });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HTTP::Session::Add(CURL* easy, Callback<void(CURLcode)>&& callback) {
+  CHECK(EventLoop::InEventLoop());
+
+  if (!initialized_) {
+    Initialize();
+  }
+
+  auto [_, inserted] = transfers_.emplace(easy, std::move(callback));
+
+  CHECK(inserted) << "transfer already added";
+
+  CHECK_EQ(curl_multi_add_handle(multi_, easy), CURLM_OK);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HTTP::Session::Remove(CURL* easy) {
+  CHECK(EventLoop::InEventLoop());
+
+  if (transfers_.erase(easy) > 0) {
+    CHECK_EQ(curl_multi_remove_handle(multi_, easy), CURLM_OK);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _HTTP::Session::Action(curl_socket_t socket, int flags) {
+  CHECK(!acting_);
+
+  acting_ = true;
+
+  int running_handles = 0;
+
+  curl_multi_socket_action(multi_, socket, flags, &running_handles);
+
+  // Unlike without a session we can't wait for there to be no more
+  // running handles since other transfers may still be running.
+  int messages = 0;
+  while (CURLMsg* message = curl_multi_info_read(multi_, &messages)) {
+    if (message->msg != CURLMSG_DONE) {
+      continue;
+    }
+
+    // NOTE: 'message' is invalid after removing the handle.
+    CURL* easy = message->easy_handle;
+    CURLcode result = message->data.result;
+
+    if (result == CURLE_OK && metrics_) {
+      metrics_->Record(easy);
+    }
+
+    CHECK_EQ(curl_multi_remove_handle(multi_, easy), CURLM_OK);
+
+    auto iterator = transfers_.find(easy);
+
+    CHECK(iterator != transfers_.end());
+
+    Callback<void(CURLcode)> callback = std::move(iterator->second);
+
+    transfers_.erase(iterator);
+
+    callback(result);
+  }
+
+  acting_ = false;
+
+  if (destroyed_) {
+    Close();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int _HTTP::Session::SocketFunction(
+    CURL* easy,
+    curl_socket_t socket,
+    int what,
+    void* data,
+    void* socket_poller) {
+  auto& session = *static_cast<Session*>(data);
+  auto* poll = static_cast<uv_poll_t*>(socket_poller);
+
+  if (what == CURL_POLL_REMOVE) {
+    if (poll != nullptr) {
+      session.polls_.erase(poll);
+
+      uv_poll_stop(poll);
+      uv_close(
+          (uv_handle_t*) poll,
+          [](uv_handle_t* handle) {
+            delete (uv_poll_t*) handle;
+          });
+
+      // NOTE: 'multi_' is 'nullptr' while being cleaned up in which
+      // case there is nothing to unassign.
+      if (session.multi_ != nullptr) {
+        curl_multi_assign(session.multi_, socket, nullptr);
+      }
+    }
+    return 0;
+  }
+
+  if (poll == nullptr) {
+    poll = new uv_poll_t();
+
+    CHECK_EQ(uv_poll_init_socket(session.loop_, poll, socket), 0);
+
+    uv_handle_set_data((uv_handle_t*) poll, &session);
+
+    session.polls_.insert(poll);
+
+    CHECK_EQ(curl_multi_assign(session.multi_, socket, poll), CURLM_OK);
+  }
+
+  int events = 0;
+  if (what & CURL_POLL_IN) {
+    events |= UV_READABLE;
+  }
+  if (what & CURL_POLL_OUT) {
+    events |= UV_WRITABLE;
+  }
+
+  CHECK_EQ(
+      uv_poll_start(
+          poll,
+          events,
+          [](uv_poll_t* handle, int status, int events) {
+            auto& session = *static_cast<Session*>(handle->data);
+
+            int flags = 0;
+            if (status < 0) {
+              flags = CURL_CSELECT_ERR;
+            }
+            if (status == 0 && (events & UV_READABLE)) {
+              flags |= CURL_CSELECT_IN;
+            }
+            if (status == 0 && (events & UV_WRITABLE)) {
+              flags |= CURL_CSELECT_OUT;
+            }
+
+            uv_os_fd_t socket;
+            uv_fileno((uv_handle_t*) handle, &socket);
+
+            session.Action((curl_socket_t) socket, flags);
+          }),
+      0);
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int _HTTP::Session::TimerFunction(
+    CURLM* multi,
+    long timeout_ms,
+    void* data) {
+  auto& session = *static_cast<Session*>(data);
+
+  // A timeout of -1 means libcurl doesn't need a timer anymore.
+  if (timeout_ms < 0) {
+    uv_timer_stop(&session.timer_);
+  } else {
+    uv_timer_start(
+        &session.timer_,
+        [](uv_timer_t* handle) {
+          auto& session = *static_cast<Session*>(handle->data);
+          session.Action(CURL_SOCKET_TIMEOUT, 0);
+        },
+        timeout_ms,
+        0);
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace http
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#include "absl/strings/ascii.h"
 #include "curl/curl.h"
+#include "eventuals/callback.h"
 #include "eventuals/event-loop.h"
 #include "eventuals/scheduler.h"
+#include "eventuals/stored-error.h"
 #include "eventuals/x509.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -293,9 +299,18 @@ struct Response final {
     return code_;
   }
 
-  const Headers& headers() const {
-    return headers_;
-  }
+  // Returns the value of the first header named 'name' (compared
+  // case-insensitively) or 'std::nullopt' if there isn't one. Unlike
+  // 'headers()' this doesn't need to allocate.
+  std::optional<std::string_view> header(std::string_view name) const;
+
+  // Returns all of the headers with the values of any duplicate
+  // headers combined, see RFC 7230, section 3.2.2.
+  //
+  // NOTE: the map is only built when first called (which is safe to
+  // do from multiple threads at the same time) and requires
+  // allocating so prefer 'header()' where possible.
+  const Headers& headers() const;
 
   const std::string& body() const {
     return body_;
@@ -304,112 +319,108 @@ struct Response final {
  private:
   friend struct _HTTP;
 
-  Response(
-      long code,
-      Headers&& headers,
-      std::string&& body)
-    : code_(code),
-      headers_(std::move(headers)),
-      body_(std::move(body)) {}
-
-  long code_ = 0;
-  Headers headers_;
-  std::string body_;
-};
-
-////////////////////////////////////////////////////////////////////////
-
-class Client final {
- public:
-  // Constructs a new http::Client "builder" with the default
-  // undefined values.
-  static auto Builder();
-
-  Client() = default;
-
-  [[nodiscard]] auto Get(
-      std::string&& uri,
-      std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
-
-  [[nodiscard]] auto Post(
-      std::string&& uri,
-      PostFields&& fields,
-      std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
-
-  [[nodiscard]] auto Do(Request&& request);
-
- private:
-  template <bool, bool>
-  class _Builder;
-
-  std::optional<bool> verify_peer_;
-  std::optional<x509::Certificate> certificate_;
-};
-
-////////////////////////////////////////////////////////////////////////
+  // A header stored as offsets into 'fields_buffer_' rather than as
+  // 'std::string_view's so that a 'Response' can be copied and moved
+  // (which might move the buffer's data, e.g., with small strings).
+  struct Field final {
+    uint32_t name_offset = 0;
+    uint32_t name_size = 0;
+    uint32_t value_offset = 0;
+    uint32_t value_size = 0;
+  };
 
-template <bool has_verify_peer_, bool has_certificate_>
-class Client::_Builder final : public builder::Builder {
- public:
-  ~_Builder() override = default;
+  // Appends a (raw) header line as received from libcurl, skipping
+  // lines which aren't headers like 'HTTP/1.1 200' or the final
+  // empty line.
+  void AddHeaderLine(std::string_view line);
 
-  auto verify_peer(bool verify_peer) && {
-    static_assert(!has_verify_peer_, "Duplicate 'verify_peer'");
-    // TODO(benh): consider checking that the scheme is 'https'.
-    return Construct<_Builder>(
-        verify_peer_.Set(verify_peer),
-        std::move(certificate_));
+  std::string_view name(const Field& field) const {
+    return std::string_view(fields_buffer_).substr(
+        field.name_offset,
+        field.name_size);
   }
 
-  // Specify the certificate to use when doing verification. Same
-  // semantics as the following:
-  //
-  // $ curl --cacert /path/to/certificate ...
-  //
-  // TODO(benh): provide support for a "bundle" of certificates.
-  auto certificate(x509::Certificate&& certificate) && {
-    static_assert(!has_certificate_, "Duplicate 'certificate'");
-    // TODO(benh): consider checking that the scheme is 'https'.
-    return Construct<_Builder>(
-        std::move(verify_peer_),
-        certificate_.Set(std::move(certificate)));
+  std::string_view value(const Field& field) const {
+    return std::string_view(fields_buffer_).substr(
+        field.value_offset,
+        field.value_size);
   }
 
-  Client Build() && {
-    Client client;
+  long code_ = 0;
 
-    if constexpr (has_verify_peer_) {
-      client.verify_peer_ = std::move(verify_peer_).value();
+  // All of the header lines of the response, retained so that
+  // 'fields_' can refer to them without any per header allocations.
+  std::string fields_buffer_;
+  std::vector<Field> fields_;
+
+  // Map built by 'headers()' which only gets set once (if multiple
+  // threads build it at the same time all but one of them throw
+  // theirs away) and isn't copied (or moved) with the response since
+  // it can always be rebuilt from 'fields_'.
+  class LazyHeaders final {
+   public:
+    LazyHeaders() = default;
+
+    LazyHeaders(const LazyHeaders&) {}
+    LazyHeaders(LazyHeaders&&) noexcept {}
+
+    LazyHeaders& operator=(const LazyHeaders&) {
+      Reset();
+      return *this;
     }
 
-    if constexpr (has_certificate_) {
-      client.certificate_ = std::move(certificate_).value();
+    LazyHeaders& operator=(LazyHeaders&&) noexcept {
+      Reset();
+      return *this;
     }
 
-    return client;
-  }
+    ~LazyHeaders() {
+      Reset();
+    }
 
- private:
-  friend class builder::Builder;
-  friend class Client;
+    // Returns the map, building it with 'build' if it hasn't been
+    // built yet.
+    template <typename F_>
+    const Headers& Get(F_&& build) const {
+      Headers* headers = headers_.load(std::memory_order_acquire);
+      if (headers == nullptr) {
+        auto built = std::make_unique<Headers>(build());
+        if (headers_.compare_exchange_strong(
+                headers,
+                built.get(),
+                std::memory_order_acq_rel,
+                std::memory_order_acquire)) {
+          headers = built.release();
+        }
+      }
+      return *headers;
+    }
 
-  _Builder() = default;
+    void Reset() {
+      delete headers_.exchange(nullptr);
+    }
 
-  _Builder(
-      builder::Field<bool, has_verify_peer_> verify_peer,
-      builder::Field<x509::Certificate, has_certificate_> certificate)
-    : verify_peer_(std::move(verify_peer)),
-      certificate_(std::move(certificate)) {}
+   private:
+    mutable std::atomic<Headers*> headers_ = nullptr;
+  };
 
-  builder::Field<bool, has_verify_peer_> verify_peer_;
-  builder::Field<x509::Certificate, has_certificate_> certificate_;
+  LazyHeaders headers_;
+
+  std::string body_;
 };
 
 ////////////////////////////////////////////////////////////////////////
 
-inline auto Client::Builder() {
-  return Client::_Builder<false, false>();
-}
+// Counts of the connections used by the (successful) transfers of an
+// 'http::Client', see 'Client::metrics()'.
+struct ClientMetrics final {
+  // Number of new connections that had to be opened.
+  size_t connections_opened = 0;
+
+  // Number of transfers that reused an already open connection, e.g.,
+  // another stream on a multiplexed HTTP/2 connection.
+  size_t connections_reused = 0;
+};
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -431,15 +442,110 @@ inline auto Client::Builder() {
 // 3. Whenever curl_multi_socket_action is called we can get an amount of
 //    remaining running easy handles. If this value is 0 then we read info
 //    from multi handle using check_multi_info lambda and clean everything up.
+//
+// Alternatively, when a client multiplexes requests, the easy handle is
+// added to the client's 'Session' instead which drives a multi handle
+// shared by all of the client's transfers, see '_HTTP::Session'.
 struct _HTTP final {
-  template <typename K_>
+  // Shared by all copies of a client, updated from the event loop.
+  struct Metrics final {
+    // Records the connections used by the (successful) transfer of
+    // 'easy'.
+    void Record(CURL* easy);
+
+    std::atomic<size_t> connections_opened = 0;
+    std::atomic<size_t> connections_reused = 0;
+  };
+
+  // A multi handle shared by all of the transfers of a client so that
+  // libcurl can reuse connections across transfers and multiplex
+  // concurrent transfers to the same host over a single HTTP/2
+  // connection.
+  //
+  // NOTE: all functions except 'Create()' must be called from within
+  // the event loop.
+  class Session final {
+   public:
+    // Returns a session that gets closed (on the event loop) after the
+    // last reference has been released.
+    static std::shared_ptr<Session> Create(
+        EventLoop& loop,
+        long max_concurrent_streams,
+        std::shared_ptr<Metrics> metrics);
+
+    Session(const Session&) = delete;
+    Session(Session&&) = delete;
+
+    // Starts the transfer of 'easy', invoking 'callback' once it has
+    // completed (but not if it gets removed first).
+    void Add(CURL* easy, Callback<void(CURLcode)>&& callback);
+
+    // Stops the transfer of 'easy', e.g., when interrupted.
+    void Remove(CURL* easy);
+
+   private:
+    Session(
+        EventLoop& loop,
+        long max_concurrent_streams,
+        std::shared_ptr<Metrics> metrics);
+
+    ~Session() = default;
+
+    static void Destroy(Session* session);
+
+    void Initialize();
+
+    void Close();
+
+    // Performs any actions for 'socket' (or timeouts if
+    // 'CURL_SOCKET_TIMEOUT') and then completes any finished
+    // transfers.
+    void Action(curl_socket_t socket, int flags);
+
+    static int SocketFunction(
+        CURL* easy,
+        curl_socket_t socket,
+        int what,
+        void* session,
+        void* poll);
+
+    static int TimerFunction(CURLM* multi, long timeout_ms, void* session);
+
+    EventLoop& loop_;
+    const long max_concurrent_streams_;
+    std::shared_ptr<Metrics> metrics_;
+
+    // Lazily initialized on the event loop, see 'Initialize()'.
+    bool initialized_ = false;
+    CURLM* multi_ = nullptr;
+    uv_timer_t timer_ = {};
+    std::set<uv_poll_t*> polls_;
+
+    std::map<CURL*, Callback<void(CURLcode)>> transfers_;
+
+    // Whether or not we're in 'Action()' and whether or not the last
+    // reference was released while we were.
+    bool acting_ = false;
+    bool destroyed_ = false;
+
+    Scheduler::Context context_;
+  };
+
+  template <typename K_, typename Errors_>
   struct Continuation final {
-    Continuation(K_ k, EventLoop& loop, Request&& request)
+    Continuation(
+        K_ k,
+        EventLoop& loop,
+        Request&& request,
+        std::shared_ptr<Session> session,
+        std::shared_ptr<Metrics> metrics)
       : loop_(loop),
         request_(std::move(request)),
+        session_(std::move(session)),
+        metrics_(std::move(metrics)),
         fields_string_(nullptr, &curl_free),
         easy_(curl_easy_init(), &curl_easy_cleanup),
-        multi_(curl_multi_init(), &curl_multi_cleanup),
+        multi_(session_ ? nullptr : curl_multi_init(), &curl_multi_cleanup),
         curl_headers_(nullptr, &curl_slist_free_all),
         context_(&loop, "HTTP (start/fail/stop)"),
         interrupt_context_(&loop_, "HTTP (interrupt)"),
@@ -448,6 +554,8 @@ struct _HTTP final {
     Continuation(Continuation&& that) noexcept
       : loop_(that.loop_),
         request_(std::move(that.request_)),
+        session_(std::move(that.session_)),
+        metrics_(std::move(that.metrics_)),
         fields_string_(std::move(that.fields_string_)),
         easy_(std::move(that.easy_)),
         multi_(std::move(that.multi_)),
@@ -485,7 +593,7 @@ struct _HTTP final {
                 CHECK(!error_);
 
                 CHECK_NOTNULL(easy_);
-                CHECK_NOTNULL(multi_);
+                CHECK(session_ || multi_);
 
                 // If applicable, PEM encode any certificate now before we start
                 // anything and can easily propagate an error.
@@ -518,8 +626,11 @@ struct _HTTP final {
                   }
                 }
 
-                CHECK_EQ(0, uv_timer_init(loop_, &timer_));
-                uv_handle_set_data((uv_handle_t*) &timer_, this);
+                // NOTE: a session has its own timer (and polls).
+                if (!session_) {
+                  CHECK_EQ(0, uv_timer_init(loop_, &timer_));
+                  uv_handle_set_data((uv_handle_t*) &timer_, this);
+                }
 
                 // Called only one time to finish the transfer
                 // and clean everything up.
@@ -541,6 +652,10 @@ struct _HTTP final {
                             continuation.easy_.get(),
                             CURLINFO_RESPONSE_CODE,
                             &continuation.code_);
+                        if (continuation.metrics_) {
+                          continuation.metrics_->Record(
+                              continuation.easy_.get());
+                        }
                       } else {
                         continuation.error_ = message->data.result;
                       }
@@ -580,84 +695,7 @@ struct _HTTP final {
                       [](uv_handle_t* handle) {
                         auto& continuation = *(Continuation*) handle->data;
                         continuation.closed_ = true;
-
-                        if (!continuation.error_) {
-                          // Build headers map.
-                          std::stringstream headers_buffer_stringstream(
-                              continuation.headers_buffer_.Extract());
-                          std::map<std::string, std::string> headers;
-
-                          // Typical 'headers_buffer_stringstream'
-                          // looks like this:
-                          // --------------------------------
-                          // HTTP/1.1 200
-                          // SomeHeaderKey1: SomeHeaderValue1
-                          // SomeHeaderKey2: SomeHeaderValue2
-                          // --------------------------------
-                          while (!headers_buffer_stringstream.eof()) {
-                            std::string line;
-                            std::getline(headers_buffer_stringstream, line);
-
-                            // Find where ':' is.
-                            auto column_iterator = std::find(
-                                line.cbegin(),
-                                line.cend(),
-                                ':');
-
-                            // Skip lines like 'HTTP/1.1 200' that aren't
-                            // headers.
-                            if (column_iterator == line.cend()) {
-                              continue;
-                            }
-
-                            // Assign key and value.
-                            std::string key(line.cbegin(), column_iterator);
-                            std::string value(column_iterator + 1, line.cend());
-
-                            // Remove leading and trailing spaces.
-                            key = absl::StripAsciiWhitespace(key);
-                            value = absl::StripAsciiWhitespace(value);
-
-                            // Add key and value to the map.
-                            // RFC 7230, section 3.2.2:
-                            // A recipient MAY combine multiple header fields
-                            // with the same field name into one
-                            // "field-name: field-value" pair, without changing
-                            // the semantics of the message, by appending each
-                            // subsequent field value to the combined field
-                            // value in order, separated by a comma. The order
-                            // in which header fields with the same field name
-                            // are received is therefore significant to the
-                            // interpretation of the combined field value;
-                            // a proxy MUST NOT change the order of these field
-                            // values when forwarding a message.
-                            //
-                            // NOTE: If user tries to add an already
-                            // existing header, append the new one
-                            // to the old one using comma.
-                            // Example:
-                            // Cookie: cookie1=value1, cookie2=value2
-                            auto iterator = headers.find(key);
-                            if (iterator == headers.end()) {
-                              // Header doesn't exist yet.
-                              headers.emplace(std::move(key), std::move(value));
-                            } else {
-                              // Header already exists.
-                              headers[key] += ", ";
-                              headers[key] += value;
-                            }
-                          }
-
-                          continuation.k_.Start(Response{
-                              continuation.code_,
-                              std::move(headers),
-                              continuation.body_buffer_.Extract()});
-                        } else {
-                          continuation.k_.Fail(
-                              RuntimeError(
-                                  curl_easy_strerror(
-                                      (CURLcode) continuation.error_)));
-                        }
+                        continuation.Complete();
                       });
                 };
 
@@ -850,9 +888,8 @@ struct _HTTP final {
                                                   size_t size,
                                                   size_t nmemb,
                                                   Continuation* continuation) {
-                  continuation->headers_buffer_ += std::string(
-                      data,
-                      size * nmemb);
+                  continuation->response_.AddHeaderLine(
+                      std::string_view(data, size * nmemb));
 
                   return nmemb * size;
                 };
@@ -860,31 +897,33 @@ struct _HTTP final {
                 using std::chrono::duration_cast;
                 using std::chrono::milliseconds;
 
-                // CURL multi options.
-                CHECK_EQ(
-                    curl_multi_setopt(
-                        multi_.get(),
-                        CURLMOPT_SOCKETDATA,
-                        this),
-                    CURLM_OK);
-                CHECK_EQ(
-                    curl_multi_setopt(
-                        multi_.get(),
-                        CURLMOPT_SOCKETFUNCTION,
-                        socket_function),
-                    CURLM_OK);
-                CHECK_EQ(
-                    curl_multi_setopt(
-                        multi_.get(),
-                        CURLMOPT_TIMERDATA,
-                        this),
-                    CURLM_OK);
-                CHECK_EQ(
-                    curl_multi_setopt(
-                        multi_.get(),
-                        CURLMOPT_TIMERFUNCTION,
-                        timer_function),
-                    CURLM_OK);
+                // CURL multi options (unless using a session).
+                if (!session_) {
+                  CHECK_EQ(
+                      curl_multi_setopt(
+                          multi_.get(),
+                          CURLMOPT_SOCKETDATA,
+                          this),
+                      CURLM_OK);
+                  CHECK_EQ(
+                      curl_multi_setopt(
+                          multi_.get(),
+                          CURLMOPT_SOCKETFUNCTION,
+                          socket_function),
+                      CURLM_OK);
+                  CHECK_EQ(
+                      curl_multi_setopt(
+                          multi_.get(),
+                          CURLMOPT_TIMERDATA,
+                          this),
+                      CURLM_OK);
+                  CHECK_EQ(
+                      curl_multi_setopt(
+                          multi_.get(),
+                          CURLMOPT_TIMERFUNCTION,
+                          timer_function),
+                      CURLM_OK);
+                }
 
                 // CURL easy options.
                 if (request_.verify_peer()) {
@@ -1058,12 +1097,56 @@ struct _HTTP final {
                         1),
                     CURLE_OK);
 
-                // Start handling connection.
-                CHECK_EQ(
-                    curl_multi_add_handle(
-                        multi_.get(),
-                        easy_.get()),
-                    CURLM_OK);
+                if (session_) {
+                  // Prefer HTTP/2 so that concurrent transfers can be
+                  // multiplexed over the same connection. Over TLS
+                  // the version is negotiated (falling back to
+                  // HTTP/1.1) but without TLS we assume the server
+                  // speaks HTTP/2 (i.e., h2c with prior knowledge)
+                  // since a connection that gets upgraded can't be
+                  // multiplexed until after the first response.
+                  const bool tls = request_.uri().rfind("https://", 0) == 0;
+                  CHECK_EQ(
+                      curl_easy_setopt(
+                          easy_.get(),
+                          CURLOPT_HTTP_VERSION,
+                          tls
+                              ? CURL_HTTP_VERSION_2TLS
+                              : CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE),
+                      CURLE_OK);
+                  // Wait for an already connecting connection to
+                  // find out if it can be multiplexed rather than
+                  // opening another connection.
+                  CHECK_EQ(
+                      curl_easy_setopt(
+                          easy_.get(),
+                          CURLOPT_PIPEWAIT,
+                          1L),
+                      CURLE_OK);
+
+                  session_->Add(easy_.get(), [this](CURLcode result) {
+                    completed_ = true;
+                    closed_ = true;
+
+                    if (result == CURLE_OK) {
+                      curl_easy_getinfo(
+                          easy_.get(),
+                          CURLINFO_RESPONSE_CODE,
+                          &code_);
+                    } else {
+                      error_ = result;
+                    }
+
+                    Complete();
+                  });
+                } else {
+                  // Start handling connection.
+                  CHECK_EQ(
+                      curl_multi_add_handle(
+                          multi_.get(),
+                          easy_.get()),
+                      CURLM_OK);
+                }
               }
             },
             context_);
@@ -1072,22 +1155,12 @@ struct _HTTP final {
 
     template <typename Error>
     void Fail(Error&& error) {
-      // TODO(benh): avoid allocating on heap by storing args in
-      // pre-allocated buffer based on composing with Errors.
-      using Tuple = std::tuple<decltype(this), Error>;
-      auto tuple = std::make_unique<Tuple>(
-          this,
-          std::forward<Error>(error));
+      stored_error_.Store(std::forward<Error>(error));
 
       // Submitting to event loop to avoid race with interrupt.
       loop_.Submit(
-          [tuple = std::move(tuple)]() {
-            std::apply(
-                [](Continuation* continuation, auto&&... args) {
-                  auto& k_ = continuation->k_;
-                  k_.Fail(std::forward<decltype(args)>(args)...);
-                },
-                std::move(*tuple));
+          [this]() {
+            stored_error_.Fail(k_);
           },
           context_);
     }
@@ -1110,6 +1183,14 @@ struct _HTTP final {
               if (!started_) {
                 CHECK(!completed_ && !error_);
                 completed_ = true;
+                k_.Stop();
+              } else if (!completed_ && session_) {
+                CHECK(started_ && !error_);
+                completed_ = true;
+                closed_ = true;
+
+                session_->Remove(easy_.get());
+
                 k_.Stop();
               } else if (!completed_) {
                 CHECK(started_ && !error_);
@@ -1152,10 +1233,32 @@ struct _HTTP final {
     }
 
    private:
+    // Starts (or fails) the continuation with the response after the
+    // transfer has completed and everything has been cleaned up.
+    void Complete() {
+      if (!error_) {
+        // NOTE: the headers were already added to 'response_' as they
+        // were received, see 'header_function'.
+        response_.code_ = code_;
+        response_.body_ = body_buffer_.Extract();
+
+        k_.Start(std::move(response_));
+      } else {
+        k_.Fail(
+            RuntimeError(
+                curl_easy_strerror(
+                    (CURLcode) error_)));
+      }
+    }
+
     EventLoop& loop_;
 
     Request request_;
 
+    // Set if the client multiplexes its requests, see '_HTTP::Session'.
+    std::shared_ptr<Session> session_;
+    std::shared_ptr<Metrics> metrics_;
+
     // Stores converted PostFields as a C string.
     std::unique_ptr<char, decltype(&curl_free)> fields_string_;
 
@@ -1168,7 +1271,7 @@ struct _HTTP final {
 
     // Response variables.
     long code_ = 0;
-    EventLoop::Buffer headers_buffer_;
+    Response response_;
     EventLoop::Buffer body_buffer_;
 
     bool started_ = false;
@@ -1177,6 +1280,8 @@ struct _HTTP final {
 
     int error_ = 0;
 
+    StoredError<K_, Errors_> stored_error_;
+
     // NOTE: we use 'context_' in each of 'Start()', 'Fail()', and
     // 'Stop()' because only one of them will called at runtime.
     Scheduler::Context context_;
@@ -1202,7 +1307,12 @@ struct _HTTP final {
 
     template <typename Arg, typename Errors, typename K>
     auto k(K k) && {
-      return Continuation<K>(std::move(k), loop_, std::move(request_));
+      return Continuation<K, Errors>(
+          std::move(k),
+          loop_,
+          std::move(request_),
+          std::move(session_),
+          std::move(metrics_));
     }
 
     template <typename Downstream>
@@ -1212,11 +1322,183 @@ struct _HTTP final {
 
     EventLoop& loop_;
     Request request_;
+    std::shared_ptr<Session> session_;
+    std::shared_ptr<Metrics> metrics_;
   };
 };
 
 ////////////////////////////////////////////////////////////////////////
 
+class Client final {
+ public:
+  // Constructs a new http::Client "builder" with the default
+  // undefined values.
+  static auto Builder();
+
+  Client() = default;
+
+  [[nodiscard]] auto Get(
+      std::string&& uri,
+      std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
+
+  [[nodiscard]] auto Post(
+      std::string&& uri,
+      PostFields&& fields,
+      std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
+
+  [[nodiscard]] auto Do(Request&& request);
+
+  // Returns the connections used by this client (and any copies of
+  // it) so far.
+  ClientMetrics metrics() const {
+    ClientMetrics metrics;
+    if (metrics_) {
+      metrics.connections_opened = metrics_->connections_opened.load();
+      metrics.connections_reused = metrics_->connections_reused.load();
+    }
+    return metrics;
+  }
+
+ private:
+  template <bool, bool, bool, bool>
+  class _Builder;
+
+  std::optional<bool> verify_peer_;
+  std::optional<x509::Certificate> certificate_;
+
+  // Only set when multiplexing, see 'Client::_Builder::multiplex()'.
+  std::shared_ptr<_HTTP::Session> session_;
+
+  std::shared_ptr<_HTTP::Metrics> metrics_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+template <
+    bool has_verify_peer_,
+    bool has_certificate_,
+    bool has_multiplex_,
+    bool has_max_concurrent_streams_>
+class Client::_Builder final : public builder::Builder {
+ public:
+  ~_Builder() override = default;
+
+  auto verify_peer(bool verify_peer) && {
+    static_assert(!has_verify_peer_, "Duplicate 'verify_peer'");
+    // TODO(benh): consider checking that the scheme is 'https'.
+    return Construct<_Builder>(
+        verify_peer_.Set(verify_peer),
+        std::move(certificate_),
+        std::move(multiplex_),
+        std::move(max_concurrent_streams_));
+  }
+
+  // Specify the certificate to use when doing verification. Same
+  // semantics as the following:
+  //
+  // $ curl --cacert /path/to/certificate ...
+  //
+  // TODO(benh): provide support for a "bundle" of certificates.
+  auto certificate(x509::Certificate&& certificate) && {
+    static_assert(!has_certificate_, "Duplicate 'certificate'");
+    // TODO(benh): consider checking that the scheme is 'https'.
+    return Construct<_Builder>(
+        std::move(verify_peer_),
+        certificate_.Set(std::move(certificate)),
+        std::move(multiplex_),
+        std::move(max_concurrent_streams_));
+  }
+
+  // Use HTTP/2 (when possible) and share connections between all of
+  // the requests of the client (and any copies of it), multiplexing
+  // concurrent requests to the same host over the same connection
+  // rather than opening a connection (and TLS session) per request.
+  //
+  // NOTE: 'http://' URIs are expected to speak HTTP/2 without TLS
+  // (i.e., h2c with prior knowledge).
+  auto multiplex(bool multiplex) && {
+    static_assert(!has_multiplex_, "Duplicate 'multiplex'");
+    return Construct<_Builder>(
+        std::move(verify_peer_),
+        std::move(certificate_),
+        multiplex_.Set(multiplex),
+        std::move(max_concurrent_streams_));
+  }
+
+  // Max number of concurrent streams (i.e., requests) multiplexed over
+  // a single connection, defaults to 100.
+  auto max_concurrent_streams(long max_concurrent_streams) && {
+    static_assert(
+        !has_max_concurrent_streams_,
+        "Duplicate 'max_concurrent_streams'");
+    CHECK_GT(max_concurrent_streams, 0);
+    return Construct<_Builder>(
+        std::move(verify_peer_),
+        std::move(certificate_),
+        std::move(multiplex_),
+        max_concurrent_streams_.Set(max_concurrent_streams));
+  }
+
+  Client Build() && {
+    static_assert(
+        !has_max_concurrent_streams_ || has_multiplex_,
+        "'max_concurrent_streams' requires 'multiplex'");
+
+    Client client;
+
+    if constexpr (has_verify_peer_) {
+      client.verify_peer_ = std::move(verify_peer_).value();
+    }
+
+    if constexpr (has_certificate_) {
+      client.certificate_ = std::move(certificate_).value();
+    }
+
+    client.metrics_ = std::make_shared<_HTTP::Metrics>();
+
+    if (multiplex_.value()) {
+      // TODO(benh): need 'Client::Default()', see 'Client::Do()'.
+      client.session_ = _HTTP::Session::Create(
+          EventLoop::Default(),
+          max_concurrent_streams_.value(),
+          client.metrics_);
+    }
+
+    return client;
+  }
+
+ private:
+  friend class builder::Builder;
+  friend class Client;
+
+  _Builder() = default;
+
+  _Builder(
+      builder::Field<bool, has_verify_peer_> verify_peer,
+      builder::Field<x509::Certificate, has_certificate_> certificate,
+      builder::FieldWithDefault<bool, has_multiplex_> multiplex,
+      builder::FieldWithDefault<long, has_max_concurrent_streams_>
+          max_concurrent_streams)
+    : verify_peer_(std::move(verify_peer)),
+      certificate_(std::move(certificate)),
+      multiplex_(std::move(multiplex)),
+      max_concurrent_streams_(std::move(max_concurrent_streams)) {}
+
+  builder::Field<bool, has_verify_peer_> verify_peer_;
+  builder::Field<x509::Certificate, has_certificate_> certificate_;
+  builder::FieldWithDefault<bool, has_multiplex_> multiplex_ = false;
+  builder::FieldWithDefault<long, has_max_concurrent_streams_>
+      max_concurrent_streams_ = 100;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+inline auto Client::Builder() {
+  return Client::_Builder<false, false, false, false>();
+}
+
+////////////////////////////////////////////////////////////////////////
+
 [[nodiscard]] inline auto Client::Do(Request&& request) {
   // TODO(benh): need 'Client::Default()'.
   EventLoop& loop = EventLoop::Default();
@@ -1234,7 +1516,7 @@ struct _HTTP final {
   // completed (or was interrupted).
   return RescheduleAfter(
       // TODO(benh): borrow '&loop' so http call can't outlive a loop.
-      _HTTP::Composable{loop, std::move(request)});
+      _HTTP::Composable{loop, std::move(request), session_, metrics_});
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,413 @@
+#include "eventuals/io-uring.h"
+
+#if EVENTUALS_IO_URING
+
+#include <fcntl.h> // For 'AT_FDCWD' and 'O_CLOEXEC'.
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "glog/logging.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+int Setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int Enter(int fd, unsigned to_submit) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_enter, fd, to_submit, 0, 0, nullptr, 0));
+}
+
+int Register(int fd, unsigned opcode, void* arg, unsigned args) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, fd, opcode, arg, args));
+}
+
+// NOTE: the rings are shared with the kernel so the head and tail
+// must be read and written with acquire/release semantics.
+unsigned LoadAcquire(const unsigned* pointer) {
+  return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease(unsigned* pointer, unsigned value) {
+  __atomic_store_n(pointer, value, __ATOMIC_RELEASE);
+}
+
+void* Map(size_t size, int fd, off_t offset) {
+  void* pointer = mmap(
+      nullptr,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      fd,
+      offset);
+  return pointer == MAP_FAILED ? nullptr : pointer;
+}
+
+// Returns true if all of the operations we use are supported.
+bool Supported(int fd) {
+  static constexpr unsigned OPS = 256;
+
+  std::unique_ptr<char[]> memory(
+      new char[sizeof(io_uring_probe) + OPS * sizeof(io_uring_probe_op)]());
+
+  io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(memory.get());
+
+  if (Register(fd, IORING_REGISTER_PROBE, probe, OPS) < 0) {
+    return false;
+  }
+
+  for (unsigned op : {
+           IORING_OP_OPENAT,
+           IORING_OP_CLOSE,
+           IORING_OP_READ,
+           IORING_OP_WRITE,
+           IORING_OP_READV,
+           IORING_OP_WRITEV}) {
+    if (op > probe->last_op
+        || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<IoUring> IoUring::Create(unsigned entries) {
+  io_uring_params params = {};
+
+  int fd = Setup(entries, &params);
+
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  // NOTE: can't use 'std::make_unique()' because the constructor is
+  // private, but from here on out the destructor cleans up anything
+  // we've set up if we fail.
+  std::unique_ptr<IoUring> io_uring(new IoUring());
+
+  io_uring->fd_ = fd;
+
+  if (!Supported(fd)) {
+    return nullptr;
+  }
+
+  io_uring->sq_entries_ = params.sq_entries;
+  io_uring->cq_entries_ = params.cq_entries;
+
+  io_uring->sq_ring_size_ =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  io_uring->cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    io_uring->sq_ring_size_ = io_uring->cq_ring_size_ = std::max(
+        io_uring->sq_ring_size_,
+        io_uring->cq_ring_size_);
+  }
+
+  io_uring->sq_ring_ = Map(io_uring->sq_ring_size_, fd, IORING_OFF_SQ_RING);
+
+  if (io_uring->sq_ring_ == nullptr) {
+    return nullptr;
+  }
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    io_uring->cq_ring_ = io_uring->sq_ring_;
+  } else {
+    io_uring->cq_ring_ = Map(io_uring->cq_ring_size_, fd, IORING_OFF_CQ_RING);
+
+    if (io_uring->cq_ring_ == nullptr) {
+      return nullptr;
+    }
+  }
+
+  io_uring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  io_uring->sqes_ = static_cast<io_uring_sqe*>(
+      Map(io_uring->sqes_size_, fd, IORING_OFF_SQES));
+
+  if (io_uring->sqes_ == nullptr) {
+    return nullptr;
+  }
+
+  char* sq = static_cast<char*>(io_uring->sq_ring_);
+
+  io_uring->sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  io_uring->sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  io_uring->sq_mask_ =
+      *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  io_uring->sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+  io_uring->tail_ = *io_uring->sq_tail_;
+
+  char* cq = static_cast<char*>(io_uring->cq_ring_);
+
+  io_uring->cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  io_uring->cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  io_uring->cq_mask_ =
+      *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  io_uring->cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  io_uring->eventfd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+  if (io_uring->eventfd_ < 0
+      || Register(fd, IORING_REGISTER_EVENTFD, &io_uring->eventfd_, 1) < 0) {
+    return nullptr;
+  }
+
+  return io_uring;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+
+  if (eventfd_ >= 0) {
+    close(eventfd_);
+  }
+
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void IoUring::Open(
+    const char* path,
+    int flags,
+    int mode,
+    Operation* operation) {
+  io_uring_sqe sqe = {};
+  sqe.opcode = IORING_OP_OPENAT;
+  sqe.fd = AT_FDCWD;
+  sqe.addr = reinterpret_cast<uint64_t>(path);
+  sqe.len = mode;
+  // NOTE: like libuv we always open with 'O_CLOEXEC'.
+  sqe.open_flags = flags | O_CLOEXEC;
+  sqe.user_data = reinterpret_cast<uint64_t>(operation);
+  Prepare(sqe);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void IoUring::Close(int fd, Operation* operation) {
+  io_uring_sqe sqe = {};
+  sqe.opcode = IORING_OP_CLOSE;
+  sqe.fd = fd;
+  sqe.user_data = reinterpret_cast<uint64_t>(operation);
+  Prepare(sqe);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void IoUring::Read(
+    int fd,
+    void* buffer,
+    size_t size,
+    uint64_t offset,
+    Operation* operation) {
+  io_uring_sqe sqe = {};
+  sqe.opcode = IORING_OP_READ;
+  sqe.fd = fd;
+  sqe.addr = reinterpret_cast<uint64_t>(buffer);
+  sqe.len = static_cast<uint32_t>(size);
+  sqe.off = offset;
+  sqe.user_data = reinterpret_cast<uint64_t>(operation);
+  Prepare(sqe);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void IoUring::Write(
+    int fd,
+    const void* buffer,
+    size_t size,
+    uint64_t offset,
+    Operation* operation) {
+  io_uring_sqe sqe = {};
+  sqe.opcode = IORING_OP_WRITE;
+  sqe.fd = fd;
+  sqe.addr = reinterpret_cast<uint64_t>(buffer);
+  sqe.len = static_cast<uint32_t>(size);
+  sqe.off = offset;
+  sqe.user_data = reinterpret_cast<uint64_t>(operation);
+  Prepare(sqe);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void IoUring::ReadV(
+    int fd,
+    const iovec* buffers,
+    size_t count,
+    uint64_t offset,
+    Operation* operation) {
+  io_uring_sqe sqe = {};
+  sqe.opcode = IORING_OP_READV;
+  sqe.fd = fd;
+  sqe.addr = reinterpret_cast<uint64_t>(buffers);
+  sqe.len = static_cast<uint32_t>(count);
+  sqe.off = offset;
+  sqe.user_data = reinterpret_cast<uint64_t>(operation);
+  Prepare(sqe);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void IoUring::WriteV(
+    int fd,
+    const iovec* buffers,
+    size_t count,
+    uint64_t offset,
+    Operation* operation) {
+  io_uring_sqe sqe = {};
+  sqe.opcode = IORING_OP_WRITEV;
+  sqe.fd = fd;
+  sqe.addr = reinterpret_cast<uint64_t>(buffers);
+  sqe.len = static_cast<uint32_t>(count);
+  sqe.off = offset;
+  sqe.user_data = reinterpret_cast<uint64_t>(operation);
+  Prepare(sqe);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void IoUring::Prepare(const io_uring_sqe& sqe) {
+  // Operations are only added to the submission queue if there is
+  // room for them and for their completions, since we bound the
+  // number of inflight operations by the size of the completion queue
+  // so that it can never overflow.
+  auto room = [this]() {
+    return tail_ - LoadAcquire(sq_head_) < sq_entries_
+        && inflight_ + prepared_ < cq_entries_;
+  };
+
+  if (!backlog_.empty() || !room()) {
+    backlog_.push_back(sqe);
+    return;
+  }
+
+  unsigned index = tail_ & sq_mask_;
+  sqes_[index] = sqe;
+  sq_array_[index] = index;
+  tail_++;
+  prepared_++;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_t IoUring::Submit() {
+  // Move as much of the backlog as we can into the submission queue.
+  while (!backlog_.empty()) {
+    if (tail_ - LoadAcquire(sq_head_) == sq_entries_
+        || inflight_ + prepared_ == cq_entries_) {
+      break;
+    }
+
+    unsigned index = tail_ & sq_mask_;
+    sqes_[index] = backlog_.front();
+    sq_array_[index] = index;
+    tail_++;
+    prepared_++;
+
+    backlog_.pop_front();
+  }
+
+  if (prepared_ == 0) {
+    return 0;
+  }
+
+  StoreRelease(sq_tail_, tail_);
+
+  int submitted = 0;
+
+  do {
+    submitted = Enter(fd_, static_cast<unsigned>(prepared_));
+  } while (submitted < 0 && errno == EINTR);
+
+  if (submitted < 0) {
+    // The kernel is out of resources and we'll try again the next
+    // time we submit.
+    if (errno == EAGAIN || errno == EBUSY) {
+      return 0;
+    }
+
+    PLOG(FATAL) << "Failed to submit to io_uring";
+  }
+
+  prepared_ -= submitted;
+  inflight_ += submitted;
+
+  return submitted;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_t IoUring::Reap() {
+  // NOTE: we clear the eventfd _before_ reaping so we can't miss any
+  // completions that happen while reaping.
+  uint64_t value = 0;
+  while (read(eventfd_, &value, sizeof(value)) < 0 && errno == EINTR) {}
+
+  size_t reaped = 0;
+
+  unsigned head = *cq_head_;
+
+  while (head != LoadAcquire(cq_tail_)) {
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+
+    Operation* operation = reinterpret_cast<Operation*>(cqe.user_data);
+    int result = cqe.res;
+
+    StoreRelease(cq_head_, ++head);
+
+    inflight_--;
+    reaped++;
+
+    // Need to move 'callback' before invoking it since invoking it
+    // might destruct the operation.
+    Callback<void(int)> callback =
+        std::move(CHECK_NOTNULL(operation)->callback);
+
+    callback(result);
+  }
+
+  return reaped;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
+
+#endif
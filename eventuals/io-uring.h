@@ -0,0 +1,180 @@
+#pragma once
+
+// Whether or not to (try and) use io_uring on Linux for filesystem
+// operations rather than libuv's threadpool. Even when compiled in
+// we still fall back to libuv if the kernel doesn't support io_uring
+// (or the operations we need) or if the environment variable
+// 'EVENTUALS_IO_URING=0' is set. It can be compiled out completely
+// with '--copt=-DEVENTUALS_IO_URING=0'.
+#ifndef EVENTUALS_IO_URING
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define EVENTUALS_IO_URING 1
+#else
+#define EVENTUALS_IO_URING 0
+#endif
+#endif
+
+#if EVENTUALS_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/uio.h> // For 'iovec'.
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "eventuals/callback.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// A minimal io_uring (using the system calls directly rather than
+// depending on 'liburing') for submitting file I/O from an event
+// loop, see 'EventLoop::io_uring()'.
+//
+// Operations are only "prepared" until 'Submit()' is called so that
+// all of the operations prepared while running the event loop can be
+// submitted with a single system call. Completions are signaled via
+// 'eventfd()' after which 'Reap()' invokes the callback of each
+// completed operation.
+//
+// NOTE: not thread-safe, all functions must be called from the same
+// thread (i.e., the thread running the event loop).
+class IoUring final {
+ public:
+  // Default number of submission queue entries, i.e., how many
+  // operations can be submitted with a single system call. Operations
+  // beyond this (or that would overflow the completion queue) are
+  // kept in a backlog until there is room.
+  static constexpr unsigned DEFAULT_ENTRIES = 256;
+
+  // An operation to perform, which must outlive the operation.
+  struct Operation final {
+    // Invoked with the result of the operation, i.e., whatever the
+    // corresponding system call would have returned (e.g., the
+    // number of bytes read) or '-errno' on failure.
+    Callback<void(int)> callback;
+  };
+
+  // Returns a new io_uring or nullptr if io_uring or any of the
+  // operations we need aren't supported (e.g., older kernels or
+  // sandboxes that disallow the system calls).
+  static std::unique_ptr<IoUring> Create(unsigned entries = DEFAULT_ENTRIES);
+
+  IoUring(const IoUring&) = delete;
+  IoUring(IoUring&&) = delete;
+
+  ~IoUring();
+
+  // File descriptor that becomes readable when operations complete.
+  int eventfd() const {
+    return eventfd_;
+  }
+
+  void Open(const char* path, int flags, int mode, Operation* operation);
+
+  void Close(int fd, Operation* operation);
+
+  void Read(
+      int fd,
+      void* buffer,
+      size_t size,
+      uint64_t offset,
+      Operation* operation);
+
+  void Write(
+      int fd,
+      const void* buffer,
+      size_t size,
+      uint64_t offset,
+      Operation* operation);
+
+  // Scatter/gather versions of 'Read()' and 'Write()', where
+  // 'buffers' must outlive the operation.
+  void ReadV(
+      int fd,
+      const iovec* buffers,
+      size_t count,
+      uint64_t offset,
+      Operation* operation);
+
+  void WriteV(
+      int fd,
+      const iovec* buffers,
+      size_t count,
+      uint64_t offset,
+      Operation* operation);
+
+  // Submits all prepared operations (and as many as possible from the
+  // backlog), returning how many were submitted.
+  size_t Submit();
+
+  // Invokes the callbacks of all completed operations (after clearing
+  // 'eventfd()'), returning how many there were.
+  size_t Reap();
+
+  // Number of operations that have not yet been submitted (including
+  // any in the backlog).
+  size_t prepared() const {
+    return prepared_ + backlog_.size();
+  }
+
+  // Number of operations that have been submitted but not reaped.
+  size_t inflight() const {
+    return inflight_;
+  }
+
+ private:
+  IoUring() = default;
+
+  // Adds 'sqe' to the submission queue or the backlog if full.
+  void Prepare(const io_uring_sqe& sqe);
+
+  int fd_ = -1;
+  int eventfd_ = -1;
+
+  unsigned sq_entries_ = 0;
+  unsigned cq_entries_ = 0;
+
+  // Memory mapped rings, which might be the same mapping if the
+  // kernel supports 'IORING_FEAT_SINGLE_MMAP'.
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  // Pointers into the mapped rings.
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  // Local tail of the submission queue which is only published to the
+  // kernel in 'Submit()'.
+  unsigned tail_ = 0;
+
+  size_t prepared_ = 0;
+  size_t inflight_ = 0;
+
+  std::deque<io_uring_sqe> backlog_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
+
+#endif
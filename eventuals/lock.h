@@ -7,8 +7,10 @@
 #include "eventuals/callback.h"
 #include "eventuals/compose.h"
 #include "eventuals/scheduler.h"
+#include "eventuals/stored-error.h"
 #include "eventuals/stream.h"
 #include "eventuals/then.h"
+#include "eventuals/trace.h"
 #include "eventuals/undefined.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -40,6 +42,7 @@ class Lock final {
               std::memory_order_relaxed)) {
         owner_.store(CHECK_NOTNULL(waiter->context.get()));
         waiter->acquired = true;
+        trace::AsyncBegin("Lock", waiter->context->name(), this);
         return true;
       }
     }
@@ -68,6 +71,7 @@ class Lock final {
               waiter,
               std::memory_order_release,
               std::memory_order_relaxed)) {
+        trace::AsyncBegin("Lock::Wait", waiter->context->name(), waiter);
         return false;
       } else {
         goto loop;
@@ -79,6 +83,9 @@ class Lock final {
     EVENTUALS_LOG(2)
         << "'" << Scheduler::Context::Get()->name() << "' releasing";
 
+    trace::AsyncEnd("Lock", Scheduler::Context::Get()->name(), this);
+
+  load:
     auto* waiter = head_.load(std::memory_order_relaxed);
 
     // Should have at least one waiter (who ever acquired) even if
@@ -90,14 +97,20 @@ class Lock final {
       // avoid racing with 'AcquireFast()' trying to set the owner.
       owner_.store(nullptr);
 
+      // Likewise unset 'acquired' _before_ the "compare and swap"
+      // because as soon as 'head_' is nullptr someone else might
+      // acquire the lock and resume our continuation (e.g., by
+      // notifying a 'ConditionVariable') on their thread which might
+      // then try and acquire the lock again with the same waiter.
+      waiter->acquired = false;
+
       if (!head_.compare_exchange_weak(
               waiter,
               nullptr,
               std::memory_order_release,
               std::memory_order_relaxed)) {
-        return Release(); // Try again.
+        goto load; // Try again.
       }
-      waiter->acquired = false;
     } else {
       while (waiter->next->next != nullptr) {
         waiter = waiter->next;
@@ -110,6 +123,9 @@ class Lock final {
 
       waiter->acquired = true;
 
+      trace::AsyncEnd("Lock::Wait", waiter->context->name(), waiter);
+      trace::AsyncBegin("Lock", waiter->context->name(), this);
+
       Callback<void()> f = std::move(waiter->f);
 
       f();
@@ -140,10 +156,15 @@ class Lock final {
 
 ////////////////////////////////////////////////////////////////////////
 
+// NOTE: '_Acquire' and '_Release' are parameterized by 'Lock_' so
+// that they can be reused for locks other than 'Lock' (e.g.,
+// 'SharedLock') that provide the same 'AcquireFast()',
+// 'AcquireSlow()', 'Release()', and 'Available()' functions and use
+// 'Lock::Waiter' as their 'Waiter'.
 struct _Acquire final {
-  template <typename K_, typename Arg_>
+  template <typename K_, typename Arg_, typename Errors_, typename Lock_>
   struct Continuation final {
-    Continuation(K_ k, Lock* lock)
+    Continuation(K_ k, Lock_* lock)
       : lock_(lock),
         k_(std::move(k)) {}
 
@@ -231,30 +252,17 @@ struct _Acquire final {
 
         k_.Fail(std::move(error));
       } else {
-        // TODO(benh): avoid allocating on heap by storing args in
-        // pre-allocated buffer based on composing with Errors.
-        using Tuple = std::tuple<decltype(this), Error>;
-        auto tuple = std::make_unique<Tuple>(
-            this,
-            std::forward<Error>(error));
-
-        waiter_.f = [tuple = std::move(tuple)]() mutable {
-          auto* acquire = std::get<0>(*tuple);
-          acquire->waiter_.context->Unblock(
-              [tuple = std::move(tuple)]() mutable {
-                std::apply(
-                    [](auto* acquire, auto&&... args) {
-                      // NOTE: need to relinquish borrow of context to
-                      // avoid this continuation causing a deadlock
-                      // when trying to destruct the context.
-                      auto& context = acquire->waiter_.context;
-                      context.relinquish();
-
-                      auto& k_ = acquire->k_;
-                      k_.Fail(std::forward<decltype(args)>(args)...);
-                    },
-                    std::move(*tuple));
-              });
+        error_.Store(std::forward<Error>(error));
+
+        waiter_.f = [this]() mutable {
+          waiter_.context->Unblock([this]() mutable {
+            // NOTE: need to relinquish borrow of context to avoid
+            // this continuation causing a deadlock when trying to
+            // destruct the context.
+            waiter_.context.relinquish();
+
+            error_.Fail(k_);
+          });
         };
 
         if (lock_->AcquireSlow(&waiter_)) {
@@ -456,11 +464,12 @@ struct _Acquire final {
       k_.Register(interrupt);
     }
 
-    Lock* lock_;
-    Lock::Waiter waiter_;
+    Lock_* lock_;
+    typename Lock_::Waiter waiter_;
     std::optional<
         std::conditional_t<!std::is_void_v<Arg_>, Arg_, Undefined>>
         arg_;
+    StoredError<K_, Errors_> error_;
     TypeErasedStream* stream_ = nullptr;
 
     // NOTE: we store 'k_' as the _last_ member so it will be
@@ -470,6 +479,7 @@ struct _Acquire final {
     K_ k_;
   };
 
+  template <typename Lock_>
   struct Composable final {
     template <typename Arg, typename Errors>
     using ValueFrom = Arg;
@@ -489,19 +499,19 @@ struct _Acquire final {
 
     template <typename Arg, typename Errors, typename K>
     auto k(K k) && {
-      return Continuation<K, Arg>(std::move(k), lock_);
+      return Continuation<K, Arg, Errors, Lock_>(std::move(k), lock_);
     }
 
-    Lock* lock_;
+    Lock_* lock_;
   };
 };
 
 ////////////////////////////////////////////////////////////////////////
 
 struct _Release final {
-  template <typename K_>
+  template <typename K_, typename Lock_>
   struct Continuation final {
-    Continuation(K_ k, Lock* lock)
+    Continuation(K_ k, Lock_* lock)
       : lock_(lock),
         k_(std::move(k)) {}
 
@@ -548,7 +558,7 @@ struct _Release final {
       k_.Register(interrupt);
     }
 
-    Lock* lock_;
+    Lock_* lock_;
 
     // NOTE: we store 'k_' as the _last_ member so it will be
     // destructed _first_ and thus we won't have any use-after-delete
@@ -557,6 +567,7 @@ struct _Release final {
     K_ k_;
   };
 
+  template <typename Lock_>
   struct Composable final {
     template <typename Arg, typename Errors>
     using ValueFrom = Arg;
@@ -576,10 +587,10 @@ struct _Release final {
 
     template <typename Arg, typename Errors, typename K>
     auto k(K k) && {
-      return Continuation<K>(std::move(k), lock_);
+      return Continuation<K, Lock_>(std::move(k), lock_);
     }
 
-    Lock* lock_;
+    Lock_* lock_;
   };
 };
 
@@ -825,13 +836,13 @@ struct _Wait final {
 ////////////////////////////////////////////////////////////////////////
 
 [[nodiscard]] inline auto Acquire(Lock* lock) {
-  return _Acquire::Composable{lock};
+  return _Acquire::Composable<Lock>{lock};
 }
 
 ////////////////////////////////////////////////////////////////////////
 
 [[nodiscard]] inline auto Release(Lock* lock) {
-  return _Release::Composable{lock};
+  return _Release::Composable<Lock>{lock};
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <climits>
+#include <cstdlib>
+
+#include "glog/logging.h"
+
+////////////////////////////////////////////////////////////////////////
+
+// Maximum level of 'EVENTUALS_LOG()' (and 'EVENTUALS_GRPC_LOG()')
+// that gets compiled in. Any site with a higher level compiles to
+// nothing (or rather, to a branch that is always false and gets
+// removed by the optimizer) so that release builds don't pay for
+// evaluating the level, nor for any of the streamed expressions,
+// e.g., '--copt=-DEVENTUALS_MAX_LOG_LEVEL=0' to compile out all
+// logging.
+#ifndef EVENTUALS_MAX_LOG_LEVEL
+#define EVENTUALS_MAX_LOG_LEVEL INT_MAX
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+// Hints to the compiler that 'condition' is unlikely to be true.
+//
+// NOTE: not using '[[unlikely]]' since it requires C++20.
+#if defined(__GNUC__) || defined(__clang__)
+#define EVENTUALS_UNLIKELY(condition) __builtin_expect(!!(condition), 0)
+#else
+#define EVENTUALS_UNLIKELY(condition) (condition)
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns true if the level specified via the 'EVENTUALS_LOG'
+// environment variable (which is only read once) is at least 'level'.
+inline bool EventualsLog(int level) {
+  static const int value = []() {
+    const char* variable = std::getenv("EVENTUALS_LOG");
+    return variable != nullptr ? atoi(variable) : 0;
+  }();
+  return EVENTUALS_UNLIKELY(value >= level);
+}
+
+#define EVENTUALS_LOG(level) \
+  LOG_IF(INFO, (level) <= EVENTUALS_MAX_LOG_LEVEL && EventualsLog(level))
+
+////////////////////////////////////////////////////////////////////////
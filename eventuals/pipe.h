@@ -41,8 +41,12 @@ class Pipe final : public Synchronizable {
   }
 
   // Reads the next value from the pipe.
+  //
+  // NOTE: using 'RepeatIteratively()' so that a reader that can read
+  // many values without waiting (or that gets resumed on the stack
+  // of a writer) doesn't recurse for every value.
   [[nodiscard]] auto Read() {
-    return Repeat()
+    return RepeatIteratively()
         >> Synchronized(
                Map([this]() {
                  return has_values_or_closed_.Wait([this]() {
@@ -38,6 +38,9 @@ template <typename E>
       Closure([context = Lazy<Scheduler::Context>(
                    Scheduler::Default(),
                    std::move(name))]() mutable {
+        // Use the same allocator as whoever is starting us.
+        context->set_allocator(Scheduler::Context::Get()->allocator());
+
         // NOTE: intentionally rescheduling with our context and never
         // rescheduling again because when we terminate we're done!
         return Reschedule(context->Borrow());
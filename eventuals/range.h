@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "eventuals/stream.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -18,7 +20,13 @@ struct _Range final {
         step_(step),
         k_(std::move(k)) {}
 
-    Continuation(Continuation&& that) noexcept = default;
+    // NOTE: explicit move-constructor because of 'std::atomic'.
+    Continuation(Continuation&& that) noexcept
+      : from_(that.from_),
+        to_(that.to_),
+        step_(that.step_),
+        previous_(std::move(that.previous_)),
+        k_(std::move(that.k_)) {}
 
     ~Continuation() override = default;
 
@@ -46,24 +54,40 @@ struct _Range final {
     }
 
     void Next() override {
-      if (from_ == to_
-          || step_ == 0
-          || (from_ > to_ && step_ > 0)
-          || (from_ < to_ && step_ < 0)) {
-        k_.Ended();
-      } else {
-        previous_->Continue([this]() {
-          int temp = from_;
-          from_ += step_;
-          k_.Body(temp);
-        });
-      }
+      Iterate();
     }
 
     void Done() override {
-      previous_->Continue([this]() {
-        k_.Ended();
-      });
+      // NOTE: 'Done()' is usually called from within 'k_.Body()' so we
+      // defer ending until it returns, see 'Iterate()'.
+      done_ = true;
+      Iterate();
+    }
+
+    // Emits values iteratively rather than recursively, i.e., calling
+    // 'Next()' while emitting a value (e.g., because everything
+    // downstream completed synchronously) doesn't recurse but instead
+    // emits the next value once 'k_.Body()' returns, otherwise the
+    // stack would grow with every value, see 'RepeatIteratively()'.
+    void Iterate() {
+      if (iterations_.fetch_add(1) == 0) {
+        previous_->Continue([this]() {
+          do {
+            if (done_
+                || from_ == to_
+                || step_ == 0
+                || (from_ > to_ && step_ > 0)
+                || (from_ < to_ && step_ < 0)) {
+              // NOTE: can't touch any members after ending.
+              k_.Ended();
+              return;
+            }
+            int temp = from_;
+            from_ += step_;
+            k_.Body(temp);
+          } while (iterations_.fetch_sub(1) != 1);
+        });
+      }
     }
 
     int from_;
@@ -72,6 +96,12 @@ struct _Range final {
 
     stout::borrowed_ptr<Scheduler::Context> previous_;
 
+    // Number of calls to 'Next()' (or 'Done()') that haven't been run
+    // yet (plus the one currently running), and whether or not 'Done()'
+    // was called, see 'Iterate()'.
+    std::atomic<size_t> iterations_ = 0;
+    bool done_ = false;
+
     // NOTE: we store 'k_' as the _last_ member so it will be
     // destructed _first_ and thus we won't have any use-after-delete
     // issues during destruction of 'k_' if it holds any references or
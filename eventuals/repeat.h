@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "eventuals/compose.h" // For 'HasValueFrom'.
 #include "eventuals/map.h"
 #include "eventuals/stream.h"
@@ -11,13 +13,16 @@ namespace eventuals {
 ////////////////////////////////////////////////////////////////////////
 
 struct _Repeat final {
-  template <typename K_>
+  template <typename K_, bool Iterative_>
   struct Continuation final : public TypeErasedStream {
     // NOTE: explicit constructor because inheriting 'TypeErasedStream'.
     Continuation(K_ k)
       : k_(std::move(k)) {}
 
-    Continuation(Continuation&& that) noexcept = default;
+    // NOTE: explicit move-constructor because of 'std::atomic'.
+    Continuation(Continuation&& that) noexcept
+      : previous_(std::move(that.previous_)),
+        k_(std::move(that.k_)) {}
 
     ~Continuation() override = default;
 
@@ -42,19 +47,57 @@ struct _Repeat final {
     }
 
     void Next() override {
-      previous_->Continue([this]() {
-        k_.Body();
-      });
+      if constexpr (!Iterative_) {
+        previous_->Continue([this]() {
+          k_.Body();
+        });
+      } else {
+        Iterate();
+      }
     }
 
     void Done() override {
-      previous_->Continue([this]() {
-        k_.Ended();
-      });
+      if constexpr (!Iterative_) {
+        previous_->Continue([this]() {
+          k_.Ended();
+        });
+      } else {
+        // NOTE: 'Done()' is usually called from within the body (e.g.,
+        // by 'Until()') so we defer ending until the body returns
+        // since 'k_.Ended()' might complete (and thus destruct) us.
+        done_ = true;
+        Iterate();
+      }
+    }
+
+    // Only whoever increments 'iterations_' from 0 runs the body, and
+    // keeps running it until every 'Next()' (or 'Done()') that was
+    // called in the meantime, either from within the body (i.e.,
+    // because downstream completed synchronously) or from another
+    // thread, has been accounted for.
+    void Iterate() {
+      if (iterations_.fetch_add(1) == 0) {
+        previous_->Continue([this]() {
+          do {
+            if (done_) {
+              // NOTE: can't touch any members after ending.
+              k_.Ended();
+              return;
+            }
+            k_.Body();
+          } while (iterations_.fetch_sub(1) != 1);
+        });
+      }
     }
 
     stout::borrowed_ptr<Scheduler::Context> previous_;
 
+    // Number of calls to 'Next()' (or 'Done()') that haven't been run
+    // yet (plus the one currently running), and whether or not 'Done()'
+    // was called, only used if 'Iterative_'.
+    std::atomic<size_t> iterations_ = 0;
+    bool done_ = false;
+
     // NOTE: we store 'k_' as the _last_ member so it will be
     // destructed _first_ and thus we won't have any use-after-delete
     // issues during destruction of 'k_' if it holds any references or
@@ -62,6 +105,7 @@ struct _Repeat final {
     K_ k_;
   };
 
+  template <bool Iterative_>
   struct Composable final {
     template <typename Arg, typename Errors>
     using ValueFrom = void;
@@ -71,7 +115,7 @@ struct _Repeat final {
 
     template <typename Arg, typename Errors, typename K>
     auto k(K k) {
-      return Continuation<K>(std::move(k));
+      return Continuation<K, Iterative_>(std::move(k));
     }
 
     template <typename Downstream>
@@ -89,11 +133,21 @@ template <typename F>
       !HasValueFrom<F>::value,
       "'Repeat' expects a callable (e.g., a lambda) not an eventual");
 
-  return _Repeat::Composable{} >> Map(std::move(f));
+  return _Repeat::Composable<false>{} >> Map(std::move(f));
 }
 
 [[nodiscard]] inline auto Repeat() {
-  return _Repeat::Composable{};
+  return _Repeat::Composable<false>{};
+}
+
+// Like 'Repeat()' except that calling 'Next()' while the body is
+// already running (e.g., because everything downstream completed
+// synchronously) doesn't recurse but instead runs the body again once
+// it returns. This keeps the stack from growing with every iteration
+// of a long running stream that rarely has to wait, e.g., a reader of
+// a 'Pipe'.
+[[nodiscard]] inline auto RepeatIteratively() {
+  return _Repeat::Composable<true>{};
 }
 
 ////////////////////////////////////////////////////////////////////////
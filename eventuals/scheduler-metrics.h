@@ -0,0 +1,306 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////
+
+// Whether or not schedulers (e.g., 'StaticThreadPool' and
+// 'EventLoop') record metrics. Recording is just a few relaxed
+// atomic operations and reads of a monotonic clock, but it can be
+// compiled out completely with
+// '--copt=-DEVENTUALS_SCHEDULER_METRICS=0'.
+#ifndef EVENTUALS_SCHEDULER_METRICS
+#define EVENTUALS_SCHEDULER_METRICS 1
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// Lock-free metrics for a scheduler with a fixed number of "workers"
+// (e.g., a thread per CPU for 'StaticThreadPool' or the single thread
+// running an 'EventLoop').
+//
+// Each worker has its own cache line of counters so that recording
+// doesn't cause any false sharing between workers. Counters are only
+// ever updated with relaxed atomics, which means a 'snapshot()' is
+// not guaranteed to be consistent across counters (e.g., a callback
+// might be counted as run before its latency is recorded), but is
+// always good enough for monitoring.
+class SchedulerMetrics final {
+ public:
+  static constexpr bool ENABLED = EVENTUALS_SCHEDULER_METRICS;
+
+  // Number of buckets in a histogram. Bucket 'i' counts durations
+  // that are less than 2^i nanoseconds (and at least 2^(i - 1)),
+  // except for the last bucket which counts everything that is at
+  // least ~1 second.
+  static constexpr std::size_t BUCKETS = 32;
+
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  struct Histogram final {
+    // Returns the total number of durations recorded.
+    uint64_t count() const {
+      uint64_t count = 0;
+      for (uint64_t n : buckets) {
+        count += n;
+      }
+      return count;
+    }
+
+    // Returns an upper bound for the duration at the given percentile
+    // (between 0.0 and 1.0), i.e., the upper bound of the bucket that
+    // the percentile falls in, or 0 if nothing has been recorded.
+    std::chrono::nanoseconds Percentile(double percentile) const {
+      const uint64_t total = count();
+
+      if (total == 0) {
+        return std::chrono::nanoseconds(0);
+      }
+
+      const double threshold = percentile * total;
+
+      uint64_t count = 0;
+      for (std::size_t i = 0; i < BUCKETS; i++) {
+        count += buckets[i];
+        if (count > 0 && count >= threshold) {
+          return std::chrono::nanoseconds(uint64_t(1) << i);
+        }
+      }
+
+      return std::chrono::nanoseconds(uint64_t(1) << (BUCKETS - 1));
+    }
+
+    Histogram& operator+=(const Histogram& that) {
+      for (std::size_t i = 0; i < BUCKETS; i++) {
+        buckets[i] += that.buckets[i];
+      }
+      return *this;
+    }
+
+    std::array<uint64_t, BUCKETS> buckets = {};
+  };
+
+  // Metrics for a single worker at the time of a 'snapshot()'.
+  struct Worker final {
+    // Number of callbacks that have been submitted but not yet run.
+    uint64_t depth() const {
+      return submitted > dequeued ? submitted - dequeued : 0;
+    }
+
+    // Fraction of checks for whether or not a context was
+    // "continuable" that could continue without submitting, or 0 if
+    // nothing has been checked.
+    double continuable_hit_rate() const {
+      const uint64_t total = continuable_hits + continuable_misses;
+      return total == 0 ? 0.0 : double(continuable_hits) / total;
+    }
+
+    Worker& operator+=(const Worker& that) {
+      submitted += that.submitted;
+      dequeued += that.dequeued;
+      wakeups += that.wakeups;
+      continuable_hits += that.continuable_hits;
+      continuable_misses += that.continuable_misses;
+      latency += that.latency;
+      run_time += that.run_time;
+      return *this;
+    }
+
+    uint64_t submitted = 0;
+    uint64_t dequeued = 0;
+    uint64_t wakeups = 0;
+    uint64_t continuable_hits = 0;
+    uint64_t continuable_misses = 0;
+
+    // Time between a callback being submitted and starting to run.
+    Histogram latency;
+
+    // Time spent running callbacks.
+    Histogram run_time;
+  };
+
+  struct Snapshot final {
+    // Returns the metrics summed across all workers.
+    Worker total() const {
+      Worker total;
+      for (const Worker& worker : workers) {
+        total += worker;
+      }
+      return total;
+    }
+
+    std::vector<Worker> workers;
+  };
+
+  // Returns the current time if metrics are enabled (and otherwise a
+  // default constructed time point without reading the clock).
+  static TimePoint Now() {
+    if constexpr (ENABLED) {
+      return Clock::now();
+    } else {
+      return TimePoint();
+    }
+  }
+
+  explicit SchedulerMetrics(std::size_t workers)
+    : workers_(workers) {
+    if constexpr (ENABLED) {
+      counters_.reset(new Counters[workers]);
+    }
+  }
+
+  std::size_t workers() const {
+    return workers_;
+  }
+
+  // Records a callback being submitted to (i.e., enqueued for) the
+  // worker, which may be called from any thread.
+  void RecordSubmit(std::size_t worker) {
+    if constexpr (ENABLED) {
+      counters(worker).submitted.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Records a callback that was submitted at 'submitted' being
+  // dequeued at 'now'. Must only be called by the worker itself.
+  void RecordDequeue(
+      std::size_t worker,
+      TimePoint submitted,
+      TimePoint now) {
+    if constexpr (ENABLED) {
+      Counters& counters = this->counters(worker);
+      Increment(counters.dequeued);
+      Increment(counters.latency[BucketOf(now - submitted)]);
+    }
+  }
+
+  // Records running a callback from 'start' until 'end'. Must only be
+  // called by the worker itself.
+  void RecordRun(std::size_t worker, TimePoint start, TimePoint end) {
+    if constexpr (ENABLED) {
+      Increment(counters(worker).run_time[BucketOf(end - start)]);
+    }
+  }
+
+  // Records the worker waking up to look for callbacks to
+  // run. Must only be called by the worker itself.
+  void RecordWakeup(std::size_t worker) {
+    if constexpr (ENABLED) {
+      Increment(counters(worker).wakeups);
+    }
+  }
+
+  // Records whether or not a context for the worker was
+  // "continuable", which may be called from any thread.
+  void RecordContinuable(std::size_t worker, bool continuable) {
+    if constexpr (ENABLED) {
+      Counters& counters = this->counters(worker);
+      if (continuable) {
+        counters.continuable_hits.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        counters.continuable_misses.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Returns the metrics recorded so far, which are all 0 if metrics
+  // have been compiled out. Safe to call from any thread.
+  Snapshot snapshot() const {
+    Snapshot snapshot;
+    snapshot.workers.resize(workers_);
+
+    if constexpr (ENABLED) {
+      for (std::size_t i = 0; i < workers_; i++) {
+        const Counters& counters = counters_[i];
+        Worker& worker = snapshot.workers[i];
+        // NOTE: loading 'dequeued' _before_ 'submitted' so that (at
+        // least for a single submitter) 'depth()' doesn't underflow.
+        worker.dequeued = Load(counters.dequeued);
+        worker.submitted = Load(counters.submitted);
+        worker.wakeups = Load(counters.wakeups);
+        worker.continuable_hits = Load(counters.continuable_hits);
+        worker.continuable_misses = Load(counters.continuable_misses);
+        for (std::size_t bucket = 0; bucket < BUCKETS; bucket++) {
+          worker.latency.buckets[bucket] = Load(counters.latency[bucket]);
+          worker.run_time.buckets[bucket] = Load(counters.run_time[bucket]);
+        }
+      }
+    }
+
+    return snapshot;
+  }
+
+  // Returns the histogram bucket for the given duration.
+  static std::size_t BucketOf(Clock::duration duration) {
+    const auto nanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+            .count();
+
+    if (nanoseconds <= 0) {
+      return 0;
+    }
+
+    // Compute the number of bits needed to represent 'nanoseconds'
+    // with a binary search rather than a loop since this is on the
+    // hot path.
+    uint64_t n = static_cast<uint64_t>(nanoseconds);
+    std::size_t bits = 0;
+    for (std::size_t shift = 32; shift > 0; shift /= 2) {
+      if ((n >> shift) != 0) {
+        n >>= shift;
+        bits += shift;
+      }
+    }
+    bits += n; // 'n' is now 1.
+
+    return bits < BUCKETS ? bits : BUCKETS - 1;
+  }
+
+ private:
+  struct alignas(64) Counters final {
+    std::atomic<uint64_t> submitted = 0;
+    std::atomic<uint64_t> dequeued = 0;
+    std::atomic<uint64_t> wakeups = 0;
+    std::atomic<uint64_t> continuable_hits = 0;
+    std::atomic<uint64_t> continuable_misses = 0;
+    std::array<std::atomic<uint64_t>, BUCKETS> latency = {};
+    std::array<std::atomic<uint64_t>, BUCKETS> run_time = {};
+  };
+
+  // NOTE: only for counters that have a single writer (the worker)
+  // so we can avoid the cost of an atomic read-modify-write.
+  static void Increment(std::atomic<uint64_t>& counter) {
+    counter.store(
+        counter.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+  }
+
+  static uint64_t Load(const std::atomic<uint64_t>& counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+
+  Counters& counters(std::size_t worker) {
+    return counters_[worker];
+  }
+
+  const std::size_t workers_;
+
+  std::unique_ptr<Counters[]> counters_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
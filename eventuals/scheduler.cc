@@ -31,8 +31,12 @@ class DefaultScheduler final : public Scheduler {
 
     context.use();
 
+    trace::Begin("Run", context.name());
+
     callback();
 
+    trace::End("Run", context.name());
+
     CHECK_EQ(&context, Context::Switch(std::move(previous)).get());
 
     context.unuse();
@@ -7,12 +7,17 @@
 #include <string>
 #include <tuple>
 
+#include "eventuals/allocator.h"
 #include "eventuals/callback.h"
 #include "eventuals/closure.h"
 #include "eventuals/compose.h"
+#include "eventuals/context-name.h"
 #include "eventuals/interrupt.h"
 #include "eventuals/lazy.h"
+#include "eventuals/scheduler-metrics.h"
+#include "eventuals/stored-error.h"
 #include "eventuals/terminal.h"
+#include "eventuals/trace.h"
 #include "eventuals/undefined.h"
 #include "stout/borrowable.h"
 #include "stout/stringify.h"
@@ -42,6 +47,10 @@ class Scheduler {
 
     // For schedulers to create intrusive linked lists of waiters.
     Waiter* next = nullptr;
+
+    // For schedulers that record 'SchedulerMetrics', when this waiter
+    // was submitted.
+    SchedulerMetrics::TimePoint submitted;
   };
 
   class Context final : public stout::enable_borrowable_from_this<Context> {
@@ -57,13 +66,14 @@ class Scheduler {
       return previous;
     }
 
-    Context(Scheduler* scheduler, std::string&& name, void* data = nullptr)
+    Context(Scheduler* scheduler, ContextName name, void* data = nullptr)
       : data(data),
         scheduler_(CHECK_NOTNULL(scheduler)),
         name_(std::move(name)) {}
 
-    Context(std::string&& name)
+    Context(ContextName name)
       : Context(Context::Get()->scheduler(), std::move(name)) {
+      allocator_ = Context::Get()->allocator_;
       scheduler()->Clone(*this);
     }
 
@@ -105,10 +115,23 @@ class Scheduler {
       return in_use_.load() != 0;
     }
 
-    const std::string& name() const {
+    const ContextName& name() const {
       return name_;
     }
 
+    // Returns the allocator that eventuals executing on this context
+    // should use for any memory they need to allocate, which is the
+    // 'DefaultAllocator()' unless one has been set.
+    Allocator* allocator() const {
+      return allocator_ != nullptr ? allocator_ : DefaultAllocator();
+    }
+
+    // NOTE: the allocator must outlive any memory allocated with it
+    // which may be longer than this context!
+    void set_allocator(Allocator* allocator) {
+      allocator_ = allocator;
+    }
+
     template <typename F>
     void Unblock(F f) {
       scheduler()->Submit(std::move(f), *this);
@@ -119,10 +142,13 @@ class Scheduler {
       if (scheduler()->Continuable(*this)) {
         auto previous = Switch(Borrow());
         use();
+        trace::Begin("Continue", name_);
         f();
+        trace::End("Continue", name_);
         Switch(std::move(previous));
         unuse();
       } else {
+        trace::Instant("Submit", name_);
         scheduler()->Submit(std::forward<F>(f), *this);
       }
     }
@@ -132,10 +158,13 @@ class Scheduler {
       if (scheduler()->Continuable(*this)) {
         auto previous = Switch(Borrow());
         use();
+        trace::Begin("Continue", name_);
         f();
+        trace::End("Continue", name_);
         Switch(std::move(previous));
         unuse();
       } else {
+        trace::Instant("Submit", name_);
         scheduler()->Submit(g(), *this);
       }
     }
@@ -166,7 +195,10 @@ class Scheduler {
     // There is the most common set of variables to create contexts.
     bool blocked_ = false;
 
-    std::string name_;
+    ContextName name_;
+
+    // Inherited by contexts that are cloned from this one.
+    Allocator* allocator_ = nullptr;
   };
 
   virtual ~Scheduler() = default;
@@ -183,7 +215,7 @@ class Scheduler {
 ////////////////////////////////////////////////////////////////////////
 
 struct _Reschedule final {
-  template <typename K_, typename Arg_>
+  template <typename K_, typename Arg_, typename Errors_>
   struct Continuation final {
     Continuation(K_ k, stout::borrowed_ref<Scheduler::Context> context)
       : context_(std::move(context)),
@@ -226,19 +258,10 @@ struct _Reschedule final {
             k_.Fail(std::forward<Error>(error));
           },
           [&]() {
-            // TODO(benh): avoid allocating on heap by storing args in
-            // pre-allocated buffer based on composing with Errors.
-            using Tuple = std::tuple<decltype(&k_), Error>;
-            auto tuple = std::make_unique<Tuple>(
-                &k_,
-                std::forward<Error>(error));
-
-            return [tuple = std::move(tuple)]() mutable {
-              std::apply(
-                  [](auto* k_, auto&&... args) {
-                    k_->Fail(std::forward<decltype(args)>(args)...);
-                  },
-                  std::move(*tuple));
+            error_.Store(std::forward<Error>(error));
+
+            return [this]() {
+              error_.Fail(k_);
             };
           });
     }
@@ -319,6 +342,8 @@ struct _Reschedule final {
             Undefined>>
         arg_;
 
+    StoredError<K_, Errors_> error_;
+
     TypeErasedStream* stream_ = nullptr;
 
     // NOTE: we store 'k_' as the _last_ member so it will be
@@ -347,7 +372,7 @@ struct _Reschedule final {
 
     template <typename Arg, typename Errors, typename K>
     auto k(K k) && {
-      return Continuation<K, Arg>(std::move(k), std::move(context_));
+      return Continuation<K, Arg, Errors>(std::move(k), std::move(context_));
     }
 
     stout::borrowed_ref<Scheduler::Context> context_;
@@ -433,7 +458,7 @@ struct Reschedulable final {
 struct _Preempt final {
   template <typename K_, typename E_, typename Arg_, typename Errors_>
   struct Continuation final {
-    Continuation(K_ k, E_ e, std::string name)
+    Continuation(K_ k, E_ e, ContextName name)
       : context_(
           Scheduler::Default(),
           std::move(name)),
@@ -443,7 +468,7 @@ struct _Preempt final {
     Continuation(Continuation&& that) noexcept
       : context_(
           Scheduler::Default(),
-          std::move(const_cast<std::string&>(that.context_.name()))),
+          that.context_.name()),
         e_(std::move(that.e_)),
         k_(std::move(that.k_)) {
       CHECK_EQ(that.previous_, nullptr) << "moving after starting";
@@ -549,14 +574,14 @@ struct _Preempt final {
     }
 
     E_ e_;
-    std::string name_;
+    ContextName name_;
   };
 };
 
 ////////////////////////////////////////////////////////////////////////
 
 template <typename E>
-[[nodiscard]] auto Preempt(std::string name, E e) {
+[[nodiscard]] auto Preempt(ContextName name, E e) {
   return _Preempt::Composable<E>{std::move(e), std::move(name)};
 }
 
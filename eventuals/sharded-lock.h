@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#include "eventuals/lock.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// 'N' independent locks where a key is hashed to pick which lock to
+// use so that eventuals synchronizing on different keys rarely
+// contend with one another, e.g., for a map that is partitioned into
+// 'N' maps where each map is protected by one of the locks.
+//
+// NOTE: eventuals synchronizing on keys that hash to the same lock
+// are serialized just like eventuals synchronizing on the same key.
+template <size_t N, typename Hash = void>
+class ShardedLock final {
+ public:
+  static_assert(N > 0, "'ShardedLock' requires at least 1 lock");
+
+  // Returns the index of the lock that 'key' hashes to.
+  template <typename Key>
+  static size_t IndexOf(const Key& key) {
+    if constexpr (std::is_void_v<Hash>) {
+      return std::hash<Key>{}(key) % N;
+    } else {
+      return Hash{}(key) % N;
+    }
+  }
+
+  template <typename Key>
+  Lock& lock(const Key& key) {
+    return shards_[IndexOf(key)].lock;
+  }
+
+  // Returns an eventual that runs 'e' while holding the lock that
+  // 'key' hashes to.
+  template <typename Key, typename E>
+  [[nodiscard]] auto Synchronized(const Key& key, E e) {
+    return _Synchronized::Composable<E>{&lock(key), std::move(e)};
+  }
+
+  static constexpr size_t size() {
+    return N;
+  }
+
+ private:
+  // NOTE: keeping each lock on its own cache line so that acquiring
+  // one lock doesn't slow down acquiring any other.
+  struct alignas(64) Shard final {
+    Lock lock;
+  };
+
+  std::array<Shard, N> shards_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "eventuals/callback.h"
+#include "eventuals/lock.h"
+#include "eventuals/scheduler.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// A reader-writer lock: any number of scheduler contexts may hold the
+// lock "shared" (see 'AcquireShared()' and 'ReleaseShared()') or a
+// single scheduler context may hold the lock "exclusive" (see
+// 'Acquire()' and 'Release()').
+//
+// Writers are preferred to avoid starving them: once a writer is
+// waiting any new readers wait as well, and when a writer releases
+// the lock all of the readers that were waiting are admitted before
+// the next writer (so readers can't be starved either).
+//
+// Acquiring or releasing the lock when nobody is waiting is a single
+// "compare and swap" on 'state_'. Waiting readers and writers are
+// queued while holding 'mutex_' which is only ever held for a handful
+// of instructions and never while invoking a waiter's callback.
+class SharedLock final {
+ public:
+  // NOTE: we use the same 'Waiter' as 'Lock' so that we can reuse
+  // '_Acquire' and '_Release'.
+  using Waiter = Lock::Waiter;
+
+  // Adaptor that provides the functions '_Acquire' and '_Release'
+  // expect for acquiring and releasing the lock shared.
+  class Shared final {
+   public:
+    using Waiter = SharedLock::Waiter;
+
+    bool AcquireFast(Waiter* waiter) {
+      return lock_->AcquireSharedFast(waiter);
+    }
+
+    bool AcquireSlow(Waiter* waiter) {
+      return lock_->AcquireSharedSlow(waiter);
+    }
+
+    void Release() {
+      lock_->ReleaseShared();
+    }
+
+    bool Available() {
+      return lock_->Available();
+    }
+
+   private:
+    friend class SharedLock;
+
+    explicit Shared(SharedLock* lock)
+      : lock_(lock) {}
+
+    SharedLock* lock_;
+  };
+
+  SharedLock()
+    : shared_(this) {}
+
+  SharedLock(const SharedLock&) = delete;
+  SharedLock(SharedLock&&) = delete;
+
+  ~SharedLock() {
+    CHECK(Available()) << "destructing while lock is held";
+  }
+
+  bool AcquireFast(Waiter* waiter) {
+    CHECK(!waiter->acquired) << "recursive lock acquire detected";
+    CHECK(waiter->next == nullptr);
+
+    uint64_t state = 0;
+
+    if (state_.compare_exchange_strong(
+            state,
+            WRITER,
+            std::memory_order_acquire,
+            std::memory_order_relaxed)) {
+      Acquired(waiter);
+      return true;
+    }
+
+    return false;
+  }
+
+  bool AcquireSlow(Waiter* waiter) {
+    CHECK(!waiter->acquired) << "recursive lock acquire detected";
+    CHECK(waiter->next == nullptr);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // NOTE: setting 'WAITERS' causes all fast paths to fail so after
+    // this nothing can change 'state_' without holding 'mutex_'
+    // _except_ readers releasing.
+    uint64_t state = state_.fetch_or(WAITERS) | WAITERS;
+
+    if (Readers(state) == 0 && !(state & WRITER) && writers_.empty()) {
+      state_.fetch_or(WRITER, std::memory_order_acquire);
+      Acquired(waiter);
+      ClearWaitersIfNoneWaiting();
+      return true;
+    }
+
+    writers_.Enqueue(waiter);
+
+    return false;
+  }
+
+  void Release() {
+    EVENTUALS_LOG(2)
+        << "'" << Scheduler::Context::Get()->name() << "' releasing";
+
+    CHECK(state_.load() & WRITER) << "releasing lock not held exclusive";
+
+    CHECK_NOTNULL(writer_)->acquired = false;
+    writer_ = nullptr;
+
+    // Unset owner _now_ instead of _after_ the "compare and swap" to
+    // avoid racing with 'AcquireFast()' trying to set the owner.
+    owner_.store(nullptr);
+
+    uint64_t state = WRITER;
+
+    if (!state_.compare_exchange_strong(
+            state,
+            0,
+            std::memory_order_release,
+            std::memory_order_relaxed)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      state_.fetch_and(~WRITER, std::memory_order_release);
+      Waiter* waiters = Admit(/* prefer_readers = */ true);
+      lock.unlock();
+      Resume(waiters);
+    }
+  }
+
+  bool AcquireSharedFast(Waiter* waiter) {
+    uint64_t state = state_.load(std::memory_order_relaxed);
+
+    while (!(state & (WRITER | WAITERS))) {
+      if (state_.compare_exchange_weak(
+              state,
+              state + 1,
+              std::memory_order_acquire,
+              std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool AcquireSharedSlow(Waiter* waiter) {
+    CHECK(waiter->next == nullptr);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    uint64_t state = state_.fetch_or(WAITERS) | WAITERS;
+
+    // NOTE: only admitting a new reader if there aren't any writers
+    // waiting, otherwise we might starve them.
+    if (!(state & WRITER) && writers_.empty()) {
+      state_.fetch_add(1, std::memory_order_acquire);
+      ClearWaitersIfNoneWaiting();
+      return true;
+    }
+
+    readers_.Enqueue(waiter);
+
+    return false;
+  }
+
+  void ReleaseShared() {
+    EVENTUALS_LOG(2)
+        << "'" << Scheduler::Context::Get()->name() << "' releasing shared";
+
+    uint64_t state = state_.fetch_sub(1, std::memory_order_release);
+
+    CHECK_GT(Readers(state), 0u) << "releasing lock not held shared";
+
+    // Only the last reader needs to admit any waiters.
+    if (Readers(state) == 1 && (state & WAITERS)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      Waiter* waiters = Admit(/* prefer_readers = */ false);
+      lock.unlock();
+      Resume(waiters);
+    }
+  }
+
+  // Returns true if the lock is not held either shared or exclusive.
+  bool Available() {
+    return (state_.load(std::memory_order_relaxed) & ~WAITERS) == 0;
+  }
+
+  // Returns true if the lock is held exclusive by the current
+  // scheduler context.
+  //
+  // NOTE: there is no way to check whether or not the current
+  // scheduler context holds the lock shared.
+  bool OwnedByCurrentSchedulerContext() {
+    // NOTE: using 'CHECK_NOTNULL' because the intention here is that
+    // the caller expects to have a current scheduler context.
+    return owner_.load() == CHECK_NOTNULL(Scheduler::Context::Get().get());
+  }
+
+  Shared* shared() {
+    return &shared_;
+  }
+
+ private:
+  // Intrusive FIFO of waiters linked through 'Waiter::next'.
+  struct Waiters final {
+    bool empty() const {
+      return head == nullptr;
+    }
+
+    void Enqueue(Waiter* waiter) {
+      if (tail == nullptr) {
+        head = waiter;
+      } else {
+        tail->next = waiter;
+      }
+      tail = waiter;
+    }
+
+    Waiter* Dequeue() {
+      Waiter* waiter = CHECK_NOTNULL(head);
+      head = waiter->next;
+      if (head == nullptr) {
+        tail = nullptr;
+      }
+      waiter->next = nullptr;
+      return waiter;
+    }
+
+    // Removes and returns all of the waiters still linked together.
+    Waiter* DequeueAll(size_t* count) {
+      Waiter* waiters = head;
+      for (Waiter* waiter = head; waiter != nullptr; waiter = waiter->next) {
+        (*count)++;
+      }
+      head = nullptr;
+      tail = nullptr;
+      return waiters;
+    }
+
+    Waiter* head = nullptr;
+    Waiter* tail = nullptr;
+  };
+
+  static uint64_t Readers(uint64_t state) {
+    return state & READERS;
+  }
+
+  // NOTE: expects 'WRITER' to already be set.
+  void Acquired(Waiter* waiter) {
+    owner_.store(CHECK_NOTNULL(waiter->context.get()));
+    waiter->acquired = true;
+    writer_ = waiter;
+  }
+
+  // NOTE: expects to be called while holding 'mutex_'.
+  void ClearWaitersIfNoneWaiting() {
+    if (readers_.empty() && writers_.empty()) {
+      state_.fetch_and(~WAITERS);
+    }
+  }
+
+  // Admits either all of the waiting readers or the next waiting
+  // writer, if possible, and returns the admitted waiters (linked
+  // through 'Waiter::next') that need to be resumed _after_ releasing
+  // 'mutex_'.
+  //
+  // NOTE: expects to be called while holding 'mutex_'.
+  Waiter* Admit(bool prefer_readers) {
+    uint64_t state = state_.load();
+
+    Waiter* waiters = nullptr;
+
+    if (state & WRITER) {
+      // Someone else was admitted in the meantime.
+    } else if (!readers_.empty() && (prefer_readers || writers_.empty())) {
+      size_t count = 0;
+      waiters = readers_.DequeueAll(&count);
+      state_.fetch_add(count, std::memory_order_acquire);
+    } else if (!writers_.empty() && Readers(state) == 0) {
+      state_.fetch_or(WRITER, std::memory_order_acquire);
+      waiters = writers_.Dequeue();
+      Acquired(waiters);
+    }
+
+    ClearWaitersIfNoneWaiting();
+
+    return waiters;
+  }
+
+  static void Resume(Waiter* waiters) {
+    while (waiters != nullptr) {
+      Waiter* waiter = waiters;
+      waiters = waiter->next;
+      waiter->next = nullptr;
+      Callback<void()> f = std::move(waiter->f);
+      f();
+    }
+  }
+
+  // Low bits of 'state_' count the readers holding the lock.
+  static constexpr uint64_t WRITER = uint64_t(1) << 63;
+  static constexpr uint64_t WAITERS = uint64_t(1) << 62;
+  static constexpr uint64_t READERS = WAITERS - 1;
+
+  std::atomic<uint64_t> state_ = 0;
+
+  std::mutex mutex_;
+  Waiters readers_;
+  Waiters writers_;
+
+  // Waiter currently holding the lock exclusive, only accessed by
+  // whoever holds the lock exclusive.
+  Waiter* writer_ = nullptr;
+
+  // See comment on 'Lock::owner_'.
+  std::atomic<Scheduler::Context*> owner_ = nullptr;
+
+  Shared shared_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Acquire(SharedLock* lock) {
+  return _Acquire::Composable<SharedLock>{lock};
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto Release(SharedLock* lock) {
+  return _Release::Composable<SharedLock>{lock};
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto AcquireShared(SharedLock* lock) {
+  return _Acquire::Composable<SharedLock::Shared>{lock->shared()};
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto ReleaseShared(SharedLock* lock) {
+  return _Release::Composable<SharedLock::Shared>{lock->shared()};
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
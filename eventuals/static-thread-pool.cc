@@ -10,7 +10,8 @@ namespace eventuals {
 ////////////////////////////////////////////////////////////////////////
 
 StaticThreadPool::StaticThreadPool()
-  : concurrency(std::thread::hardware_concurrency()) {
+  : concurrency(std::thread::hardware_concurrency()),
+    metrics_(concurrency) {
   semaphores_.reserve(concurrency);
   heads_.reserve(concurrency);
   threads_.reserve(concurrency);
@@ -43,6 +44,8 @@ StaticThreadPool::StaticThreadPool()
           do {
             semaphore.Wait();
 
+            metrics_.RecordWakeup(cpu);
+
           load:
             Waiter* waiter = head.load(std::memory_order_relaxed);
 
@@ -75,6 +78,10 @@ StaticThreadPool::StaticThreadPool()
 
               EVENTUALS_LOG(1) << "Resuming '" << context->name() << "'";
 
+              auto start = SchedulerMetrics::Now();
+
+              metrics_.RecordDequeue(cpu, waiter->submitted, start);
+
               context->unblock();
 
               context->use();
@@ -86,6 +93,8 @@ StaticThreadPool::StaticThreadPool()
 
               Callback<void()> callback = std::move(waiter->callback);
 
+              trace::Begin("Run", context->name());
+
               callback();
 
               ////////////////////////////////////////////////////
@@ -93,6 +102,10 @@ StaticThreadPool::StaticThreadPool()
               // because it might have been deallocated!        //
               ////////////////////////////////////////////////////
 
+              trace::End("Run", context->name());
+
+              metrics_.RecordRun(cpu, start, SchedulerMetrics::Now());
+
               CHECK_EQ(context, Context::Switch(std::move(previous)).get());
 
               context->unuse();
@@ -152,6 +165,12 @@ void StaticThreadPool::Submit(Callback<void()> callback, Context& context) {
 
   CHECK(waiter->next == nullptr) << context.name();
 
+  // NOTE: must record _before_ enqueuing because once the waiter has
+  // been enqueued it might get dequeued (and run) immediately.
+  waiter->submitted = SchedulerMetrics::Now();
+
+  metrics_.RecordSubmit(cpu);
+
   waiter->next = head->load(std::memory_order_relaxed);
 
   while (!head->compare_exchange_weak(
@@ -183,7 +202,11 @@ bool StaticThreadPool::Continuable(const Context& context) {
 
   unsigned int cpu = pinned.cpu().value();
 
-  return StaticThreadPool::member && StaticThreadPool::cpu == cpu;
+  bool continuable = StaticThreadPool::member && StaticThreadPool::cpu == cpu;
+
+  metrics_.RecordContinuable(cpu, continuable);
+
+  return continuable;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -15,6 +15,7 @@
 #include "eventuals/lazy.h"
 #include "eventuals/scheduler.h"
 #include "eventuals/semaphore.h"
+#include "eventuals/stored-error.h"
 #include "stout/borrowed_ptr.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -107,7 +108,7 @@ class StaticThreadPool final : public Scheduler {
     auto Schedule(E e);
 
     template <typename E>
-    auto Schedule(std::string&& name, E e);
+    auto Schedule(ContextName name, E e);
 
     auto* requirements() {
       return &requirements_;
@@ -145,7 +146,7 @@ class StaticThreadPool final : public Scheduler {
 
   template <typename E>
   [[nodiscard]] auto Schedule(
-      std::string&& name,
+      ContextName name,
       Requirements* requirements,
       E e);
 
@@ -167,6 +168,11 @@ class StaticThreadPool final : public Scheduler {
   template <typename E>
   [[nodiscard]] static auto Spawn(Requirements&& requirements, E e);
 
+  // Metrics for each thread (i.e., CPU) in the pool.
+  SchedulerMetrics& metrics() {
+    return metrics_;
+  }
+
  private:
   // NOTE: we use a semaphore instead of something like eventfd for
   // "signalling" the thread because it should be faster/less overhead
@@ -176,6 +182,7 @@ class StaticThreadPool final : public Scheduler {
   std::deque<Semaphore> ready_;
   std::vector<std::thread> threads_;
   std::atomic<bool> shutdown_ = false;
+  SchedulerMetrics metrics_;
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -188,7 +195,7 @@ struct _StaticThreadPoolSchedule final {
         K_ k,
         StaticThreadPool* pool,
         StaticThreadPool::Requirements* requirements,
-        std::string&& name,
+        ContextName name,
         E_ e)
       : e_(std::move(e)),
         context_(
@@ -218,6 +225,16 @@ struct _StaticThreadPoolSchedule final {
       return static_cast<StaticThreadPool::Requirements*>(context_->data);
     }
 
+    // Helper that returns true if we're already running on the pinned
+    // CPU and thus don't need to submit, recording the outcome.
+    bool Continuable() {
+      unsigned int cpu = requirements()->pinned.cpu().value();
+      bool continuable =
+          StaticThreadPool::member && StaticThreadPool::cpu == cpu;
+      pool()->metrics().RecordContinuable(cpu, continuable);
+      return continuable;
+    }
+
     template <typename... Args>
     void Start(Args&&... args) {
       static_assert(
@@ -239,7 +256,7 @@ struct _StaticThreadPoolSchedule final {
 
       CHECK(pinned.cpu() <= pool()->concurrency);
 
-      if (StaticThreadPool::member && StaticThreadPool::cpu == pinned.cpu()) {
+      if (Continuable()) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -289,7 +306,7 @@ struct _StaticThreadPoolSchedule final {
 
       CHECK(pinned.cpu() <= pool()->concurrency);
 
-      if (StaticThreadPool::member && StaticThreadPool::cpu == pinned.cpu()) {
+      if (Continuable()) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -299,25 +316,15 @@ struct _StaticThreadPoolSchedule final {
         context_->unuse();
         ;
       } else {
-        // TODO(benh): avoid allocating on heap by storing args in
-        // pre-allocated buffer based on composing with Errors.
-        using Tuple = std::tuple<decltype(this), Error>;
-        auto tuple = std::make_unique<Tuple>(
-            this,
-            std::forward<Error>(error));
+        error_.Store(std::forward<Error>(error));
 
         EVENTUALS_LOG(1)
             << "Schedule submitting '" << context_->name() << "'";
 
         pool()->Submit(
-            this->Borrow([tuple = std::move(tuple)]() mutable {
-              std::apply(
-                  [](auto* schedule, auto&&... args) {
-                    schedule->Adapt();
-                    schedule->adapted_->Fail(
-                        std::forward<decltype(args)>(args)...);
-                  },
-                  std::move(*tuple));
+            this->Borrow([this]() {
+              Adapt();
+              error_.Fail(*adapted_);
             }),
             *context_);
       }
@@ -343,7 +350,7 @@ struct _StaticThreadPoolSchedule final {
 
       CHECK(pinned.cpu() <= pool()->concurrency);
 
-      if (StaticThreadPool::member && StaticThreadPool::cpu == pinned.cpu()) {
+      if (Continuable()) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -382,7 +389,7 @@ struct _StaticThreadPoolSchedule final {
 
       CHECK(pinned.cpu() <= pool()->concurrency);
 
-      if (StaticThreadPool::member && StaticThreadPool::cpu == pinned.cpu()) {
+      if (Continuable()) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -423,7 +430,7 @@ struct _StaticThreadPoolSchedule final {
 
       CHECK(pinned.cpu() <= pool()->concurrency);
 
-      if (StaticThreadPool::member && StaticThreadPool::cpu == pinned.cpu()) {
+      if (Continuable()) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -472,7 +479,7 @@ struct _StaticThreadPoolSchedule final {
 
       CHECK(pinned.cpu() <= pool()->concurrency);
 
-      if (StaticThreadPool::member && StaticThreadPool::cpu == pinned.cpu()) {
+      if (Continuable()) {
         Adapt();
         auto previous = Scheduler::Context::Switch(context_->Borrow());
         context_->use();
@@ -544,7 +551,7 @@ struct _StaticThreadPoolSchedule final {
     // this class _before_ it's started and 'Context' is not movable.
     Lazy::Of<Scheduler::Context>::Args<
         StaticThreadPool*,
-        std::string,
+        ContextName,
         StaticThreadPool::Requirements*>
         context_;
 
@@ -560,6 +567,8 @@ struct _StaticThreadPoolSchedule final {
 
     std::unique_ptr<Adapted_> adapted_;
 
+    StoredError<Adapted_, Errors_> error_;
+
     // NOTE: we store 'k_' as the _last_ member so it will be
     // destructed _first_ and thus we won't have any use-after-delete
     // issues during destruction of 'k_' if it holds any references or
@@ -593,7 +602,7 @@ struct _StaticThreadPoolSchedule final {
     StaticThreadPool* pool_ = nullptr;
     StaticThreadPool::Requirements* requirements_ = nullptr;
     E_ e_;
-    std::string name_ = "[StaticThreadPool::Schedule - anonymous]";
+    ContextName name_ = "[StaticThreadPool::Schedule - anonymous]";
   };
 };
 
@@ -609,7 +618,7 @@ template <typename E>
 
 template <typename E>
 [[nodiscard]] auto StaticThreadPool::Schedule(
-    std::string&& name,
+    ContextName name,
     Requirements* requirements,
     E e) {
   return _StaticThreadPoolSchedule::Composable<E>{
@@ -630,7 +639,7 @@ template <typename E>
 
 template <typename E>
 [[nodiscard]] auto StaticThreadPool::Schedulable::Schedule(
-    std::string&& name,
+    ContextName name,
     E e) {
   return StaticThreadPool::Scheduler().Schedule(
       std::move(name),
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory> // For 'std::make_unique'.
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "eventuals/callback.h"
+#include "eventuals/type-traits.h"
+#include "glog/logging.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+// Holds an error that a continuation needs to propagate to 'K_' via
+// 'Fail()' _after_ it has been rescheduled (e.g., on a different
+// scheduler context, thread, or event loop).
+//
+// Since a continuation can't be moved after it has started it can
+// store the error itself and only capture 'this' in the 'Callback'
+// that it submits, rather than allocating the error on the heap so
+// that it can be captured in the 'Callback'.
+//
+// The storage is sized at compile time from 'Errors_', i.e., the
+// errors that can propagate to the continuation. Any other error
+// (e.g., a subtype of one of 'Errors_') falls back to being
+// allocated on the heap.
+template <typename K_, typename Errors_>
+class StoredError final {
+ public:
+  // Stores 'error' so that it can later be propagated by calling
+  // 'Fail()'.
+  template <typename Error>
+  void Store(Error&& error) {
+    using E = std::decay_t<Error>;
+
+    if constexpr (tuple_contains_exact_type_v<E, Errors_>) {
+      CHECK_EQ(error_.index(), 0u) << "already storing an error";
+      error_.template emplace<E>(std::forward<Error>(error));
+    } else {
+      CHECK(!fallback_) << "already storing an error";
+      fallback_ = [error = std::make_unique<E>(std::forward<Error>(error))](
+                      K_& k) mutable {
+        k.Fail(std::move(*error));
+      };
+    }
+  }
+
+  // Propagates the stored error to 'k' via 'Fail()'.
+  void Fail(K_& k) {
+    if (fallback_) {
+      Callback<void(K_&)> fallback = std::move(fallback_);
+      fallback(k);
+    } else {
+      CHECK_NE(error_.index(), 0u) << "no error stored";
+
+      // NOTE: moving the error out so that we can store another
+      // error if the continuation gets reused.
+      auto error = std::move(error_);
+      error_.template emplace<std::monostate>();
+
+      std::visit(
+          [&k](auto&& error) {
+            if constexpr (!std::is_same_v<
+                              std::decay_t<decltype(error)>,
+                              std::monostate>) {
+              k.Fail(std::move(error));
+            }
+          },
+          std::move(error));
+    }
+  }
+
+ private:
+  variant_of_type_and_tuple_t<std::monostate, Errors_> error_;
+
+  Callback<void(K_&)> fallback_;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
@@ -17,6 +17,7 @@
 
 #include "eventuals/interrupt.h"
 #include "eventuals/scheduler.h"
+#include "eventuals/stored-error.h"
 #include "eventuals/type-erased-stream.h"
 #include "eventuals/type-traits.h"
 #include "eventuals/undefined.h"
@@ -46,6 +47,7 @@ struct _Stream final {
                 std::reference_wrapper<std::remove_reference_t<Arg_>>,
                 Arg_>>>
         arg_;
+    StoredError<K_, Errors_> error_;
 
     void Begin() {
       stream_->previous_->Continue([this]() {
@@ -70,19 +72,10 @@ struct _Stream final {
             k_->Fail(std::forward<Error>(error));
           },
           [&]() {
-            // TODO(benh): avoid allocating on heap by storing args in
-            // pre-allocated buffer based on composing with Errors.
-            using Tuple = std::tuple<decltype(k_), Error>;
-            auto tuple = std::make_unique<Tuple>(
-                k_,
-                std::forward<Error>(error));
-
-            return [tuple = std::move(tuple)]() mutable {
-              std::apply(
-                  [](auto* k_, auto&&... args) {
-                    k_->Fail(std::forward<decltype(args)>(args)...);
-                  },
-                  std::move(*tuple));
+            error_.Store(std::forward<Error>(error));
+
+            return [this]() {
+              error_.Fail(*k_);
             };
           });
     }
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <functional> // For 'std::reference_wrapper'.
-#include <memory> // For 'std::unique_ptr'.
+#include <memory> // For 'std::make_unique'.
 #include <optional>
 #include <tuple>
 #include <variant>
@@ -11,6 +11,7 @@
 #include "eventuals/just.h"
 #include "eventuals/raise.h"
 #include "eventuals/terminal.h"
+#include "eventuals/type-erased-storage.h"
 #include "eventuals/type-traits.h"
 #include "stout/stringify.h"
 
@@ -57,6 +58,8 @@ using TaskStopCallback = Callback<void()>;
 
 ////////////////////////////////////////////////////////////////////////
 
+// NOTE: despite the name a 'HeapTask' is only allocated on the heap
+// if it doesn't fit inline, see '_TaskFromToWith::Storage'.
 template <
     typename E_,
     typename From_,
@@ -210,6 +213,13 @@ struct _TaskFromToWith final {
     Fail = 2,
   };
 
+  // Storage for the type-erased eventual, which is constructed inline
+  // if it fits in 'Inline_' bytes (see 'Task::Inline') and otherwise
+  // is allocated using the allocator of the current
+  // 'Scheduler::Context'.
+  template <size_t Inline_>
+  using Storage = TypeErasedStorage<Inline_>;
+
   // Using templated type name to allow using both
   // in 'Composable' and 'Continuation'.
   template <
@@ -217,6 +227,7 @@ struct _TaskFromToWith final {
       typename To,
       typename Catches,
       typename Raises,
+      size_t Inline,
       typename... Args>
   using DispatchCallback =
       Callback<void(
@@ -231,7 +242,7 @@ struct _TaskFromToWith final {
                   std::is_void_v<From>,
                   std::monostate,
                   From>>&&,
-          std::unique_ptr<void, Callback<void(void*)>>&,
+          Storage<Inline>&,
           Interrupt&,
           TaskStartCallback<To>&&,
           TaskFailCallback<Raises>&&,
@@ -243,6 +254,7 @@ struct _TaskFromToWith final {
       typename To_,
       typename Catches_,
       typename Raises_,
+      size_t Inline_,
       typename... Args_>
   struct Continuation final {
     Continuation(
@@ -250,7 +262,7 @@ struct _TaskFromToWith final {
         std::tuple<Args_...>&& args,
         std::variant<
             MonostateIfVoidOrReferenceWrapperOr<To_>,
-            DispatchCallback<From_, To_, Catches_, Raises_, Args_...>>&&
+            DispatchCallback<From_, To_, Catches_, Raises_, Inline_, Args_...>>&&
             value_or_dispatch)
       : args_(std::move(args)),
         value_or_dispatch_(std::move(value_or_dispatch)),
@@ -356,10 +368,10 @@ struct _TaskFromToWith final {
     // passed on to the continuation.
     std::variant<
         MonostateIfVoidOrReferenceWrapperOr<To_>,
-        DispatchCallback<From_, To_, Catches_, Raises_, Args_...>>
+        DispatchCallback<From_, To_, Catches_, Raises_, Inline_, Args_...>>
         value_or_dispatch_;
 
-    std::unique_ptr<void, Callback<void(void*)>> e_;
+    Storage<Inline_> e_;
     Interrupt* interrupt_ = nullptr;
 
     // NOTE: we store 'k_' as the _last_ member so it will be
@@ -374,6 +386,7 @@ struct _TaskFromToWith final {
       typename To_,
       typename Catches_,
       typename Raises_,
+      size_t Inline_,
       typename... Args_>
   struct Composable final {
     template <typename Arg, typename Errors>
@@ -458,28 +471,21 @@ struct _TaskFromToWith final {
                                        Catches_>::type>&& error,
                                Args_&... args,
                                std::optional<MonostateIfVoidOr<From_>>&& arg,
-                               std::unique_ptr<void, Callback<void(void*)>>& e_,
+                               Storage<Inline_>& e_,
                                Interrupt& interrupt,
                                TaskStartCallback<To_>&& start,
                                TaskFailCallback<Raises_>&& fail,
                                TaskStopCallback&& stop) mutable {
         if (!e_) {
-          e_ = std::unique_ptr<void, Callback<void(void*)>>(
-              new HeapTask<
+          e_.template Emplace<
+              HeapTask<
                   E,
                   From_,
                   To_,
                   Catches_,
-                  Raises_>(f(args...)),
-              [](void* e) {
-                delete static_cast<
-                    HeapTask<
-                        E,
-                        From_,
-                        To_,
-                        Catches_,
-                        Raises_>*>(e);
-              });
+                  Raises_>>(
+              Scheduler::Context::Get()->allocator(),
+              f(args...));
         }
 
         auto* e = static_cast<
@@ -535,7 +541,7 @@ struct _TaskFromToWith final {
         std::optional<
             std::variant<
                 MonostateIfVoidOrReferenceWrapperOr<To_>,
-                DispatchCallback<From_, To_, Catches_, Raises_, Args_...>>>&&
+                DispatchCallback<From_, To_, Catches_, Raises_, Inline_, Args_...>>>&&
             value_or_dispatch,
         std::tuple<Args_...>&& args)
       : value_or_dispatch_(std::move(value_or_dispatch)),
@@ -547,7 +553,7 @@ struct _TaskFromToWith final {
           !std::disjunction_v<IsUndefined<From_>, IsUndefined<To_>>,
           "'Task' 'From' or 'To' type is not specified");
 
-      return Continuation<K, From_, To_, Catches_, Raises_, Args_...>(
+      return Continuation<K, From_, To_, Catches_, Raises_, Inline_, Args_...>(
           std::move(k),
           std::move(args_),
           std::move(value_or_dispatch_.value()));
@@ -559,7 +565,7 @@ struct _TaskFromToWith final {
     std::optional<
         std::variant<
             MonostateIfVoidOrReferenceWrapperOr<To_>,
-            DispatchCallback<From_, To_, Catches_, Raises_, Args_...>>>
+            DispatchCallback<From_, To_, Catches_, Raises_, Inline_, Args_...>>>
         value_or_dispatch_;
 
     std::tuple<Args_...> args_;
@@ -577,6 +583,7 @@ template <
     typename To_,
     typename Catches_,
     typename Raises_,
+    size_t Inline_,
     typename... Args_>
 class _Task final {
  public:
@@ -596,32 +603,37 @@ class _Task final {
   template <typename T>
   using From = std::enable_if_t<
       IsUndefined<From_>::value,
-      _Task<T, To_, Catches_, Raises_, Args_...>>;
+      _Task<T, To_, Catches_, Raises_, Inline_, Args_...>>;
 
   template <typename T>
   using To = std::enable_if_t<
       IsUndefined<To_>::value,
-      _Task<From_, T, Catches_, Raises_, Args_...>>;
+      _Task<From_, T, Catches_, Raises_, Inline_, Args_...>>;
 
   template <typename... Errors>
   using Catches = std::enable_if_t<
       std::tuple_size_v<Catches_> == 0,
-      _Task<From_, To_, std::tuple<Errors...>, Raises_, Args_...>>;
+      _Task<From_, To_, std::tuple<Errors...>, Raises_, Inline_, Args_...>>;
 
   template <typename... Errors>
   using Raises = std::enable_if_t<
       std::tuple_size_v<Raises_> == 0,
-      _Task<From_, To_, Catches_, std::tuple<Errors...>, Args_...>>;
+      _Task<From_, To_, Catches_, std::tuple<Errors...>, Inline_, Args_...>>;
 
   template <typename... Args>
   using With = std::enable_if_t<
       sizeof...(Args_) == 0,
-      _Task<From_, To_, Catches_, Raises_, Args...>>;
+      _Task<From_, To_, Catches_, Raises_, Inline_, Args...>>;
 
   template <typename T>
   using Of = std::enable_if_t<
       std::conjunction_v<IsUndefined<From_>, IsUndefined<To_>>,
-      _Task<void, T, Catches_, Raises_, Args_...>>;
+      _Task<void, T, Catches_, Raises_, Inline_, Args_...>>;
+
+  // Number of bytes to store the type-erased eventual inline before
+  // falling back to allocating, see 'TYPE_ERASED_INLINE_SIZE'.
+  template <size_t N>
+  using Inline = _Task<From_, To_, Catches_, Raises_, N, Args_...>;
 
   template <typename F>
   _Task(Args_... args, F f)
@@ -664,6 +676,9 @@ class _Task final {
 
     context_.emplace(Scheduler::Default(), std::move(name));
 
+    // Use the same allocator as whoever is starting us.
+    context_->set_allocator(Scheduler::Context::Get()->allocator());
+
     k_.emplace(Build<void, Catches_>(
         Reschedule(context_->Borrow())
         >> std::move(e_)
@@ -759,6 +774,9 @@ class _Task final {
 
     context_.emplace(Scheduler::Default(), std::move(name));
 
+    // Use the same allocator as whoever is starting us.
+    context_->set_allocator(Scheduler::Context::Get()->allocator());
+
     k_.emplace(Build<void, Catches_>(
         Reschedule(context_->Borrow())
         >> std::move(e_)
@@ -792,6 +810,9 @@ class _Task final {
 
     context_.emplace(Scheduler::Default(), std::move(name));
 
+    // Use the same allocator as whoever is starting us.
+    context_->set_allocator(Scheduler::Context::Get()->allocator());
+
     k_.emplace(Build<void, Catches_>(
         Reschedule(context_->Borrow())
         >> std::move(e_)
@@ -841,7 +862,8 @@ class _Task final {
         void,
         Value,
         Catches_,
-        Raises_>(std::move(value));
+        Raises_,
+        Inline_>(std::move(value));
   }
 
   template <typename Value>
@@ -850,7 +872,8 @@ class _Task final {
         void,
         Value&,
         Catches_,
-        Raises_>(std::move(value));
+        Raises_,
+        Inline_>(std::move(value));
   }
 
   [[nodiscard]] static auto Success() {
@@ -858,7 +881,8 @@ class _Task final {
         void,
         void,
         Catches_,
-        Raises_>(std::monostate{});
+        Raises_,
+        Inline_>(std::monostate{});
   }
 
   template <typename Error>
@@ -895,13 +919,13 @@ class _Task final {
  private:
   // To make possible constructing from another '_Task' with
   // the different 'std::tuple' of error types.
-  template <typename, typename, typename, typename, typename...>
+  template <typename, typename, typename, typename, size_t, typename...>
   friend class _Task;
 
   std::conditional_t<
       std::disjunction_v<IsUndefined<From_>, IsUndefined<To_>>,
       decltype(Eventual<Undefined>()),
-      _TaskFromToWith::Composable<From_, To_, Catches_, Raises_, Args_...>>
+      _TaskFromToWith::Composable<From_, To_, Catches_, Raises_, Inline_, Args_...>>
       e_;
 
   // Optional promise if we are invoked as a continuation without any
@@ -939,7 +963,12 @@ class _Task final {
   std::optional<K_> k_;
 };
 
-using Task = _Task<Undefined, Undefined, std::tuple<>, std::tuple<>>;
+using Task = _Task<
+    Undefined,
+    Undefined,
+    std::tuple<>,
+    std::tuple<>,
+    TYPE_ERASED_INLINE_SIZE>;
 
 ////////////////////////////////////////////////////////////////////////
 
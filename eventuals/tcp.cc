@@ -0,0 +1,443 @@
+#include "eventuals/tcp.h"
+
+#ifndef _WIN32
+#include <sys/socket.h> // For 'setsockopt()' and 'SO_REUSEPORT'.
+#endif
+
+#include <cerrno>
+#include <utility>
+
+#include "glog/logging.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+int _Tcp::Address(
+    const std::string& ip,
+    const int port,
+    sockaddr_storage* address) {
+  int error = uv_ip4_addr(
+      ip.c_str(),
+      port,
+      reinterpret_cast<sockaddr_in*>(address));
+
+  if (error) {
+    error = uv_ip6_addr(
+        ip.c_str(),
+        port,
+        reinterpret_cast<sockaddr_in6*>(address));
+  }
+
+  return error;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int _Tcp::Stream::Initialize() {
+  CHECK(!initialized);
+
+  int error = uv_tcp_init(loop, &tcp);
+
+  if (!error) {
+    initialized = true;
+    tcp.data = this;
+  }
+
+  return error;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Stream::StartReading(Callback<void(ssize_t)>&& callback) {
+  CHECK(!reader) << "already reading";
+
+  reader = std::move(callback);
+
+  // NOTE: we only read while there is a reader (rather than reading
+  // continuously and buffering) so that a slow reader applies
+  // backpressure via TCP flow control, and so we can read directly
+  // into our one 'buffer' since it's not being used.
+  int error = uv_read_start(
+      stream(),
+      [](uv_handle_t* handle, size_t, uv_buf_t* buf) {
+        auto& stream = *static_cast<Stream*>(handle->data);
+        buf->base = stream.buffer.get();
+        buf->len = stream.options.read_buffer_size;
+      },
+      [](uv_stream_t* handle, ssize_t nread, const uv_buf_t*) {
+        auto& stream = *static_cast<Stream*>(handle->data);
+
+        // libuv may call us with 0 which just means "would block".
+        if (nread == 0) {
+          return;
+        }
+
+        uv_read_stop(handle);
+
+        if (nread == UV_EOF) {
+          stream.eof = true;
+          nread = 0;
+        }
+
+        Callback<void(ssize_t)> reader = std::move(stream.reader);
+        reader(nread);
+      });
+
+  if (error) {
+    Callback<void(ssize_t)> reader = std::move(this->reader);
+    reader(error);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Stream::Cancel() {
+  auto cancel = [this]() {
+    cancelling.store(false);
+    if (reader) {
+      uv_read_stop(stream());
+      Callback<void(ssize_t)> reader = std::move(this->reader);
+      reader(UV_ECANCELED);
+    }
+  };
+
+  if (EventLoop::InEventLoop()) {
+    cancel();
+  } else if (!cancelling.exchange(true)) {
+    // NOTE: a cancel that is already pending will cancel whichever
+    // read is outstanding when it runs so we only need one.
+    loop.Submit(std::move(cancel), interrupt_context);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Stream::Add(Write* write) {
+  queued.push_back(write);
+
+  if (writing.empty()) {
+    Flush();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Stream::Flush() {
+  CHECK(writing.empty());
+
+  writing.swap(queued);
+
+  buffers.clear();
+
+  for (Write* write : writing) {
+    buffers.insert(
+        buffers.end(),
+        write->buffers,
+        write->buffers + write->count);
+  }
+
+  // libuv doesn't allow writing 0 buffers.
+  if (buffers.empty()) {
+    Written(0);
+    return;
+  }
+
+  request.data = this;
+
+  // NOTE: all of the writes go out with a single 'writev()' (as long
+  // as the socket isn't full) rather than one system call each.
+  int error = uv_write(
+      &request,
+      stream(),
+      buffers.data(),
+      buffers.size(),
+      [](uv_write_t* request, int status) {
+        static_cast<Stream*>(request->data)->Written(status);
+      });
+
+  if (error) {
+    Written(error);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Stream::Written(int status) {
+  // NOTE: need to swap out 'writing' before invoking any callbacks
+  // since they may add more writes.
+  std::vector<Write*> written;
+  written.swap(writing);
+
+  for (Write* write : written) {
+    Callback<void(int)> callback = std::move(write->callback);
+    callback(status);
+  }
+
+  if (writing.empty() && !queued.empty()) {
+    Flush();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Stream::Close(Callback<void()>&& callback) {
+  CHECK(EventLoop::InEventLoop());
+
+  closed = std::move(callback);
+
+  if (!initialized) {
+    Callback<void()> closed = std::move(this->closed);
+    delete this;
+    if (closed) {
+      closed();
+    }
+    return;
+  }
+
+  // NOTE: libuv fails any outstanding writes with 'UV_ECANCELED' when
+  // closing so we do the same for an outstanding read.
+  if (reader) {
+    uv_read_stop(stream());
+    Callback<void(ssize_t)> reader = std::move(this->reader);
+    reader(UV_ECANCELED);
+  }
+
+  uv_close(handle(), [](uv_handle_t* handle) {
+    auto* stream = static_cast<Stream*>(handle->data);
+    Callback<void()> closed = std::move(stream->closed);
+    delete stream;
+    if (closed) {
+      closed();
+    }
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Stream::Destroy(Stream* stream) {
+  if (EventLoop::InEventLoop()) {
+    stream->Close(Callback<void()>());
+  } else {
+    // NOTE: 'context' won't be destructed until the stream is deleted
+    // which happens asynchronously after this callback has returned.
+    stream->loop.Submit(
+        [stream]() {
+          stream->Close(Callback<void()>());
+        },
+        stream->context);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int _Tcp::Listener::Listen(const sockaddr_storage& address) {
+  CHECK(!initialized);
+
+  int error = uv_tcp_init_ex(loop, &tcp, address.ss_family);
+
+  if (error) {
+    return error;
+  }
+
+  initialized = true;
+  tcp.data = this;
+
+  if (options.reuse_port) {
+#if defined(SO_REUSEPORT)
+    uv_os_fd_t fd;
+
+    error = uv_fileno(handle(), &fd);
+
+    if (error) {
+      return error;
+    }
+
+    int enable = 1;
+
+    if (setsockopt(
+            fd,
+            SOL_SOCKET,
+            SO_REUSEPORT,
+            &enable,
+            sizeof(enable))
+        != 0) {
+      return uv_translate_sys_error(errno);
+    }
+#else
+    return UV_ENOTSUP;
+#endif
+  }
+
+  error = uv_tcp_bind(&tcp, reinterpret_cast<const sockaddr*>(&address), 0);
+
+  if (error) {
+    return error;
+  }
+
+  return uv_listen(
+      stream(),
+      options.backlog,
+      [](uv_stream_t* handle, int status) {
+        auto& listener = *static_cast<Listener*>(handle->data);
+        if (status == 0) {
+          listener.pending++;
+        } else {
+          listener.error = status;
+        }
+        listener.TryAccept();
+      });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int _Tcp::Listener::port() {
+  sockaddr_storage address = {};
+  int length = sizeof(address);
+
+  int error = uv_tcp_getsockname(
+      &tcp,
+      reinterpret_cast<sockaddr*>(&address),
+      &length);
+
+  CHECK_EQ(error, 0) << uv_strerror(error);
+
+  if (address.ss_family == AF_INET6) {
+    return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+  } else {
+    return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Listener::Accept(Callback<void(int, Stream*)>&& callback) {
+  CHECK(!acceptor) << "already accepting";
+
+  acceptor = std::move(callback);
+
+  TryAccept();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Listener::TryAccept() {
+  if (!acceptor) {
+    return;
+  }
+
+  // NOTE: errors from listening (e.g., 'UV_EMFILE') are transient so
+  // we only fail the current 'Accept()' with each one and keep
+  // listening rather than failing every 'Accept()' from now on.
+  if (error) {
+    int error = std::exchange(this->error, 0);
+    Callback<void(int, Stream*)> acceptor = std::move(this->acceptor);
+    acceptor(error, nullptr);
+    return;
+  }
+
+  if (pending == 0) {
+    return;
+  }
+
+  pending--;
+
+  auto* stream = new Stream(loop, options);
+
+  int error = stream->Initialize();
+
+  if (!error) {
+    error = uv_accept(this->stream(), stream->stream());
+  }
+
+  if (error == UV_EAGAIN) {
+    // Nothing to accept after all (e.g., the connection was reset
+    // before we accepted it) so keep waiting for the next one.
+    Stream::Destroy(stream);
+    pending = 0;
+    return;
+  }
+
+  Callback<void(int, Stream*)> acceptor = std::move(this->acceptor);
+
+  if (error) {
+    Stream::Destroy(stream);
+    acceptor(error, nullptr);
+  } else {
+    if (options.nodelay) {
+      uv_tcp_nodelay(&stream->tcp, 1);
+    }
+    acceptor(0, stream);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Listener::Cancel() {
+  auto cancel = [this]() {
+    cancelling.store(false);
+    if (acceptor) {
+      Callback<void(int, Stream*)> acceptor = std::move(this->acceptor);
+      acceptor(UV_ECANCELED, nullptr);
+    }
+  };
+
+  if (EventLoop::InEventLoop()) {
+    cancel();
+  } else if (!cancelling.exchange(true)) {
+    loop.Submit(std::move(cancel), interrupt_context);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Listener::Close(Callback<void()>&& callback) {
+  CHECK(EventLoop::InEventLoop());
+
+  closed = std::move(callback);
+
+  if (acceptor) {
+    Callback<void(int, Stream*)> acceptor = std::move(this->acceptor);
+    acceptor(UV_ECANCELED, nullptr);
+  }
+
+  if (!initialized) {
+    Callback<void()> closed = std::move(this->closed);
+    delete this;
+    if (closed) {
+      closed();
+    }
+    return;
+  }
+
+  uv_close(handle(), [](uv_handle_t* handle) {
+    auto* listener = static_cast<Listener*>(handle->data);
+    Callback<void()> closed = std::move(listener->closed);
+    delete listener;
+    if (closed) {
+      closed();
+    }
+  });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void _Tcp::Listener::Destroy(Listener* listener) {
+  if (EventLoop::InEventLoop()) {
+    listener->Close(Callback<void()>());
+  } else {
+    listener->loop.Submit(
+        [listener]() {
+          listener->Close(Callback<void()>());
+        },
+        listener->context);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
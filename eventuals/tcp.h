@@ -0,0 +1,761 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "eventuals/buffer-chain.h"
+#include "eventuals/callback.h"
+#include "eventuals/event-loop.h"
+#include "eventuals/eventual.h"
+#include "eventuals/repeat.h"
+#include "eventuals/until.h"
+#include "uv.h"
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+struct TcpOptions final {
+  // Disables Nagle's algorithm (i.e., sets 'TCP_NODELAY') on
+  // connected and accepted streams.
+  bool nodelay = true;
+
+  // Lets multiple listeners bind the same address and port (i.e.,
+  // sets 'SO_REUSEPORT' where supported), e.g., one per event loop so
+  // the kernel can balance connections between them.
+  bool reuse_port = false;
+
+  // Max number of pending connections, see 'listen(2)'.
+  int backlog = 128;
+
+  // Size of the buffer each stream reads into, i.e., the max size of
+  // each chunk from 'TcpStream::Read()'.
+  size_t read_buffer_size = 64 * 1024;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+struct _Tcp final {
+  // Returns 0 and fills in 'address' if 'ip' is a valid IPv4 or IPv6
+  // address, otherwise a libuv error.
+  static int Address(
+      const std::string& ip,
+      const int port,
+      sockaddr_storage* address);
+
+  // The state of a 'TcpStream' which must remain at the same address
+  // for as long as libuv is using it, i.e., until it's been closed.
+  //
+  // NOTE: all functions must be called from within the event loop
+  // except 'Destroy()'.
+  struct Stream final {
+    // A write that is waiting to be (or is being) written.
+    struct Write final {
+      const uv_buf_t* buffers = nullptr;
+      size_t count = 0;
+
+      // Invoked with 0 after the write completed or a libuv error.
+      Callback<void(int)> callback;
+    };
+
+    Stream(EventLoop& loop, const TcpOptions& options)
+      : loop(loop),
+        options(options),
+        buffer(new char[options.read_buffer_size]),
+        context(&loop, "TcpStream (close)"),
+        interrupt_context(&loop, "TcpStream (interrupt)") {}
+
+    Stream(const Stream&) = delete;
+    Stream(Stream&&) = delete;
+
+    int Initialize();
+
+    // Starts reading into 'buffer' (at most once) invoking 'callback'
+    // with the number of bytes read, 0 at the end of the stream, or a
+    // libuv error.
+    void StartReading(Callback<void(ssize_t)>&& callback);
+
+    // Stops reading (if we still are) invoking the callback passed to
+    // 'StartReading()' with 'UV_ECANCELED'. Safe to call from any
+    // thread, e.g., when a read gets interrupted.
+    void Cancel();
+
+    // Writes 'write' after all previously added writes. All writes
+    // added while a write is in progress get written together (with
+    // a single 'writev()') after it completes.
+    void Add(Write* write);
+
+    // Closes the stream and deletes it, invoking 'callback' after.
+    void Close(Callback<void()>&& callback);
+
+    // Closes and deletes 'stream' from any thread.
+    static void Destroy(Stream* stream);
+
+    uv_stream_t* stream() {
+      return reinterpret_cast<uv_stream_t*>(&tcp);
+    }
+
+    uv_handle_t* handle() {
+      return reinterpret_cast<uv_handle_t*>(&tcp);
+    }
+
+    EventLoop& loop;
+    const TcpOptions options;
+
+    uv_tcp_t tcp = {};
+    bool initialized = false;
+
+    std::unique_ptr<char[]> buffer;
+    Callback<void(ssize_t)> reader;
+    bool eof = false;
+
+    std::vector<Write*> queued;
+    std::vector<Write*> writing;
+    std::vector<uv_buf_t> buffers;
+    uv_write_t request = {};
+
+    Callback<void()> closed;
+
+    // Used to close the stream when destructed outside of the event
+    // loop, see 'Destroy()', and to cancel reads, see 'Cancel()'.
+    Scheduler::Context context;
+    Scheduler::Context interrupt_context;
+    std::atomic<bool> cancelling = false;
+
+   private:
+    void Flush();
+    void Written(int status);
+  };
+
+  // The state of a 'TcpListener', see '_Tcp::Stream' above.
+  struct Listener final {
+    Listener(EventLoop& loop, const TcpOptions& options)
+      : loop(loop),
+        options(options),
+        context(&loop, "TcpListener (close)"),
+        interrupt_context(&loop, "TcpListener (interrupt)") {}
+
+    Listener(const Listener&) = delete;
+    Listener(Listener&&) = delete;
+
+    // Binds 'address' and starts listening.
+    int Listen(const sockaddr_storage& address);
+
+    // Returns the port we're listening on (e.g., after binding 0).
+    int port();
+
+    // Accepts the next connection (at most once) invoking 'callback'
+    // with either the accepted stream or a libuv error.
+    void Accept(Callback<void(int, Stream*)>&& callback);
+
+    // Like '_Tcp::Stream::Cancel()' but for 'Accept()'.
+    void Cancel();
+
+    void Close(Callback<void()>&& callback);
+
+    static void Destroy(Listener* listener);
+
+    uv_stream_t* stream() {
+      return reinterpret_cast<uv_stream_t*>(&tcp);
+    }
+
+    uv_handle_t* handle() {
+      return reinterpret_cast<uv_handle_t*>(&tcp);
+    }
+
+    EventLoop& loop;
+    const TcpOptions options;
+
+    uv_tcp_t tcp = {};
+    bool initialized = false;
+
+    // Number of connections that are ready to be accepted, and the
+    // last error from listening that hasn't yet been reported to an
+    // 'Accept()'.
+    size_t pending = 0;
+    int error = 0;
+
+    Callback<void(int, Stream*)> acceptor;
+
+    Callback<void()> closed;
+
+    Scheduler::Context context;
+    Scheduler::Context interrupt_context;
+    std::atomic<bool> cancelling = false;
+
+   private:
+    void TryAccept();
+  };
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// A connected TCP stream (i.e., a socket), see 'TcpStream::Connect()'
+// and 'TcpListener::Accept()'.
+//
+// NOTE: a stream must outlive any of its operations and should be
+// closed via 'Close()' but will otherwise be closed asynchronously
+// when destructed.
+//
+// Moveable, not Copyable.
+class TcpStream final {
+ public:
+  // Connects to 'ip' (IPv4 or IPv6) at 'port'.
+  [[nodiscard]] static auto Connect(
+      std::string ip,
+      int port,
+      TcpOptions options = TcpOptions(),
+      EventLoop& loop = EventLoop::Default());
+
+  TcpStream() = default;
+
+  TcpStream(const TcpStream&) = delete;
+
+  TcpStream(TcpStream&& that) noexcept
+    : stream_(std::exchange(that.stream_, nullptr)) {}
+
+  TcpStream& operator=(const TcpStream&) = delete;
+
+  TcpStream& operator=(TcpStream&& that) noexcept {
+    if (this == &that) {
+      return *this;
+    }
+
+    if (stream_ != nullptr) {
+      _Tcp::Stream::Destroy(stream_);
+    }
+
+    stream_ = std::exchange(that.stream_, nullptr);
+
+    return *this;
+  }
+
+  ~TcpStream() {
+    if (stream_ != nullptr) {
+      _Tcp::Stream::Destroy(stream_);
+    }
+  }
+
+  bool IsOpen() const {
+    return stream_ != nullptr;
+  }
+
+  // Returns a stream of chunks as they are read until the peer shuts
+  // down (or closes) its end. Only one chunk is read at a time so a
+  // slow consumer applies backpressure all the way to the peer.
+  //
+  // NOTE: to avoid copying (or allocating) each chunk is a view into
+  // a buffer that gets reused for the next chunk, i.e., it's only
+  // valid until the stream's 'Next()'.
+  [[nodiscard]] auto Read();
+
+  // Writes 'data' after any previous writes. Writes that are started
+  // while another write is in progress are batched together.
+  [[nodiscard]] auto Write(std::string data);
+
+  // Like 'Write()' above but writes all of the slices of 'chain'
+  // without copying them into a contiguous buffer.
+  [[nodiscard]] auto Write(BufferChain chain);
+
+  // Shuts down our end of the stream after all pending writes, i.e.,
+  // the peer reads the end of the stream.
+  [[nodiscard]] auto Shutdown();
+
+  [[nodiscard]] auto Close();
+
+ private:
+  explicit TcpStream(_Tcp::Stream* stream)
+    : stream_(stream) {}
+
+  // Reads the next chunk, which is empty at the end of the stream.
+  [[nodiscard]] auto ReadChunk();
+
+  // Writes 'owner' (either a 'std::string' or a 'BufferChain') which
+  // is kept alive until the write has completed.
+  template <typename Owner_>
+  [[nodiscard]] auto WriteOwned(Owner_ owner);
+
+  friend class TcpListener;
+
+  _Tcp::Stream* stream_ = nullptr;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Listens for TCP connections, see 'TcpListener::Listen()'.
+//
+// NOTE: like 'TcpStream' a listener must outlive any of its
+// operations and should be closed via 'Close()'.
+//
+// Moveable, not Copyable.
+class TcpListener final {
+ public:
+  // Listens on 'ip' (IPv4 or IPv6) at 'port', or an ephemeral port
+  // if 'port' is 0, see 'port()'.
+  [[nodiscard]] static auto Listen(
+      std::string ip,
+      int port,
+      TcpOptions options = TcpOptions(),
+      EventLoop& loop = EventLoop::Default());
+
+  TcpListener() = default;
+
+  TcpListener(const TcpListener&) = delete;
+
+  TcpListener(TcpListener&& that) noexcept
+    : listener_(std::exchange(that.listener_, nullptr)) {}
+
+  TcpListener& operator=(const TcpListener&) = delete;
+
+  TcpListener& operator=(TcpListener&& that) noexcept {
+    if (this == &that) {
+      return *this;
+    }
+
+    if (listener_ != nullptr) {
+      _Tcp::Listener::Destroy(listener_);
+    }
+
+    listener_ = std::exchange(that.listener_, nullptr);
+
+    return *this;
+  }
+
+  ~TcpListener() {
+    if (listener_ != nullptr) {
+      _Tcp::Listener::Destroy(listener_);
+    }
+  }
+
+  bool IsOpen() const {
+    return listener_ != nullptr;
+  }
+
+  int port() {
+    CHECK_NOTNULL(listener_);
+    return listener_->port();
+  }
+
+  // Returns an infinite stream of accepted connections, i.e., until
+  // downstream is done or it gets interrupted.
+  [[nodiscard]] auto Accept();
+
+  // Closes the listener, stopping any outstanding 'Accept()'.
+  [[nodiscard]] auto Close();
+
+ private:
+  explicit TcpListener(_Tcp::Listener* listener)
+    : listener_(listener) {}
+
+  [[nodiscard]] auto AcceptOne();
+
+  _Tcp::Listener* listener_ = nullptr;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpStream::Connect(
+    std::string ip,
+    int port,
+    TcpOptions options,
+    EventLoop& loop) {
+  struct Data {
+    EventLoop& loop;
+    std::string ip;
+    int port;
+    TcpOptions options;
+
+    _Tcp::Stream* stream = nullptr;
+    uv_connect_t request = {};
+
+    void* k = nullptr;
+  };
+
+  return loop.Schedule(
+      "TcpStream::Connect",
+      Eventual<TcpStream>()
+          .raises<RuntimeError>()
+          .context(Data{loop, std::move(ip), port, options})
+          .start([](Data& data, auto& k) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            sockaddr_storage address = {};
+
+            int error = _Tcp::Address(data.ip, data.port, &address);
+
+            if (error) {
+              k.Fail(RuntimeError(uv_strerror(error)));
+              return;
+            }
+
+            data.stream = new _Tcp::Stream(data.loop, data.options);
+
+            error = data.stream->Initialize();
+
+            if (!error) {
+              data.request.data = &data;
+
+              error = uv_tcp_connect(
+                  &data.request,
+                  &data.stream->tcp,
+                  reinterpret_cast<sockaddr*>(&address),
+                  [](uv_connect_t* request, int status) {
+                    auto& data = *static_cast<Data*>(request->data);
+                    auto& k = *static_cast<K*>(data.k);
+                    if (status == 0) {
+                      if (data.options.nodelay) {
+                        uv_tcp_nodelay(&data.stream->tcp, 1);
+                      }
+                      k.Start(TcpStream(data.stream));
+                    } else {
+                      _Tcp::Stream::Destroy(data.stream);
+                      k.Fail(RuntimeError(uv_strerror(status)));
+                    }
+                  });
+            }
+
+            if (error) {
+              _Tcp::Stream::Destroy(data.stream);
+              k.Fail(RuntimeError(uv_strerror(error)));
+            }
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpStream::ReadChunk() {
+  struct Data {
+    _Tcp::Stream* stream;
+
+    void* k = nullptr;
+  };
+
+  CHECK_NOTNULL(stream_);
+
+  return stream_->loop.Schedule(
+      "TcpStream::Read",
+      Eventual<std::string_view>()
+          .raises<RuntimeError>()
+          .interruptible()
+          .context(Data{stream_})
+          .start([](Data& data, auto& k, auto& handler) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            if (data.stream->eof) {
+              k.Start(std::string_view());
+              return;
+            }
+
+            if (handler) {
+              // NOTE: only capturing the stream (and not 'data') since
+              // the read might complete (and 'data' be destructed)
+              // before the stream gets cancelled.
+              bool installed = handler->Install([stream = data.stream]() {
+                stream->Cancel();
+              });
+
+              if (!installed) {
+                // Interrupt has already been triggered.
+                k.Stop();
+                return;
+              }
+            }
+
+            data.stream->StartReading([&data](ssize_t nread) {
+              auto& k = *static_cast<K*>(data.k);
+              if (nread >= 0) {
+                k.Start(std::string_view(data.stream->buffer.get(), nread));
+              } else if (nread == UV_ECANCELED) {
+                k.Stop();
+              } else {
+                k.Fail(RuntimeError(uv_strerror(nread)));
+              }
+            });
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpStream::Read() {
+  return Repeat([this]() { return ReadChunk(); })
+      >> Until([](std::string_view& chunk) {
+           return chunk.empty();
+         });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template <typename Owner_>
+[[nodiscard]] auto TcpStream::WriteOwned(Owner_ owner) {
+  struct Data {
+    _Tcp::Stream* stream;
+    Owner_ owner;
+
+    uv_buf_t buffer = {};
+    _Tcp::Stream::Write write;
+
+    void* k = nullptr;
+  };
+
+  CHECK_NOTNULL(stream_);
+
+  return stream_->loop.Schedule(
+      "TcpStream::Write",
+      Eventual<void>()
+          .raises<RuntimeError>()
+          .context(Data{stream_, std::move(owner)})
+          .start([](Data& data, auto& k) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            if constexpr (std::is_same_v<Owner_, BufferChain>) {
+              data.write.buffers = data.owner.buffers().data();
+              data.write.count = data.owner.buffers().size();
+            } else {
+              data.buffer = uv_buf_init(
+                  data.owner.data(),
+                  data.owner.size());
+              data.write.buffers = &data.buffer;
+              data.write.count = 1;
+            }
+
+            data.write.callback = [&data](int status) {
+              auto& k = *static_cast<K*>(data.k);
+              if (status == 0) {
+                k.Start();
+              } else {
+                k.Fail(RuntimeError(uv_strerror(status)));
+              }
+            };
+
+            data.stream->Add(&data.write);
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpStream::Write(std::string data) {
+  return WriteOwned(std::move(data));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpStream::Write(BufferChain chain) {
+  return WriteOwned(std::move(chain));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpStream::Shutdown() {
+  struct Data {
+    _Tcp::Stream* stream;
+
+    uv_shutdown_t request = {};
+
+    void* k = nullptr;
+  };
+
+  CHECK_NOTNULL(stream_);
+
+  return stream_->loop.Schedule(
+      "TcpStream::Shutdown",
+      Eventual<void>()
+          .raises<RuntimeError>()
+          .context(Data{stream_})
+          .start([](Data& data, auto& k) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+            data.request.data = &data;
+
+            int error = uv_shutdown(
+                &data.request,
+                data.stream->stream(),
+                [](uv_shutdown_t* request, int status) {
+                  auto& data = *static_cast<Data*>(request->data);
+                  auto& k = *static_cast<K*>(data.k);
+                  if (status == 0) {
+                    k.Start();
+                  } else {
+                    k.Fail(RuntimeError(uv_strerror(status)));
+                  }
+                });
+
+            if (error) {
+              k.Fail(RuntimeError(uv_strerror(error)));
+            }
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpStream::Close() {
+  struct Data {
+    TcpStream& self;
+
+    void* k = nullptr;
+  };
+
+  CHECK_NOTNULL(stream_);
+
+  return stream_->loop.Schedule(
+      "TcpStream::Close",
+      Eventual<void>()
+          .context(Data{*this})
+          .start([](Data& data, auto& k) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            _Tcp::Stream* stream = std::exchange(data.self.stream_, nullptr);
+
+            CHECK_NOTNULL(stream)->Close([&data]() {
+              static_cast<K*>(data.k)->Start();
+            });
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpListener::Listen(
+    std::string ip,
+    int port,
+    TcpOptions options,
+    EventLoop& loop) {
+  struct Data {
+    EventLoop& loop;
+    std::string ip;
+    int port;
+    TcpOptions options;
+  };
+
+  return loop.Schedule(
+      "TcpListener::Listen",
+      Eventual<TcpListener>()
+          .raises<RuntimeError>()
+          .context(Data{loop, std::move(ip), port, options})
+          .start([](Data& data, auto& k) {
+            sockaddr_storage address = {};
+
+            int error = _Tcp::Address(data.ip, data.port, &address);
+
+            if (error) {
+              k.Fail(RuntimeError(uv_strerror(error)));
+              return;
+            }
+
+            auto* listener = new _Tcp::Listener(data.loop, data.options);
+
+            error = listener->Listen(address);
+
+            if (error) {
+              _Tcp::Listener::Destroy(listener);
+              k.Fail(RuntimeError(uv_strerror(error)));
+            } else {
+              k.Start(TcpListener(listener));
+            }
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpListener::AcceptOne() {
+  struct Data {
+    _Tcp::Listener* listener;
+
+    void* k = nullptr;
+  };
+
+  CHECK_NOTNULL(listener_);
+
+  return listener_->loop.Schedule(
+      "TcpListener::Accept",
+      Eventual<TcpStream>()
+          .raises<RuntimeError>()
+          .interruptible()
+          .context(Data{listener_})
+          .start([](Data& data, auto& k, auto& handler) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            if (handler) {
+              // NOTE: only capturing the listener, see 'ReadChunk()'.
+              bool installed = handler->Install(
+                  [listener = data.listener]() {
+                    listener->Cancel();
+                  });
+
+              if (!installed) {
+                // Interrupt has already been triggered.
+                k.Stop();
+                return;
+              }
+            }
+
+            data.listener->Accept([&data](int error, _Tcp::Stream* stream) {
+              auto& k = *static_cast<K*>(data.k);
+              if (!error) {
+                k.Start(TcpStream(stream));
+              } else if (error == UV_ECANCELED) {
+                k.Stop();
+              } else {
+                k.Fail(RuntimeError(uv_strerror(error)));
+              }
+            });
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpListener::Accept() {
+  return Repeat([this]() { return AcceptOne(); });
+}
+
+////////////////////////////////////////////////////////////////////////
+
+[[nodiscard]] inline auto TcpListener::Close() {
+  struct Data {
+    TcpListener& self;
+
+    void* k = nullptr;
+  };
+
+  CHECK_NOTNULL(listener_);
+
+  return listener_->loop.Schedule(
+      "TcpListener::Close",
+      Eventual<void>()
+          .context(Data{*this})
+          .start([](Data& data, auto& k) {
+            using K = std::decay_t<decltype(k)>;
+
+            data.k = &k;
+
+            _Tcp::Listener* listener =
+                std::exchange(data.self.listener_, nullptr);
+
+            CHECK_NOTNULL(listener)->Close([&data]() {
+              static_cast<K*>(data.k)->Start();
+            });
+          }));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,160 @@
+#include "eventuals/trace.h"
+
+#include <mutex>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+namespace trace {
+
+////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// All of the buffers that have ever been registered. Buffers are
+// never deallocated so that events recorded by threads that have
+// since exited can still be exported.
+struct Buffers final {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+Buffers& buffers() {
+  // NOTE: never deleted so that threads that exit after 'main()'
+  // returns can still safely access it.
+  static Buffers* buffers = new Buffers();
+  return *buffers;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Writes 's' as a JSON string (including the quotes).
+void WriteString(std::ostream& stream, const char* s) {
+  stream << '"';
+  for (; *s != '\0'; s++) {
+    char c = *s;
+    switch (c) {
+      case '"':
+        stream << "\\\"";
+        break;
+      case '\\':
+        stream << "\\\\";
+        break;
+      case '\n':
+        stream << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          // Drop any other control characters.
+          break;
+        }
+        stream << c;
+    }
+  }
+  stream << '"';
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////
+
+Buffer* RegisterBuffer() {
+  Buffers& buffers = trace::buffers();
+  std::lock_guard<std::mutex> lock(buffers.mutex);
+  // NOTE: thread ids start at 1 to make them easier to read.
+  buffers.buffers.push_back(
+      std::make_unique<Buffer>(buffers.buffers.size() + 1));
+  return buffers.buffers.back().get();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void Start() {
+  recording.store(true);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void Stop() {
+  recording.store(false);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void Clear() {
+  Buffers& buffers = trace::buffers();
+  std::lock_guard<std::mutex> lock(buffers.mutex);
+  for (std::unique_ptr<Buffer>& buffer : buffers.buffers) {
+    buffer->recorded.store(0);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void Export(std::ostream& stream) {
+  Buffers& buffers = trace::buffers();
+  std::lock_guard<std::mutex> lock(buffers.mutex);
+
+  stream << "{\"traceEvents\":[";
+
+  bool first = true;
+
+  for (std::unique_ptr<Buffer>& buffer : buffers.buffers) {
+    uint64_t recorded = buffer->recorded.load(std::memory_order_acquire);
+
+    // Only the most recent 'BUFFER_SIZE' events are still around.
+    uint64_t i = recorded > BUFFER_SIZE ? recorded - BUFFER_SIZE : 0;
+
+    for (; i < recorded; i++) {
+      const Event& event = buffer->events[i % BUFFER_SIZE];
+
+      if (!first) {
+        stream << ",";
+      }
+      first = false;
+
+      // Use the context name as the name of the event (which is what
+      // gets displayed) unless there isn't one and use what is being
+      // traced as the category so they can be filtered.
+      stream << "\n{\"name\":";
+      WriteString(stream, event.name[0] != '\0' ? event.name : event.what);
+      stream << ",\"cat\":";
+      WriteString(stream, event.what);
+      stream << ",\"ph\":\"" << static_cast<char>(event.phase) << "\"";
+
+      // Timestamps are in microseconds.
+      stream << ",\"ts\":" << event.timestamp / 1000 << "."
+             << (event.timestamp % 1000) / 100
+             << (event.timestamp % 100) / 10
+             << event.timestamp % 10;
+
+      stream << ",\"pid\":1,\"tid\":" << buffer->tid;
+
+      switch (event.phase) {
+        case Event::Phase::AsyncBegin:
+        case Event::Phase::AsyncEnd:
+          stream << ",\"id\":\"0x" << std::hex << event.id << std::dec
+                 << "\"";
+          break;
+        case Event::Phase::Instant:
+          // Scope instant events to the thread.
+          stream << ",\"s\":\"t\"";
+          break;
+        default:
+          break;
+      }
+
+      stream << "}";
+    }
+  }
+
+  stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace trace
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
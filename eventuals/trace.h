@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+#include "eventuals/context-name.h"
+
+////////////////////////////////////////////////////////////////////////
+
+// Whether or not tracing is compiled in. Even when compiled in nothing
+// gets recorded until 'trace::Start()' is called, which only costs a
+// relaxed atomic load per trace point, but it can be compiled out
+// completely with '--copt=-DEVENTUALS_TRACE=0'.
+#ifndef EVENTUALS_TRACE
+#define EVENTUALS_TRACE 1
+#endif
+
+// Number of events each thread keeps (in a ring buffer) while
+// tracing, i.e., older events get overwritten. Each event is 64 bytes.
+#ifndef EVENTUALS_TRACE_BUFFER_SIZE
+#define EVENTUALS_TRACE_BUFFER_SIZE 16384
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+namespace trace {
+
+////////////////////////////////////////////////////////////////////////
+
+inline constexpr bool ENABLED = EVENTUALS_TRACE;
+
+inline constexpr size_t BUFFER_SIZE = EVENTUALS_TRACE_BUFFER_SIZE;
+
+////////////////////////////////////////////////////////////////////////
+
+// A single trace event. The phases correspond to the phases of the
+// Chrome trace event format so that events can be exported as is.
+struct Event final {
+  enum class Phase : char {
+    Begin = 'B',
+    End = 'E',
+    Instant = 'i',
+    AsyncBegin = 'b',
+    AsyncEnd = 'e',
+  };
+
+  // Nanoseconds since the epoch of 'std::chrono::steady_clock'.
+  int64_t timestamp;
+
+  // What is being traced, e.g., "Continue" or "Lock", which must be a
+  // string literal.
+  const char* what;
+
+  // For matching asynchronous begin and end events, which may happen
+  // on different threads.
+  uintptr_t id;
+
+  Phase phase;
+
+  // Name of the context (possibly truncated).
+  char name[64 - sizeof(int64_t) - sizeof(const char*) - sizeof(uintptr_t)
+            - sizeof(Phase)];
+};
+
+static_assert(sizeof(Event) == 64);
+
+////////////////////////////////////////////////////////////////////////
+
+// Per thread ring buffer of events. There is only ever a single writer
+// (the thread) so recording doesn't need any synchronization other
+// than publishing how many events have been recorded.
+struct Buffer final {
+  std::unique_ptr<Event[]> events = std::make_unique<Event[]>(BUFFER_SIZE);
+
+  // Total number of events ever recorded, i.e., the next event gets
+  // recorded at 'recorded % BUFFER_SIZE'.
+  std::atomic<uint64_t> recorded = 0;
+
+  // Used as the "thread id" when exporting.
+  const size_t tid;
+
+  explicit Buffer(size_t tid)
+    : tid(tid) {}
+};
+
+////////////////////////////////////////////////////////////////////////
+
+// Starts recording events (on all threads).
+void Start();
+
+// Stops recording events. Any events that were already recorded can
+// be exported with 'Export()'.
+void Stop();
+
+// Discards all recorded events. Like 'Export()' this should be called
+// after 'Stop()'.
+void Clear();
+
+// Writes all recorded events in the Chrome trace event JSON format,
+// which can be loaded into 'chrome://tracing' or Perfetto
+// ('ui.perfetto.dev') to get a flame chart of each thread.
+//
+// NOTE: should be called after 'Stop()' as events that are being
+// recorded concurrently might otherwise get exported partially
+// written.
+void Export(std::ostream& stream);
+
+////////////////////////////////////////////////////////////////////////
+
+// Whether or not events are currently being recorded.
+inline std::atomic<bool> recording = false;
+
+// Returns the buffer for the current thread, creating (and
+// registering it for exporting) the first time.
+Buffer* RegisterBuffer();
+
+inline void Record(
+    Event::Phase phase,
+    const char* what,
+    const ContextName& name,
+    const void* id = nullptr) {
+  if constexpr (ENABLED) {
+    if (!recording.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    static thread_local Buffer* buffer = RegisterBuffer();
+
+    uint64_t recorded = buffer->recorded.load(std::memory_order_relaxed);
+
+    Event& event = buffer->events[recorded % BUFFER_SIZE];
+
+    event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+    event.what = what;
+    event.id = reinterpret_cast<uintptr_t>(id);
+    event.phase = phase;
+
+    name.CopyTo(event.name, sizeof(event.name));
+
+    buffer->recorded.store(recorded + 1, std::memory_order_release);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Records the beginning (or end) of a span on the current thread,
+// e.g., running a context. Spans on the same thread must nest.
+inline void Begin(const char* what, const ContextName& name) {
+  Record(Event::Phase::Begin, what, name);
+}
+
+inline void End(const char* what, const ContextName& name) {
+  Record(Event::Phase::End, what, name);
+}
+
+// Records something that happened at a point in time.
+inline void Instant(const char* what, const ContextName& name) {
+  Record(Event::Phase::Instant, what, name);
+}
+
+// Records the beginning (or end) of a span that may begin and end on
+// different threads, e.g., waiting to acquire a lock, where 'id'
+// (along with 'what') is used to match up the beginning and end.
+inline void AsyncBegin(
+    const char* what,
+    const ContextName& name,
+    const void* id) {
+  Record(Event::Phase::AsyncBegin, what, name, id);
+}
+
+inline void AsyncEnd(
+    const char* what,
+    const ContextName& name,
+    const void* id) {
+  Record(Event::Phase::AsyncEnd, what, name, id);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace trace
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <memory>
 #include <optional>
 #include <variant>
 
@@ -9,6 +8,7 @@
 #include "eventuals/stream.h"
 #include "eventuals/task.h"
 #include "eventuals/terminal.h"
+#include "eventuals/type-erased-storage.h"
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -179,6 +179,10 @@ struct _Transformer final {
     Stop = 2,
   };
 
+  // See comment on '_TaskFromToWith::Storage', always using the
+  // default 'TYPE_ERASED_INLINE_SIZE'.
+  using Storage = TypeErasedStorage<TYPE_ERASED_INLINE_SIZE>;
+
   template <
       typename K_,
       typename From_,
@@ -271,7 +275,7 @@ struct _Transformer final {
         std::optional<
             typename MonostateIfEmptyOrVariantOf<Catches_>::type>&&,
         std::optional<From_>&&,
-        std::unique_ptr<void, Callback<void(void*)>>&,
+        Storage&,
         Interrupt&,
         TransformerBeginCallback&&,
         TransformerFailCallback<Raises_>&&,
@@ -280,7 +284,7 @@ struct _Transformer final {
         TransformerEndedCallback&&)>
         dispatch_;
 
-    std::unique_ptr<void, Callback<void(void*)>> e_;
+    Storage e_;
     Interrupt* interrupt_ = nullptr;
 
     // NOTE: we store 'k_' as the _last_ member so it will be
@@ -374,7 +378,7 @@ struct _Transformer final {
                           typename MonostateIfEmptyOrVariantOf<
                               Catches_>::type>&& error,
                       std::optional<From_>&& from,
-                      std::unique_ptr<void, Callback<void(void*)>>& e_,
+                      Storage& e_,
                       Interrupt& interrupt,
                       TransformerBeginCallback&& begin,
                       TransformerFailCallback<Raises_>&& fail,
@@ -382,12 +386,9 @@ struct _Transformer final {
                       TransformerBodyCallback<To_>&& body,
                       TransformerEndedCallback&& ended) {
         if (!e_) {
-          e_ = std::unique_ptr<void, Callback<void(void*)>>(
-              new HeapTransformer<E, From_, To_, Catches_, Raises_>(f()),
-              [](void* e) {
-                delete static_cast<
-                    HeapTransformer<E, From_, To_, Catches_, Raises_>*>(e);
-              });
+          e_.Emplace<HeapTransformer<E, From_, To_, Catches_, Raises_>>(
+              Scheduler::Context::Get()->allocator(),
+              f());
         }
 
         auto* e = static_cast<
@@ -457,7 +458,7 @@ struct _Transformer final {
             typename MonostateIfEmptyOrVariantOf<
                 Catches_>::type>&&,
         std::optional<From_>&&,
-        std::unique_ptr<void, Callback<void(void*)>>&,
+        Storage&,
         Interrupt&,
         TransformerBeginCallback&&,
         TransformerFailCallback<Raises_>&&,
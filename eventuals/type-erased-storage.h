@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <new> // For placement new.
+#include <type_traits> // For 'std::aligned_storage'.
+#include <utility>
+
+#include "eventuals/allocator.h"
+#include "glog/logging.h"
+
+////////////////////////////////////////////////////////////////////////
+
+// Default number of bytes that type-erased eventuals (e.g., 'Task' and
+// 'Generator') can use to store their eventual inline, i.e., without
+// needing to allocate. This is kept small because the storage is part
+// of every continuation that composes a type-erased eventual, whether
+// or not the eventual fits. Hot paths with bigger eventuals can opt in
+// to more per type, e.g., 'Task::Of<int>::Inline<1024>', or everywhere
+// at compile time, e.g., with
+// '--copt=-DEVENTUALS_TYPE_ERASED_INLINE_SIZE=1024'.
+#ifndef EVENTUALS_TYPE_ERASED_INLINE_SIZE
+#define EVENTUALS_TYPE_ERASED_INLINE_SIZE 128
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals {
+
+////////////////////////////////////////////////////////////////////////
+
+inline constexpr size_t TYPE_ERASED_INLINE_SIZE =
+    EVENTUALS_TYPE_ERASED_INLINE_SIZE;
+
+////////////////////////////////////////////////////////////////////////
+
+// Storage for a single type-erased object which is constructed in
+// place if it fits in 'Size' bytes and otherwise is allocated using
+// an 'Allocator'.
+//
+// NOTE: just like a continuation, once an object has been emplaced
+// the storage can not be moved.
+template <size_t Size>
+class TypeErasedStorage final {
+ public:
+  template <typename T>
+  static constexpr bool Fits = sizeof(T) <= Size
+      && alignof(T) <= alignof(std::max_align_t);
+
+  TypeErasedStorage() = default;
+
+  TypeErasedStorage(TypeErasedStorage&& that) noexcept {
+    CHECK(!that) << "moving after emplacing";
+  }
+
+  ~TypeErasedStorage() {
+    Reset();
+  }
+
+  // Constructs a 'T' from 'args' and returns a pointer to it, only
+  // using 'allocator' if 'T' doesn't fit inline.
+  template <typename T, typename... Args>
+  T* Emplace(Allocator* allocator, Args&&... args) {
+    Reset();
+
+    T* t = nullptr;
+
+    if constexpr (Fits<T>) {
+      t = new (&storage_) T(std::forward<Args>(args)...);
+    } else {
+      allocator_ = CHECK_NOTNULL(allocator);
+      t = new (allocator_->Allocate(sizeof(T), alignof(T)))
+          T(std::forward<Args>(args)...);
+    }
+
+    pointer_ = t;
+
+    destroy_ = [](void* pointer, Allocator* allocator) {
+      static_cast<T*>(pointer)->~T();
+      if (allocator != nullptr) {
+        allocator->Deallocate(pointer, sizeof(T), alignof(T));
+      }
+    };
+
+    return t;
+  }
+
+  void Reset() {
+    if (pointer_ != nullptr) {
+      destroy_(pointer_, allocator_);
+      pointer_ = nullptr;
+      allocator_ = nullptr;
+      destroy_ = nullptr;
+    }
+  }
+
+  void* get() const {
+    return pointer_;
+  }
+
+  // Returns true if the object was allocated rather than constructed
+  // inline.
+  bool allocated() const {
+    return allocator_ != nullptr;
+  }
+
+  explicit operator bool() const {
+    return pointer_ != nullptr;
+  }
+
+ private:
+  // NOTE: using a size of at least 1 so 'Size' can be 0 which forces
+  // every object to be allocated.
+  std::aligned_storage_t<(Size > 0 ? Size : 1), alignof(std::max_align_t)>
+      storage_;
+
+  void* pointer_ = nullptr;
+
+  // Allocator used to allocate 'pointer_' or 'nullptr' if inline.
+  Allocator* allocator_ = nullptr;
+
+  void (*destroy_)(void*, Allocator*) = nullptr;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals
+
+////////////////////////////////////////////////////////////////////////
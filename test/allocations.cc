@@ -0,0 +1,44 @@
+#include "test/allocations.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+////////////////////////////////////////////////////////////////////////
+
+// NOTE: we replace the global 'operator new' and 'operator delete' so
+// that we can count allocations, they otherwise behave just like the
+// defaults.
+static std::atomic<size_t> allocations = 0;
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  std::free(pointer);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals::test {
+
+////////////////////////////////////////////////////////////////////////
+
+size_t Allocations() {
+  return allocations.load();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals::test
+
+////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////
+
+namespace eventuals::test {
+
+////////////////////////////////////////////////////////////////////////
+
+// Returns the number of times the global 'operator new' has been
+// called (from any thread) since the program started, which tests can
+// use to check that something doesn't allocate.
+size_t Allocations();
+
+////////////////////////////////////////////////////////////////////////
+
+} // namespace eventuals::test
+
+////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,145 @@
+#include "eventuals/arena.h"
+
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "eventuals/collect.h"
+#include "eventuals/concurrent.h"
+#include "eventuals/iterate.h"
+#include "eventuals/just.h"
+#include "eventuals/map.h"
+#include "eventuals/task.h"
+#include "eventuals/then.h"
+#include "gtest/gtest.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+TEST(ArenaTest, Allocate) {
+  Arena arena(/* initial_chunk_size = */ 128);
+
+  void* a = arena.Allocate(10, 1);
+  void* b = arena.Allocate(16, 16);
+
+  EXPECT_NE(a, b);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b) % 16);
+
+  // Bigger than the initial chunk size.
+  void* c = arena.Allocate(1024, 8);
+
+  EXPECT_NE(nullptr, c);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(c) % 8);
+
+  EXPECT_EQ(3u, arena.allocations());
+  EXPECT_EQ(2u, arena.chunks());
+}
+
+
+TEST(ArenaTest, ResetReusesChunks) {
+  Arena arena(/* initial_chunk_size = */ 128);
+
+  for (size_t i = 0; i < 100; i++) {
+    arena.Allocate(100, 8);
+  }
+
+  size_t chunks = arena.chunks();
+
+  for (size_t i = 0; i < 10; i++) {
+    arena.Reset();
+
+    for (size_t j = 0; j < 100; j++) {
+      arena.Allocate(100, 8);
+    }
+
+    EXPECT_EQ(chunks, arena.chunks());
+  }
+}
+
+
+TEST(ArenaTest, ConcurrentAllocate) {
+  Arena arena(/* initial_chunk_size = */ 128);
+
+  static constexpr size_t kThreads = 4;
+  static constexpr size_t kAllocations = 10000;
+
+  std::vector<std::vector<uint64_t*>> pointers(kThreads);
+
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < kThreads; i++) {
+    threads.emplace_back([&arena, &pointers, i]() {
+      for (size_t j = 0; j < kAllocations; j++) {
+        auto* pointer = static_cast<uint64_t*>(
+            arena.Allocate(sizeof(uint64_t), alignof(uint64_t)));
+        *pointer = i * kAllocations + j;
+        pointers[i].push_back(pointer);
+      }
+    });
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(kThreads * kAllocations, arena.allocations());
+
+  // No two allocations overlapped, otherwise a value would have been
+  // overwritten.
+  for (size_t i = 0; i < kThreads; i++) {
+    for (size_t j = 0; j < kAllocations; j++) {
+      ASSERT_EQ(i * kAllocations + j, *pointers[i][j]);
+    }
+  }
+}
+
+
+TEST(ArenaTest, SchedulerContextAllocator) {
+  Arena arena;
+
+  Scheduler::Context::Get()->set_allocator(&arena);
+
+  auto task = []() -> Task::Of<int> {
+    return []() {
+      // NOTE: too big to be stored inline so it must be allocated.
+      return Just(std::array<char, TYPE_ERASED_INLINE_SIZE>())
+          >> Then([](auto&&) {
+               return 1;
+             });
+    };
+  };
+
+  auto e = [&]() {
+    return Iterate({1, 2, 3, 4, 5})
+        >> Concurrent([&]() {
+             return Map([&](int i) {
+               return task()
+                   >> Then([i](int j) {
+                        return i + j;
+                      });
+             });
+           })
+        >> Collect<std::vector>();
+  };
+
+  EXPECT_EQ(5u, (*e()).size());
+
+  // Every task and at least one fiber (fibers may get reused) should
+  // have been allocated from the arena.
+  EXPECT_GE(arena.allocations(), 6u);
+
+  size_t chunks = arena.chunks();
+
+  arena.Reset();
+
+  EXPECT_EQ(5u, (*e()).size());
+
+  EXPECT_EQ(chunks, arena.chunks());
+
+  Scheduler::Context::Get()->set_allocator(nullptr);
+}
+
+} // namespace
+} // namespace eventuals::test
@@ -0,0 +1,234 @@
+#include "eventuals/bounded-pipe.h"
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eventuals/collect.h"
+#include "eventuals/promisify.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+TEST(BoundedPipe, UniqueValue) {
+  BoundedPipe<int> pipe(4);
+
+  *pipe.Write(1);
+  *pipe.Close();
+
+  auto e = [&pipe]() {
+    return pipe.Read()
+        >> Collect<std::vector>();
+  };
+
+  EXPECT_THAT(*e(), ElementsAre(1));
+}
+
+
+TEST(BoundedPipe, WriteWaitsWhenFull) {
+  BoundedPipe<int> pipe(2);
+
+  *pipe.Write(1);
+  *pipe.Write(2);
+
+  auto [future, k] = PromisifyForTest(pipe.Write(3));
+
+  k.Start();
+
+  EXPECT_EQ(
+      std::future_status::timeout,
+      future.wait_for(std::chrono::seconds(0)));
+
+  EXPECT_THAT(*pipe.ReadBatch(1), ElementsAre(1));
+
+  EXPECT_EQ(
+      std::future_status::ready,
+      future.wait_for(std::chrono::seconds(0)));
+
+  *pipe.Close();
+
+  auto e = [&pipe]() {
+    return pipe.Read()
+        >> Collect<std::vector>();
+  };
+
+  EXPECT_THAT(*e(), ElementsAre(2, 3));
+}
+
+
+TEST(BoundedPipe, ReadWaitsWhenEmpty) {
+  BoundedPipe<int> pipe(2);
+
+  auto [future, k] = PromisifyForTest(pipe.ReadBatch(2));
+
+  k.Start();
+
+  EXPECT_EQ(
+      std::future_status::timeout,
+      future.wait_for(std::chrono::seconds(0)));
+
+  *pipe.Write(1);
+
+  EXPECT_THAT(future.get(), ElementsAre(1));
+}
+
+
+TEST(BoundedPipe, Batch) {
+  BoundedPipe<std::string> pipe(4);
+
+  // NOTE: more values than the capacity so 'WriteBatch()' has to
+  // wait for the reader below.
+  std::vector<std::string> values = {"a", "b", "c", "d", "e", "f"};
+
+  auto [future, k] = PromisifyForTest(pipe.WriteBatch(std::move(values)));
+
+  k.Start();
+
+  EXPECT_EQ(
+      std::future_status::timeout,
+      future.wait_for(std::chrono::seconds(0)));
+
+  EXPECT_THAT(*pipe.ReadBatch(3), ElementsAre("a", "b", "c"));
+
+  future.get();
+
+  EXPECT_THAT(*pipe.ReadBatch(8), ElementsAre("d", "e", "f"));
+
+  *pipe.Close();
+
+  EXPECT_THAT(*pipe.ReadBatch(8), IsEmpty());
+}
+
+
+TEST(BoundedPipe, CloseDropsWaitingWrites) {
+  BoundedPipe<int> pipe(2);
+
+  *pipe.Write(1);
+  *pipe.Write(2);
+
+  auto [future, k] = PromisifyForTest(pipe.Write(3));
+
+  k.Start();
+
+  EXPECT_EQ(
+      std::future_status::timeout,
+      future.wait_for(std::chrono::seconds(0)));
+
+  *pipe.Close();
+
+  future.get();
+
+  EXPECT_TRUE(*pipe.IsClosed());
+  EXPECT_EQ(*pipe.Size(), 2);
+
+  // Values written to a closed pipe are silently dropped.
+  *pipe.Write(4);
+  EXPECT_EQ(*pipe.Size(), 2);
+
+  auto e = [&pipe]() {
+    return pipe.Read()
+        >> Collect<std::vector>();
+  };
+
+  EXPECT_THAT(*e(), ElementsAre(1, 2));
+}
+
+
+TEST(BoundedPipe, WaitForClosedAndEmpty) {
+  BoundedPipe<int> pipe(4);
+
+  *pipe.Write(1);
+  *pipe.Write(2);
+  *pipe.Close();
+
+  auto [future, k] = PromisifyForTest(pipe.WaitForClosedAndEmpty());
+  k.Start();
+
+  EXPECT_EQ(
+      std::future_status::timeout,
+      future.wait_for(std::chrono::seconds(0)));
+
+  auto e = [&pipe]() {
+    return pipe.Read()
+        >> Collect<std::vector>();
+  };
+  EXPECT_THAT(*e(), ElementsAre(1, 2));
+
+  EXPECT_EQ(
+      std::future_status::ready,
+      future.wait_for(std::chrono::seconds(0)));
+}
+
+
+TEST(BoundedPipe, MultipleWritersAndReaders) {
+  constexpr size_t kWriters = 4;
+  constexpr size_t kReaders = 4;
+  constexpr int kValuesPerWriter = 1000;
+
+  BoundedPipe<int> pipe(8);
+
+  std::vector<std::thread> writers;
+  for (size_t i = 0; i < kWriters; i++) {
+    writers.emplace_back([&pipe]() {
+      for (int value = 1; value <= kValuesPerWriter; value++) {
+        *pipe.Write(int(value));
+      }
+    });
+  }
+
+  std::vector<std::future<long>> sums;
+  for (size_t i = 0; i < kReaders; i++) {
+    sums.push_back(std::async(std::launch::async, [&pipe]() {
+      long sum = 0;
+      for (int value : *(pipe.Read() >> Collect<std::vector>())) {
+        sum += value;
+      }
+      return sum;
+    }));
+  }
+
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  *pipe.Close();
+
+  long sum = 0;
+  for (auto& future : sums) {
+    sum += future.get();
+  }
+
+  EXPECT_EQ(kWriters * (kValuesPerWriter * (kValuesPerWriter + 1) / 2), sum);
+}
+
+TEST(BoundedPipe, ReadManyValuesWithoutWaiting) {
+  // NOTE: enough values that a reader would overflow its stack if it
+  // recursed for every value it reads.
+  constexpr size_t kValues = 100000;
+
+  BoundedPipe<int> pipe(kValues);
+
+  for (size_t i = 0; i < kValues; i++) {
+    *pipe.Write(1);
+  }
+
+  *pipe.Close();
+
+  auto e = [&pipe]() {
+    return pipe.Read()
+        >> Collect<std::vector>();
+  };
+
+  EXPECT_EQ(kValues, (*e()).size());
+}
+
+} // namespace
+} // namespace eventuals::test
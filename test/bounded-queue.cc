@@ -0,0 +1,130 @@
+#include "eventuals/bounded-queue.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace eventuals::test {
+namespace {
+
+TEST(BoundedQueue, PushPop) {
+  BoundedQueue<std::string> queue(4);
+
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.TryPop());
+
+  EXPECT_TRUE(queue.TryPush(std::string("hello")));
+  EXPECT_TRUE(queue.TryPush(std::string("world")));
+
+  EXPECT_FALSE(queue.Empty());
+
+  EXPECT_EQ("hello", queue.TryPop().value());
+  EXPECT_EQ("world", queue.TryPop().value());
+
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.TryPop());
+}
+
+
+TEST(BoundedQueue, CapacityRoundedUp) {
+  BoundedQueue<int> queue(3);
+
+  EXPECT_EQ(4, queue.capacity());
+
+  // A queue always has at least 2 slots.
+  BoundedQueue<int> one(1);
+
+  EXPECT_EQ(2, one.capacity());
+}
+
+
+TEST(BoundedQueue, Full) {
+  BoundedQueue<std::unique_ptr<int>> queue(2);
+
+  EXPECT_TRUE(queue.TryPush(std::make_unique<int>(1)));
+  EXPECT_TRUE(queue.TryPush(std::make_unique<int>(2)));
+
+  // A failed push must not move from the value.
+  auto value = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.TryPush(std::move(value)));
+  ASSERT_TRUE(value);
+
+  EXPECT_EQ(1, *queue.TryPop().value());
+
+  EXPECT_TRUE(queue.TryPush(std::move(value)));
+
+  EXPECT_EQ(2, *queue.TryPop().value());
+  EXPECT_EQ(3, *queue.TryPop().value());
+  EXPECT_FALSE(queue.TryPop());
+}
+
+
+TEST(BoundedQueue, DestructsRemainingValues) {
+  auto value = std::make_shared<int>(42);
+
+  {
+    BoundedQueue<std::shared_ptr<int>> queue(4);
+    EXPECT_TRUE(queue.TryPush(value));
+    EXPECT_TRUE(queue.TryPush(value));
+    EXPECT_EQ(3, value.use_count());
+  }
+
+  EXPECT_EQ(1, value.use_count());
+}
+
+
+TEST(BoundedQueue, MultipleProducersMultipleConsumers) {
+  constexpr size_t kProducers = 4;
+  constexpr size_t kConsumers = 4;
+  constexpr size_t kValuesPerProducer = 10000;
+
+  BoundedQueue<size_t> queue(64);
+
+  std::atomic<size_t> popped = 0;
+  std::atomic<size_t> sum = 0;
+
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < kProducers; i++) {
+    threads.emplace_back([&queue]() {
+      for (size_t value = 1; value <= kValuesPerProducer; value++) {
+        while (!queue.TryPush(value)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for (size_t i = 0; i < kConsumers; i++) {
+    threads.emplace_back([&]() {
+      while (popped.load() < kProducers * kValuesPerProducer) {
+        std::optional<size_t> value = queue.TryPop();
+        if (value) {
+          sum += *value;
+          popped++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(kProducers * kValuesPerProducer, popped.load());
+  EXPECT_EQ(
+      kProducers * (kValuesPerProducer * (kValuesPerProducer + 1) / 2),
+      sum.load());
+  EXPECT_TRUE(queue.Empty());
+}
+
+} // namespace
+} // namespace eventuals::test
@@ -0,0 +1,142 @@
+#include "eventuals/buffer-chain.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace eventuals::test {
+namespace {
+
+TEST(BufferChainTest, Append) {
+  BufferChain chain;
+
+  EXPECT_TRUE(chain.empty());
+
+  chain.AppendUnowned("Hello");
+  chain.Append(std::string(", "));
+  chain += std::string("world!");
+
+  // Empty slices are skipped.
+  chain.Append(std::string());
+
+  EXPECT_FALSE(chain.empty());
+  EXPECT_EQ(13u, chain.size());
+  EXPECT_EQ(3u, chain.slices());
+  EXPECT_EQ("Hello, world!", chain.ToString());
+
+  ASSERT_EQ(3u, chain.buffers().size());
+  EXPECT_EQ(5u, chain.buffers()[0].len);
+  EXPECT_EQ(2u, chain.buffers()[1].len);
+  EXPECT_EQ(6u, chain.buffers()[2].len);
+}
+
+
+TEST(BufferChainTest, WithoutCopying) {
+  // Big enough to not fit in a small string.
+  std::string data(1024, 'x');
+  const char* pointer = data.data();
+
+  BufferChain chain;
+  chain.Append(std::move(data));
+
+  EXPECT_EQ(pointer, chain.buffers()[0].base);
+
+  auto shared = std::make_shared<const std::string>("shared");
+
+  chain.Append(shared);
+
+  EXPECT_EQ(shared->data(), chain.buffers()[1].base);
+  EXPECT_EQ(2, shared.use_count());
+
+  chain.Clear();
+
+  EXPECT_EQ(1, shared.use_count());
+}
+
+
+TEST(BufferChainTest, Share) {
+  auto shared = std::make_shared<const std::string>("shared");
+
+  BufferChain chain;
+  chain.Append(shared);
+
+  {
+    BufferChain copy = chain;
+
+    BufferChain other;
+    other.AppendUnowned("not ");
+    other.Append(chain);
+
+    EXPECT_EQ("shared", copy.ToString());
+    EXPECT_EQ("not shared", other.ToString());
+
+    // Every chain references the same slice.
+    EXPECT_EQ(shared->data(), copy.buffers()[0].base);
+    EXPECT_EQ(shared->data(), other.buffers()[1].base);
+    EXPECT_EQ(4, shared.use_count());
+  }
+
+  EXPECT_EQ(2, shared.use_count());
+}
+
+
+TEST(BufferChainTest, BufferPool) {
+  BufferPool pool(/* buffer_size = */ 16);
+
+  {
+    BufferChain chain;
+
+    BufferPool::Buffer buffer = pool.Acquire();
+    std::memcpy(buffer.data(), "pooled", 6);
+    buffer.resize(6);
+
+    chain.Append(std::move(buffer));
+
+    EXPECT_EQ("pooled", chain.ToString());
+    EXPECT_EQ(1u, pool.outstanding());
+
+    BufferChain copy = chain;
+
+    chain.Clear();
+
+    // Still referenced by 'copy'.
+    EXPECT_EQ(1u, pool.outstanding());
+  }
+
+  EXPECT_EQ(0u, pool.outstanding());
+  EXPECT_EQ(1u, pool.cached());
+}
+
+
+TEST(BufferChainTest, Consume) {
+  auto hello = std::make_shared<const std::string>("Hello");
+
+  BufferChain chain;
+  chain.Append(hello);
+  chain.AppendUnowned(", ");
+  chain.Append(std::string("world!"));
+
+  chain.Consume(3);
+
+  EXPECT_EQ("lo, world!", chain.ToString());
+  EXPECT_EQ(10u, chain.size());
+  EXPECT_EQ(3u, chain.slices());
+
+  // Consuming the rest of a slice releases it.
+  chain.Consume(4);
+
+  EXPECT_EQ("world!", chain.ToString());
+  EXPECT_EQ(1u, chain.slices());
+  EXPECT_EQ(1, hello.use_count());
+
+  chain.Consume(6);
+
+  EXPECT_TRUE(chain.empty());
+  EXPECT_EQ(0u, chain.slices());
+}
+
+} // namespace
+} // namespace eventuals::test
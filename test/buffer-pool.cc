@@ -0,0 +1,102 @@
+#include "eventuals/buffer-pool.h"
+
+#include <cstring>
+#include <thread>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace eventuals::test {
+namespace {
+
+TEST(BufferPoolTest, Acquire) {
+  BufferPool pool(/* buffer_size = */ 16);
+
+  BufferPool::Buffer buffer = pool.Acquire();
+
+  EXPECT_NE(nullptr, buffer.data());
+  EXPECT_EQ(16u, buffer.size());
+  EXPECT_EQ(16u, buffer.capacity());
+  EXPECT_EQ(1u, pool.outstanding());
+
+  std::memcpy(buffer.data(), "hello", 5);
+  buffer.resize(5);
+
+  EXPECT_EQ("hello", buffer.view());
+  EXPECT_EQ(16u, buffer.capacity());
+}
+
+
+TEST(BufferPoolTest, Reuse) {
+  BufferPool pool(/* buffer_size = */ 16);
+
+  char* data = nullptr;
+
+  {
+    BufferPool::Buffer buffer = pool.Acquire();
+    data = buffer.data();
+  }
+
+  EXPECT_EQ(0u, pool.outstanding());
+  EXPECT_EQ(1u, pool.cached());
+
+  // Steady state shouldn't allocate any more buffers.
+  for (size_t i = 0; i < 100; i++) {
+    BufferPool::Buffer buffer = pool.Acquire();
+    EXPECT_EQ(data, buffer.data());
+  }
+
+  EXPECT_EQ(1u, pool.allocations());
+}
+
+
+TEST(BufferPoolTest, MaxCached) {
+  BufferPool pool(/* buffer_size = */ 16, /* max_cached = */ 2);
+
+  {
+    BufferPool::Buffer a = pool.Acquire();
+    BufferPool::Buffer b = pool.Acquire();
+    BufferPool::Buffer c = pool.Acquire();
+    EXPECT_EQ(3u, pool.outstanding());
+  }
+
+  EXPECT_EQ(0u, pool.outstanding());
+  EXPECT_EQ(2u, pool.cached());
+}
+
+
+TEST(BufferPoolTest, Move) {
+  BufferPool pool(/* buffer_size = */ 16);
+
+  BufferPool::Buffer a = pool.Acquire();
+  char* data = a.data();
+
+  BufferPool::Buffer b = std::move(a);
+
+  EXPECT_EQ(nullptr, a.data());
+  EXPECT_EQ(0u, a.capacity());
+  EXPECT_EQ(data, b.data());
+  EXPECT_EQ(1u, pool.outstanding());
+
+  b = pool.Acquire();
+
+  // Assigning released the original buffer back to the pool.
+  EXPECT_EQ(1u, pool.outstanding());
+  EXPECT_EQ(1u, pool.cached());
+}
+
+
+TEST(BufferPoolTest, ReleaseOnDifferentThread) {
+  BufferPool pool(/* buffer_size = */ 16);
+
+  BufferPool::Buffer buffer = pool.Acquire();
+
+  std::thread thread([buffer = std::move(buffer)]() {});
+  thread.join();
+
+  EXPECT_EQ(0u, pool.outstanding());
+  EXPECT_EQ(1u, pool.cached());
+}
+
+} // namespace
+} // namespace eventuals::test
@@ -1,7 +1,13 @@
 #include "eventuals/callback.h"
 
+#include <array>
+#include <memory>
+#include <optional>
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "stout/borrowed_ptr.h"
+#include "test/allocations.h"
 
 namespace eventuals::test {
 namespace {
@@ -66,5 +72,115 @@ TEST(Callback, BorrowedCallable) {
   EXPECT_EQ(foo.borrows(), 0);
 }
 
+TEST(Callback, InlineSize) {
+  std::array<char, 100> array = {'a'};
+
+  size_t before = Allocations();
+
+  Callback<char(), 128> callback = [array]() {
+    return array[0];
+  };
+
+  Callback<char(), 128> moved = std::move(callback);
+
+  EXPECT_FALSE(callback);
+  EXPECT_EQ('a', moved());
+
+  EXPECT_EQ(before, Allocations());
+}
+
+TEST(Callback, TriviallyCopyable) {
+  int i = 41;
+
+  Callback<int(int)> callback = [&i](int j) {
+    return i + j;
+  };
+
+  Callback<int(int)> moved;
+  moved = std::move(callback);
+
+  EXPECT_FALSE(callback);
+  EXPECT_EQ(42, moved(1));
+}
+
+TEST(Callback, Pooled) {
+  auto f = [](std::array<int, 64> array, std::unique_ptr<int> i) {
+    return [array, i = std::move(i)]() {
+      return array[0] + *i;
+    };
+  };
+
+  static_assert(!PooledCallback<int()>::Fits<decltype(f({}, nullptr))>);
+
+  {
+    PooledCallback<int()> callback = f({1}, std::make_unique<int>(41));
+
+    PooledCallback<int()> moved = std::move(callback);
+
+    EXPECT_FALSE(callback);
+    EXPECT_EQ(42, moved());
+  }
+
+  // The block should be reused from the pool.
+  auto lambda = f({2}, std::make_unique<int>(40));
+
+  size_t before = Allocations();
+
+  PooledCallback<int()> callback = std::move(lambda);
+
+  EXPECT_EQ(before, Allocations());
+
+  EXPECT_EQ(42, callback());
+}
+
+TEST(Callback, PooledDestructedOnAnotherThread) {
+  auto f = [](std::array<int, 64> array) {
+    return [array]() {
+      return array[0];
+    };
+  };
+
+  std::optional<PooledCallback<int()>> callback = f({42});
+
+  std::thread thread([&]() {
+    EXPECT_EQ(42, (*callback)());
+
+    // The block isn't cached by this thread since it was allocated on
+    // another thread ...
+    callback.reset();
+
+    // ... so this needs to allocate.
+    auto lambda = f({41});
+
+    size_t before = Allocations();
+
+    PooledCallback<int()> other = std::move(lambda);
+
+    EXPECT_LT(before, Allocations());
+
+    EXPECT_EQ(41, other());
+  });
+
+  thread.join();
+}
+
+TEST(Callback, PooledDestructedAtThreadExit) {
+  std::thread thread([]() {
+    // NOTE: constructed before the pool's 'thread_local' state so it
+    // gets destructed after it.
+    static thread_local std::optional<PooledCallback<int()>> callback;
+
+    std::array<int, 64> array = {42};
+
+    callback = [array]() {
+      return array[0];
+    };
+
+    EXPECT_EQ(42, (*callback)());
+  });
+
+  thread.join();
+}
+
 } // namespace
 } // namespace eventuals::test
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "eventuals/allocator.h"
+#include "eventuals/callback.h"
+#include "eventuals/collect.h"
+#include "eventuals/eventual.h"
+#include "eventuals/let.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/range.h"
+#include "test/concurrent/concurrent.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+// Tests that many fibers can be in flight at the same time and that
+// they all complete once their eventuals do.
+TYPED_TEST(ConcurrentTypedTest, ManyFibersInFlight) {
+  constexpr int kFibers = 10000;
+
+  std::deque<Callback<void()>> callbacks;
+
+  auto e = [&]() {
+    return Range(kFibers)
+        >> this->ConcurrentOrConcurrentOrdered([&]() {
+            struct Data {
+              void* k;
+              int i;
+            };
+            return Map(Let([&](int& i) {
+              return Eventual<int>(
+                  [&, data = Data()](auto& k) mutable {
+                    using K = std::decay_t<decltype(k)>;
+                    data.k = &k;
+                    data.i = i;
+                    callbacks.emplace_back([&data]() {
+                      static_cast<K*>(data.k)->Start(data.i);
+                    });
+                  });
+            }));
+          })
+        >> Collect<std::vector>();
+  };
+
+  auto [future, k] = PromisifyForTest(e());
+
+  k.Start();
+
+  ASSERT_EQ(kFibers, callbacks.size());
+
+  EXPECT_EQ(
+      std::future_status::timeout,
+      future.wait_for(std::chrono::seconds(0)));
+
+  // Complete the fibers in reverse order so that fibers finish in a
+  // different order than they were started.
+  for (auto it = callbacks.rbegin(); it != callbacks.rend(); ++it) {
+    (*it)();
+  }
+
+  std::vector<int> values = future.get();
+
+  ASSERT_EQ(kFibers, values.size());
+
+  if constexpr (std::is_same_v<TypeParam, ConcurrentOrderedType>) {
+    for (int i = 0; i < kFibers; i++) {
+      EXPECT_EQ(i, values[i]);
+    }
+  } else {
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < kFibers; i++) {
+      EXPECT_EQ(i, values[i]);
+    }
+  }
+}
+
+// Counts the allocations made with it, e.g., for each new fiber.
+class CountingAllocator final : public Allocator {
+ public:
+  void* Allocate(size_t size, size_t alignment) override {
+    allocations++;
+    return DefaultAllocator()->Allocate(size, alignment);
+  }
+
+  void Deallocate(void* pointer, size_t size, size_t alignment) override {
+    DefaultAllocator()->Deallocate(pointer, size, alignment);
+  }
+
+  size_t allocations = 0;
+};
+
+// Sets the allocator of the current 'Scheduler::Context' for the
+// lifetime of the guard.
+class AllocatorGuard final {
+ public:
+  AllocatorGuard(Allocator* allocator)
+    : previous_(Scheduler::Context::Get()->allocator()) {
+    Scheduler::Context::Get()->set_allocator(allocator);
+  }
+
+  ~AllocatorGuard() {
+    Scheduler::Context::Get()->set_allocator(previous_);
+  }
+
+ private:
+  Allocator* previous_;
+};
+
+// Tests that fibers get reused when each eventual completes before
+// the next upstream value arrives.
+TYPED_TEST(ConcurrentTypedTest, ManyFibersReused) {
+  constexpr int kValues = 10000;
+
+  // NOTE: fibers are allocated using the allocator of the current
+  // 'Scheduler::Context' so we can count them.
+  CountingAllocator allocator;
+
+  AllocatorGuard guard(&allocator);
+
+  auto e = [&]() {
+    return Range(kValues)
+        >> this->ConcurrentOrConcurrentOrdered([]() {
+            return Map([](int i) {
+              return i + 1;
+            });
+          })
+        >> Collect<std::vector>();
+  };
+
+  std::vector<int> values = *e();
+
+  ASSERT_EQ(kValues, values.size());
+
+  std::sort(values.begin(), values.end());
+
+  for (int i = 0; i < kValues; i++) {
+    EXPECT_EQ(i + 1, values[i]);
+  }
+
+  // Every fiber finishes before the next value arrives so only a
+  // handful of fibers should ever have been allocated rather than one
+  // for every value.
+  EXPECT_GT(allocator.allocations, 0u);
+  EXPECT_LE(allocator.allocations, 2u);
+}
+
+} // namespace
+} // namespace eventuals::test
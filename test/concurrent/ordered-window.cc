@@ -0,0 +1,165 @@
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "eventuals/callback.h"
+#include "eventuals/collect.h"
+#include "eventuals/concurrent-ordered.h"
+#include "eventuals/eventual.h"
+#include "eventuals/let.h"
+#include "eventuals/map.h"
+#include "eventuals/promisify.h"
+#include "eventuals/range.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+using testing::StrEq;
+using testing::ThrowsMessage;
+
+// Tests that 'ConcurrentOrdered()' with a window stops requesting
+// upstream values while the value at the head of the window hasn't
+// finished and that all values are still emitted in order.
+TEST(ConcurrentOrderedWindow, ThrottlesUpstream) {
+  constexpr int kValues = 100;
+  constexpr size_t kWindow = 4;
+
+  std::deque<Callback<void()>> callbacks;
+
+  auto e = [&]() {
+    return Range(kValues)
+        >> ConcurrentOrdered(
+               [&]() {
+                 struct Data {
+                   void* k;
+                   int i;
+                 };
+                 return Map(Let([&](int& i) {
+                   return Eventual<int>(
+                       [&, data = Data()](auto& k) mutable {
+                         using K = std::decay_t<decltype(k)>;
+                         data.k = &k;
+                         data.i = i;
+                         callbacks.emplace_back([&data]() {
+                           static_cast<K*>(data.k)->Start(data.i);
+                         });
+                       });
+                 }));
+               },
+               kWindow)
+        >> Collect<std::vector>();
+  };
+
+  auto [future, k] = PromisifyForTest(e());
+
+  k.Start();
+
+  ASSERT_EQ(kWindow, callbacks.size());
+
+  // Completing everything but the head of the window shouldn't admit
+  // any more upstream values.
+  while (callbacks.size() > 1) {
+    Callback<void()> callback = std::move(callbacks.back());
+    callbacks.pop_back();
+    callback();
+  }
+
+  ASSERT_EQ(1, callbacks.size());
+
+  EXPECT_EQ(
+      std::future_status::timeout,
+      future.wait_for(std::chrono::seconds(0)));
+
+  // Completing the head should advance the window past all of the
+  // values that already completed.
+  Callback<void()> head = std::move(callbacks.front());
+  callbacks.pop_front();
+  head();
+
+  ASSERT_EQ(kWindow, callbacks.size());
+
+  while (!callbacks.empty()) {
+    Callback<void()> callback = std::move(callbacks.back());
+    callbacks.pop_back();
+    callback();
+  }
+
+  std::vector<int> values = future.get();
+
+  ASSERT_EQ(kValues, values.size());
+
+  for (int i = 0; i < kValues; i++) {
+    EXPECT_EQ(i, values[i]);
+  }
+}
+
+// Tests that a failure doesn't deadlock when the head of the window
+// hasn't finished and upstream is waiting to be admitted.
+TEST(ConcurrentOrderedWindow, FailWhileHeadStalled) {
+  constexpr int kValues = 100;
+  constexpr size_t kWindow = 4;
+
+  std::deque<Callback<void()>> callbacks;
+
+  auto e = [&]() {
+    return Range(kValues)
+        >> ConcurrentOrdered(
+               [&]() {
+                 struct Data {
+                   void* k;
+                   int i;
+                 };
+                 return Map(Let([&](int& i) {
+                   return Eventual<int>()
+                       .raises<RuntimeError>()
+                       .start([&, data = Data()](auto& k) mutable {
+                         using K = std::decay_t<decltype(k)>;
+                         data.k = &k;
+                         data.i = i;
+                         callbacks.emplace_back([&data]() {
+                           if (data.i == 2) {
+                             static_cast<K*>(data.k)->Fail(
+                                 RuntimeError("error"));
+                           } else {
+                             static_cast<K*>(data.k)->Start(data.i);
+                           }
+                         });
+                       });
+                 }));
+               },
+               kWindow)
+        >> Collect<std::vector>();
+  };
+
+  auto [future, k] = PromisifyForTest(e());
+
+  k.Start();
+
+  ASSERT_EQ(kWindow, callbacks.size());
+
+  // Fail before the head of the window has finished.
+  Callback<void()> fail = std::move(callbacks[2]);
+  callbacks.erase(callbacks.begin() + 2);
+  fail();
+
+  while (!callbacks.empty()) {
+    Callback<void()> callback = std::move(callbacks.front());
+    callbacks.pop_front();
+    callback();
+  }
+
+  EXPECT_THAT(
+      // NOTE: capturing 'future' as a pointer because until C++20 we
+      // can't capture a "local binding" by reference and there is a
+      // bug with 'EXPECT_THAT' that forces our lambda to be const so
+      // if we capture it by copy we can't call 'get()' because that
+      // is a non-const function.
+      [future = &future]() { future->get(); },
+      ThrowsMessage<RuntimeError>(StrEq("error")));
+}
+
+} // namespace
+} // namespace eventuals::test
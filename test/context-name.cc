@@ -0,0 +1,127 @@
+#include "eventuals/context-name.h"
+
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "eventuals/collect.h"
+#include "eventuals/concurrent.h"
+#include "eventuals/iterate.h"
+#include "eventuals/map.h"
+#include "eventuals/scheduler.h"
+#include "eventuals/then.h"
+#include "gtest/gtest.h"
+#include "test/allocations.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+TEST(ContextNameTest, Literal) {
+  size_t before = Allocations();
+
+  ContextName name = "a rather long name that would not fit inline";
+
+  ContextName derived = name.Derive("concurrent fiber");
+
+  EXPECT_EQ(before, Allocations());
+
+  EXPECT_EQ(name, "a rather long name that would not fit inline");
+  EXPECT_EQ(
+      derived,
+      "a rather long name that would not fit inline [concurrent fiber]");
+}
+
+
+TEST(ContextNameTest, Array) {
+  // Mutable arrays aren't treated like string literals.
+  static_assert(!std::is_constructible_v<ContextName, char (&)[8]>);
+
+  // A name stops at the first null character.
+  static const char kName[16] = "name";
+
+  EXPECT_EQ(ContextName(kName), "name");
+  EXPECT_EQ(ContextName(kName).str().size(), 4u);
+
+  char buffer[16] = "buffer";
+
+  EXPECT_EQ(ContextName(std::string(buffer)), "buffer");
+}
+
+
+TEST(ContextNameTest, Derive) {
+  ContextName name = std::string("parent");
+
+  std::string label = "label";
+
+  EXPECT_EQ(name.Derive("suffix").str(), "parent [suffix]");
+  EXPECT_EQ(
+      name.Derive("suffix", label, 3).str(),
+      "parent [suffix - label - 3]");
+  EXPECT_EQ(
+      name.Derive("suffix", std::string_view(), 3).str(),
+      "parent [suffix - 3]");
+
+  // Deriving from a derived name.
+  EXPECT_EQ(
+      name.Derive("first").Derive("second").str(),
+      "parent [first] [second]");
+
+  std::ostringstream stream;
+  stream << name.Derive("suffix", label, 3);
+
+  EXPECT_EQ(stream.str(), "parent [suffix - label - 3]");
+}
+
+
+TEST(ContextNameTest, CopyTo) {
+  ContextName name = ContextName("parent").Derive("suffix", "label", 3);
+
+  char buffer[64];
+
+  size_t before = Allocations();
+
+  EXPECT_EQ(27, name.CopyTo(buffer, sizeof(buffer)));
+
+  EXPECT_EQ(before, Allocations());
+
+  EXPECT_EQ("parent [suffix - label - 3]", std::string(buffer));
+
+  // Truncated (including the terminating null character).
+  EXPECT_EQ(9, name.CopyTo(buffer, 10));
+  EXPECT_EQ("parent [s", std::string(buffer));
+}
+
+
+TEST(ContextNameTest, ConcurrentDoesNotAllocateNames) {
+  auto e = [](size_t n) {
+    return Iterate(std::vector<int>(n, 1))
+        >> Concurrent([]() {
+             return Map([](int i) {
+               return i;
+             });
+           })
+        >> Collect<std::vector>();
+  };
+
+  auto allocations = [&](size_t n) {
+    auto [future, k] = PromisifyForTest(e(n));
+    size_t before = Allocations();
+    k.Start();
+    EXPECT_EQ(n, future.get().size());
+    return Allocations() - before;
+  };
+
+  // NOTE: every value gets run on a fiber with a context whose name
+  // is derived from the current context's name, which shouldn't
+  // allocate, so other than growing the collected 'std::vector' the
+  // number of allocations shouldn't depend on the number of values.
+  size_t ten = allocations(10);
+  size_t thousand = allocations(1000);
+
+  EXPECT_LE(thousand, ten + 16);
+}
+
+} // namespace
+} // namespace eventuals::test
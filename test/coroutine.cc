@@ -0,0 +1,212 @@
+#include "eventuals/coroutine.h"
+
+// NOTE: coroutines are only tested when building with C++20, i.e.,
+// with '--config=cpp20'.
+#if EVENTUALS_HAS_COROUTINES
+
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "eventuals/arena.h"
+#include "eventuals/eventual.h"
+#include "eventuals/just.h"
+#include "eventuals/raise.h"
+#include "eventuals/task.h"
+#include "eventuals/terminal.h"
+#include "eventuals/then.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+using testing::MockFunction;
+using testing::StrEq;
+using testing::ThrowsMessage;
+
+Coroutine::Of<int> AddOne(int i) {
+  int j = co_await (
+      Just(i)
+      >> Then([](int i) {
+          return i + 1;
+        }));
+  co_return j;
+}
+
+TEST(CoroutineTest, Succeed) {
+  EXPECT_EQ(42, *AddOne(41));
+
+  auto e = []() {
+    return AddOne(40)
+        >> Then([](int i) {
+             return i + 1;
+           });
+  };
+
+  EXPECT_EQ(42, *e());
+}
+
+
+Coroutine::Of<void> Set(int& x) {
+  co_await Then([&x]() {
+    x = 100;
+  });
+}
+
+TEST(CoroutineTest, Void) {
+  int x = 0;
+
+  *Set(x);
+
+  EXPECT_EQ(100, x);
+}
+
+
+Coroutine::Of<int> AddTwo(int i) {
+  int j = co_await AddOne(i);
+  co_return co_await AddOne(j);
+}
+
+TEST(CoroutineTest, Nested) {
+  EXPECT_EQ(42, *AddTwo(40));
+}
+
+
+TEST(CoroutineTest, Task) {
+  auto task = []() -> Task::Of<int> {
+    return []() {
+      return AddOne(41);
+    };
+  };
+
+  EXPECT_EQ(42, *task());
+}
+
+
+Coroutine::Of<std::string>::Raises<RuntimeError> Catch() {
+  try {
+    co_await Raise("error");
+  } catch (const RuntimeError& error) {
+    co_return std::string("caught ") + error.what();
+  }
+  co_return std::string("not caught");
+}
+
+TEST(CoroutineTest, Catch) {
+  EXPECT_EQ("caught error", *Catch());
+}
+
+
+Coroutine::Of<int>::Raises<RuntimeError> Fail() {
+  co_await Raise("error");
+  co_return 42;
+}
+
+TEST(CoroutineTest, Fail) {
+  auto e = []() {
+    return Fail()
+        >> Then([](int i) {
+             ADD_FAILURE() << "Encountered unexpected value";
+             return i;
+           });
+  };
+
+  static_assert(
+      eventuals::tuple_types_unordered_equals_v<
+          typename decltype(e())::template ErrorsFrom<void, std::tuple<>>,
+          std::tuple<RuntimeError>>);
+
+  EXPECT_THAT(
+      [&]() { *e(); },
+      ThrowsMessage<RuntimeError>(StrEq("error")));
+}
+
+
+Coroutine::Of<int> Stop(bool& resumed) {
+  int i = co_await Eventual<int>([](auto& k) {
+    k.Stop();
+  });
+  resumed = true;
+  co_return i;
+}
+
+TEST(CoroutineTest, Stop) {
+  bool resumed = false;
+
+  EXPECT_THROW(*Stop(resumed), eventuals::Stopped);
+
+  EXPECT_FALSE(resumed);
+}
+
+
+Coroutine::Of<int> Asynchronous() {
+  std::optional<std::thread> thread;
+
+  int i = co_await Eventual<int>([&thread](auto& k) {
+    thread.emplace([&k]() {
+      k.Start(41);
+    });
+  });
+
+  // NOTE: we've been resumed on 'thread' so we need to detach it
+  // before we can destruct it.
+  thread->detach();
+
+  co_return i + 1;
+}
+
+TEST(CoroutineTest, Asynchronous) {
+  EXPECT_EQ(42, *Asynchronous());
+}
+
+
+Coroutine::Of<int> Interruptible(MockFunction<void()>& start) {
+  co_return co_await Eventual<int>()
+      .interruptible()
+      .start([&](auto& k, std::optional<Interrupt::Handler>& handler) {
+        CHECK(handler) << "Test expects interrupt to be registered";
+        EXPECT_TRUE(handler->Install([&k]() {
+          k.Stop();
+        }));
+        start.Call();
+      });
+}
+
+TEST(CoroutineTest, Interrupt) {
+  MockFunction<void()> start;
+
+  auto [future, k] = PromisifyForTest(Interruptible(start));
+
+  Interrupt interrupt;
+
+  k.Register(interrupt);
+
+  EXPECT_CALL(start, Call())
+      .WillOnce([&]() {
+        interrupt.Trigger();
+      });
+
+  k.Start();
+
+  EXPECT_THROW(future.get(), eventuals::Stopped);
+}
+
+
+TEST(CoroutineTest, Allocator) {
+  Arena arena;
+
+  Scheduler::Context::Get()->set_allocator(&arena);
+
+  EXPECT_EQ(42, *AddOne(41));
+
+  EXPECT_EQ(1u, arena.allocations());
+
+  Scheduler::Context::Get()->set_allocator(nullptr);
+}
+
+} // namespace
+} // namespace eventuals::test
+
+#endif
@@ -1,6 +1,10 @@
 #include "eventuals/dns-resolver.h"
 
+#include <filesystem>
+#include <fstream>
 #include <regex>
+#include <string>
+#include <vector>
 
 #include "eventuals/event-loop.h"
 #include "eventuals/then.h"
@@ -13,6 +17,7 @@
 namespace eventuals::test {
 namespace {
 
+using testing::ElementsAre;
 using testing::MockFunction;
 using testing::StrEq;
 using testing::ThrowsMessage;
@@ -108,5 +113,209 @@ TEST_F(DomainNameResolveTest, Raises) {
       ThrowsMessage<MyError>(StrEq("child error")));
 }
 
+
+class DnsResolverTest : public EventLoopTest {};
+
+
+TEST_F(DnsResolverTest, Resolve) {
+  DnsResolver resolver;
+
+  auto e = [&]() {
+    return resolver.Resolve("localhost");
+  };
+
+  static_assert(
+      eventuals::tuple_types_unordered_equals_v<
+          typename decltype(e())::template ErrorsFrom<void, std::tuple<>>,
+          std::tuple<RuntimeError>>);
+
+  std::vector<std::string> addresses = *e();
+
+  ASSERT_FALSE(addresses.empty());
+
+  for (const std::string& address : addresses) {
+    EXPECT_TRUE(address == "127.0.0.1" || address == "::1") << address;
+  }
+
+  EXPECT_EQ(1u, resolver.lookups());
+}
+
+
+TEST_F(DnsResolverTest, Cache) {
+  DnsResolver resolver(DnsResolverOptions{std::chrono::seconds(10)});
+
+  auto e = [&]() {
+    return resolver.Resolve("localhost");
+  };
+
+  std::vector<std::string> addresses = *e();
+
+  EXPECT_EQ(addresses, *e());
+
+  EXPECT_EQ(1u, resolver.lookups());
+  EXPECT_EQ(1u, resolver.hits());
+
+  Clock().Pause();
+
+  Clock().Advance(std::chrono::seconds(9));
+
+  EXPECT_EQ(addresses, *e());
+
+  EXPECT_EQ(1u, resolver.lookups());
+
+  // Now the cached addresses have expired.
+  Clock().Advance(std::chrono::seconds(1));
+
+  EXPECT_EQ(addresses, *e());
+
+  EXPECT_EQ(2u, resolver.lookups());
+
+  Clock().Resume();
+}
+
+
+TEST_F(DnsResolverTest, Coalesce) {
+  DnsResolver resolver;
+
+  auto [future1, k1] = PromisifyForTest(resolver.Resolve("localhost"));
+  auto [future2, k2] = PromisifyForTest(resolver.Resolve("localhost"));
+
+  k1.Start();
+  k2.Start();
+
+  RunUntil(future1);
+  RunUntil(future2);
+
+  EXPECT_FALSE(future1.get().empty());
+  EXPECT_FALSE(future2.get().empty());
+
+  EXPECT_EQ(1u, resolver.lookups());
+}
+
+
+TEST_F(DnsResolverTest, Fail) {
+  DnsResolver resolver;
+
+  auto e = [&]() {
+    return resolver.Resolve(";;!(*#!()%$%*(#*!~_+");
+  };
+
+  EXPECT_THAT(
+      [&]() { *e(); },
+      ThrowsMessage<RuntimeError>(StrEq("EAI_NONAME")));
+
+  // Failures are cached too.
+  EXPECT_THAT(
+      [&]() { *e(); },
+      ThrowsMessage<RuntimeError>(StrEq("EAI_NONAME")));
+
+  EXPECT_EQ(1u, resolver.lookups());
+}
+
+
+TEST_F(DnsResolverTest, Hosts) {
+  const std::filesystem::path path = "test_dns_resolver_hosts";
+
+  std::ofstream ofs(path);
+  ofs << "# Stub resolver for testing.\n"
+      << "10.0.0.1 eventuals.test alias.eventuals.test\n"
+      << "\n"
+      << "fd00::1  eventuals.test # IPv6\n";
+  ofs.close();
+
+  DnsResolverOptions options;
+  options.hosts = path;
+
+  DnsResolver resolver(options);
+
+  std::filesystem::remove(path);
+
+  EXPECT_THAT(
+      *resolver.Resolve("eventuals.test"),
+      ElementsAre("10.0.0.1", "fd00::1"));
+
+  EXPECT_THAT(
+      *resolver.Resolve("alias.eventuals.test"),
+      ElementsAre("10.0.0.1"));
+
+  EXPECT_EQ(0u, resolver.lookups());
+  EXPECT_EQ(2u, resolver.hits());
+}
+
+
+TEST_F(DnsResolverTest, Interrupt) {
+  DnsResolver resolver;
+
+  auto [future, k] = PromisifyForTest(resolver.Resolve("localhost"));
+
+  Interrupt interrupt;
+
+  k.Register(interrupt);
+
+  k.Start();
+
+  // Wait until the lookup has started before interrupting.
+  RunUntil([&]() {
+    return resolver.lookups() == 1;
+  });
+
+  interrupt.Trigger();
+
+  RunUntil(future);
+
+  EXPECT_THROW(future.get(), eventuals::Stopped);
+
+  // The lookup still completes (and gets cached) which we need to
+  // wait for before the resolver gets destructed.
+  EXPECT_FALSE((*resolver.Resolve("localhost")).empty());
+
+  EXPECT_EQ(1u, resolver.lookups());
+}
+
+
+TEST_F(DnsResolverTest, Evict) {
+  DnsResolverOptions options;
+  options.max_entries = 1;
+
+  DnsResolver resolver(options);
+
+  EXPECT_FALSE((*resolver.Resolve("localhost")).empty());
+
+  EXPECT_EQ(1u, resolver.size());
+
+  // Caching another name evicts "localhost" even though it hasn't
+  // expired yet.
+  EXPECT_THAT(*resolver.Resolve("127.0.0.1"), ElementsAre("127.0.0.1"));
+
+  EXPECT_EQ(1u, resolver.size());
+  EXPECT_EQ(2u, resolver.lookups());
+
+  EXPECT_FALSE((*resolver.Resolve("localhost")).empty());
+
+  EXPECT_EQ(1u, resolver.size());
+  EXPECT_EQ(3u, resolver.lookups());
+
+  // Names with a lookup in flight are never evicted.
+  auto [future1, k1] = PromisifyForTest(resolver.Resolve("127.0.0.1"));
+  auto [future2, k2] = PromisifyForTest(resolver.Resolve("::1"));
+
+  k1.Start();
+  k2.Start();
+
+  RunUntil([&]() {
+    return resolver.lookups() == 5;
+  });
+
+  EXPECT_EQ(2u, resolver.size());
+
+  RunUntil(future1);
+  RunUntil(future2);
+
+  EXPECT_THAT(future1.get(), ElementsAre("127.0.0.1"));
+  EXPECT_THAT(future2.get(), ElementsAre("::1"));
+
+  EXPECT_EQ(1u, resolver.size());
+}
+
 } // namespace
 } // namespace eventuals::test
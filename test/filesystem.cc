@@ -1,10 +1,22 @@
 #include "eventuals/filesystem.h"
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <csignal>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <string>
+#include <vector>
 
 #include "event-loop-test.h"
 #include "eventuals/closure.h"
+#include "eventuals/collect.h"
+#include "eventuals/iterate.h"
+#include "eventuals/just.h"
+#include "eventuals/loop.h"
 #include "eventuals/promisify.h"
 #include "eventuals/then.h"
 #include "gmock/gmock.h"
@@ -131,6 +143,36 @@ TEST_F(FilesystemTest, ReadFileFail) {
 }
 
 
+TEST_F(FilesystemTest, ReadFilePastEnd) {
+  const std::filesystem::path path = "test_readfile_past_end";
+  const std::string test_string = "Hello GTest!";
+
+  std::ofstream ofs(path);
+
+  ofs << test_string;
+  ofs.close();
+
+  // Only what was actually read should be returned.
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return ReadFile(file, 1024, 6)
+                   >> Then([&](std::string&& data) {
+                        EXPECT_EQ("GTest!", data);
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
 TEST_F(FilesystemTest, WriteFileSucceed) {
   const std::filesystem::path path = "test_writefile_succeed";
   const std::string test_string = "Hello GTest!";
@@ -201,6 +243,705 @@ TEST_F(FilesystemTest, WriteFileFail) {
 }
 
 
+#ifndef _WIN32
+// Limits the size of the files this process can write to 'size' bytes
+// for the lifetime of the object, ignoring 'SIGXFSZ' so that writing
+// past the limit fails with 'EFBIG' rather than killing us, which lets
+// us force a short write.
+class FileSizeLimit final {
+ public:
+  FileSizeLimit(rlim_t size) {
+    CHECK_EQ(0, getrlimit(RLIMIT_FSIZE, &previous_));
+    rlimit limit = previous_;
+    limit.rlim_cur = size;
+    CHECK_EQ(0, setrlimit(RLIMIT_FSIZE, &limit));
+    handler_ = signal(SIGXFSZ, SIG_IGN);
+  }
+
+  ~FileSizeLimit() {
+    CHECK_EQ(0, setrlimit(RLIMIT_FSIZE, &previous_));
+    signal(SIGXFSZ, handler_);
+  }
+
+ private:
+  rlimit previous_;
+  void (*handler_)(int);
+};
+
+
+TEST_F(FilesystemTest, WriteFileShortWrite) {
+  const std::filesystem::path path = "test_writefile_short_write";
+  const std::string test_string = "Hello GTest!";
+
+  std::ofstream ofs(path);
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_WRONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return WriteFile(file, test_string, 0)
+                   >> Then([&]() {
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  {
+    // Only the first 5 bytes can be written so the first write is
+    // short and then writing the rest must fail rather than the
+    // short write being treated as success.
+    FileSizeLimit limit(5);
+
+    EXPECT_THROW(*e(), RuntimeError);
+  }
+
+  std::ifstream ifs(path);
+  std::string contents;
+  std::getline(ifs, contents);
+  ifs.close();
+
+  EXPECT_EQ("Hello", contents);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+#endif
+
+
+TEST_F(FilesystemTest, ReadFileIntoBufferPoolBuffer) {
+  const std::filesystem::path path = "test_readfile_buffer_pool";
+  const std::string test_string = "Hello GTest!";
+
+  std::ofstream ofs(path);
+
+  ofs << test_string;
+  ofs.close();
+
+  BufferPool pool(/* buffer_size = */ 8);
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&,
+                             file = std::move(file),
+                             buffer = pool.Acquire()]() mutable {
+               return ReadFile(file, buffer, 0)
+                   >> Then([&](size_t bytes) {
+                        EXPECT_EQ(8u, bytes);
+                        EXPECT_EQ("Hello GT", buffer.view());
+                      })
+                   // Reuse the same buffer for the rest of the file.
+                   >> ReadFile(file, buffer, 8)
+                   >> Then([&](size_t bytes) {
+                        EXPECT_EQ(4u, bytes);
+                        EXPECT_EQ("est!", buffer.view());
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  EXPECT_EQ(1u, pool.allocations());
+  EXPECT_EQ(0u, pool.outstanding());
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, ReadFileScatter) {
+  const std::filesystem::path path = "test_readfile_scatter";
+  const std::string test_string = "Hello GTest!";
+
+  std::ofstream ofs(path);
+
+  ofs << test_string;
+  ofs.close();
+
+  char hello[6];
+  char gtest[6];
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return ReadFile(
+                          file,
+                          {uv_buf_init(hello, sizeof(hello)),
+                           uv_buf_init(gtest, sizeof(gtest))},
+                          0)
+                   >> Then([&](size_t bytes) {
+                        EXPECT_EQ(test_string.size(), bytes);
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  EXPECT_EQ("Hello ", std::string(hello, sizeof(hello)));
+  EXPECT_EQ("GTest!", std::string(gtest, sizeof(gtest)));
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, WriteFileGather) {
+  const std::filesystem::path path = "test_writefile_gather";
+
+  std::ofstream ofs(path);
+  ofs.close();
+
+  std::string hello = "Hello ";
+  std::string gtest = "GTest!";
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_WRONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return WriteFile(
+                          file,
+                          {uv_buf_init(hello.data(), hello.size()),
+                           uv_buf_init(gtest.data(), gtest.size())},
+                          0)
+                   >> Then([&](size_t bytes) {
+                        EXPECT_EQ(hello.size() + gtest.size(), bytes);
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  std::ifstream ifs(path);
+  std::string contents;
+  std::getline(ifs, contents);
+  ifs.close();
+
+  EXPECT_EQ("Hello GTest!", contents);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, WriteFileWithoutCopying) {
+  const std::filesystem::path path = "test_writefile_without_copying";
+  const std::string test_string = "Hello GTest!";
+
+  std::ofstream ofs(path);
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_WRONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return WriteFile(
+                          file,
+                          test_string.data(),
+                          test_string.size(),
+                          0)
+                   >> Then([&](size_t bytes) {
+                        EXPECT_EQ(test_string.size(), bytes);
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  std::ifstream ifs(path);
+  std::string contents;
+  std::getline(ifs, contents);
+  ifs.close();
+
+  EXPECT_EQ(test_string, contents);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, WriteFileBufferChain) {
+  const std::filesystem::path path = "test_writefile_buffer_chain";
+
+  std::ofstream ofs(path);
+  ofs.close();
+
+  BufferPool pool(/* buffer_size = */ 16);
+
+  BufferPool::Buffer buffer = pool.Acquire();
+  std::memcpy(buffer.data(), "GTest", 5);
+  buffer.resize(5);
+
+  BufferChain chain;
+  chain.AppendUnowned("Hello ");
+  chain.Append(std::move(buffer));
+  chain.Append(std::string("!"));
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_WRONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return WriteFile(file, std::move(chain), 0)
+                   >> Then([&](size_t bytes) {
+                        EXPECT_EQ(12u, bytes);
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  // The pooled buffer was returned once the write completed.
+  EXPECT_EQ(0u, pool.outstanding());
+
+  std::ifstream ifs(path);
+  std::string contents;
+  std::getline(ifs, contents);
+  ifs.close();
+
+  EXPECT_EQ("Hello GTest!", contents);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+#ifndef _WIN32
+TEST_F(FilesystemTest, WriteFileBufferChainShortWrite) {
+  const std::filesystem::path path = "test_writefile_buffer_chain_short_write";
+
+  std::ofstream ofs(path);
+  ofs.close();
+
+  BufferChain chain;
+  chain.AppendUnowned("Hello ");
+  chain.Append(std::string("GTest"));
+  chain.Append(std::string("!"));
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_WRONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return WriteFile(file, std::move(chain), 0)
+                   >> Then([&](size_t) {
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  {
+    // Only the first 8 bytes (i.e., part way through the second
+    // slice) can be written so the first write is short and then
+    // writing the rest of the chain must fail.
+    FileSizeLimit limit(8);
+
+    EXPECT_THROW(*e(), RuntimeError);
+  }
+
+  std::ifstream ifs(path);
+  std::string contents;
+  std::getline(ifs, contents);
+  ifs.close();
+
+  EXPECT_EQ("Hello GT", contents);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+#endif
+
+
+TEST_F(FilesystemTest, ReadFileStream) {
+  const std::filesystem::path path = "test_readfilestream";
+  const std::string test_string = "Hello GTest! Streaming a file.";
+
+  std::ofstream ofs(path);
+
+  ofs << test_string;
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return ReadFileStream(
+                          file,
+                          /* chunk_size = */ 4,
+                          /* readahead = */ 3)
+                   >> Collect<std::vector>()
+                   >> Then([&](std::vector<std::string>&& chunks) {
+                        return CloseFile(std::move(file))
+                            >> Just(std::move(chunks));
+                      });
+             });
+           });
+  };
+
+  std::vector<std::string> chunks = *e();
+
+  ASSERT_EQ(8u, chunks.size());
+  EXPECT_EQ("Hell", chunks[0]);
+  EXPECT_EQ("e.", chunks[7]);
+
+  std::string contents;
+  for (const std::string& chunk : chunks) {
+    contents += chunk;
+  }
+
+  EXPECT_EQ(test_string, contents);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, ReadFileStreamBufferPool) {
+  const std::filesystem::path path = "test_readfilestream_buffer_pool";
+  const std::string test_string = "Hello GTest! Streaming a file.";
+
+  std::ofstream ofs(path);
+
+  ofs << test_string;
+  ofs.close();
+
+  BufferPool pool(/* buffer_size = */ 8);
+
+  std::string contents;
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return ReadFileStream(file, pool, /* readahead = */ 2)
+                   >> Loop()
+                          .body([&](auto& stream, auto&& buffer) {
+                            contents += buffer.view();
+                            stream.Next();
+                          })
+                   >> Then([&]() {
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  EXPECT_EQ(test_string, contents);
+  EXPECT_EQ(0u, pool.outstanding());
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, ReadFileStreamEmptyFile) {
+  const std::filesystem::path path = "test_readfilestream_empty";
+
+  std::ofstream ofs(path);
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return ReadFileStream(file, /* chunk_size = */ 4)
+                   >> Collect<std::vector>()
+                   >> Then([&](std::vector<std::string>&& chunks) {
+                        EXPECT_TRUE(chunks.empty());
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, WriteFileStream) {
+  const std::filesystem::path path = "test_writefilestream";
+
+  std::ofstream ofs(path);
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_WRONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return Iterate(std::vector<std::string>{
+                          "Hello ",
+                          "GTest! ",
+                          "Streaming ",
+                          "a file."})
+                   >> WriteFileStream(
+                          file,
+                          /* offset = */ 0,
+                          /* write_behind = */ 2,
+                          SyncPolicy::EveryChunk)
+                   >> Then([&](size_t written) {
+                        EXPECT_EQ(30u, written);
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  std::ifstream ifs(path);
+  std::string contents;
+  std::getline(ifs, contents);
+  ifs.close();
+
+  EXPECT_EQ("Hello GTest! Streaming a file.", contents);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, CopyWithFileStreams) {
+  const std::filesystem::path src = "test_filestreams_src";
+  const std::filesystem::path dst = "test_filestreams_dst";
+
+  const std::string test_string(1000, 'x');
+
+  std::ofstream ofs(src);
+  ofs << test_string;
+  ofs.close();
+
+  ofs.open(dst);
+  ofs.close();
+
+  BufferPool pool(/* buffer_size = */ 64);
+
+  auto e = [&]() {
+    return OpenFile(src, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, from = std::move(file)]() mutable {
+               return OpenFile(dst, UV_FS_O_WRONLY, 0)
+                   >> Then([&](File&& file) {
+                        return Closure([&, to = std::move(file)]() mutable {
+                          return ReadFileStream(from, pool)
+                              >> WriteFileStream(to)
+                              >> Then([&](size_t written) {
+                                   EXPECT_EQ(test_string.size(), written);
+                                   return CloseFile(std::move(to))
+                                       >> CloseFile(std::move(from));
+                                 });
+                        });
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  std::ifstream ifs(dst);
+  std::string contents;
+  std::getline(ifs, contents);
+  ifs.close();
+
+  EXPECT_EQ(test_string, contents);
+  EXPECT_EQ(0u, pool.outstanding());
+
+  std::filesystem::remove(src);
+  std::filesystem::remove(dst);
+}
+
+
+#ifndef _WIN32
+TEST_F(FilesystemTest, MapFile) {
+  const std::filesystem::path path = "test_mapfile";
+  const std::string test_string = "Hello GTest!";
+
+  std::ofstream ofs(path);
+
+  ofs << test_string;
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return MapFile(file)
+                   >> Then([&](MappedFile&& mapped) {
+                        return CloseFile(std::move(file))
+                            >> Just(std::move(mapped));
+                      });
+             });
+           });
+  };
+
+  MappedFile mapped = *e();
+
+  // Still valid after the file has been closed.
+  EXPECT_EQ(test_string, mapped.view());
+
+  EXPECT_TRUE(mapped.Advise(MapAdvice::Sequential));
+  EXPECT_TRUE(mapped.Advise(MapAdvice::WillNeed, 6, 6));
+  EXPECT_FALSE(mapped.Advise(MapAdvice::Random, 1024));
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, MapFileReadWrite) {
+  const std::filesystem::path path = "test_mapfile_read_write";
+  const std::string test_string = "Hello GTest!";
+
+  std::ofstream ofs(path);
+
+  ofs << test_string;
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDWR, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return MapFile(file, MapMode::ReadWrite, /* prefault = */ true)
+                   >> Then([&](MappedFile&& mapped) {
+                        mapped.data()[0] = 'J';
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  std::ifstream ifs(path);
+  std::string contents;
+  std::getline(ifs, contents);
+  ifs.close();
+
+  EXPECT_EQ("Jello GTest!", contents);
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, MapFileEmpty) {
+  const std::filesystem::path path = "test_mapfile_empty";
+
+  std::ofstream ofs(path);
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return MapFile(file)
+                   >> Then([&](MappedFile&& mapped) {
+                        EXPECT_TRUE(mapped.empty());
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  *e();
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, MapFileFail) {
+  const std::filesystem::path path = "test_mapfile_fail";
+
+  std::ofstream ofs(path);
+  ofs << "Hello GTest!";
+  ofs.close();
+
+  // Can't map a file for writing that was only opened for reading.
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return MapFile(file, MapMode::ReadWrite)
+                   >> Then([&](MappedFile&&) {
+                        return CloseFile(std::move(file));
+                      });
+             });
+           });
+  };
+
+  EXPECT_THAT(
+      [&]() { *e(); },
+      ThrowsMessage<RuntimeError>(StrEq("permission denied")));
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+
+TEST_F(FilesystemTest, IteratePages) {
+  const std::filesystem::path path = "test_iterate_pages";
+  const std::string test_string = "Hello GTest!";
+
+  std::ofstream ofs(path);
+
+  ofs << test_string;
+  ofs.close();
+
+  auto e = [&]() {
+    return OpenFile(path, UV_FS_O_RDONLY, 0)
+        >> Then([&](File&& file) {
+             return Closure([&, file = std::move(file)]() mutable {
+               return MapFile(file)
+                   >> Then([&](MappedFile&& mapped) {
+                        return CloseFile(std::move(file))
+                            >> Just(std::move(mapped));
+                      });
+             });
+           });
+  };
+
+  MappedFile mapped = *e();
+
+  *PrefaultMappedFile(mapped);
+
+  auto pages = [&]() {
+    return IteratePages(mapped, /* chunk_size = */ 5)
+        >> Collect<std::vector>();
+  };
+
+  EXPECT_THAT(
+      *pages(),
+      testing::ElementsAre("Hello", " GTes", "t!"));
+
+  auto page = [&]() {
+    return IteratePages(mapped)
+        >> Collect<std::vector>();
+  };
+
+  EXPECT_THAT(*page(), testing::ElementsAre(test_string));
+
+  std::filesystem::remove(path);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+#endif
+
+
 TEST_F(FilesystemTest, UnlinkFileSucceed) {
   const std::filesystem::path path = "test_unlinkfile_succeed";
 
@@ -85,6 +85,11 @@ TEST(Generator, Succeed) {
 
 TEST(Generator, GeneratorWithNonCopyable) {
   struct NonCopyable {
+    // NOTE: an explicit constructor is required because as of C++20 a
+    // type with any user-declared constructors isn't an aggregate.
+    explicit NonCopyable(int x)
+      : x(x) {}
+
     NonCopyable(NonCopyable&&) = default;
     NonCopyable(const NonCopyable&) = delete;
 
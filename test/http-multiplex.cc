@@ -0,0 +1,321 @@
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "eventuals/concurrent.h"
+#include "eventuals/http.h"
+#include "eventuals/iterate.h"
+#include "eventuals/just.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/reduce.h"
+#include "eventuals/tcp.h"
+#include "eventuals/then.h"
+#include "gtest/gtest.h"
+#include "test/event-loop-test.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::http::test {
+namespace {
+
+// A stand-in for an HTTP/2 server without TLS (i.e., h2c with prior
+// knowledge) which speaks just enough of the protocol to respond to
+// each request with status 200 and a body of "hello".
+//
+// NOTE: the requests themselves aren't decoded (which would require
+// HPACK) since all we need is the stream they were sent on.
+class H2cServer final {
+ public:
+  H2cServer() {
+    listener_ = *TcpListener::Listen("127.0.0.1", 0);
+  }
+
+  int port() {
+    return listener_.port();
+  }
+
+  std::string uri() {
+    return "http://127.0.0.1:" + std::to_string(port()) + "/";
+  }
+
+  // Number of connections accepted so far.
+  size_t connections() const {
+    return connections_.size();
+  }
+
+  // Number of requests responded to so far.
+  size_t requests() const {
+    return requests_;
+  }
+
+  auto Serve() {
+    return listener_.Accept()
+        >> Concurrent([this]() {
+             return Map([this](TcpStream&& stream) {
+               connections_.push_back(Connection{std::move(stream)});
+
+               Connection& connection = connections_.back();
+
+               // Our (empty) SETTINGS must be the first frame we send.
+               return connection.stream.Write(Frame(0, SETTINGS, 0, 0))
+                   >> Then([this, &connection]() {
+                        return connection.stream.Read()
+                            >> Map([this, &connection](std::string_view data) {
+                                 connection.input.append(data);
+                                 return connection.stream.Write(
+                                     Handle(connection));
+                               })
+                            >> Loop();
+                      })
+                   // NOTE: 'Concurrent()' doesn't support 'void'.
+                   >> Just(true);
+             });
+           })
+        >> Loop();
+  }
+
+  // Closes the listener and all of the connections (which should
+  // already have been closed by the client).
+  void Close() {
+    for (Connection& connection : connections_) {
+      if (connection.stream.IsOpen()) {
+        *connection.stream.Close();
+      }
+    }
+    *listener_.Close();
+  }
+
+ private:
+  struct Connection {
+    TcpStream stream;
+    std::string input;
+    bool preface = false;
+  };
+
+  // Returns a frame header for a frame of 'length' bytes.
+  static std::string Frame(
+      size_t length,
+      uint8_t type,
+      uint8_t flags,
+      uint32_t stream) {
+    return std::string{
+        static_cast<char>((length >> 16) & 0xFF),
+        static_cast<char>((length >> 8) & 0xFF),
+        static_cast<char>(length & 0xFF),
+        static_cast<char>(type),
+        static_cast<char>(flags),
+        static_cast<char>((stream >> 24) & 0x7F),
+        static_cast<char>((stream >> 16) & 0xFF),
+        static_cast<char>((stream >> 8) & 0xFF),
+        static_cast<char>(stream & 0xFF)};
+  }
+
+  // Handles all of the complete frames in 'connection.input'
+  // returning any frames to send back.
+  std::string Handle(Connection& connection) {
+    static constexpr std::string_view PREFACE =
+        "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+    std::string output;
+
+    if (!connection.preface) {
+      if (connection.input.size() < PREFACE.size()) {
+        return output;
+      }
+      EXPECT_EQ(PREFACE, connection.input.substr(0, PREFACE.size()));
+      connection.input.erase(0, PREFACE.size());
+      connection.preface = true;
+    }
+
+    while (connection.input.size() >= 9) {
+      const auto* header =
+          reinterpret_cast<const uint8_t*>(connection.input.data());
+
+      const size_t length = (header[0] << 16) | (header[1] << 8) | header[2];
+      const uint8_t type = header[3];
+      const uint8_t flags = header[4];
+      const uint32_t stream = ((header[5] & 0x7F) << 24)
+          | (header[6] << 16)
+          | (header[7] << 8)
+          | header[8];
+
+      if (connection.input.size() < 9 + length) {
+        break;
+      }
+
+      std::string payload = connection.input.substr(9, length);
+
+      connection.input.erase(0, 9 + length);
+
+      switch (type) {
+        case SETTINGS:
+          if (!(flags & ACK)) {
+            output += Frame(0, SETTINGS, ACK, 0);
+          }
+          break;
+        case PING:
+          if (!(flags & ACK)) {
+            output += Frame(payload.size(), PING, ACK, 0) + payload;
+          }
+          break;
+        case HEADERS: {
+          // HPACK indexed header field for ':status: 200' from the
+          // static table.
+          static constexpr char STATUS_200 = '\x88';
+          static constexpr std::string_view BODY = "hello";
+
+          output += Frame(1, HEADERS, END_HEADERS, stream);
+          output += STATUS_200;
+          output += Frame(BODY.size(), DATA, END_STREAM, stream);
+          output += BODY;
+
+          requests_++;
+          break;
+        }
+        default:
+          // Ignoring everything else, e.g., WINDOW_UPDATE.
+          break;
+      }
+    }
+
+    return output;
+  }
+
+  // Frame types.
+  static constexpr uint8_t DATA = 0x0;
+  static constexpr uint8_t HEADERS = 0x1;
+  static constexpr uint8_t SETTINGS = 0x4;
+  static constexpr uint8_t PING = 0x6;
+
+  // Frame flags.
+  static constexpr uint8_t ACK = 0x1;
+  static constexpr uint8_t END_STREAM = 0x1;
+  static constexpr uint8_t END_HEADERS = 0x4;
+
+  TcpListener listener_;
+
+  // NOTE: using a 'std::list' so references remain valid.
+  std::list<Connection> connections_;
+
+  size_t requests_ = 0;
+};
+
+
+class HttpMultiplexTest : public ::eventuals::test::EventLoopTest {
+ protected:
+  void SetUp() override {
+    EventLoopTest::SetUp();
+
+    if (!(curl_version_info(CURLVERSION_NOW)->features
+          & CURL_VERSION_HTTP2)) {
+      GTEST_SKIP() << "libcurl was built without HTTP/2 support";
+    }
+  }
+
+  // Sends 'requests' concurrent 'GET' requests returning how many
+  // succeeded.
+  size_t Get(Client& client, const std::string& uri, size_t requests) {
+    return *(Iterate(std::vector<size_t>(requests))
+             >> Concurrent([&]() {
+                  return Map([&](size_t) {
+                    return client.Get(std::string(uri));
+                  });
+                })
+             >> Reduce(
+                 /* succeeded = */ size_t(0),
+                 [](size_t& succeeded) {
+                   return Then([&](Response&& response) {
+                     if (response.code() == 200
+                         && response.body() == "hello") {
+                       succeeded++;
+                     }
+                     return true;
+                   });
+                 }));
+  }
+};
+
+
+TEST_F(HttpMultiplexTest, SharedConnection) {
+  static constexpr size_t kRequests = 10;
+
+  H2cServer server;
+
+  auto [future, k] = PromisifyForTest(server.Serve());
+
+  k.Start();
+
+  {
+    Client client = Client::Builder()
+                        .multiplex(true)
+                        .Build();
+
+    EXPECT_EQ(kRequests, Get(client, server.uri(), kRequests));
+
+    // All of the requests were multiplexed over a single connection.
+    EXPECT_EQ(1u, server.connections());
+    EXPECT_EQ(kRequests, server.requests());
+
+    ClientMetrics metrics = client.metrics();
+
+    EXPECT_EQ(1u, metrics.connections_opened);
+    EXPECT_EQ(kRequests - 1, metrics.connections_reused);
+
+    // Later requests continue to reuse the connection.
+    EXPECT_EQ(kRequests, Get(client, server.uri(), kRequests));
+
+    metrics = client.metrics();
+
+    EXPECT_EQ(1u, server.connections());
+    EXPECT_EQ(1u, metrics.connections_opened);
+    EXPECT_EQ(2 * kRequests - 1, metrics.connections_reused);
+  }
+
+  // Let the client's session close its connection.
+  RunUntilIdle();
+
+  server.Close();
+
+  RunUntil(future);
+}
+
+
+TEST_F(HttpMultiplexTest, MaxConcurrentStreams) {
+  static constexpr size_t kRequests = 10;
+
+  H2cServer server;
+
+  auto [future, k] = PromisifyForTest(server.Serve());
+
+  k.Start();
+
+  {
+    Client client = Client::Builder()
+                        .multiplex(true)
+                        .max_concurrent_streams(2)
+                        .Build();
+
+    EXPECT_EQ(kRequests, Get(client, server.uri(), kRequests));
+
+    EXPECT_EQ(kRequests, server.requests());
+
+    // Every request either opened or reused a connection.
+    ClientMetrics metrics = client.metrics();
+
+    EXPECT_EQ(server.connections(), metrics.connections_opened);
+    EXPECT_EQ(
+        kRequests,
+        metrics.connections_opened + metrics.connections_reused);
+  }
+
+  RunUntilIdle();
+
+  server.Close();
+
+  RunUntil(future);
+}
+
+} // namespace
+} // namespace eventuals::http::test
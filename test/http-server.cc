@@ -0,0 +1,478 @@
+#include "eventuals/http-server.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "eventuals/event-loop.h"
+#include "eventuals/head.h"
+#include "eventuals/loop.h"
+#include "eventuals/map.h"
+#include "eventuals/reduce.h"
+#include "eventuals/tcp.h"
+#include "eventuals/then.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "test/event-loop-test.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+using eventuals::http::Server;
+using eventuals::http::ServerOptions;
+
+class HttpServerTest : public EventLoopTest {
+ protected:
+  // Returns the next exchange from 'server_'.
+  Server::Exchange Next() {
+    return *(server_.Serve() >> Head());
+  }
+
+  // Connects a client to 'server_' and writes 'requests'.
+  TcpStream Send(std::string_view requests) {
+    TcpStream client = *TcpStream::Connect("127.0.0.1", server_.port());
+    *client.Write(std::string(requests));
+    return client;
+  }
+
+  // Reads from 'stream' until what's been read ends with 'end'.
+  std::string ReadUntil(TcpStream& stream, std::string_view end) {
+    return *(stream.Read()
+             >> Reduce(
+                 /* data = */ std::string(),
+                 [end](std::string& data) {
+                   return Then([&data, end](std::string_view chunk) {
+                     data.append(chunk);
+                     return data.size() < end.size()
+                         || data.compare(
+                                data.size() - end.size(),
+                                end.size(),
+                                end)
+                         != 0;
+                   });
+                 }));
+  }
+
+  // Reads from 'stream' until the end of the stream.
+  std::string ReadAll(TcpStream& stream) {
+    return *(stream.Read()
+             >> Reduce(
+                 /* data = */ std::string(),
+                 [](std::string& data) {
+                   return Then([&](std::string_view chunk) {
+                     data.append(chunk);
+                     return true;
+                   });
+                 }));
+  }
+
+  // Reads all of the request body of 'exchange'.
+  std::string ReadBody(Server::Exchange& exchange) {
+    return *(exchange.Body()
+             >> Reduce(
+                 /* data = */ std::string(),
+                 [](std::string& data) {
+                   return Then([&](std::string&& chunk) {
+                     data.append(chunk);
+                     return true;
+                   });
+                 }));
+  }
+
+  void SetUp() override {
+    EventLoopTest::SetUp();
+    server_ = *Server::Listen("127.0.0.1", 0);
+  }
+
+  void TearDown() override {
+    if (server_.IsOpen()) {
+      *server_.Close();
+    }
+    EventLoopTest::TearDown();
+  }
+
+  Server server_;
+};
+
+
+TEST_F(HttpServerTest, KeepAlive) {
+  TcpStream client = Send("GET /hello?name=world HTTP/1.1\r\n"
+                          "Host: localhost\r\n"
+                          "X-Custom:  value \r\n"
+                          "\r\n");
+
+  Server::Exchange exchange = Next();
+
+  EXPECT_EQ("GET", exchange.request().method());
+  EXPECT_EQ("/hello?name=world", exchange.request().target());
+  EXPECT_EQ("/hello", exchange.request().path());
+  EXPECT_EQ("name=world", exchange.request().query());
+  EXPECT_EQ("HTTP/1.1", exchange.request().version());
+  EXPECT_EQ("localhost", exchange.request().header("host"));
+  EXPECT_EQ("value", exchange.request().header("x-CUSTOM"));
+  EXPECT_EQ(std::nullopt, exchange.request().header("missing"));
+  EXPECT_TRUE(exchange.request().keep_alive());
+
+  *exchange.Respond(200, {{"Content-Type", "text/plain"}}, "hello");
+
+  EXPECT_EQ(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: text/plain\r\n"
+      "Content-Length: 5\r\n"
+      "\r\n"
+      "hello",
+      ReadUntil(client, "hello"));
+
+  // Same connection can be used again.
+  *client.Write("GET /again HTTP/1.1\r\n\r\n");
+
+  exchange = Next();
+
+  EXPECT_EQ("/again", exchange.request().target());
+
+  *exchange.Respond(404);
+
+  EXPECT_EQ(
+      "HTTP/1.1 404 Not Found\r\n"
+      "Content-Length: 0\r\n"
+      "\r\n",
+      ReadUntil(client, "\r\n\r\n"));
+
+  EXPECT_EQ(1u, server_.connections());
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, Pipelined) {
+  TcpStream client = Send("GET /0 HTTP/1.1\r\n\r\n"
+                          "GET /1 HTTP/1.1\r\n\r\n"
+                          "GET /2 HTTP/1.1\r\n\r\n");
+
+  std::vector<Server::Exchange> exchanges;
+  exchanges.push_back(Next());
+  exchanges.push_back(Next());
+  exchanges.push_back(Next());
+
+  // Respond out of order, responses should still be sent in order.
+  for (size_t i = 3; i > 0; i--) {
+    Server::Exchange& exchange = exchanges[i - 1];
+    *exchange.Respond(200, {}, std::string(exchange.request().path()));
+  }
+
+  EXPECT_EQ(
+      "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n/0"
+      "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n/1"
+      "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n/2",
+      ReadUntil(client, "/2"));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, ContentLengthBody) {
+  TcpStream client = Send("POST /echo HTTP/1.1\r\n"
+                          "Content-Length: 11\r\n"
+                          "\r\n"
+                          "hello world");
+
+  Server::Exchange exchange = Next();
+
+  EXPECT_EQ("hello world", ReadBody(exchange));
+
+  // Reading after the end of the body is still the end of the body.
+  EXPECT_EQ("", ReadBody(exchange));
+
+  *exchange.Respond(200);
+
+  EXPECT_EQ(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 0\r\n"
+      "\r\n",
+      ReadUntil(client, "\r\n\r\n"));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, ChunkedBody) {
+  TcpStream client = Send("POST /echo HTTP/1.1\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "\r\n"
+                          "5\r\nhello\r\n"
+                          "6;extension\r\n world\r\n"
+                          "0\r\n"
+                          "Trailer: ignored\r\n"
+                          "\r\n"
+                          "GET /next HTTP/1.1\r\n\r\n");
+
+  Server::Exchange exchange = Next();
+
+  EXPECT_EQ("hello world", ReadBody(exchange));
+
+  *exchange.Respond(200);
+
+  // The next request is read after the body.
+  EXPECT_EQ("/next", Next().request().target());
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, UnreadBodyDiscarded) {
+  TcpStream client = Send("POST /ignore HTTP/1.1\r\n"
+                          "Content-Length: 5\r\n"
+                          "\r\n"
+                          "hello"
+                          "GET /next HTTP/1.1\r\n\r\n");
+
+  Server::Exchange exchange = Next();
+
+  *exchange.Respond(200);
+
+  EXPECT_EQ("/next", Next().request().target());
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, StreamingResponse) {
+  TcpStream client = Send("GET /stream HTTP/1.1\r\n\r\n");
+
+  Server::Exchange exchange = Next();
+
+  *exchange.Begin(200);
+  *exchange.Write("hello");
+  *exchange.Write(" world");
+  *exchange.End();
+
+  EXPECT_EQ(
+      "HTTP/1.1 200 OK\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n"
+      "5\r\nhello\r\n"
+      "6\r\n world\r\n"
+      "0\r\n\r\n",
+      ReadUntil(client, "0\r\n\r\n"));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, Head) {
+  TcpStream client = Send("HEAD / HTTP/1.1\r\n\r\n");
+
+  *Next().Respond(200, {}, "hello");
+
+  // Content-Length of the body that would have been sent but no body.
+  EXPECT_EQ(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 5\r\n"
+      "\r\n",
+      ReadUntil(client, "\r\n\r\n"));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, ConnectionClose) {
+  TcpStream client = Send("GET / HTTP/1.1\r\n"
+                          "Connection: close\r\n"
+                          "\r\n");
+
+  Server::Exchange exchange = Next();
+
+  EXPECT_FALSE(exchange.request().keep_alive());
+
+  *exchange.Respond(200, {}, "bye");
+
+  EXPECT_EQ(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 3\r\n"
+      "Connection: close\r\n"
+      "\r\n"
+      "bye",
+      ReadAll(client));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, Http10) {
+  TcpStream client = Send("GET / HTTP/1.0\r\n\r\n");
+
+  Server::Exchange exchange = Next();
+
+  EXPECT_FALSE(exchange.request().keep_alive());
+
+  // No chunked encoding for HTTP/1.0, the body ends with the
+  // connection instead.
+  *exchange.Begin(200);
+  *exchange.Write("hello");
+  *exchange.End();
+
+  EXPECT_EQ(
+      "HTTP/1.0 200 OK\r\n"
+      "Connection: close\r\n"
+      "\r\n"
+      "hello",
+      ReadAll(client));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, BadRequest) {
+  TcpStream client = Send("garbage\r\n\r\n");
+
+  EXPECT_EQ(
+      "HTTP/1.1 400 Bad Request\r\n"
+      "Content-Length: 0\r\n"
+      "Connection: close\r\n"
+      "\r\n",
+      ReadAll(client));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, UnsupportedVersion) {
+  TcpStream client = Send("GET / HTTP/2.0\r\n\r\n");
+
+  EXPECT_EQ(
+      "HTTP/1.1 505 HTTP Version Not Supported\r\n"
+      "Content-Length: 0\r\n"
+      "Connection: close\r\n"
+      "\r\n",
+      ReadAll(client));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, HeadersTooLarge) {
+  *server_.Close();
+
+  ServerOptions options;
+  options.max_header_size = 64;
+
+  server_ = *Server::Listen("127.0.0.1", 0, options);
+
+  TcpStream client = Send("GET / HTTP/1.1\r\n"
+                          "X-Large: " + std::string(100, 'x') + "\r\n"
+                          "\r\n");
+
+  EXPECT_EQ(
+      "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+      "Content-Length: 0\r\n"
+      "Connection: close\r\n"
+      "\r\n",
+      ReadAll(client));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, Abandoned) {
+  TcpStream client = Send("GET / HTTP/1.1\r\n\r\n");
+
+  {
+    // Never responded to.
+    Server::Exchange exchange = Next();
+  }
+
+  EXPECT_EQ(
+      "HTTP/1.1 500 Internal Server Error\r\n"
+      "Content-Length: 0\r\n"
+      "Connection: close\r\n"
+      "\r\n",
+      ReadAll(client));
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, MaxConnections) {
+  *server_.Close();
+
+  ServerOptions options;
+  options.max_connections = 1;
+
+  server_ = *Server::Listen("127.0.0.1", 0, options);
+
+  TcpStream first = Send("GET /first HTTP/1.1\r\n\r\n");
+
+  Server::Exchange exchange = Next();
+
+  EXPECT_EQ("/first", exchange.request().target());
+
+  // Gets connected (via the listen backlog) but not accepted.
+  TcpStream second = Send("GET /second HTTP/1.1\r\n\r\n");
+
+  RunUntilIdle();
+
+  EXPECT_EQ(1u, server_.connections());
+
+  *exchange.Respond(200);
+
+  // Closing the first connection lets the second one be accepted.
+  *first.Close();
+
+  exchange = Next();
+
+  EXPECT_EQ("/second", exchange.request().target());
+
+  *exchange.Respond(200);
+
+  *second.Close();
+}
+
+
+TEST_F(HttpServerTest, InterruptServe) {
+  auto [future, k] = PromisifyForTest(server_.Serve() >> Head());
+
+  Interrupt interrupt;
+
+  k.Register(interrupt);
+
+  k.Start();
+
+  RunUntilIdle();
+
+  interrupt.Trigger();
+
+  RunUntil(future);
+
+  EXPECT_THROW(future.get(), eventuals::Stopped);
+
+  // Can still serve after being interrupted.
+  TcpStream client = Send("GET / HTTP/1.1\r\n\r\n");
+
+  *Next().Respond(200);
+
+  *client.Close();
+}
+
+
+TEST_F(HttpServerTest, CloseEndsServe) {
+  auto [future, k] = PromisifyForTest(
+      server_.Serve()
+      >> Map([](Server::Exchange&& exchange) {
+          return exchange.Respond(200);
+        })
+      >> Loop());
+
+  k.Start();
+
+  RunUntilIdle();
+
+  *server_.Close();
+
+  RunUntil(future);
+
+  EXPECT_NO_THROW(future.get());
+}
+
+} // namespace
+} // namespace eventuals::test
@@ -1,5 +1,8 @@
 #include "eventuals/http.h"
 
+#include <thread>
+#include <vector>
+
 #include "event-loop-test.h"
 #include "eventuals/interrupt.h"
 #include "eventuals/let.h"
@@ -353,5 +356,106 @@ TEST_P(HttpTest, GetDuplicateHeaders) {
   EXPECT_EQ("<html>Hello World!</html>", response.body());
 }
 
+
+TEST_P(HttpTest, GetHeaderCaseInsensitive) {
+  std::string scheme = GetParam();
+
+  HttpMockServer server(scheme);
+
+  // NOTE: using an 'http::Client' configured to work for the server.
+  Client client = server.Client();
+
+  EXPECT_CALL(server, ReceivedHeaders)
+      .WillOnce([](auto socket, const std::string& data) {
+        socket->Send(
+            "HTTP/1.1 200 OK\r\n"
+            "Foo:   Bar1 \r\n"
+            "foo: Bar2\r\n"
+            "Content-Length: 25\r\n"
+            "\r\n"
+            "<html>Hello World!</html>\r\n"
+            "\r\n");
+
+        socket->Close();
+      });
+
+  auto response = *client.Get(server.uri());
+
+  EXPECT_EQ(200, response.code());
+
+  // Returns the (trimmed) value of the first matching header.
+  EXPECT_EQ("Bar1", response.header("FOO"));
+  EXPECT_EQ("25", response.header("content-length"));
+  EXPECT_EQ(std::nullopt, response.header("Bar"));
+
+  // NOTE: 'headers()' is case-sensitive (it's a 'std::map').
+  EXPECT_THAT(
+      response.headers(),
+      testing::Contains(Header("Foo", "Bar1")));
+  EXPECT_THAT(
+      response.headers(),
+      testing::Contains(Header("foo", "Bar2")));
+
+  // Copies refer to their own headers.
+  Response copy = response;
+
+  response = Response();
+
+  EXPECT_EQ("Bar1", copy.header("Foo"));
+  EXPECT_EQ("Bar2", copy.headers().at("foo"));
+  EXPECT_EQ(std::nullopt, response.header("Foo"));
+}
+
+
+TEST_P(HttpTest, GetHeadersFromManyThreads) {
+  std::string scheme = GetParam();
+
+  HttpMockServer server(scheme);
+
+  // NOTE: using an 'http::Client' configured to work for the server.
+  Client client = server.Client();
+
+  EXPECT_CALL(server, ReceivedHeaders)
+      .WillOnce([](auto socket, const std::string& data) {
+        socket->Send(
+            "HTTP/1.1 200 OK\r\n"
+            "Foo: Bar1\r\n"
+            "Foo: Bar2\r\n"
+            "Content-Length: 25\r\n"
+            "\r\n"
+            "<html>Hello World!</html>\r\n"
+            "\r\n");
+
+        socket->Close();
+      });
+
+  const Response response = *client.Get(server.uri());
+
+  // Every thread should see the same map even though they all try
+  // and build it at the same time.
+  constexpr size_t kThreads = 8;
+
+  std::vector<const Headers*> headers(kThreads, nullptr);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < kThreads; i++) {
+    threads.emplace_back([&, i]() {
+      headers[i] = &response.headers();
+    });
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (const Headers* other : headers) {
+    EXPECT_EQ(headers[0], other);
+  }
+
+  EXPECT_THAT(
+      response.headers(),
+      testing::Contains(Header("Foo", "Bar1, Bar2")));
+}
+
 } // namespace
 } // namespace eventuals::http::test
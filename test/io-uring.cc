@@ -0,0 +1,189 @@
+#include "eventuals/io-uring.h"
+
+#if EVENTUALS_IO_URING
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace eventuals::test {
+namespace {
+
+class IoUringTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    io_uring_ = IoUring::Create(/* entries = */ 8);
+
+    if (!io_uring_) {
+      GTEST_SKIP() << "io_uring is not supported";
+    }
+
+    std::ofstream ofs(path_);
+    ofs << contents_;
+    ofs.close();
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(path_);
+  }
+
+  // Waits for completions and reaps them until there aren't any
+  // inflight operations.
+  void Wait() {
+    while (io_uring_->inflight() > 0 || io_uring_->prepared() > 0) {
+      io_uring_->Submit();
+      pollfd fd = {io_uring_->eventfd(), POLLIN, 0};
+      ASSERT_EQ(1, poll(&fd, 1, /* timeout = */ 10000));
+      io_uring_->Reap();
+    }
+  }
+
+  std::unique_ptr<IoUring> io_uring_;
+
+  const std::filesystem::path path_ = "test_io_uring";
+  const std::string contents_ = "Hello io_uring!";
+};
+
+
+TEST_F(IoUringTest, OpenReadClose) {
+  int fd = -1;
+
+  IoUring::Operation open;
+  open.callback = [&](int result) {
+    fd = result;
+  };
+
+  io_uring_->Open(path_.c_str(), O_RDONLY, 0, &open);
+
+  EXPECT_EQ(1u, io_uring_->prepared());
+
+  Wait();
+
+  ASSERT_GE(fd, 0);
+
+  std::string data(contents_.size(), '\0');
+  int read = -1;
+
+  IoUring::Operation operation;
+  operation.callback = [&](int result) {
+    read = result;
+  };
+
+  io_uring_->Read(fd, data.data(), data.size(), 0, &operation);
+
+  Wait();
+
+  EXPECT_EQ(static_cast<int>(contents_.size()), read);
+  EXPECT_EQ(contents_, data);
+
+  int closed = -1;
+
+  IoUring::Operation close;
+  close.callback = [&](int result) {
+    closed = result;
+  };
+
+  io_uring_->Close(fd, &close);
+
+  Wait();
+
+  EXPECT_EQ(0, closed);
+}
+
+
+TEST_F(IoUringTest, Write) {
+  int fd = open(path_.c_str(), O_WRONLY);
+  ASSERT_GE(fd, 0);
+
+  const std::string data = "HELLO";
+  int written = -1;
+
+  IoUring::Operation operation;
+  operation.callback = [&](int result) {
+    written = result;
+  };
+
+  io_uring_->Write(fd, data.data(), data.size(), 0, &operation);
+
+  Wait();
+
+  close(fd);
+
+  EXPECT_EQ(static_cast<int>(data.size()), written);
+
+  std::ifstream ifs(path_);
+  std::string contents;
+  std::getline(ifs, contents);
+
+  EXPECT_EQ("HELLO io_uring!", contents);
+}
+
+
+TEST_F(IoUringTest, Fail) {
+  int result = 0;
+
+  IoUring::Operation operation;
+  operation.callback = [&](int r) {
+    result = r;
+  };
+
+  char buffer[16];
+
+  io_uring_->Read(-1, buffer, sizeof(buffer), 0, &operation);
+
+  Wait();
+
+  EXPECT_EQ(-EBADF, result);
+}
+
+
+TEST_F(IoUringTest, Batched) {
+  int fd = open(path_.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+
+  // More operations than there are entries in the submission queue
+  // so that some of them must be kept in the backlog.
+  static constexpr size_t kOperations = 20;
+
+  std::vector<IoUring::Operation> operations(kOperations);
+  std::vector<std::string> data(kOperations, std::string(5, '\0'));
+
+  size_t completed = 0;
+
+  for (size_t i = 0; i < kOperations; i++) {
+    operations[i].callback = [&](int result) {
+      EXPECT_EQ(5, result);
+      completed++;
+    };
+    io_uring_->Read(fd, data[i].data(), 5, 0, &operations[i]);
+  }
+
+  EXPECT_EQ(kOperations, io_uring_->prepared());
+
+  // All of the prepared operations that fit are submitted at once.
+  EXPECT_EQ(8u, io_uring_->Submit());
+  EXPECT_EQ(8u, io_uring_->inflight());
+
+  Wait();
+
+  close(fd);
+
+  EXPECT_EQ(kOperations, completed);
+
+  for (const std::string& s : data) {
+    EXPECT_EQ("Hello", s);
+  }
+}
+
+} // namespace
+} // namespace eventuals::test
+
+#endif
@@ -1,11 +1,14 @@
 #include "eventuals/lock.h"
 
 #include <thread>
+#include <vector>
 
 #include "eventuals/if.h"
 #include "eventuals/iterate.h"
 #include "eventuals/just.h"
+#include "eventuals/loop.h"
 #include "eventuals/map.h"
+#include "eventuals/range.h"
 #include "eventuals/reduce.h"
 #include "eventuals/terminal.h"
 #include "eventuals/then.h"
@@ -413,5 +416,84 @@ TEST(LockTest, ConditionVariable_UseAfterFree) {
   *foo.NotifyAll();
 }
 
+
+TEST(LockTest, ReleaseRacingWithAcquire) {
+  // A bug was caught in the wild where 'Lock::Release()' would only
+  // mark the waiter as no longer having acquired the lock _after_
+  // making the lock available. In between another thread could
+  // acquire the lock and resume (e.g., via a 'ConditionVariable') the
+  // releasing continuation which would then reuse the same waiter to
+  // acquire the lock again and fail with "recursive lock acquire
+  // detected".
+  //
+  // NOTE: the window is small so a single reader (which reuses the
+  // same continuations, and thus waiters, for every value) takes many
+  // values out of a slot that multiple writers on their own threads
+  // are waiting to put values into.
+  struct Slot : public Synchronizable {
+    Slot()
+      : empty_(&lock()),
+        full_(&lock()) {}
+
+    auto Put() {
+      return Synchronized(
+          empty_.Wait([this]() {
+            return full_value_;
+          })
+          >> Then([this]() {
+              full_value_ = true;
+              full_.Notify();
+            }));
+    }
+
+    auto Take() {
+      return Synchronized(
+          full_.Wait([this]() {
+            return !full_value_;
+          })
+          >> Then([this]() {
+              full_value_ = false;
+              empty_.Notify();
+            }));
+    }
+
+    ConditionVariable empty_;
+    ConditionVariable full_;
+    bool full_value_ = false;
+  };
+
+  static constexpr int kWriters = 4;
+
+  // NOTE: reading in rounds since a reader nests deeper on the stack
+  // for every value it can read without waiting.
+  static constexpr int kRounds = 100;
+  static constexpr int kValues = 1000;
+
+  Slot slot;
+
+  for (int round = 0; round < kRounds; round++) {
+    std::vector<std::thread> writers;
+    for (int i = 0; i < kWriters; i++) {
+      writers.emplace_back([&]() {
+        for (int value = 0; value < kValues / kWriters; value++) {
+          *slot.Put();
+        }
+      });
+    }
+
+    *(Range(kValues)
+      >> Map([&slot](int) {
+          return slot.Take();
+        })
+      >> Loop());
+
+    for (std::thread& writer : writers) {
+      writer.join();
+    }
+  }
+
+  EXPECT_FALSE(slot.full_value_);
+}
+
 } // namespace
 } // namespace eventuals::test
@@ -120,5 +120,26 @@ TEST(Pipe, WaitForClosedAndEmpty) {
       future.wait_for(std::chrono::seconds(0)));
 }
 
+TEST(Pipe, ReadManyValuesWithoutWaiting) {
+  // NOTE: enough values that a reader would overflow its stack if it
+  // recursed for every value it reads.
+  constexpr size_t kValues = 100000;
+
+  Pipe<int> pipe;
+
+  for (size_t i = 0; i < kValues; i++) {
+    *pipe.Write(1);
+  }
+
+  *pipe.Close();
+
+  auto e = [&pipe]() {
+    return pipe.Read()
+        >> Collect<std::vector>();
+  };
+
+  EXPECT_EQ(kValues, (*e()).size());
+}
+
 } // namespace
 } // namespace eventuals::test
@@ -0,0 +1,175 @@
+#include "eventuals/scheduler-metrics.h"
+
+#include <chrono>
+#include <thread>
+
+#include "eventuals/event-loop.h"
+#include "eventuals/promisify.h"
+#include "eventuals/static-thread-pool.h"
+#include "eventuals/then.h"
+#include "gtest/gtest.h"
+#include "test/event-loop-test.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+using std::chrono::nanoseconds;
+
+TEST(SchedulerMetricsTest, Histogram) {
+  if constexpr (!SchedulerMetrics::ENABLED) {
+    GTEST_SKIP() << "Scheduler metrics are compiled out";
+  }
+
+  EXPECT_EQ(0, SchedulerMetrics::BucketOf(nanoseconds(0)));
+  EXPECT_EQ(1, SchedulerMetrics::BucketOf(nanoseconds(1)));
+  EXPECT_EQ(2, SchedulerMetrics::BucketOf(nanoseconds(2)));
+  EXPECT_EQ(2, SchedulerMetrics::BucketOf(nanoseconds(3)));
+  EXPECT_EQ(11, SchedulerMetrics::BucketOf(nanoseconds(1024)));
+  EXPECT_EQ(
+      SchedulerMetrics::BUCKETS - 1,
+      SchedulerMetrics::BucketOf(std::chrono::hours(1)));
+
+  SchedulerMetrics metrics(2);
+
+  SchedulerMetrics::TimePoint start;
+
+  for (int i = 0; i < 99; i++) {
+    metrics.RecordRun(0, start, start + nanoseconds(100));
+  }
+
+  metrics.RecordRun(1, start, start + nanoseconds(10000));
+
+  SchedulerMetrics::Snapshot snapshot = metrics.snapshot();
+
+  ASSERT_EQ(2, snapshot.workers.size());
+
+  EXPECT_EQ(99, snapshot.workers[0].run_time.count());
+  EXPECT_EQ(1, snapshot.workers[1].run_time.count());
+
+  SchedulerMetrics::Histogram run_time = snapshot.total().run_time;
+
+  EXPECT_EQ(100, run_time.count());
+  EXPECT_EQ(nanoseconds(128), run_time.Percentile(0.5));
+  EXPECT_EQ(nanoseconds(128), run_time.Percentile(0.99));
+  EXPECT_EQ(nanoseconds(16384), run_time.Percentile(1.0));
+
+  EXPECT_EQ(nanoseconds(0), SchedulerMetrics::Histogram().Percentile(0.5));
+}
+
+
+TEST(SchedulerMetricsTest, Counters) {
+  if constexpr (!SchedulerMetrics::ENABLED) {
+    GTEST_SKIP() << "Scheduler metrics are compiled out";
+  }
+
+  SchedulerMetrics metrics(1);
+
+  SchedulerMetrics::TimePoint submitted;
+
+  metrics.RecordSubmit(0);
+  metrics.RecordSubmit(0);
+  metrics.RecordDequeue(0, submitted, submitted + nanoseconds(1000));
+  metrics.RecordWakeup(0);
+  metrics.RecordContinuable(0, true);
+  metrics.RecordContinuable(0, true);
+  metrics.RecordContinuable(0, true);
+  metrics.RecordContinuable(0, false);
+
+  SchedulerMetrics::Worker worker = metrics.snapshot().workers[0];
+
+  EXPECT_EQ(2, worker.submitted);
+  EXPECT_EQ(1, worker.dequeued);
+  EXPECT_EQ(1, worker.depth());
+  EXPECT_EQ(1, worker.wakeups);
+  EXPECT_EQ(1, worker.latency.count());
+  EXPECT_EQ(nanoseconds(1024), worker.latency.Percentile(1.0));
+  EXPECT_DOUBLE_EQ(0.75, worker.continuable_hit_rate());
+}
+
+
+TEST(SchedulerMetricsTest, StaticThreadPool) {
+  if constexpr (!SchedulerMetrics::ENABLED) {
+    GTEST_SKIP() << "Scheduler metrics are compiled out";
+  }
+
+  StaticThreadPool& pool = StaticThreadPool::Scheduler();
+
+  StaticThreadPool::Requirements requirements(
+      "metrics",
+      Pinned::ExactCPU(0));
+
+  // NOTE: the pool is shared with other tests so we only check
+  // differences between snapshots.
+  SchedulerMetrics::Worker before = pool.metrics().snapshot().workers[0];
+
+  // Submitted from this thread (a "miss") and then scheduled again
+  // from the pool (a "hit").
+  auto e = pool.Schedule(
+      &requirements,
+      Then([&]() {
+        return pool.Schedule(
+            &requirements,
+            Then([]() {
+              return 42;
+            }));
+      }));
+
+  EXPECT_EQ(42, *std::move(e));
+
+  // NOTE: run time is recorded _after_ running the callback which
+  // might be after we've gotten the result.
+  SchedulerMetrics::Worker after;
+  do {
+    std::this_thread::yield();
+    after = pool.metrics().snapshot().workers[0];
+  } while (after.run_time.count() == before.run_time.count());
+
+  EXPECT_LE(before.submitted + 1, after.submitted);
+  EXPECT_LE(before.dequeued + 1, after.dequeued);
+  EXPECT_LE(before.wakeups + 1, after.wakeups);
+  EXPECT_LE(before.latency.count() + 1, after.latency.count());
+  EXPECT_LE(before.continuable_hits + 1, after.continuable_hits);
+  EXPECT_LE(before.continuable_misses + 1, after.continuable_misses);
+}
+
+
+class SchedulerMetricsEventLoopTest : public EventLoopTest {};
+
+
+TEST_F(SchedulerMetricsEventLoopTest, EventLoop) {
+  if constexpr (!SchedulerMetrics::ENABLED) {
+    GTEST_SKIP() << "Scheduler metrics are compiled out";
+  }
+
+  auto e = EventLoop::Default().Schedule(Then([]() {
+    return 42;
+  }));
+
+  auto [future, k] = PromisifyForTest(std::move(e));
+
+  k.Start();
+
+  RunUntil(future);
+
+  EXPECT_EQ(42, future.get());
+
+  SchedulerMetrics::Snapshot snapshot = EventLoop::Default()
+                                            .metrics()
+                                            .snapshot();
+
+  ASSERT_EQ(1, snapshot.workers.size());
+
+  SchedulerMetrics::Worker& worker = snapshot.workers[0];
+
+  EXPECT_LE(1, worker.submitted);
+  EXPECT_EQ(worker.submitted, worker.dequeued);
+  EXPECT_EQ(0, worker.depth());
+  EXPECT_LE(1, worker.wakeups);
+  EXPECT_EQ(worker.dequeued, worker.latency.count());
+  EXPECT_EQ(worker.dequeued, worker.run_time.count());
+  EXPECT_LE(1, worker.continuable_misses);
+}
+
+} // namespace
+} // namespace eventuals::test
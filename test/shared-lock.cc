@@ -0,0 +1,239 @@
+#include "eventuals/shared-lock.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eventuals/sharded-lock.h"
+#include "eventuals/terminal.h"
+#include "eventuals/then.h"
+#include "gtest/gtest.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+template <typename Future>
+bool IsReady(Future& future) {
+  return future.wait_for(std::chrono::seconds(0))
+      == std::future_status::ready;
+}
+
+TEST(SharedLockTest, ReadersShare) {
+  SharedLock lock;
+
+  auto reader = [&](std::string name) {
+    return AcquireShared(&lock)
+        >> Then([name]() { return name; });
+  };
+
+  auto [future1, r1] = PromisifyForTest(reader("r1"));
+  auto [future2, r2] = PromisifyForTest(reader("r2"));
+
+  r1.Start();
+  r2.Start();
+
+  EXPECT_EQ("r1", future1.get());
+  EXPECT_EQ("r2", future2.get());
+
+  EXPECT_FALSE(lock.Available());
+
+  auto [future3, w] = PromisifyForTest(
+      Acquire(&lock)
+      >> Then([]() { return "w"; }));
+
+  w.Start();
+
+  EXPECT_FALSE(IsReady(future3));
+
+  *ReleaseShared(&lock);
+
+  EXPECT_FALSE(IsReady(future3));
+
+  *ReleaseShared(&lock);
+
+  EXPECT_STREQ("w", future3.get());
+
+  *Release(&lock);
+
+  EXPECT_TRUE(lock.Available());
+}
+
+
+TEST(SharedLockTest, WriterPreferred) {
+  SharedLock lock;
+
+  *AcquireShared(&lock);
+
+  auto [future1, w] = PromisifyForTest(
+      Acquire(&lock)
+      >> Then([]() { return "w"; }));
+
+  w.Start();
+
+  EXPECT_FALSE(IsReady(future1));
+
+  // A new reader must wait behind the waiting writer even though the
+  // lock is currently only held shared.
+  auto [future2, r] = PromisifyForTest(
+      AcquireShared(&lock)
+      >> Then([]() { return "r"; }));
+
+  r.Start();
+
+  EXPECT_FALSE(IsReady(future2));
+
+  *ReleaseShared(&lock);
+
+  EXPECT_STREQ("w", future1.get());
+
+  EXPECT_FALSE(IsReady(future2));
+
+  *Release(&lock);
+
+  EXPECT_STREQ("r", future2.get());
+
+  *ReleaseShared(&lock);
+
+  EXPECT_TRUE(lock.Available());
+}
+
+
+TEST(SharedLockTest, WriterReleaseAdmitsWaitingReaders) {
+  SharedLock lock;
+
+  // NOTE: the writer's continuation must outlive its hold on the lock
+  // so we can't just use '*Acquire(&lock)' here.
+  auto [future0, w0] = PromisifyForTest(Acquire(&lock));
+
+  w0.Start();
+
+  future0.get();
+
+  auto reader = [&](std::string name) {
+    return AcquireShared(&lock)
+        >> Then([name]() { return name; });
+  };
+
+  auto [future1, r1] = PromisifyForTest(reader("r1"));
+  auto [future2, r2] = PromisifyForTest(reader("r2"));
+
+  r1.Start();
+  r2.Start();
+
+  auto [future3, w] = PromisifyForTest(
+      Acquire(&lock)
+      >> Then([]() { return "w"; }));
+
+  w.Start();
+
+  EXPECT_FALSE(IsReady(future1));
+  EXPECT_FALSE(IsReady(future2));
+  EXPECT_FALSE(IsReady(future3));
+
+  // Readers that were waiting before the next writer get admitted
+  // first so that they aren't starved.
+  *Release(&lock);
+
+  EXPECT_EQ("r1", future1.get());
+  EXPECT_EQ("r2", future2.get());
+
+  EXPECT_FALSE(IsReady(future3));
+
+  *ReleaseShared(&lock);
+  *ReleaseShared(&lock);
+
+  EXPECT_STREQ("w", future3.get());
+
+  *Release(&lock);
+
+  EXPECT_TRUE(lock.Available());
+}
+
+
+TEST(SharedLockTest, OwnedByCurrentSchedulerContext) {
+  SharedLock lock;
+
+  auto e = [&]() {
+    return Acquire(&lock)
+        >> Then([&]() {
+             return lock.OwnedByCurrentSchedulerContext();
+           })
+        >> Release(&lock)
+        >> Then([&](bool owned) {
+             return owned && !lock.OwnedByCurrentSchedulerContext();
+           });
+  };
+
+  EXPECT_TRUE(*e());
+}
+
+
+TEST(SharedLockTest, Threads) {
+  SharedLock lock;
+
+  // NOTE: not atomic, the lock is what protects these.
+  int value = 0;
+  int copy = 0;
+
+  constexpr int kThreads = 8;
+  constexpr int kIterations = 1000;
+
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < kThreads; i++) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < kIterations; j++) {
+        if ((i + j) % 4 == 0) {
+          *(Acquire(&lock)
+            >> Then([&]() {
+                value++;
+                copy = value;
+              })
+            >> Release(&lock));
+        } else {
+          bool consistent = *(AcquireShared(&lock)
+                              >> Then([&]() {
+                                  return value == copy;
+                                })
+                              >> ReleaseShared(&lock));
+          EXPECT_TRUE(consistent);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(kThreads * kIterations / 4, value);
+  EXPECT_TRUE(lock.Available());
+}
+
+
+TEST(ShardedLockTest, Synchronized) {
+  ShardedLock<16> locks;
+
+  EXPECT_EQ(
+      ShardedLock<16>::IndexOf(std::string("key")),
+      ShardedLock<16>::IndexOf(std::string("key")));
+
+  EXPECT_EQ(&locks.lock(42), &locks.lock(42));
+
+  auto e = [&]() {
+    return locks.Synchronized(
+        42,
+        Then([&]() {
+          return locks.lock(42).OwnedByCurrentSchedulerContext();
+        }));
+  };
+
+  EXPECT_TRUE(*e());
+
+  EXPECT_TRUE(locks.lock(42).Available());
+}
+
+} // namespace
+} // namespace eventuals::test
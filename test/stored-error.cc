@@ -0,0 +1,111 @@
+#include "eventuals/stored-error.h"
+
+#include <string>
+#include <vector>
+
+#include "eventuals/compose.h"
+#include "eventuals/errors.h"
+#include "eventuals/raise.h"
+#include "eventuals/scheduler.h"
+#include "eventuals/terminal.h"
+#include "gtest/gtest.h"
+#include "test/allocations.h"
+
+namespace eventuals::test {
+namespace {
+
+// Scheduler that is never "continuable" and instead defers every
+// callback until 'RunUntilIdle()' is called so that every error must
+// be propagated across a scheduler "hop".
+class DeferringScheduler final : public Scheduler {
+ public:
+  DeferringScheduler() {
+    // Avoid any allocations when submitting.
+    callbacks_.reserve(16);
+  }
+
+  bool Continuable(const Context&) override {
+    return false;
+  }
+
+  void Submit(Callback<void()> callback, Context& context) override {
+    CHECK_LT(callbacks_.size(), callbacks_.capacity());
+    callbacks_.push_back(std::move(callback));
+  }
+
+  void Clone(Context& context) override {}
+
+  void RunUntilIdle() {
+    while (!callbacks_.empty()) {
+      Callback<void()> callback = std::move(callbacks_.back());
+      callbacks_.pop_back();
+      callback();
+    }
+  }
+
+ private:
+  std::vector<Callback<void()>> callbacks_;
+};
+
+
+TEST(StoredErrorTest, RescheduleFailDoesNotAllocate) {
+  DeferringScheduler scheduler;
+
+  Scheduler::Context context(&scheduler, "deferred");
+
+  bool failed = false;
+
+  auto k = Build(
+      Raise(RuntimeError("error"))
+      >> Reschedule(context.Borrow())
+      >> Terminal()
+             .fail([&](RuntimeError&& error) {
+               EXPECT_EQ("error", std::string(error.what()));
+               failed = true;
+             }));
+
+  size_t before = Allocations();
+
+  k.Start();
+
+  EXPECT_FALSE(failed);
+
+  scheduler.RunUntilIdle();
+
+  EXPECT_EQ(before, Allocations());
+
+  EXPECT_TRUE(failed);
+}
+
+
+TEST(StoredErrorTest, UndeclaredErrorFallsBackToHeap) {
+  struct K {
+    void Fail(RuntimeError&& error) {
+      message = error.what();
+    }
+
+    std::string message;
+  };
+
+  StoredError<K, std::tuple<>> error;
+
+  size_t before = Allocations();
+
+  error.Store(RuntimeError("error"));
+
+  EXPECT_LT(before, Allocations());
+
+  K k;
+  error.Fail(k);
+
+  EXPECT_EQ("error", k.message);
+
+  // Can be reused after calling 'Fail()'.
+  error.Store(RuntimeError("another error"));
+  error.Fail(k);
+
+  EXPECT_EQ("another error", k.message);
+}
+
+} // namespace
+} // namespace eventuals::test
@@ -1,5 +1,6 @@
 #include "eventuals/task.h"
 
+#include <array>
 #include <string>
 
 #include "eventuals/catch.h"
@@ -131,6 +132,11 @@ TEST(Task, CatchesRaiseFinallyInside) {
 
 TEST(Task, TaskWithNonCopyable) {
   struct NonCopyable {
+    // NOTE: an explicit constructor is required because as of C++20 a
+    // type with any user-declared constructors isn't an aggregate.
+    explicit NonCopyable(int x)
+      : x(x) {}
+
     NonCopyable(NonCopyable&&) = default;
     NonCopyable(const NonCopyable&) = delete;
 
@@ -795,5 +801,88 @@ TEST(Task, RaisesGeneralError) {
       ThrowsMessage<TypeErasedError>(StrEq("runtime error")));
 }
 
+class CountingAllocator final : public Allocator {
+ public:
+  void* Allocate(size_t size, size_t alignment) override {
+    allocations++;
+    return DefaultAllocator()->Allocate(size, alignment);
+  }
+
+  void Deallocate(void* pointer, size_t size, size_t alignment) override {
+    deallocations++;
+    DefaultAllocator()->Deallocate(pointer, size, alignment);
+  }
+
+  size_t allocations = 0;
+  size_t deallocations = 0;
+};
+
+// Sets the allocator of the current 'Scheduler::Context' for the
+// lifetime of the guard so that a failing assertion can't leak it
+// into later tests.
+class AllocatorGuard final {
+ public:
+  AllocatorGuard(Allocator* allocator)
+    : previous_(Scheduler::Context::Get()->allocator()) {
+    Scheduler::Context::Get()->set_allocator(allocator);
+  }
+
+  ~AllocatorGuard() {
+    Scheduler::Context::Get()->set_allocator(previous_);
+  }
+
+ private:
+  Allocator* previous_;
+};
+
+TEST(Task, InlineStorage) {
+  CountingAllocator allocator;
+
+  AllocatorGuard guard(&allocator);
+
+  auto small = []() -> Task::Of<int>::Inline<1024> {
+    return []() {
+      return Just(42);
+    };
+  };
+
+  EXPECT_EQ(42, *small());
+
+  EXPECT_EQ(0, allocator.allocations);
+
+  auto large = []() -> Task::Of<int>::Inline<1024> {
+    return []() {
+      return Just(std::array<char, 1024>())
+          >> Then([](auto&&) {
+               return 42;
+             });
+    };
+  };
+
+  EXPECT_EQ(42, *large());
+
+  EXPECT_EQ(1, allocator.allocations);
+  EXPECT_EQ(1, allocator.deallocations);
+}
+
+TEST(Task, InlineStorageDefault) {
+  CountingAllocator allocator;
+
+  AllocatorGuard guard(&allocator);
+
+  // Even a 'Task' of 'Just(42)' is too big for the default inline
+  // size once it has been type-erased.
+  auto task = []() -> Task::Of<int> {
+    return []() {
+      return Just(42);
+    };
+  };
+
+  EXPECT_EQ(42, *task());
+
+  EXPECT_EQ(1, allocator.allocations);
+  EXPECT_EQ(1, allocator.deallocations);
+}
+
 } // namespace
 } // namespace eventuals::test
@@ -0,0 +1,269 @@
+#include "eventuals/tcp.h"
+
+#include <cstring>
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "eventuals/event-loop.h"
+#include "eventuals/head.h"
+#include "eventuals/reduce.h"
+#include "eventuals/then.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "test/event-loop-test.h"
+#include "test/promisify-for-test.h"
+
+namespace eventuals::test {
+namespace {
+
+using testing::StrEq;
+using testing::ThrowsMessage;
+
+class TcpTest : public EventLoopTest {
+ protected:
+  // Connects a client to 'listener_' returning the client and the
+  // accepted server side of the connection.
+  std::pair<TcpStream, TcpStream> Connect() {
+    auto [future, k] = PromisifyForTest(listener_.Accept() >> Head());
+
+    k.Start();
+
+    TcpStream client = *TcpStream::Connect("127.0.0.1", listener_.port());
+
+    RunUntil(future);
+
+    return {std::move(client), future.get()};
+  }
+
+  // Reads from 'stream' until the end of the stream.
+  std::string ReadAll(TcpStream& stream) {
+    return *(stream.Read()
+             >> Reduce(
+                 /* data = */ std::string(),
+                 [](std::string& data) {
+                   return Then([&](std::string_view chunk) {
+                     data.append(chunk);
+                     return true;
+                   });
+                 }));
+  }
+
+  void SetUp() override {
+    EventLoopTest::SetUp();
+    listener_ = *TcpListener::Listen("127.0.0.1", 0);
+  }
+
+  void TearDown() override {
+    if (listener_.IsOpen()) {
+      *listener_.Close();
+    }
+    EventLoopTest::TearDown();
+  }
+
+  TcpListener listener_;
+};
+
+
+TEST_F(TcpTest, ConnectAccept) {
+  EXPECT_NE(0, listener_.port());
+
+  auto [client, server] = Connect();
+
+  EXPECT_TRUE(client.IsOpen());
+  EXPECT_TRUE(server.IsOpen());
+
+  *client.Close();
+  *server.Close();
+}
+
+
+TEST_F(TcpTest, Echo) {
+  auto [client, server] = Connect();
+
+  *client.Write("hello");
+
+  std::string data = *(server.Read()
+                       >> Head()
+                       >> Then([](std::string_view chunk) {
+                            return std::string(chunk);
+                          }));
+
+  EXPECT_EQ("hello", data);
+
+  *server.Write(data + " world");
+
+  *server.Shutdown();
+
+  EXPECT_EQ("hello world", ReadAll(client));
+
+  *client.Close();
+  *server.Close();
+}
+
+
+TEST_F(TcpTest, EndOfStream) {
+  auto [client, server] = Connect();
+
+  // More than one read buffer's worth so it takes multiple chunks.
+  const std::string data(TcpOptions().read_buffer_size * 3 + 1, 'x');
+
+  *client.Write(data);
+  *client.Shutdown();
+
+  EXPECT_EQ(data, ReadAll(server));
+
+  // Reading after the end of the stream is still the end of the stream.
+  EXPECT_EQ("", ReadAll(server));
+
+  *client.Close();
+  *server.Close();
+}
+
+
+TEST_F(TcpTest, Batched) {
+  auto [client, server] = Connect();
+
+  static constexpr size_t kWrites = 100;
+
+  std::vector<std::future<void>> futures;
+
+  // Start all of the writes before running the event loop so that
+  // everything after the first write gets batched together.
+  for (size_t i = 0; i < kWrites; i++) {
+    auto [future, k] = PromisifyForTest(
+        client.Write(std::to_string(i) + ","));
+    k.Start();
+    futures.push_back(std::move(future));
+  }
+
+  for (std::future<void>& future : futures) {
+    RunUntil(future);
+    future.get();
+  }
+
+  *client.Shutdown();
+
+  std::string expected;
+  for (size_t i = 0; i < kWrites; i++) {
+    expected += std::to_string(i) + ",";
+  }
+
+  EXPECT_EQ(expected, ReadAll(server));
+
+  *client.Close();
+  *server.Close();
+}
+
+
+TEST_F(TcpTest, WriteBufferChain) {
+  auto [client, server] = Connect();
+
+  BufferPool pool(/* buffer_size = */ 16);
+
+  BufferPool::Buffer buffer = pool.Acquire();
+  std::memcpy(buffer.data(), "body", 4);
+  buffer.resize(4);
+
+  BufferChain chain;
+  chain.AppendUnowned("headers\r\n\r\n");
+  chain.Append(std::move(buffer));
+
+  *client.Write(std::move(chain));
+
+  // The pooled buffer was returned once the write completed.
+  EXPECT_EQ(0u, pool.outstanding());
+
+  *client.Shutdown();
+
+  EXPECT_EQ("headers\r\n\r\nbody", ReadAll(server));
+
+  *client.Close();
+  *server.Close();
+}
+
+
+TEST_F(TcpTest, InterruptAccept) {
+  auto [future, k] = PromisifyForTest(listener_.Accept() >> Head());
+
+  Interrupt interrupt;
+
+  k.Register(interrupt);
+
+  k.Start();
+
+  RunUntilIdle();
+
+  interrupt.Trigger();
+
+  RunUntil(future);
+
+  EXPECT_THROW(future.get(), eventuals::Stopped);
+
+  // Can still accept after being interrupted.
+  auto [client, server] = Connect();
+
+  *client.Close();
+  *server.Close();
+}
+
+
+TEST_F(TcpTest, InterruptRead) {
+  auto [client, server] = Connect();
+
+  auto [future, k] = PromisifyForTest(server.Read() >> Head());
+
+  Interrupt interrupt;
+
+  k.Register(interrupt);
+
+  k.Start();
+
+  RunUntilIdle();
+
+  interrupt.Trigger();
+
+  RunUntil(future);
+
+  EXPECT_THROW(future.get(), eventuals::Stopped);
+
+  *client.Close();
+  *server.Close();
+}
+
+
+TEST_F(TcpTest, CloseListener) {
+  auto [future, k] = PromisifyForTest(listener_.Accept() >> Head());
+
+  k.Start();
+
+  RunUntilIdle();
+
+  *listener_.Close();
+
+  RunUntil(future);
+
+  EXPECT_THROW(future.get(), eventuals::Stopped);
+}
+
+
+TEST_F(TcpTest, ConnectRefused) {
+  const int port = listener_.port();
+
+  *listener_.Close();
+
+  EXPECT_THAT(
+      [&]() { *TcpStream::Connect("127.0.0.1", port); },
+      ThrowsMessage<RuntimeError>(StrEq("connection refused")));
+}
+
+
+TEST_F(TcpTest, InvalidAddress) {
+  EXPECT_THAT(
+      [&]() { *TcpStream::Connect("not an address", 80); },
+      ThrowsMessage<RuntimeError>(StrEq("invalid argument")));
+}
+
+} // namespace
+} // namespace eventuals::test
@@ -0,0 +1,79 @@
+#include "eventuals/trace.h"
+
+#include <sstream>
+#include <string>
+
+#include "eventuals/lock.h"
+#include "eventuals/promisify.h"
+#include "eventuals/static-thread-pool.h"
+#include "eventuals/then.h"
+#include "gtest/gtest.h"
+
+namespace eventuals::test {
+namespace {
+
+std::string Export() {
+  std::ostringstream stream;
+  trace::Export(stream);
+  return stream.str();
+}
+
+
+TEST(TraceTest, Export) {
+  if constexpr (!trace::ENABLED) {
+    GTEST_SKIP() << "Tracing is compiled out";
+  }
+
+  trace::Clear();
+
+  trace::Start();
+
+  Lock lock;
+
+  StaticThreadPool::Requirements requirements("trace");
+
+  auto e = [&]() {
+    return StaticThreadPool::Scheduler().Schedule(
+               "\"traced\"",
+               &requirements,
+               Then([]() {
+                 return 41;
+               }))
+        >> Acquire(&lock)
+        >> Then([](int i) {
+             return i + 1;
+           })
+        >> Release(&lock);
+  };
+
+  EXPECT_EQ(42, *e());
+
+  trace::Stop();
+
+  std::string json = Export();
+
+  EXPECT_EQ(0, json.find("{\"traceEvents\":["));
+
+  // Context names are escaped.
+  EXPECT_NE(
+      std::string::npos,
+      json.find("{\"name\":\"\\\"traced\\\"\",\"cat\":\"Run\",\"ph\":\"B\""));
+  EXPECT_NE(
+      std::string::npos,
+      json.find("{\"name\":\"\\\"traced\\\"\",\"cat\":\"Run\",\"ph\":\"E\""));
+
+  EXPECT_NE(std::string::npos, json.find("\"cat\":\"Lock\",\"ph\":\"b\""));
+  EXPECT_NE(std::string::npos, json.find("\"cat\":\"Lock\",\"ph\":\"e\""));
+
+  // Nothing gets recorded after stopping.
+  EXPECT_EQ(42, *e());
+
+  EXPECT_EQ(json, Export());
+
+  trace::Clear();
+
+  EXPECT_EQ(std::string::npos, Export().find("\"cat\""));
+}
+
+} // namespace
+} // namespace eventuals::test